@@ -0,0 +1,58 @@
+// Tests that find and getMore batches requested as OP_MSG document sequences, which the server
+// sends by reference to the documents rather than copying them into the reply, read back exactly
+// like the usual reply arrays.
+// @tags: [requires_getmore]
+(function() {
+'use strict';
+
+const collName = 'find_getmore_document_sequences';
+const coll = db[collName];
+coll.drop();
+
+// Large enough that the server references the documents rather than copying them.
+const padding = 'x'.repeat(64 * 1024);
+const numDocs = 10;
+for (let i = 0; i < numDocs; i++) {
+    assert.commandWorked(coll.insert({_id: i, padding: padding}));
+}
+
+// Small documents are mixed in to check that copied and referenced documents keep their order.
+for (let i = numDocs; i < 2 * numDocs; i++) {
+    assert.commandWorked(coll.insert({_id: i}));
+}
+
+function checkBatch(batch, firstId) {
+    for (let i = 0; i < batch.length; i++) {
+        const id = firstId + i;
+        assert.eq(id, batch[i]._id, tojson(batch[i]._id));
+        assert.eq(id < numDocs ? padding : undefined, batch[i].padding);
+    }
+}
+
+let cmdRes = db.runCommand(
+    {find: collName, sort: {_id: 1}, batchSize: 3, $_requestDocumentSequences: true});
+assert.commandWorked(cmdRes);
+assert.neq(cmdRes.cursor.id, NumberLong(0));
+assert.eq(cmdRes.cursor.ns, coll.getFullName());
+assert.eq(cmdRes.cursor.firstBatch.length, 3);
+checkBatch(cmdRes.cursor.firstBatch, 0);
+
+let nextId = 3;
+const cursorId = cmdRes.cursor.id;
+while (nextId < 2 * numDocs) {
+    cmdRes = db.runCommand(
+        {getMore: cursorId, collection: collName, batchSize: 4, $_requestDocumentSequences: true});
+    assert.commandWorked(cmdRes);
+    assert.eq(cmdRes.cursor.ns, coll.getFullName());
+    assert.gt(cmdRes.cursor.nextBatch.length, 0);
+    checkBatch(cmdRes.cursor.nextBatch, nextId);
+    nextId += cmdRes.cursor.nextBatch.length;
+}
+assert.eq(nextId, 2 * numDocs);
+assert.eq(cmdRes.cursor.id, NumberLong(0));
+
+// The reply is the same whether or not the batch was sent as a document sequence.
+assert.eq(db.runCommand({find: collName, sort: {_id: 1}, $_requestDocumentSequences: true})
+              .cursor.firstBatch,
+          db.runCommand({find: collName, sort: {_id: 1}}).cursor.firstBatch);
+})();
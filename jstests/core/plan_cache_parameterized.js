@@ -0,0 +1,45 @@
+// Tests that queries answered by a cached plan whose index bounds are bound from the query's
+// constants return the same results as queries which are planned from scratch.
+(function() {
+"use strict";
+
+const coll = db.plan_cache_parameterized;
+coll.drop();
+
+const docs = [
+    {_id: 0, a: 1, b: 1},
+    {_id: 1, a: 1, b: 2},
+    {_id: 2, a: 2, b: 1},
+    {_id: 3, a: "x", b: 1},
+    {_id: 4, a: null, b: 1},
+    {_id: 5, b: 1},
+    {_id: 6, a: [1, 2], b: 1},
+    {_id: 7, a: {c: 1}, b: 1},
+];
+assert.commandWorked(coll.insert(docs));
+assert.commandWorked(coll.createIndexes([{a: 1, b: 1}, {b: 1}]));
+
+function expectedIds(predicate) {
+    return docs.filter(predicate).map(doc => doc._id).sort();
+}
+
+function runQuery(filter) {
+    return coll.find(filter).toArray().map(doc => doc._id).sort();
+}
+
+// Run the query shape several times so that its cache entry becomes active.
+for (let i = 0; i < 3; ++i) {
+    runQuery({a: 1, b: 1});
+}
+
+const matchesA = (doc, value) => Array.isArray(doc.a) ? doc.a.includes(value) : doc.a === value;
+
+assert.eq(expectedIds(doc => matchesA(doc, 1) && doc.b === 1), runQuery({a: 1, b: 1}));
+assert.eq(expectedIds(doc => matchesA(doc, 1) && doc.b === 2), runQuery({a: 1, b: 2}));
+assert.eq(expectedIds(doc => matchesA(doc, 2) && doc.b === 1), runQuery({a: 2, b: 1}));
+assert.eq(expectedIds(doc => doc.a === "x" && doc.b === 1), runQuery({a: "x", b: 1}));
+assert.eq([4, 5], runQuery({a: null, b: 1}));
+assert.eq([6], runQuery({a: [1, 2], b: 1}));
+assert.eq([7], runQuery({a: {c: 1}, b: 1}));
+assert.eq([], runQuery({a: 3, b: 1}));
+}());
@@ -0,0 +1,65 @@
+/**
+ * Tests that mongos cursors which request batches from the shards ahead of time return the same
+ * results as those which request them only once they run out, for sorted and unsorted queries, and
+ * while the buffer budget holds read-ahead back.
+ * @tags: [requires_sharding]
+ */
+(function() {
+"use strict";
+
+const st = new ShardingTest({shards: 3});
+const mongos = st.s;
+const testDB = mongos.getDB("test");
+const coll = testDB.cluster_cursor_read_ahead;
+
+assert.commandWorked(mongos.adminCommand({enableSharding: testDB.getName()}));
+st.ensurePrimaryShard(testDB.getName(), st.shard0.shardName);
+assert.commandWorked(mongos.adminCommand({shardCollection: coll.getFullName(), key: {_id: 1}}));
+for (let [splitAt, shard] of [[1000, st.shard1.shardName], [2000, st.shard2.shardName]]) {
+    assert.commandWorked(mongos.adminCommand({split: coll.getFullName(), middle: {_id: splitAt}}));
+    assert.commandWorked(mongos.adminCommand(
+        {moveChunk: coll.getFullName(), find: {_id: splitAt}, to: shard, _waitForDelete: true}));
+}
+
+const numDocs = 3000;
+const padding = "x".repeat(200);
+let bulk = coll.initializeUnorderedBulkOp();
+for (let i = 0; i < numDocs; i++) {
+    bulk.insert({_id: i, a: (i * 7919) % numDocs, padding: padding});
+}
+assert.commandWorked(bulk.execute());
+
+function runQueries() {
+    return {
+        unsorted: coll.find({}, {padding: 0}).batchSize(50).toArray().length,
+        sorted: coll.find({}, {padding: 0}).sort({a: -1}).batchSize(50).toArray(),
+        limited: coll.find({}, {padding: 0}).sort({a: 1}).batchSize(20).limit(333).toArray(),
+    };
+}
+
+function setReadAheadParameters(params) {
+    assert.commandWorked(mongos.adminCommand(Object.assign({setParameter: 1}, params)));
+}
+
+const expected = runQueries();
+assert.eq(numDocs, expected.unsorted);
+
+setReadAheadParameters({internalQueryClusterCursorReadAhead: true});
+for (let watermarkPercent of [0, 50, 100]) {
+    setReadAheadParameters({internalQueryClusterCursorReadAheadWatermarkPercent: watermarkPercent});
+    assert.eq(expected, runQueries(), "watermark " + watermarkPercent + "%");
+}
+
+// A budget too small for any batch turns read-ahead off, and a small one holds it back.
+for (let maxBufferedBytes of [0, 16 * 1024]) {
+    setReadAheadParameters({internalQueryClusterCursorReadAheadMaxBufferedBytes: maxBufferedBytes});
+    assert.eq(expected, runQueries(), "budget " + maxBufferedBytes + " bytes");
+}
+
+// Cursors which are abandoned with batches in flight are cleaned up when killed.
+const cursor = coll.find().batchSize(10);
+cursor.next();
+cursor.close();
+
+st.stop();
+})();
@@ -0,0 +1,73 @@
+/**
+ * Tests that index builds which generate keys on several threads produce the same indexes as
+ * builds which generate them on the scanning thread alone.
+ */
+(function() {
+'use strict';
+
+const conn = MongoRunner.runMongod();
+assert.neq(null, conn, "mongod was unable to start up");
+
+const testDB = conn.getDB("test");
+const coll = testDB.index_build_key_generation_threads;
+coll.drop();
+
+// Enough documents to fill several batches of buffered documents, including multikey and unique
+// values, and documents which a partial index filters out.
+const numDocs = 20 * 1000;
+const padding = "x".repeat(2 * 1024);
+let bulk = coll.initializeUnorderedBulkOp();
+for (let i = 0; i < numDocs; i++) {
+    bulk.insert({_id: i, a: i % 97, b: [i, i + 1, i % 13], c: {d: String(i)}, padding: padding});
+}
+assert.commandWorked(bulk.execute());
+
+const indexSpecs = [
+    {key: {a: 1}, name: "a_1"},
+    {key: {b: 1, a: -1}, name: "b_1_a_-1"},
+    {key: {"c.d": 1}, name: "c.d_1", unique: true},
+    {key: {a: 1, _id: 1}, name: "partial", partialFilterExpression: {a: {$gt: 50}}},
+    {key: {"$**": 1}, name: "wildcard"},
+];
+
+function buildIndexesAndCollectKeys(numThreads) {
+    assert.commandWorked(
+        testDB.adminCommand({setParameter: 1, maxIndexBuildKeyGenerationThreads: numThreads}));
+    assert.commandWorked(coll.dropIndexes());
+    assert.commandWorked(testDB.runCommand({createIndexes: coll.getName(), indexes: indexSpecs}));
+
+    const res = assert.commandWorked(coll.validate({full: true}));
+    assert(res.valid, tojson(res));
+
+    const keysPerIndex = {};
+    for (let spec of indexSpecs) {
+        if (spec.name === "wildcard") {
+            continue;
+        }
+        keysPerIndex[spec.name] =
+            coll.find({}, {_id: 1}).hint(spec.name).returnKey().toArray().map(tojson);
+    }
+    keysPerIndex.wildcardCount = coll.find({b: {$gte: 0}}).hint("wildcard").itcount();
+    keysPerIndex.nIndexes = res.nIndexes;
+    keysPerIndex.keysPerIndex = res.keysPerIndex;
+    return keysPerIndex;
+}
+
+const serial = buildIndexesAndCollectKeys(0);
+for (let numThreads of [1, 3, 8]) {
+    jsTestLog("Building indexes with " + numThreads + " key generation threads");
+    assert.docEq(serial, buildIndexesAndCollectKeys(numThreads));
+}
+
+// A uniqueness violation must still fail the build when keys are generated on several threads.
+assert.commandWorked(coll.insert({_id: numDocs, c: {d: "0"}}));
+assert.commandWorked(coll.dropIndexes());
+assert.commandWorked(
+    testDB.adminCommand({setParameter: 1, maxIndexBuildKeyGenerationThreads: 4}));
+assert.commandFailedWithCode(
+    testDB.runCommand(
+        {createIndexes: coll.getName(), indexes: [{key: {"c.d": 1}, name: "c.d_1", unique: true}]}),
+    ErrorCodes.DuplicateKey);
+
+MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,44 @@
+/**
+ * Tests that a mongod which accepts connections with the io_uring transport layer serves requests
+ * of all sizes, from several clients at once.
+ */
+(function() {
+"use strict";
+
+// The io_uring transport layer only supports the synchronous service executor.
+assert.eq(null, MongoRunner.runMongod({transportLayer: "iouring", serviceExecutor: "adaptive"}));
+
+const conn = MongoRunner.runMongod({transportLayer: "iouring"});
+if (conn === null) {
+    jsTestLog("Skipping test since the io_uring transport layer is not supported on this host");
+    return;
+}
+
+const testDB = conn.getDB("test");
+const coll = testDB.transport_layer_io_uring;
+
+// Messages which fit in a registered buffer, and ones which need reading in several parts.
+for (let size of [0, 1000, 100 * 1000, 10 * 1000 * 1000]) {
+    assert.commandWorked(coll.insert({_id: size, padding: "x".repeat(size)}));
+    assert.eq(size, coll.findOne({_id: size}).padding.length);
+}
+
+// Several clients at once, each with its own connection.
+const shells = [];
+for (let i = 0; i < 4; i++) {
+    shells.push(startParallelShell(function() {
+        const coll = db.getSiblingDB("test").transport_layer_io_uring_parallel;
+        for (let j = 0; j < 500; j++) {
+            assert.commandWorked(coll.insert({j: j}));
+        }
+    }, conn.port));
+}
+shells.forEach((join) => join());
+assert.eq(2000, testDB.transport_layer_io_uring_parallel.find().itcount());
+
+// The bytes the io_uring transport layer reads are counted like those of the ASIO one.
+const serverStatus = assert.commandWorked(testDB.adminCommand({serverStatus: 1}));
+assert.gt(serverStatus.network.physicalBytesIn, 10 * 1000 * 1000, tojson(serverStatus.network));
+
+MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,42 @@
+/**
+ * Tests that the zstd-dict network message compressor trains a dictionary from the replies it
+ * compresses on a connection, sends it to that connection's client, and reports its statistics in
+ * serverStatus.
+ */
+(function() {
+'use strict';
+
+const conn = MongoRunner.runMongod({
+    networkMessageCompressors: "zstd-dict",
+    setParameter: {zstdDictionaryTrainingSampleBytes: 16 * 1024},
+});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const testDB = conn.getDB("test");
+assert.commandWorked(testDB.coll.insert({_id: 0, name: "user", city: "City", active: true}));
+
+// Enough small, similar replies for the server to sample and train a dictionary from, which
+// the shell has to receive to decompress the replies that follow.
+const workload = "for (let i = 0; i < 5000; i++) {" +
+    "    assert.eq(1, db.getSiblingDB('test').coll.find({_id: 0}).itcount());" +
+    "}";
+assert.eq(0,
+          runMongoProgram("mongo",
+                          "--port",
+                          conn.port,
+                          "--networkMessageCompressors=zstd-dict",
+                          "--eval",
+                          workload));
+
+const stats = assert.commandWorked(testDB.adminCommand({serverStatus: 1})).network.compression;
+jsTestLog("Compression statistics: " + tojson(stats));
+const zstdDict = stats["zstd-dict"];
+assert.gte(zstdDict.dictionary.trained, 1, tojson(zstdDict));
+assert.gte(zstdDict.dictionary.sent, 1, tojson(zstdDict));
+assert.gt(zstdDict.compressor.bytesIn, 0, tojson(zstdDict));
+assert.gt(zstdDict.compressor.ratio, 1, tojson(zstdDict));
+assert.gte(zstdDict.compressor.micros, 0, tojson(zstdDict));
+assert.gt(zstdDict.decompressor.bytesOut, 0, tojson(zstdDict));
+
+MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,45 @@
+/**
+ * Tests that replica set members and the shell can talk to each other with the zstd-stream network
+ * message compressor, which compresses the messages of each connection as one stream.
+ */
+(function() {
+'use strict';
+
+const rst = new ReplSetTest({nodes: 2, nodeOptions: {networkMessageCompressors: "zstd-stream"}});
+rst.startSet();
+rst.initiate();
+
+const primary = rst.getPrimary();
+const testDB = primary.getDB("test");
+
+// Similar writes, which the oplog fetcher's replies carry to the secondary.
+let bulk = testDB.coll.initializeUnorderedBulkOp();
+for (let i = 0; i < 5000; i++) {
+    bulk.insert({_id: i, name: "user" + i, city: "City" + (i % 50), active: true});
+}
+assert.commandWorked(bulk.execute());
+rst.awaitReplication();
+
+const workload = "for (let i = 0; i < 1000; i++) {" +
+    "    assert.eq(1, db.getSiblingDB('test').coll.find({_id: i}).itcount());" +
+    "}";
+assert.eq(0,
+          runMongoProgram("mongo",
+                          "--port",
+                          primary.port,
+                          "--networkMessageCompressors=zstd-stream",
+                          "--eval",
+                          workload));
+
+for (let node of rst.nodes) {
+    const stats = assert.commandWorked(node.adminCommand({serverStatus: 1})).network.compression;
+    jsTestLog("Compression statistics of " + node.host + ": " + tojson(stats));
+    const zstdStream = stats["zstd-stream"];
+    assert.gt(zstdStream.compressor.bytesIn, 0, tojson(zstdStream));
+    assert.gt(zstdStream.compressor.ratio, 1, tojson(zstdStream));
+    assert.gt(zstdStream.decompressor.bytesOut, 0, tojson(zstdStream));
+}
+
+rst.checkReplicatedDataHashes();
+rst.stopSet();
+})();
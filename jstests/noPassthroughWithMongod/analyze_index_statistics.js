@@ -0,0 +1,102 @@
+// Tests the analyze command, and that the query planner uses the statistics it collects to estimate
+// the cost of candidate plans.
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");
+
+const coll = db.analyze_index_statistics;
+coll.drop();
+
+// Cost-based pruning is off by default.
+const originalRatio =
+    assert
+        .commandWorked(
+            db.adminCommand({getParameter: 1, internalQueryCostBasedPlanSelectionRatio: 1}))
+        .internalQueryCostBasedPlanSelectionRatio;
+assert.eq(0, originalRatio);
+assert.commandWorked(
+    db.adminCommand({setParameter: 1, internalQueryCostBasedPlanSelectionRatio: 10}));
+
+const bulk = coll.initializeUnorderedBulkOp();
+for (let i = 0; i < 1000; ++i) {
+    bulk.insert({a: i, b: i % 2, c: -i});
+}
+assert.commandWorked(bulk.execute());
+assert.commandWorked(coll.createIndexes([{a: 1}, {b: 1}, {c: -1}, {d: "hashed"}]));
+
+const query = {a: 5, b: 1};
+
+// Without statistics every candidate plan is trial-run.
+let explain = coll.find(query).explain();
+assert(hasRejectedPlans(explain), tojson(explain));
+for (let ixscan of getPlanStages(explain.queryPlanner.winningPlan, "IXSCAN")) {
+    assert(!ixscan.hasOwnProperty("estimatedKeysExamined"), tojson(explain));
+}
+
+// Invalid options.
+assert.commandFailedWithCode(db.runCommand({analyze: "analyze_index_statistics_missing"}),
+                             ErrorCodes.NamespaceNotFound);
+assert.commandFailedWithCode(db.runCommand({analyze: coll.getName(), index: "missing_1"}),
+                             ErrorCodes.IndexNotFound);
+assert.commandFailedWithCode(db.runCommand({analyze: coll.getName(), index: "d_hashed"}),
+                             ErrorCodes.InvalidOptions);
+assert.commandFailedWithCode(db.runCommand({analyze: coll.getName(), maxBuckets: 0}),
+                             ErrorCodes.BadValue);
+assert.commandFailedWithCode(db.runCommand({analyze: coll.getName(), maxBuckets: "ten"}),
+                             ErrorCodes.TypeMismatch);
+
+// Analyze a single index.
+let res = assert.commandWorked(db.runCommand({analyze: coll.getName(), index: "b_1"}));
+assert.eq(1, res.indexes.length, tojson(res));
+assert.eq("b_1", res.indexes[0].name, tojson(res));
+assert.eq(1000, res.indexes[0].numKeys, tojson(res));
+assert.eq(2, res.indexes[0].numDistinct, tojson(res));
+
+// Analyze every btree index. The hashed index is skipped.
+res = assert.commandWorked(db.runCommand({analyze: coll.getName(), maxBuckets: 10}));
+assert.eq(["_id_", "a_1", "b_1", "c_-1"], res.indexes.map(index => index.name).sort(), tojson(res));
+for (let index of res.indexes) {
+    assert.eq(1000, index.numKeys, tojson(index));
+    assert.lte(index.buckets.length, 20, tojson(index));
+}
+
+// The plan over {b: 1} is estimated to examine hundreds of times more keys than the plan over
+// {a: 1}, so it is discarded without a trial and the remaining plan is run directly.
+explain = coll.find(query).explain("executionStats");
+assert(!hasRejectedPlans(explain), tojson(explain));
+let ixscan = getPlanStage(explain.executionStats.executionStages, "IXSCAN");
+assert.eq("a_1", ixscan.indexName, tojson(explain));
+assert.eq(1, ixscan.estimatedKeysExamined, tojson(explain));
+assert.eq(1, ixscan.keysExamined, tojson(explain));
+assert.eq(1, coll.find(query).itcount());
+
+// Descending indexes are estimated too.
+explain = coll.find({c: {$lte: -900}}).explain("executionStats");
+ixscan = getPlanStage(explain.executionStats.executionStages, "IXSCAN");
+assert.eq("c_-1", ixscan.indexName, tojson(explain));
+assert.between(50, ixscan.estimatedKeysExamined, 150, tojson(explain));
+assert.eq(100, explain.executionStats.nReturned, tojson(explain));
+
+// Queries with a limit keep every candidate, since stopping early can make a plan much cheaper
+// than estimated.
+explain = coll.find(query).limit(1).explain();
+assert(hasRejectedPlans(explain), tojson(explain));
+
+// Cost-based pruning can be disabled.
+assert.commandWorked(
+    db.adminCommand({setParameter: 1, internalQueryCostBasedPlanSelectionRatio: 0}));
+explain = coll.find(query).explain();
+assert(hasRejectedPlans(explain), tojson(explain));
+assert.commandWorked(
+    db.adminCommand({setParameter: 1, internalQueryCostBasedPlanSelectionRatio: 10}));
+
+// Dropping an index discards its statistics.
+assert.commandWorked(coll.dropIndex({a: 1}));
+assert.commandWorked(coll.createIndex({a: 1}));
+explain = coll.find(query).explain();
+assert(hasRejectedPlans(explain), tojson(explain));
+
+assert.commandWorked(
+    db.adminCommand({setParameter: 1, internalQueryCostBasedPlanSelectionRatio: originalRatio}));
+}());
@@ -0,0 +1,70 @@
+/**
+ * Tests that a node started with an empty dbpath and 'fileCopyBasedInitialSyncSource' copies the
+ * data files of its sync source instead of cloning the data logically, and then replicates newer
+ * writes like any other secondary.
+ *
+ * @tags: [requires_persistence, requires_wiredtiger]
+ */
+(function() {
+"use strict";
+load("jstests/libs/check_log.js");
+
+const replSet = new ReplSetTest({nodes: 1});
+replSet.startSet();
+replSet.initiate();
+const primary = replSet.getPrimary();
+const testDB = primary.getDB("test");
+
+let bulk = testDB.coll.initializeUnorderedBulkOp();
+for (let i = 0; i < 1000; i++) {
+    bulk.insert({_id: i, x: i, s: "x".repeat(100)});
+}
+assert.commandWorked(bulk.execute());
+assert.commandWorked(testDB.coll.createIndex({x: 1}));
+assert.commandWorked(testDB.other.insert({_id: 0}, {writeConcern: {w: 1, j: true}}));
+
+// Make sure the writes above are in a checkpoint, so that the copy does not rely only on replaying
+// the oplog.
+assert.commandWorked(primary.adminCommand({fsync: 1}));
+
+// Writes made after the checkpoint are recovered from the copied oplog.
+assert.commandWorked(testDB.coll.insert({_id: "afterCheckpoint"}));
+
+const secondary = replSet.add({setParameter: {fileCopyBasedInitialSyncSource: primary.host}});
+checkLog.contains(secondary, "File copy based initial sync copied");
+replSet.reInitiate();
+replSet.awaitSecondaryNodes();
+
+// The node never ran a logical initial sync.
+assert(!checkLog.checkContainsOnce(secondary, "Starting initial sync"));
+
+// Writes made after the copy are replicated normally.
+assert.commandWorked(testDB.coll.insert({_id: "afterCopy"}));
+replSet.awaitReplication();
+
+const secondaryDB = secondary.getDB("test");
+secondary.setSlaveOk();
+assert.eq(1002, secondaryDB.coll.find().itcount());
+assert.eq(1002, secondaryDB.coll.find().hint({x: 1}).itcount());
+assert.eq(1, secondaryDB.other.find().itcount());
+replSet.checkReplicatedDataHashes();
+
+// The backup on the sync source has been closed, so another one can be opened.
+const res = assert.commandWorked(primary.adminCommand({_fileCopyInitialSyncBeginBackup: 1}));
+assert(res.hasOwnProperty("checkpointTimestamp"), tojson(res));
+assert.commandWorked(
+    primary.adminCommand({_fileCopyInitialSyncEndBackup: 1, backupId: res.backupId}));
+
+// A backup which the syncing node abandons is closed once it has not been used for long enough.
+assert.commandWorked(
+    primary.adminCommand({setParameter: 1, fileCopyBackupInactivityTimeoutSecs: 1}));
+const abandoned = assert.commandWorked(primary.adminCommand({_fileCopyInitialSyncBeginBackup: 1}));
+assert.commandFailedWithCode(primary.adminCommand({_fileCopyInitialSyncBeginBackup: 1}),
+                             ErrorCodes.ConflictingOperationInProgress);
+checkLog.contains(primary, "for file copy based initial sync, which has not been used for");
+assert.commandFailedWithCode(
+    primary.adminCommand({_fileCopyInitialSyncEndBackup: 1, backupId: abandoned.backupId}),
+    ErrorCodes.NoSuchKey);
+
+replSet.stopSet();
+})();
@@ -0,0 +1,60 @@
+/**
+ * Tests that initial sync clones a large collection as several _id ranges in parallel, and that
+ * the synced node ends up with the same data as its sync source.
+ */
+(function() {
+"use strict";
+load("jstests/libs/check_log.js");
+
+const replSet = new ReplSetTest({nodes: 1});
+replSet.startSet();
+replSet.initiate();
+const primary = replSet.getPrimary();
+const testDB = primary.getDB("test");
+
+// Mix _id types so that the ranges span several type brackets.
+const numDocs = 4000;
+let bulk = testDB.big.initializeUnorderedBulkOp();
+for (let i = 0; i < numDocs; i++) {
+    bulk.insert({_id: i % 2 === 0 ? i : "id" + i, x: i, padding: "x".repeat(100)});
+}
+assert.commandWorked(bulk.execute());
+assert.commandWorked(testDB.big.createIndex({x: 1}));
+
+assert.commandWorked(testDB.createCollection("capped", {capped: true, size: 1024 * 1024}));
+for (let i = 0; i < 2000; i++) {
+    assert.commandWorked(testDB.capped.insert({_id: i}));
+}
+assert.commandWorked(testDB.small.insert({_id: 0}));
+
+const secondary = replSet.add({
+    setParameter: {collectionClonerMinDocumentsPerRange: 500, collectionClonerMaxParallelRanges: 4}
+});
+secondary.setSlaveOk();
+assert.commandWorked(secondary.adminCommand(
+    {configureFailPoint: "initialSyncHangBeforeFinish", mode: "alwaysOn"}));
+replSet.reInitiate();
+
+checkLog.contains(secondary, "initial sync - initialSyncHangBeforeFinish fail point enabled");
+const res = assert.commandWorked(secondary.adminCommand({replSetGetStatus: 1}));
+const dbStatus = res.initialSyncStatus.databases.test;
+assert.gt(dbStatus["test.big"].ranges, 1, tojson(dbStatus));
+assert.lte(dbStatus["test.big"].ranges, 4, tojson(dbStatus));
+assert.eq(numDocs, dbStatus["test.big"].documentsCopied, tojson(dbStatus));
+// Capped collections must be cloned in natural order, and small ones are not worth splitting.
+assert.eq(1, dbStatus["test.capped"].ranges, tojson(dbStatus));
+assert.eq(1, dbStatus["test.small"].ranges, tojson(dbStatus));
+
+assert.commandWorked(
+    secondary.adminCommand({configureFailPoint: "initialSyncHangBeforeFinish", mode: "off"}));
+replSet.awaitSecondaryNodes();
+replSet.awaitReplication();
+
+const secondaryDB = secondary.getDB("test");
+assert.eq(numDocs, secondaryDB.big.find().itcount());
+assert.eq(numDocs, secondaryDB.big.find().hint({x: 1}).itcount());
+assert.eq(testDB.capped.find().toArray(), secondaryDB.capped.find().toArray());
+replSet.checkReplicatedDataHashes();
+
+replSet.stopSet();
+})();
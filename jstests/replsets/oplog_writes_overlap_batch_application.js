@@ -0,0 +1,84 @@
+/**
+ * Tests that a secondary which writes the next batch's oplog entries while applying the current
+ * batch, and forms several batches ahead, ends up with the same oplog and data as one which writes
+ * and applies each batch in turn, including across a restart.
+ */
+(function() {
+"use strict";
+
+const pipelinedParams = {
+    replBatchLimitOperations: 50,
+    replBatcherMaxReadyBatches: 4,
+    replOplogWriterThreadCount: 4,
+};
+const serialParams = {
+    replBatchLimitOperations: 50,
+    replBatcherMaxReadyBatches: 1,
+    replOplogWriterThreadCount: 0,
+};
+
+const rst = new ReplSetTest({
+    nodes: [
+        {},
+        {rsConfig: {priority: 0}, setParameter: pipelinedParams},
+        {rsConfig: {priority: 0}, setParameter: serialParams},
+    ]
+});
+rst.startSet();
+rst.initiate();
+
+const primary = rst.getPrimary();
+const testDB = primary.getDB("test");
+
+function runWorkload(round) {
+    const numDocs = 2000;
+    let bulk = testDB.coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < numDocs; i++) {
+        bulk.insert({_id: round * numDocs + i, x: i, round: round});
+    }
+    for (let i = 0; i < numDocs; i += 3) {
+        bulk.find({_id: round * numDocs + i}).updateOne({$inc: {x: 1}, $set: {updated: true}});
+    }
+    for (let i = 0; i < numDocs; i += 7) {
+        bulk.find({_id: round * numDocs + i}).removeOne();
+    }
+    assert.commandWorked(bulk.execute());
+
+    // Updates to the same few documents conflict with each other across many batches.
+    for (let i = 0; i < 200; i++) {
+        assert.commandWorked(testDB.hot.update({_id: i % 5}, {$inc: {n: 1}}, {upsert: true}));
+    }
+}
+
+function checkOplogsMatch() {
+    rst.awaitReplication();
+    const primaryOplog = primary.getDB("local").oplog.rs;
+    const lastEntry = primaryOplog.find().sort({$natural: -1}).limit(1).next();
+    for (let node of rst.getSecondaries()) {
+        node.setSlaveOk();
+        const oplog = node.getDB("local").oplog.rs;
+        assert.eq(lastEntry.ts, oplog.find().sort({$natural: -1}).limit(1).next().ts, node.host);
+    }
+    rst.checkReplicatedDataHashes();
+}
+
+runWorkload(0);
+checkOplogsMatch();
+
+// Restart the pipelined secondary under load, so that it may shut down with a batch written to
+// the oplog but not yet applied.
+const pipelinedSecondary = rst.nodes[1];
+runWorkload(1);
+rst.restart(pipelinedSecondary, {setParameter: pipelinedParams});
+rst.awaitSecondaryNodes();
+runWorkload(2);
+checkOplogsMatch();
+
+const expectedDocs = testDB.coll.find().itcount();
+for (let node of rst.getSecondaries()) {
+    node.setSlaveOk();
+    assert.eq(expectedDocs, node.getDB("test").coll.find().itcount(), node.host);
+}
+
+rst.stopSet();
+})();
@@ -33,6 +33,7 @@
 
 #include "mongo/db/catalog/multi_index_block.h"
 
+#include <algorithm>
 #include <ostream>
 
 #include "mongo/base/error_codes.h"
@@ -42,6 +43,7 @@
 #include "mongo/db/catalog/multi_index_block_gen.h"
 #include "mongo/db/client.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/exec/intra_query_workers.h"
 #include "mongo/db/index/index_build_interceptor.h"
 #include "mongo/db/index/multikey_paths.h"
 #include "mongo/db/multi_key_path_tracker.h"
@@ -71,6 +73,16 @@ MONGO_FAIL_POINT_DEFINE(hangAfterIndexBuildOf);
 MONGO_FAIL_POINT_DEFINE(hangAndThenFailIndexBuild);
 MONGO_FAIL_POINT_DEFINE(leaveIndexBuildUnfinishedForShutdown);
 
+namespace {
+
+// When keys are generated on several threads, the documents buffered by the collection scan may use
+// at most 1/kPendingDocumentsShare of the index build memory limit, and never more than
+// kMaxPendingDocumentsBytes.
+const std::size_t kPendingDocumentsShare = 20;
+const std::size_t kMaxPendingDocumentsBytes = 16 * 1024 * 1024;
+
+}  // namespace
+
 MultiIndexBlock::~MultiIndexBlock() {
     invariant(_buildIsCleanedUp);
 }
@@ -278,13 +290,27 @@ StatusWith<std::vector<BSONObj>> MultiIndexBlock::init(OperationContext* opCtx,
             }
         }
 
+        // Hybrid builds and non-hybrid foreground builds use the bulk builder.
+        const bool useBulk =
+            _method == IndexBuildMethod::kHybrid || _method == IndexBuildMethod::kForeground;
+
+        // Bulk builds may generate keys on several threads. The documents buffered for them count
+        // against the memory limit, along with the sorters of every partition.
+        std::size_t maxMemoryUsageBytes =
+            static_cast<std::size_t>(maxIndexBuildMemoryUsageMegabytes.load()) * 1024 * 1024;
+        _numBulkPartitions =
+            useBulk ? 1 + static_cast<std::size_t>(maxIndexBuildKeyGenerationThreads.load()) : 1;
+        if (_numBulkPartitions > 1) {
+            _maxPendingDocumentsBytes =
+                std::min(kMaxPendingDocumentsBytes, maxMemoryUsageBytes / kPendingDocumentsShare);
+            maxMemoryUsageBytes -= _maxPendingDocumentsBytes;
+        }
+
         std::vector<BSONObj> indexInfoObjs;
         indexInfoObjs.reserve(indexSpecs.size());
         std::size_t eachIndexBuildMaxMemoryUsageBytes = 0;
         if (!indexSpecs.empty()) {
-            eachIndexBuildMaxMemoryUsageBytes =
-                static_cast<std::size_t>(maxIndexBuildMemoryUsageMegabytes.load()) * 1024 * 1024 /
-                indexSpecs.size();
+            eachIndexBuildMaxMemoryUsageBytes = maxMemoryUsageBytes / indexSpecs.size();
         }
 
         for (size_t i = 0; i < indexSpecs.size(); i++) {
@@ -323,13 +349,11 @@ StatusWith<std::vector<BSONObj>> MultiIndexBlock::init(OperationContext* opCtx,
             if (!status.isOK())
                 return status;
 
-            // Hybrid builds and non-hybrid foreground builds use the bulk builder.
-            const bool useBulk =
-                _method == IndexBuildMethod::kHybrid || _method == IndexBuildMethod::kForeground;
             if (useBulk) {
                 // Bulk build process requires foreground building as it assumes nothing is changing
                 // under it.
-                index.bulk = index.real->initiateBulk(eachIndexBuildMaxMemoryUsageBytes);
+                index.bulk =
+                    index.real->initiateBulk(eachIndexBuildMaxMemoryUsageBytes, _numBulkPartitions);
             }
 
             const IndexDescriptor* descriptor = index.block->getEntry()->descriptor();
@@ -463,6 +487,21 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(OperationContext* opCtx,
         _method != IndexBuildMethod::kBackground && useReadOnceCursorsForIndexBuilds.load();
     opCtx->recoveryUnit()->setReadOnce(readOnce);
 
+    // Documents scanned but not yet inserted, when keys are generated on several threads.
+    std::vector<BSONObj> pendingDocs;
+    std::vector<RecordId> pendingLocs;
+    size_t pendingBytes = 0;
+    auto insertPendingDocs = [&]() -> Status {
+        Status ret = _insertIntoBulkInParallel(opCtx, pendingDocs, pendingLocs);
+        if (!ret.isOK()) {
+            return ret;
+        }
+        pendingDocs.clear();
+        pendingLocs.clear();
+        pendingBytes = 0;
+        return Status::OK();
+    };
+
     Snapshotted<BSONObj> objToIndex;
     RecordId loc;
     PlanExecutor::ExecState state;
@@ -492,6 +531,38 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(OperationContext* opCtx,
 
             failPointHangDuringBuild(&hangBeforeIndexBuildOf, "before", objToIndex.value());
 
+            if (_numBulkPartitions > 1) {
+                // Buffer the document so that the keys of a batch of documents can be generated
+                // on several threads. The document must be owned, as the scan may yield.
+                const BSONObj ownedDoc = objToIndex.value().getOwned();
+                pendingDocs.push_back(ownedDoc);
+                pendingLocs.push_back(loc);
+                pendingBytes += pendingDocs.back().objsize();
+
+                // While hangAfterIndexBuildOf is enabled, each document is inserted as soon as it
+                // is buffered, so that the build hangs right after indexing the matching document
+                // as it does when documents are inserted one at a time. The predicate only runs
+                // when the fail point is enabled and never consumes its activation count.
+                bool hangAfterIndexBuildOfEnabled = false;
+                hangAfterIndexBuildOf.shouldFail([&](const BSONObj&) {
+                    hangAfterIndexBuildOfEnabled = true;
+                    return false;
+                });
+                if (pendingBytes >= _maxPendingDocumentsBytes ||
+                    MONGO_unlikely(hangAfterIndexBuildOfEnabled)) {
+                    Status ret = insertPendingDocs();
+                    if (!ret.isOK()) {
+                        return ret;
+                    }
+                }
+                failPointHangDuringBuild(&hangAfterIndexBuildOf, "after", ownedDoc);
+
+                progress->hit();
+                n++;
+                retries = 0;
+                continue;
+            }
+
             WriteUnitOfWork wunit(opCtx);
             Status ret = insert(opCtx, objToIndex.value(), loc);
             if (_method == IndexBuildMethod::kBackground)
@@ -540,6 +611,13 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(OperationContext* opCtx,
         return exec->getMemberObjectStatus(objToIndex.value());
     }
 
+    if (!pendingDocs.empty()) {
+        Status ret = insertPendingDocs();
+        if (!ret.isOK()) {
+            return ret;
+        }
+    }
+
     if (MONGO_unlikely(leaveIndexBuildUnfinishedForShutdown.shouldFail())) {
         log() << "Index build interrupted due to 'leaveIndexBuildUnfinishedForShutdown' failpoint. "
                  "Mimicing shutdown error code.";
@@ -585,6 +663,13 @@ Status MultiIndexBlock::insert(OperationContext* opCtx, const BSONObj& doc, cons
                 str::stream() << "Index build aborted: " << _abortReason};
     }
 
+    return _insertIntoIndexes(opCtx, doc, loc, 0);
+}
+
+Status MultiIndexBlock::_insertIntoIndexes(OperationContext* opCtx,
+                                           const BSONObj& doc,
+                                           const RecordId& loc,
+                                           size_t partition) {
     for (size_t i = 0; i < _indexes.size(); i++) {
         if (_indexes[i].filterExpression && !_indexes[i].filterExpression->matchesBSON(doc)) {
             continue;
@@ -596,7 +681,8 @@ Status MultiIndexBlock::insert(OperationContext* opCtx, const BSONObj& doc, cons
             // When calling insert, BulkBuilderImpl's Sorter performs file I/O that may result in an
             // exception.
             try {
-                idxStatus = _indexes[i].bulk->insert(opCtx, doc, loc, _indexes[i].options);
+                idxStatus =
+                    _indexes[i].bulk->insert(opCtx, doc, loc, _indexes[i].options, partition);
             } catch (...) {
                 return exceptionToStatus();
             }
@@ -610,6 +696,40 @@ Status MultiIndexBlock::insert(OperationContext* opCtx, const BSONObj& doc, cons
     return Status::OK();
 }
 
+Status MultiIndexBlock::_insertIntoBulkInParallel(OperationContext* opCtx,
+                                                  const std::vector<BSONObj>& docs,
+                                                  const std::vector<RecordId>& locs) {
+    invariant(docs.size() == locs.size());
+    if (State::kAborted == _getState()) {
+        return {ErrorCodes::IndexBuildAborted,
+                str::stream() << "Index build aborted: " << _abortReason};
+    }
+
+    // Each partition of the documents is inserted into the same partition of every bulk builder,
+    // so no two threads ever add to the same sorter. Only the bulk builders are used off the
+    // calling thread, and they do not use 'opCtx'.
+    std::vector<Status> statuses(_numBulkPartitions, Status::OK());
+    try {
+        IntraQueryWorkers workers(opCtx->getServiceContext(), _numBulkPartitions - 1);
+        workers.parallelFor(_numBulkPartitions, [&](size_t partition) {
+            const size_t begin = docs.size() * partition / _numBulkPartitions;
+            const size_t end = docs.size() * (partition + 1) / _numBulkPartitions;
+            for (size_t i = begin; i < end && statuses[partition].isOK(); ++i) {
+                statuses[partition] = _insertIntoIndexes(opCtx, docs[i], locs[i], partition);
+            }
+        });
+    } catch (...) {
+        return exceptionToStatus();
+    }
+
+    for (auto&& status : statuses) {
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+    return Status::OK();
+}
+
 Status MultiIndexBlock::dumpInsertsFromBulk(OperationContext* opCtx) {
     return dumpInsertsFromBulk(opCtx, nullptr);
 }
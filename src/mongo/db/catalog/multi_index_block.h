@@ -317,6 +317,24 @@ private:
     Status _dumpInsertsFromBulk(std::set<RecordId>* dupRecords,
                                 std::vector<BSONObj>* dupKeysInserted);
 
+    /**
+     * Inserts 'doc' into every index whose filter it matches, adding the keys to the given
+     * partition of the bulk builders of those which have one.
+     */
+    Status _insertIntoIndexes(OperationContext* opCtx,
+                              const BSONObj& doc,
+                              const RecordId& loc,
+                              size_t partition);
+
+    /**
+     * Generates and inserts the keys of 'docs' into the bulk builders, splitting the documents
+     * between the partitions of the builders and spreading the partitions across any helper
+     * threads which can be reserved.
+     */
+    Status _insertIntoBulkInParallel(OperationContext* opCtx,
+                                     const std::vector<BSONObj>& docs,
+                                     const std::vector<RecordId>& locs);
+
     /**
      * Returns the current state.
      */
@@ -343,6 +361,14 @@ private:
 
     bool _ignoreUnique = false;
 
+    // The number of partitions of the bulk builders. Greater than one when keys are generated on
+    // several threads during the collection scan.
+    size_t _numBulkPartitions = 1;
+
+    // The total size of the documents the collection scan may buffer before generating their keys,
+    // when keys are generated on several threads.
+    size_t _maxPendingDocumentsBytes = 0;
+
     bool _needToCleanup = true;
 
     // Set to true when no work remains to be done, the object can safely destruct without leaving
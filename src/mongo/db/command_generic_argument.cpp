@@ -52,7 +52,7 @@ struct SpecialArgRecord {
 // If that changes, it should be added. When you add to this list, consider whether you
 // should also change the filterCommandRequestForPassthrough() function.
 // clang-format off
-static constexpr std::array<SpecialArgRecord, 27> specials{{
+static constexpr std::array<SpecialArgRecord, 28> specials{{
     //                                       /-isGeneric
     //                                       |  /-stripFromRequest
     //                                       |  |  /-stripFromReply
@@ -63,6 +63,7 @@ static constexpr std::array<SpecialArgRecord, 27> specials{{
     {"allowImplicitCollectionCreation"_sd,   1, 1, 0},
     {"$oplogQueryData"_sd,                   1, 1, 1},
     {"$queryOptions"_sd,                     1, 0, 0},
+    {"$_requestDocumentSequences"_sd,        1, 1, 0},
     {"$readPreference"_sd,                   1, 1, 0},
     {"$replData"_sd,                         1, 1, 1},
     {"$clusterTime"_sd,                      1, 1, 1},
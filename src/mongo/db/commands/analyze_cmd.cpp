@@ -0,0 +1,227 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kCommand
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/index_names.h"
+#include "mongo/db/query/collection_query_info.h"
+#include "mongo/db/query/index_statistics.h"
+#include "mongo/db/query/internal_plans.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+namespace {
+
+// Upper limit on the 'maxBuckets' option, which keeps the statistics of each index small.
+constexpr long long kMaxBucketsLimit = 1000;
+
+/**
+ * Scans 'desc' in the order of its leading field and builds its key distribution statistics.
+ */
+std::shared_ptr<const IndexStatistics> buildIndexStatistics(OperationContext* opCtx,
+                                                            const Collection* collection,
+                                                            const IndexDescriptor* desc,
+                                                            size_t maxBuckets) {
+    // Bound every field of the key by the extreme values in index order. A descending leading
+    // field is scanned backwards so that the builder sees its values in ascending order.
+    BSONObjBuilder lowKey;
+    BSONObjBuilder highKey;
+    for (auto&& field : desc->keyPattern()) {
+        if (field.number() >= 0) {
+            lowKey.appendMinKey("");
+            highKey.appendMaxKey("");
+        } else {
+            lowKey.appendMaxKey("");
+            highKey.appendMinKey("");
+        }
+    }
+    const bool forward = desc->keyPattern().firstElement().number() >= 0;
+    const BSONObj startKey = forward ? lowKey.obj() : highKey.obj();
+    const BSONObj endKey = forward ? highKey.obj() : lowKey.obj();
+
+    auto exec = InternalPlanner::indexScan(opCtx,
+                                           collection,
+                                           desc,
+                                           startKey,
+                                           endKey,
+                                           BoundInclusion::kIncludeBothStartAndEndKeys,
+                                           PlanExecutor::YIELD_AUTO,
+                                           forward ? InternalPlanner::FORWARD
+                                                   : InternalPlanner::BACKWARD);
+
+    IndexStatistics::Builder builder(maxBuckets);
+    BSONObj key;
+    PlanExecutor::ExecState state;
+    while (PlanExecutor::ADVANCED == (state = exec->getNext(&key, nullptr))) {
+        builder.addKey(key.firstElement());
+    }
+
+    if (PlanExecutor::FAILURE == state) {
+        uassertStatusOK(WorkingSetCommon::getMemberObjectStatus(key).withContext(
+            str::stream() << "Executor error while scanning index " << desc->indexName()));
+    }
+
+    return std::make_shared<const IndexStatistics>(builder.done());
+}
+
+/**
+ * Example analyze command:
+ *   {
+ *       analyze: "collectionNameWithoutTheDBPart",
+ *       index: <string>  // Optional. Only the named index is analyzed.
+ *       maxBuckets: <int>  // Optional. The resolution of the histogram kept for each index.
+ *   }
+ */
+class AnalyzeCmd : public BasicCommand {
+public:
+    AnalyzeCmd() : BasicCommand("analyze") {}
+
+    AllowedOnSecondary secondaryAllowed(ServiceContext*) const override {
+        return AllowedOnSecondary::kAlways;
+    }
+
+    std::string help() const override {
+        return "Collects key distribution statistics for the indexes of a collection, which the "
+               "query planner uses to estimate the cost of candidate plans.\n"
+               "Statistics are kept in memory until the index is dropped or analyze is run "
+               "again.\n"
+               "\tAdd {index: <name>} to analyze a single index.\n"
+               "\tAdd {maxBuckets: <n>} to set the resolution of the histograms.";
+    }
+
+    bool supportsWriteConcern(const BSONObj& cmd) const override {
+        return false;
+    }
+
+    bool maintenanceOk() const override {
+        return false;
+    }
+
+    void addRequiredPrivileges(const std::string& dbname,
+                               const BSONObj& cmdObj,
+                               std::vector<Privilege>* out) const override {
+        ActionSet actions;
+        actions.addAction(ActionType::planCacheWrite);
+        out->push_back(Privilege(parseResourcePattern(dbname, cmdObj), actions));
+    }
+
+    bool run(OperationContext* opCtx,
+             const std::string& dbname,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        const NamespaceString nss(CommandHelpers::parseNsCollectionRequired(dbname, cmdObj));
+
+        size_t maxBuckets = IndexStatistics::kDefaultMaxBuckets;
+        if (auto maxBucketsElem = cmdObj["maxBuckets"]) {
+            uassert(ErrorCodes::TypeMismatch,
+                    "'maxBuckets' must be a number",
+                    maxBucketsElem.isNumber());
+            const long long value = maxBucketsElem.safeNumberLong();
+            uassert(ErrorCodes::BadValue,
+                    str::stream() << "'maxBuckets' must be between 1 and " << kMaxBucketsLimit,
+                    value >= 1 && value <= kMaxBucketsLimit);
+            maxBuckets = static_cast<size_t>(value);
+        }
+
+        boost::optional<std::string> indexName;
+        if (auto indexElem = cmdObj["index"]) {
+            uassert(ErrorCodes::TypeMismatch,
+                    "'index' must be a string",
+                    indexElem.type() == BSONType::String);
+            indexName = indexElem.str();
+        }
+
+        AutoGetCollectionForReadCommand ctx(opCtx, nss);
+        Collection* collection = ctx.getCollection();
+        uassert(ErrorCodes::NamespaceNotFound,
+                str::stream() << "Collection " << nss << " does not exist",
+                collection);
+
+        std::vector<std::string> indexNames;
+        if (indexName) {
+            auto desc = collection->getIndexCatalog()->findIndexByName(opCtx, *indexName);
+            uassert(ErrorCodes::IndexNotFound,
+                    str::stream() << "Index " << *indexName << " does not exist on " << nss,
+                    desc);
+            uassert(ErrorCodes::InvalidOptions,
+                    str::stream() << "Statistics can only be collected for btree indexes, but "
+                                  << *indexName << " has type " << desc->getAccessMethodName(),
+                    desc->getAccessMethodName() == IndexNames::BTREE);
+            indexNames.push_back(*indexName);
+        } else {
+            auto it = collection->getIndexCatalog()->getIndexIterator(opCtx, false);
+            while (it->more()) {
+                auto desc = it->next()->descriptor();
+                if (desc->getAccessMethodName() == IndexNames::BTREE) {
+                    indexNames.push_back(desc->indexName());
+                }
+            }
+        }
+
+        if (!serverGlobalParams.quiet.load()) {
+            LOG(0) << "CMD: analyze " << nss.ns() << ", indexes: " << indexNames.size();
+        }
+
+        BSONArrayBuilder indexesBuilder(result.subarrayStart("indexes"));
+        for (auto&& name : indexNames) {
+            // Scanning an index yields, so an index found above may have been dropped since.
+            auto desc = collection->getIndexCatalog()->findIndexByName(opCtx, name);
+            if (!desc) {
+                continue;
+            }
+
+            auto stats = buildIndexStatistics(opCtx, collection, desc, maxBuckets);
+
+            BSONObjBuilder indexBuilder(indexesBuilder.subobjStart());
+            indexBuilder.append("name", name);
+            indexBuilder.appendElements(stats->toBSON());
+            indexBuilder.doneFast();
+
+            CollectionQueryInfo::get(collection).setIndexStatistics(name, std::move(stats));
+        }
+        indexesBuilder.doneFast();
+
+        // Cached plans were chosen without the new statistics.
+        CollectionQueryInfo::get(collection).clearQueryCache();
+        return true;
+    }
+
+} analyzeCmd;
+
+}  // namespace
+}  // namespace mongo
@@ -490,6 +490,8 @@ public:
             // Stream query results, adding them to a BSONArray as we go.
             CursorResponseBuilder::Options options;
             options.isInitialResponse = true;
+            options.useDocumentSequences =
+                CursorResponseBuilder::shouldUseDocumentSequences(_request.body, *result);
             CursorResponseBuilder firstBatch(result, options);
             Document doc;
             PlanExecutor::ExecState state = PlanExecutor::ADVANCED;
@@ -230,7 +230,8 @@ public:
         Invocation(Command* cmd, const OpMsgRequest& request)
             : CommandInvocation(cmd),
               _request(uassertStatusOK(
-                  GetMoreRequest::parseFromBSON(request.getDatabase().toString(), request.body))) {}
+                  GetMoreRequest::parseFromBSON(request.getDatabase().toString(), request.body))),
+              _cmdObj(request.body) {}
 
     private:
         bool supportsWriteConcern() const override {
@@ -535,7 +536,10 @@ public:
 
             CursorId respondWithId = 0;
 
-            CursorResponseBuilder nextBatch(reply, CursorResponseBuilder::Options());
+            CursorResponseBuilder::Options options;
+            options.useDocumentSequences =
+                CursorResponseBuilder::shouldUseDocumentSequences(_cmdObj, *reply);
+            CursorResponseBuilder nextBatch(reply, options);
             BSONObj obj;
             PlanExecutor::ExecState state = PlanExecutor::ADVANCED;
             std::uint64_t numResults = 0;
@@ -667,6 +671,7 @@ public:
         }
 
         const GetMoreRequest _request;
+        const BSONObj _cmdObj;
     };
 
     bool maintenanceOk() const override {
@@ -611,6 +611,13 @@ void CurOp::reportState(OperationContext* opCtx, BSONObjBuilder* builder, bool t
         builder->append("writeConflicts", n);
     }
 
+    if (auto n = _debug.additiveMetrics.groupSpilledPartitions.load(); n > 0) {
+        builder->append("groupSpilledPartitions", n);
+    }
+    if (auto n = _debug.additiveMetrics.groupSpilledBytes.load(); n > 0) {
+        builder->append("groupSpilledBytes", n);
+    }
+
     builder->append("numYields", _numYields);
 }
 
@@ -706,6 +713,8 @@ string OpDebug::report(OperationContext* opCtx, const SingleThreadedLockStats* l
     OPDEBUG_TOSTRING_HELP_OPTIONAL("docsExamined", additiveMetrics.docsExamined);
     OPDEBUG_TOSTRING_HELP_BOOL(hasSortStage);
     OPDEBUG_TOSTRING_HELP_BOOL(usedDisk);
+    OPDEBUG_TOSTRING_HELP_ATOMIC("groupSpilledPartitions", additiveMetrics.groupSpilledPartitions);
+    OPDEBUG_TOSTRING_HELP_ATOMIC("groupSpilledBytes", additiveMetrics.groupSpilledBytes);
     OPDEBUG_TOSTRING_HELP_BOOL(fromMultiPlanner);
     OPDEBUG_TOSTRING_HELP_BOOL(replanned);
     OPDEBUG_TOSTRING_HELP_OPTIONAL("nMatched", additiveMetrics.nMatched);
@@ -810,6 +819,8 @@ void OpDebug::append(OperationContext* opCtx,
     OPDEBUG_APPEND_OPTIONAL("docsExamined", additiveMetrics.docsExamined);
     OPDEBUG_APPEND_BOOL(hasSortStage);
     OPDEBUG_APPEND_BOOL(usedDisk);
+    OPDEBUG_APPEND_ATOMIC("groupSpilledPartitions", additiveMetrics.groupSpilledPartitions);
+    OPDEBUG_APPEND_ATOMIC("groupSpilledBytes", additiveMetrics.groupSpilledBytes);
     OPDEBUG_APPEND_BOOL(fromMultiPlanner);
     OPDEBUG_APPEND_BOOL(replanned);
     OPDEBUG_APPEND_OPTIONAL("nMatched", additiveMetrics.nMatched);
@@ -936,6 +947,8 @@ void OpDebug::AdditiveMetrics::add(const AdditiveMetrics& otherMetrics) {
     keysDeleted = addOptionalLongs(keysDeleted, otherMetrics.keysDeleted);
     prepareReadConflicts.fetchAndAdd(otherMetrics.prepareReadConflicts.load());
     writeConflicts.fetchAndAdd(otherMetrics.writeConflicts.load());
+    groupSpilledPartitions.fetchAndAdd(otherMetrics.groupSpilledPartitions.load());
+    groupSpilledBytes.fetchAndAdd(otherMetrics.groupSpilledBytes.load());
 }
 
 void OpDebug::AdditiveMetrics::reset() {
@@ -949,6 +962,8 @@ void OpDebug::AdditiveMetrics::reset() {
     keysDeleted = boost::none;
     prepareReadConflicts.store(0);
     writeConflicts.store(0);
+    groupSpilledPartitions.store(0);
+    groupSpilledBytes.store(0);
 }
 
 bool OpDebug::AdditiveMetrics::equals(const AdditiveMetrics& otherMetrics) const {
@@ -957,7 +972,9 @@ bool OpDebug::AdditiveMetrics::equals(const AdditiveMetrics& otherMetrics) const
         ninserted == otherMetrics.ninserted && ndeleted == otherMetrics.ndeleted &&
         keysInserted == otherMetrics.keysInserted && keysDeleted == otherMetrics.keysDeleted &&
         prepareReadConflicts.load() == otherMetrics.prepareReadConflicts.load() &&
-        writeConflicts.load() == otherMetrics.writeConflicts.load();
+        writeConflicts.load() == otherMetrics.writeConflicts.load() &&
+        groupSpilledPartitions.load() == otherMetrics.groupSpilledPartitions.load() &&
+        groupSpilledBytes.load() == otherMetrics.groupSpilledBytes.load();
 }
 
 void OpDebug::AdditiveMetrics::incrementWriteConflicts(long long n) {
@@ -989,6 +1006,11 @@ void OpDebug::AdditiveMetrics::incrementPrepareReadConflicts(long long n) {
     prepareReadConflicts.fetchAndAdd(n);
 }
 
+void OpDebug::AdditiveMetrics::incrementGroupSpills(long long partitions, long long bytes) {
+    groupSpilledPartitions.fetchAndAdd(partitions);
+    groupSpilledBytes.fetchAndAdd(bytes);
+}
+
 string OpDebug::AdditiveMetrics::report() const {
     StringBuilder s;
 
@@ -1002,6 +1024,8 @@ string OpDebug::AdditiveMetrics::report() const {
     OPDEBUG_TOSTRING_HELP_OPTIONAL("keysDeleted", keysDeleted);
     OPDEBUG_TOSTRING_HELP_ATOMIC("prepareReadConflicts", prepareReadConflicts);
     OPDEBUG_TOSTRING_HELP_ATOMIC("writeConflicts", writeConflicts);
+    OPDEBUG_TOSTRING_HELP_ATOMIC("groupSpilledPartitions", groupSpilledPartitions);
+    OPDEBUG_TOSTRING_HELP_ATOMIC("groupSpilledBytes", groupSpilledBytes);
 
     return s.str();
 }
@@ -109,6 +109,11 @@ public:
          */
         void incrementPrepareReadConflicts(long long n);
 
+        /**
+         * Increments groupSpilledPartitions by 'partitions' and groupSpilledBytes by 'bytes'.
+         */
+        void incrementGroupSpills(long long partitions, long long bytes);
+
         /**
          * Generates a string showing all non-empty fields. For every non-empty field field1,
          * field2, ..., with corresponding values value1, value2, ..., we will output a string in
@@ -139,6 +144,11 @@ public:
         // Number of read conflicts caused by a prepared transaction.
         AtomicWord<long long> prepareReadConflicts{0};
         AtomicWord<long long> writeConflicts{0};
+
+        // Number of partitions spilled by $group stages using partitioned spilling, and the total
+        // number of bytes spilled by $group stages. The stages add to these as they spill.
+        AtomicWord<long long> groupSpilledPartitions{0};
+        AtomicWord<long long> groupSpilledBytes{0};
     };
 
     OpDebug() = default;
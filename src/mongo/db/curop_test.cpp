@@ -166,6 +166,7 @@ TEST(CurOpTest, AdditiveMetricsFieldsShouldIncrementByN) {
     additiveMetrics.writeConflicts.store(1);
     additiveMetrics.keysInserted = 2;
     additiveMetrics.prepareReadConflicts.store(6);
+    additiveMetrics.groupSpilledBytes.store(100);
 
     // Increment the fields.
     additiveMetrics.incrementWriteConflicts(1);
@@ -173,12 +174,15 @@ TEST(CurOpTest, AdditiveMetricsFieldsShouldIncrementByN) {
     additiveMetrics.incrementKeysDeleted(0);
     additiveMetrics.incrementNinserted(3);
     additiveMetrics.incrementPrepareReadConflicts(2);
+    additiveMetrics.incrementGroupSpills(1, 50);
 
     ASSERT_EQ(additiveMetrics.writeConflicts.load(), 2);
     ASSERT_EQ(*additiveMetrics.keysInserted, 7);
     ASSERT_EQ(*additiveMetrics.keysDeleted, 0);
     ASSERT_EQ(*additiveMetrics.ninserted, 3);
     ASSERT_EQ(additiveMetrics.prepareReadConflicts.load(), 8);
+    ASSERT_EQ(additiveMetrics.groupSpilledPartitions.load(), 1);
+    ASSERT_EQ(additiveMetrics.groupSpilledBytes.load(), 150);
 }
 
 TEST(CurOpTest, OptionalAdditiveMetricsNotDisplayedIfUninitialized) {
@@ -72,6 +72,7 @@
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/dbmessage.h"
+#include "mongo/db/exec/intra_query_workers.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/free_mon/free_mon_mongod.h"
 #include "mongo/db/ftdc/ftdc_mongod.h"
@@ -104,6 +105,7 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repair_database_and_check_version.h"
 #include "mongo/db/repl/drop_pending_collection_reaper.h"
+#include "mongo/db/repl/file_copy_initial_sync.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/repl_settings.h"
 #include "mongo/db/repl/replication_consistency_markers_impl.h"
@@ -334,6 +336,7 @@ ExitCode _initAndListen(int listenPort) {
                      std::make_unique<FlowControl>(
                          serviceContext, repl::ReplicationCoordinator::get(serviceContext)));
 
+    repl::copyDataFilesFromSyncSourceIfNeeded(serviceContext);
     initializeStorageEngine(serviceContext, StorageEngineInitFlags::kNone);
 
 #ifdef MONGO_CONFIG_WIREDTIGER_ENABLED
@@ -982,6 +985,10 @@ void shutdownTask(const ShutdownTaskArgs& shutdownArgs) {
     // Depends on setKillAllOperations() above to interrupt the index build operations.
     IndexBuildsCoordinator::get(serviceContext)->shutdown();
 
+    // Index builds and queries which are still running do the rest of their work on their own
+    // threads once the intra-query worker pool has shut down.
+    IntraQueryWorkers::shutdown(serviceContext);
+
     ReplicaSetMonitor::shutdown();
 
     if (auto sr = Grid::get(serviceContext)->shardRegistry()) {
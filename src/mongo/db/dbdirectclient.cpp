@@ -152,6 +152,8 @@ bool DBDirectClient::call(Message& toSend, Message& response, bool assertOk, str
     auto dbResponse = loopbackBuildResponse(_opCtx, &_lastError, toSend);
     invariant(!dbResponse.response.empty());
     response = std::move(dbResponse.response);
+    // Replies are parsed in place, so they must not reference documents in other buffers.
+    response.flatten();
 
     return true;
 }
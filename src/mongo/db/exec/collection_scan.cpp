@@ -31,6 +31,7 @@
 
 #include "mongo/db/exec/collection_scan.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "mongo/db/catalog/collection.h"
@@ -38,9 +39,11 @@
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/exec/collection_scan_common.h"
 #include "mongo/db/exec/filter.h"
+#include "mongo/db/exec/intra_query_workers.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/repl/optime.h"
 #include "mongo/db/storage/oplog_hack.h"
 #include "mongo/util/fail_point.h"
@@ -53,6 +56,67 @@ namespace mongo {
 using std::unique_ptr;
 using std::vector;
 
+namespace {
+
+// The number of records read ahead by the first batch of a scan which evaluates its filter in
+// parallel. Each subsequent batch doubles in size, up to
+// 'internalQueryCollectionScanReadAheadMaxRecords'.
+const size_t kInitialReadAheadBatchSize = 64;
+
+// The number of partitions each thread evaluating a read ahead batch is given on average, so that
+// threads which finish early can pick up remaining work.
+const size_t kReadAheadPartitionsPerThread = 4;
+
+// A read ahead batch stops early once its records take up this many bytes, which keeps the buffer
+// holding them well within BufferMaxSize even when the last record is as large as a document gets.
+const int kReadAheadMaxBytes = 16 * 1024 * 1024;
+
+/**
+ * Returns true if 'expr' consists only of match expressions which are stateless when matching, and
+ * may therefore be evaluated against several documents concurrently. This excludes, among others,
+ * $where and $expr, which evaluate through shared JavaScript and expression contexts.
+ */
+bool canEvaluateInParallel(const MatchExpression* expr) {
+    switch (expr->matchType()) {
+        case MatchExpression::AND:
+        case MatchExpression::OR:
+        case MatchExpression::NOR:
+        case MatchExpression::NOT:
+        case MatchExpression::ELEM_MATCH_OBJECT:
+        case MatchExpression::ELEM_MATCH_VALUE:
+        case MatchExpression::SIZE:
+        case MatchExpression::EQ:
+        case MatchExpression::LTE:
+        case MatchExpression::LT:
+        case MatchExpression::GT:
+        case MatchExpression::GTE:
+        case MatchExpression::REGEX:
+        case MatchExpression::MOD:
+        case MatchExpression::EXISTS:
+        case MatchExpression::MATCH_IN:
+        case MatchExpression::BITS_ALL_SET:
+        case MatchExpression::BITS_ALL_CLEAR:
+        case MatchExpression::BITS_ANY_SET:
+        case MatchExpression::BITS_ANY_CLEAR:
+        case MatchExpression::TYPE_OPERATOR:
+        case MatchExpression::ALWAYS_FALSE:
+        case MatchExpression::ALWAYS_TRUE:
+        case MatchExpression::INTERNAL_EXPR_EQ:
+            break;
+        default:
+            return false;
+    }
+
+    for (size_t i = 0; i < expr->numChildren(); ++i) {
+        if (!canEvaluateInParallel(expr->getChild(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
 // static
 const char* CollectionScan::kStageType = "COLLSCAN";
 
@@ -84,6 +148,16 @@ CollectionScan::CollectionScan(OperationContext* opCtx,
         _endCondition = std::make_unique<GTEMatchExpression>(repl::OpTime::kTimestampFieldName,
                                                              _endConditionBSON.firstElement());
     }
+
+    // Evaluating the filter in parallel reads records ahead of the consumer, which is only done for
+    // plain scans of regular collections.
+    const int filterWorkers = internalQueryCollectionScanFilterWorkers.load();
+    if (filterWorkers > 1 && _filter && canEvaluateInParallel(_filter) && !params.tailable &&
+        !params.minTs && !params.maxTs && !params.shouldTrackLatestOplogTimestamp &&
+        !params.stopApplyingFilterAfterFirstMatch && !collection->ns().isOplog()) {
+        _filterWorkers = filterWorkers;
+    }
+    _readAheadBatchSize = kInitialReadAheadBatchSize;
 }
 
 PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
@@ -91,6 +165,10 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
         return PlanStage::IS_EOF;
     }
 
+    if (_readAheadPos < _readAheadBuffer.size()) {
+        return returnReadAheadRecord(out);
+    }
+
     boost::optional<Record> record;
     const bool needToMakeCursor = !_cursor;
     try {
@@ -137,6 +215,14 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
             return PlanStage::NEED_TIME;
         }
 
+        if (_filterWorkers > 1 && readAheadAndFilter()) {
+            if (_readAheadBuffer.empty()) {
+                _commonStats.isEOF = true;
+                return PlanStage::IS_EOF;
+            }
+            return returnReadAheadRecord(out);
+        }
+
         if (_lastSeenId.isNull() && _params.minTs) {
             // See if the RecordStore supports the oplogStartHack.
             StatusWith<RecordId> goal = oploghack::keyForOptime(*_params.minTs);
@@ -206,6 +292,87 @@ Status CollectionScan::setLatestOplogEntryTimestamp(const Record& record) {
     return Status::OK();
 }
 
+bool CollectionScan::readAheadAndFilter() {
+    IntraQueryWorkers workers(getOpCtx()->getServiceContext(), _filterWorkers - 1);
+    if (workers.size() == 0) {
+        return false;
+    }
+
+    _readAheadBuffer.clear();
+    _readAheadRecordData.reset();
+    _readAheadPos = 0;
+
+    auto filterReadAheadBuffer = [&] {
+        // The record data no longer moves once all of the batch has been read.
+        for (auto&& readAheadRecord : _readAheadBuffer) {
+            readAheadRecord.obj = BSONObj(_readAheadRecordData.buf() + readAheadRecord.offset);
+        }
+
+        const size_t numRecords = _readAheadBuffer.size();
+        const size_t numThreads = workers.size() + 1;
+        const size_t numPartitions =
+            std::min(numRecords, numThreads * kReadAheadPartitionsPerThread);
+        if (numPartitions == 0) {
+            return;
+        }
+
+        const size_t partitionSize = (numRecords + numPartitions - 1) / numPartitions;
+        workers.parallelFor(numPartitions, [&](size_t partition) {
+            const size_t end = std::min(numRecords, (partition + 1) * partitionSize);
+            for (size_t i = partition * partitionSize; i < end; ++i) {
+                auto& readAheadRecord = _readAheadBuffer[i];
+                readAheadRecord.matches = _filter->matchesBSON(readAheadRecord.obj);
+            }
+        });
+        _specificStats.filterWorkers = std::max(_specificStats.filterWorkers, numThreads);
+    };
+
+    try {
+        while (_readAheadBuffer.size() < _readAheadBatchSize &&
+               _readAheadRecordData.len() < kReadAheadMaxBytes) {
+            auto record = _cursor->next();
+            if (!record) {
+                break;
+            }
+            _readAheadBuffer.push_back({record->id,
+                                        getOpCtx()->recoveryUnit()->getSnapshotId(),
+                                        _readAheadRecordData.len(),
+                                        BSONObj()});
+            _readAheadRecordData.appendBuf(record->data.data(), record->data.size());
+        }
+    } catch (const WriteConflictException&) {
+        // The records read so far are behind the cursor's position, so they must still be returned
+        // once the scan resumes.
+        filterReadAheadBuffer();
+        throw;
+    }
+
+    filterReadAheadBuffer();
+    _readAheadBatchSize = std::min(
+        _readAheadBatchSize * 2,
+        static_cast<size_t>(internalQueryCollectionScanReadAheadMaxRecords.load()));
+    return true;
+}
+
+PlanStage::StageState CollectionScan::returnReadAheadRecord(WorkingSetID* out) {
+    auto& readAheadRecord = _readAheadBuffer[_readAheadPos++];
+    _lastSeenId = readAheadRecord.id;
+    ++_specificStats.docsTested;
+
+    if (!readAheadRecord.matches) {
+        return PlanStage::NEED_TIME;
+    }
+
+    WorkingSetID id = _workingSet->allocate();
+    WorkingSetMember* member = _workingSet->get(id);
+    member->recordId = readAheadRecord.id;
+    member->resetDocument(readAheadRecord.snapshotId, readAheadRecord.obj.getOwned());
+    _workingSet->transitionToRecordIdAndObj(id);
+
+    *out = id;
+    return PlanStage::ADVANCED;
+}
+
 PlanStage::StageState CollectionScan::returnIfMatches(WorkingSetMember* member,
                                                       WorkingSetID memberID,
                                                       WorkingSetID* out) {
@@ -30,11 +30,14 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
+#include "mongo/bson/util/builder.h"
 #include "mongo/db/exec/collection_scan_common.h"
 #include "mongo/db/exec/requires_collection_stage.h"
 #include "mongo/db/matcher/expression_leaf.h"
 #include "mongo/db/record_id.h"
+#include "mongo/db/storage/snapshot.h"
 
 namespace mongo {
 
@@ -96,6 +99,19 @@ private:
      */
     Status setLatestOplogEntryTimestamp(const Record& record);
 
+    /**
+     * Reads a batch of records ahead from '_cursor' into '_readAheadBuffer' and evaluates '_filter'
+     * against them using intra-query worker threads. Returns false, without reading anything, if
+     * no worker threads could be reserved.
+     */
+    bool readAheadAndFilter();
+
+    /**
+     * Returns the next record from '_readAheadBuffer' if it passed the filter, and NEED_TIME
+     * otherwise.
+     */
+    StageState returnReadAheadRecord(WorkingSetID* out);
+
     // WorkingSet is not owned by us.
     WorkingSet* _workingSet;
 
@@ -117,6 +133,28 @@ private:
     // timestamp seen in the collection.  Otherwise, this is a null timestamp.
     Timestamp _latestOplogEntryTimestamp;
 
+    // The maximum number of threads, including this one, used to evaluate '_filter'. Parallel
+    // evaluation is only used for plain scans whose filter is safe to evaluate concurrently.
+    size_t _filterWorkers = 1;
+
+    // Records read ahead from '_cursor' whose filter has already been evaluated, to be returned in
+    // scan order. The batch size grows with each read ahead, so that a scan which is only partially
+    // consumed does not read far beyond what its consumer needs.
+    struct ReadAheadRecord {
+        RecordId id;
+        SnapshotId snapshotId;
+        int offset;  // Into '_readAheadRecordData'.
+        BSONObj obj;
+        bool matches = false;
+    };
+    std::vector<ReadAheadRecord> _readAheadBuffer;
+
+    // The data of every record in '_readAheadBuffer', since the cursor's copy does not outlive its
+    // next call. Reused across read aheads; only records which pass the filter get their own copy.
+    BufBuilder _readAheadRecordData;
+    size_t _readAheadPos = 0;
+    size_t _readAheadBatchSize;
+
     // Stats
     CollectionScanStats _specificStats;
 };
@@ -78,6 +78,7 @@ IndexScan::IndexScan(OperationContext* opCtx,
     _specificStats.indexName = params.name;
     _specificStats.keyPattern = _keyPattern;
     _specificStats.isMultiKey = params.isMultiKey;
+    _specificStats.estimatedKeysExamined = params.estimatedKeysExamined;
     _specificStats.multiKeyPaths = params.multikeyPaths;
     _specificStats.isUnique = params.indexDescriptor->unique();
     _specificStats.isSparse = params.indexDescriptor->isSparse();
@@ -80,6 +80,9 @@ struct IndexScanParams {
 
     // Do we want to add the key as metadata?
     bool addKeyMetadata{false};
+
+    // The cost model's estimate of the number of keys the scan will examine, reported by explain.
+    boost::optional<double> estimatedKeysExamined;
 };
 
 /**
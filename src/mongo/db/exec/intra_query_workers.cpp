@@ -0,0 +1,159 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/intra_query_workers.h"
+
+#include <algorithm>
+#include <exception>
+
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/service_context.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/util/concurrency/thread_pool.h"
+
+namespace mongo {
+namespace {
+
+AtomicWord<long long> numReservedWorkers{0};
+
+/**
+ * Each granted helper runs at most one task at a time, so the reservations made against the pool
+ * keep it from needing more threads than the budget allows.
+ */
+struct IntraQueryWorkerPool {
+    IntraQueryWorkerPool()
+        : threadPool([] {
+              ThreadPool::Options options;
+              options.poolName = "IntraQueryWorkers";
+              options.threadNamePrefix = "IntraQueryWorker-";
+              options.minThreads = 0;
+              options.maxThreads = IntraQueryWorkers::kMaxWorkerThreads;
+              return options;
+          }()) {}
+
+    ThreadPool threadPool;
+};
+
+const auto getIntraQueryWorkerPool = ServiceContext::declareDecoration<IntraQueryWorkerPool>();
+const ServiceContext::ConstructorActionRegisterer intraQueryWorkerPoolRegisterer{
+    "IntraQueryWorkerPool",
+    [](ServiceContext* service) { getIntraQueryWorkerPool(service).threadPool.startup(); }};
+
+}  // namespace
+
+IntraQueryWorkers::IntraQueryWorkers(ServiceContext* service, size_t requested)
+    : _pool(&getIntraQueryWorkerPool(service).threadPool) {
+    if (requested == 0) {
+        return;
+    }
+
+    const long long budget = internalQueryMaxIntraQueryWorkers.load();
+    auto reserved = numReservedWorkers.load();
+    while (reserved < budget) {
+        const auto toGrant = std::min(static_cast<long long>(requested), budget - reserved);
+        if (numReservedWorkers.compareAndSwap(&reserved, reserved + toGrant)) {
+            _granted = toGrant;
+            return;
+        }
+    }
+}
+
+IntraQueryWorkers::~IntraQueryWorkers() {
+    if (_granted) {
+        numReservedWorkers.subtractAndFetch(_granted);
+    }
+}
+
+void IntraQueryWorkers::shutdown(ServiceContext* service) {
+    auto& pool = getIntraQueryWorkerPool(service).threadPool;
+    pool.shutdown();
+    pool.join();
+}
+
+size_t IntraQueryWorkers::getNumReserved() {
+    return numReservedWorkers.load();
+}
+
+void IntraQueryWorkers::parallelFor(size_t numPartitions, const std::function<void(size_t)>& fn) {
+    AtomicWord<unsigned long long> nextPartition{0};
+    auto mutex = MONGO_MAKE_LATCH();
+    stdx::condition_variable allHelpersDone;
+    size_t numRunningHelpers = 0;
+    std::exception_ptr firstError;
+
+    // Each participant claims partitions until there are none left, so that an uneven split of
+    // work does not leave threads idle while another still has several partitions queued.
+    auto runPartitions = [&] {
+        try {
+            for (auto partition = nextPartition.fetchAndAdd(1); partition < numPartitions;
+                 partition = nextPartition.fetchAndAdd(1)) {
+                fn(partition);
+            }
+        } catch (...) {
+            stdx::lock_guard<Latch> lk(mutex);
+            if (!firstError) {
+                firstError = std::current_exception();
+            }
+        }
+    };
+
+    const size_t numHelpers = std::min(_granted, numPartitions > 0 ? numPartitions - 1 : 0);
+    {
+        stdx::lock_guard<Latch> lk(mutex);
+        numRunningHelpers = numHelpers;
+    }
+    for (size_t i = 0; i < numHelpers; ++i) {
+        // If the pool is shutting down, the task is run inline with a non-OK status. The work is
+        // still performed, just without the extra parallelism.
+        _pool->schedule([&](Status) {
+            runPartitions();
+            stdx::lock_guard<Latch> lk(mutex);
+            if (--numRunningHelpers == 0) {
+                allHelpersDone.notify_one();
+            }
+        });
+    }
+
+    runPartitions();
+
+    {
+        stdx::unique_lock<Latch> lk(mutex);
+        allHelpersDone.wait(lk, [&] { return numRunningHelpers == 0; });
+    }
+
+    if (firstError) {
+        std::rethrow_exception(firstError);
+    }
+}
+
+}  // namespace mongo
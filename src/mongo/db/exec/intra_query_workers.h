@@ -0,0 +1,92 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace mongo {
+
+class ServiceContext;
+class ThreadPool;
+
+/**
+ * Reserves helper threads on behalf of a single query from the process-wide budget of intra-query
+ * workers, which is bounded by 'internalQueryMaxIntraQueryWorkers'. The reservation is held for the
+ * lifetime of this object. Fewer helpers than requested, possibly none, are granted when other
+ * queries hold the rest of the budget; callers are expected to fall back to serial execution.
+ *
+ * The helpers run on a thread pool owned by the ServiceContext, which has at most
+ * kMaxWorkerThreads threads.
+ */
+class IntraQueryWorkers {
+    IntraQueryWorkers(const IntraQueryWorkers&) = delete;
+    IntraQueryWorkers& operator=(const IntraQueryWorkers&) = delete;
+
+public:
+    // The most threads the worker pool of a ServiceContext runs at once. This is also the upper
+    // bound of 'internalQueryMaxIntraQueryWorkers'.
+    static constexpr size_t kMaxWorkerThreads = 64;
+
+    IntraQueryWorkers(ServiceContext* service, size_t requested);
+    ~IntraQueryWorkers();
+
+    /**
+     * Shuts down the worker pool of 'service' and waits for its threads to exit. Work scheduled
+     * afterwards runs on the calling thread of parallelFor().
+     */
+    static void shutdown(ServiceContext* service);
+
+    /**
+     * The number of helper threads granted to this reservation.
+     */
+    size_t size() const {
+        return _granted;
+    }
+
+    /**
+     * Invokes 'fn' once for each partition in [0, numPartitions), spreading the calls across the
+     * granted helper threads and the calling thread, and returns once every call has finished. If
+     * any call throws, the first exception is rethrown on the calling thread. 'fn' must be safe to
+     * invoke concurrently for distinct partitions.
+     */
+    void parallelFor(size_t numPartitions, const std::function<void(size_t)>& fn);
+
+    /**
+     * Returns the number of helper threads currently reserved across the process.
+     */
+    static size_t getNumReserved();
+
+private:
+    ThreadPool* const _pool;
+    size_t _granted = 0;
+};
+
+}  // namespace mongo
@@ -0,0 +1,114 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <vector>
+
+#include "mongo/db/exec/intra_query_workers.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/service_context_test_fixture.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace {
+
+using IntraQueryWorkersTest = ServiceContextTest;
+
+TEST_F(IntraQueryWorkersTest, ReservationIsBoundedByGlobalBudget) {
+    const auto originalBudget = internalQueryMaxIntraQueryWorkers.load();
+    ON_BLOCK_EXIT([&] { internalQueryMaxIntraQueryWorkers.store(originalBudget); });
+    internalQueryMaxIntraQueryWorkers.store(5);
+
+    ASSERT_EQ(IntraQueryWorkers::getNumReserved(), 0U);
+    {
+        IntraQueryWorkers first(getServiceContext(), 3);
+        ASSERT_EQ(first.size(), 3U);
+
+        IntraQueryWorkers second(getServiceContext(), 3);
+        ASSERT_EQ(second.size(), 2U);
+
+        IntraQueryWorkers third(getServiceContext(), 1);
+        ASSERT_EQ(third.size(), 0U);
+        ASSERT_EQ(IntraQueryWorkers::getNumReserved(), 5U);
+    }
+    ASSERT_EQ(IntraQueryWorkers::getNumReserved(), 0U);
+
+    IntraQueryWorkers none(getServiceContext(), 0);
+    ASSERT_EQ(none.size(), 0U);
+}
+
+TEST_F(IntraQueryWorkersTest, ParallelForInvokesEachPartitionOnce) {
+    for (size_t requested : {0, 1, 4}) {
+        IntraQueryWorkers workers(getServiceContext(), requested);
+        for (size_t numPartitions : {0, 1, 3, 100}) {
+            std::vector<AtomicWord<int>> calls(numPartitions);
+            workers.parallelFor(numPartitions, [&](size_t partition) {
+                ASSERT_LT(partition, numPartitions);
+                calls[partition].fetchAndAdd(1);
+            });
+            for (auto&& count : calls) {
+                ASSERT_EQ(count.load(), 1);
+            }
+        }
+    }
+}
+
+TEST_F(IntraQueryWorkersTest, ParallelForRethrowsExceptionOnCallingThread) {
+    IntraQueryWorkers workers(getServiceContext(), 4);
+    AtomicWord<int> numFinished{0};
+    ASSERT_THROWS_CODE(workers.parallelFor(50,
+                                           [&](size_t partition) {
+                                               if (partition == 10) {
+                                                   uasserted(ErrorCodes::BadValue, "failed");
+                                               }
+                                               numFinished.fetchAndAdd(1);
+                                           }),
+                       AssertionException,
+                       ErrorCodes::BadValue);
+    ASSERT_LTE(numFinished.load(), 49);
+}
+
+TEST_F(IntraQueryWorkersTest, ParallelForRunsEveryPartitionAfterShutdown) {
+    IntraQueryWorkers::shutdown(getServiceContext());
+
+    IntraQueryWorkers workers(getServiceContext(), 4);
+    ASSERT_EQ(workers.size(), 4U);
+    std::vector<AtomicWord<int>> calls(20);
+    workers.parallelFor(calls.size(), [&](size_t partition) { calls[partition].fetchAndAdd(1); });
+    for (auto&& count : calls) {
+        ASSERT_EQ(count.load(), 1);
+    }
+}
+
+}  // namespace
+}  // namespace mongo
@@ -245,6 +245,10 @@ struct CollectionScanStats : public SpecificStats {
     // document that does not pass the filter and has a "ts" Timestamp field greater than 'maxTs'.
     // Must only be set on forward oplog scans.
     boost::optional<Timestamp> maxTs;
+
+    // The largest number of threads, including the one executing the query, which evaluated the
+    // filter over a batch of records read ahead from the collection.
+    size_t filterWorkers{1};
 };
 
 struct CountStats : public SpecificStats {
@@ -530,6 +534,10 @@ struct IndexScanStats : public SpecificStats {
 
     // Number of times the index cursor is re-positioned during the execution of the scan.
     size_t seeks;
+
+    // The number of keys the cost model expected the scan to examine, if it had statistics for
+    // the index.
+    boost::optional<double> estimatedKeysExamined;
 };
 
 struct LimitStats : public SpecificStats {
@@ -33,6 +33,7 @@
 
 #include "mongo/db/index/btree_access_method.h"
 
+#include <algorithm>
 #include <utility>
 #include <vector>
 
@@ -49,6 +50,7 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/repl/timestamp_block.h"
+#include "mongo/db/sorter/sort_iterator_prefetcher.h"
 #include "mongo/db/storage/durable_catalog.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/util/log.h"
@@ -66,6 +68,13 @@ using IndexVersion = IndexDescriptor::IndexVersion;
 
 namespace {
 
+// Number of keys handed from the sorter to the index builder, and inserted under a single
+// WriteUnitOfWork, at a time during the final phase of a bulk build.
+const size_t kBulkLoadBatchSize = 1024;
+
+// Number of batches which the sorter may read ahead of the index builder.
+const size_t kBulkLoadMaxQueuedBatches = 4;
+
 // Reserved RecordId against which multikey metadata keys are indexed.
 static const RecordId kMultikeyMetadataKeyId =
     RecordId{RecordId::ReservedId::kWildcardMultikeyMetadataId};
@@ -427,12 +436,14 @@ class AbstractIndexAccessMethod::BulkBuilderImpl : public IndexAccessMethod::Bul
 public:
     BulkBuilderImpl(const IndexAccessMethod* index,
                     const IndexDescriptor* descriptor,
-                    size_t maxMemoryUsageBytes);
+                    size_t maxMemoryUsageBytes,
+                    size_t numPartitions);
 
     Status insert(OperationContext* opCtx,
                   const BSONObj& obj,
                   const RecordId& loc,
-                  const InsertDeleteOptions& options) final;
+                  const InsertDeleteOptions& options,
+                  size_t partition) final;
 
     const MultikeyPaths& getMultikeyPaths() const final;
 
@@ -447,99 +458,164 @@ public:
     int64_t getKeysInserted() const final;
 
 private:
-    std::unique_ptr<Sorter> _sorter;
-    const IndexAccessMethod* _real;
-    int64_t _keysInserted = 0;
+    /**
+     * The state accumulated by the inserts into one partition.
+     */
+    struct Partition {
+        std::unique_ptr<Sorter> sorter;
+        int64_t keysInserted = 0;
+
+        // Set to true if any document added to the partition causes the index to become
+        // multikey.
+        bool isMultiKey = false;
 
-    // Set to true if any document added to the BulkBuilder causes the index to become multikey.
-    bool _isMultiKey = false;
+        // Holds the path components that cause this index to be multikey. The vector remains
+        // empty if this index doesn't support path-level multikey tracking.
+        MultikeyPaths indexMultikeyPaths;
 
-    // Holds the path components that cause this index to be multikey. The '_indexMultikeyPaths'
-    // vector remains empty if this index doesn't support path-level multikey tracking.
-    MultikeyPaths _indexMultikeyPaths;
+        // Caches the set of all multikey metadata keys generated by the partition. These are
+        // inserted into the sorter after all normal data keys have been added, just before the
+        // bulk build is committed.
+        KeyStringSet multikeyMetadataKeys;
+    };
 
-    // Caches the set of all multikey metadata keys generated during the bulk build process.
-    // These are inserted into the sorter after all normal data keys have been added, just
-    // before the bulk build is committed.
-    KeyStringSet _multikeyMetadataKeys;
+    const IndexAccessMethod* _real;
+    std::vector<Partition> _partitions;
+
+    // The multikey paths of all partitions combined, computed by getMultikeyPaths().
+    mutable MultikeyPaths _indexMultikeyPaths;
 };
 
 std::unique_ptr<IndexAccessMethod::BulkBuilder> AbstractIndexAccessMethod::initiateBulk(
-    size_t maxMemoryUsageBytes) {
-    return std::make_unique<BulkBuilderImpl>(this, _descriptor, maxMemoryUsageBytes);
+    size_t maxMemoryUsageBytes, size_t numPartitions) {
+    return std::make_unique<BulkBuilderImpl>(
+        this, _descriptor, maxMemoryUsageBytes, numPartitions);
+}
+
+namespace {
+
+SortOptions makeBulkSortOptions(size_t maxMemoryUsageBytes) {
+    return SortOptions()
+        .TempDir(storageGlobalParams.dbpath + "/_tmp")
+        .ExtSortAllowed()
+        .MaxMemoryUsageBytes(maxMemoryUsageBytes);
 }
 
+void mergeMultikeyPaths(const MultikeyPaths& from, MultikeyPaths* into) {
+    if (from.empty()) {
+        return;
+    }
+    if (into->empty()) {
+        *into = from;
+        return;
+    }
+    invariant(into->size() == from.size());
+    for (size_t i = 0; i < from.size(); ++i) {
+        (*into)[i].insert(from[i].begin(), from[i].end());
+    }
+}
+
+}  // namespace
+
 AbstractIndexAccessMethod::BulkBuilderImpl::BulkBuilderImpl(const IndexAccessMethod* index,
                                                             const IndexDescriptor* descriptor,
-                                                            size_t maxMemoryUsageBytes)
-    : _sorter(Sorter::make(SortOptions()
-                               .TempDir(storageGlobalParams.dbpath + "/_tmp")
-                               .ExtSortAllowed()
-                               .MaxMemoryUsageBytes(maxMemoryUsageBytes),
-                           BtreeExternalSortComparison(),
-                           std::pair<KeyString::Value::SorterDeserializeSettings,
-                                     mongo::NullValue::SorterDeserializeSettings>(
-                               {index->getSortedDataInterface()->getKeyStringVersion()}, {}))),
-      _real(index) {}
+                                                            size_t maxMemoryUsageBytes,
+                                                            size_t numPartitions)
+    : _real(index), _partitions(numPartitions) {
+    invariant(numPartitions > 0);
+    for (auto&& partition : _partitions) {
+        partition.sorter.reset(
+            Sorter::make(makeBulkSortOptions(maxMemoryUsageBytes / numPartitions),
+                         BtreeExternalSortComparison(),
+                         std::pair<KeyString::Value::SorterDeserializeSettings,
+                                   mongo::NullValue::SorterDeserializeSettings>(
+                             {index->getSortedDataInterface()->getKeyStringVersion()}, {})));
+    }
+}
 
 Status AbstractIndexAccessMethod::BulkBuilderImpl::insert(OperationContext* opCtx,
                                                           const BSONObj& obj,
                                                           const RecordId& loc,
-                                                          const InsertDeleteOptions& options) {
+                                                          const InsertDeleteOptions& options,
+                                                          size_t partition) {
+    invariant(partition < _partitions.size());
+    auto& state = _partitions[partition];
+
     KeyStringSet keys;
     MultikeyPaths multikeyPaths;
 
     try {
         _real->getKeys(
-            obj, options.getKeysMode, &keys, &_multikeyMetadataKeys, &multikeyPaths, loc);
+            obj, options.getKeysMode, &keys, &state.multikeyMetadataKeys, &multikeyPaths, loc);
     } catch (...) {
         return exceptionToStatus();
     }
 
-    if (!multikeyPaths.empty()) {
-        if (_indexMultikeyPaths.empty()) {
-            _indexMultikeyPaths = multikeyPaths;
-        } else {
-            invariant(_indexMultikeyPaths.size() == multikeyPaths.size());
-            for (size_t i = 0; i < multikeyPaths.size(); ++i) {
-                _indexMultikeyPaths[i].insert(multikeyPaths[i].begin(), multikeyPaths[i].end());
-            }
-        }
-    }
+    mergeMultikeyPaths(multikeyPaths, &state.indexMultikeyPaths);
 
     for (const auto& keyString : keys) {
-        _sorter->add(keyString, mongo::NullValue());
-        ++_keysInserted;
+        state.sorter->add(keyString, mongo::NullValue());
+        ++state.keysInserted;
     }
 
-    _isMultiKey = _isMultiKey ||
+    state.isMultiKey = state.isMultiKey ||
         _real->shouldMarkIndexAsMultikey(
             {keys.begin(), keys.end()},
-            {_multikeyMetadataKeys.begin(), _multikeyMetadataKeys.end()},
+            {state.multikeyMetadataKeys.begin(), state.multikeyMetadataKeys.end()},
             multikeyPaths);
 
     return Status::OK();
 }
 
 const MultikeyPaths& AbstractIndexAccessMethod::BulkBuilderImpl::getMultikeyPaths() const {
+    _indexMultikeyPaths.clear();
+    for (auto&& partition : _partitions) {
+        mergeMultikeyPaths(partition.indexMultikeyPaths, &_indexMultikeyPaths);
+    }
     return _indexMultikeyPaths;
 }
 
 bool AbstractIndexAccessMethod::BulkBuilderImpl::isMultikey() const {
-    return _isMultiKey;
+    return std::any_of(_partitions.begin(), _partitions.end(), [](const auto& partition) {
+        return partition.isMultiKey;
+    });
 }
 
 IndexAccessMethod::BulkBuilder::Sorter::Iterator*
 AbstractIndexAccessMethod::BulkBuilderImpl::done() {
-    for (const auto& keyString : _multikeyMetadataKeys) {
-        _sorter->add(keyString, mongo::NullValue());
-        ++_keysInserted;
+    // The same metadata key may have been generated by several partitions, but must only be
+    // inserted once.
+    KeyStringSet multikeyMetadataKeys;
+    for (auto&& partition : _partitions) {
+        multikeyMetadataKeys.insert(partition.multikeyMetadataKeys.begin(),
+                                    partition.multikeyMetadataKeys.end());
+    }
+    auto& first = _partitions.front();
+    for (const auto& keyString : multikeyMetadataKeys) {
+        first.sorter->add(keyString, mongo::NullValue());
+        ++first.keysInserted;
+    }
+
+    if (_partitions.size() == 1) {
+        return first.sorter->done();
+    }
+
+    // The partitions' sorters each hold a sorted subset of the keys; merge them into a single
+    // sorted stream. The merge owns no file of its own, as each sorter cleans up its spills.
+    std::vector<std::shared_ptr<Sorter::Iterator>> iters;
+    for (auto&& partition : _partitions) {
+        iters.emplace_back(partition.sorter->done());
     }
-    return _sorter->done();
+    return Sorter::Iterator::merge(
+        iters, "", makeBulkSortOptions(0), BtreeExternalSortComparison());
 }
 
 int64_t AbstractIndexAccessMethod::BulkBuilderImpl::getKeysInserted() const {
-    return _keysInserted;
+    int64_t keysInserted = 0;
+    for (auto&& partition : _partitions) {
+        keysInserted += partition.keysInserted;
+    }
+    return keysInserted;
 }
 
 Status AbstractIndexAccessMethod::commitBulk(OperationContext* opCtx,
@@ -568,64 +644,71 @@ Status AbstractIndexAccessMethod::commitBulk(OperationContext* opCtx,
 
     KeyString::Value previousKey;
 
-    while (it->more()) {
+    // Read and merge the sorted data on a background thread so that the sorter's file I/O overlaps
+    // with the insertions into the index, and insert each batch in a single storage transaction.
+    SortIteratorPrefetcher<KeyString::Value, mongo::NullValue> prefetcher(
+        std::move(it), kBulkLoadBatchSize, kBulkLoadMaxQueuedBatches);
+    std::vector<BulkBuilder::Sorter::Data> batch;
+
+    while (prefetcher.nextBatch(&batch)) {
         opCtx->checkForInterrupt();
 
         WriteUnitOfWork wunit(opCtx);
 
-        // Get the next datum and add it to the builder.
-        BulkBuilder::Sorter::Data data = it->next();
-
-        // Assert that keys are retrieved from the sorter in non-decreasing order, but only in
-        // debug builds since this check can be expensive.
-        int cmpData;
-        if (kDebugBuild || _descriptor->unique()) {
-            cmpData = data.first.compareWithoutRecordId(previousKey);
-            if (cmpData < 0) {
-                severe() << "expected the next key" << data.first.toString()
-                         << " to be greater than or equal to the previous key"
-                         << previousKey.toString();
-                fassertFailedNoTrace(31171);
+        for (auto&& data : batch) {
+            // Assert that keys are retrieved from the sorter in non-decreasing order, but only in
+            // debug builds since this check can be expensive.
+            int cmpData;
+            if (kDebugBuild || _descriptor->unique()) {
+                cmpData = data.first.compareWithoutRecordId(previousKey);
+                if (cmpData < 0) {
+                    severe() << "expected the next key" << data.first.toString()
+                             << " to be greater than or equal to the previous key"
+                             << previousKey.toString();
+                    fassertFailedNoTrace(31171);
+                }
             }
-        }
 
-        // Before attempting to insert, perform a duplicate key check.
-        bool isDup = false;
-        if (_descriptor->unique()) {
-            isDup = cmpData == 0;
-            if (isDup && !dupsAllowed) {
-                if (dupRecords) {
-                    RecordId recordId = KeyString::decodeRecordIdAtEnd(data.first.getBuffer(),
-                                                                       data.first.getSize());
-                    dupRecords->insert(recordId);
-                    continue;
+            // Before attempting to insert, perform a duplicate key check.
+            bool isDup = false;
+            if (_descriptor->unique()) {
+                isDup = cmpData == 0;
+                if (isDup && !dupsAllowed) {
+                    if (dupRecords) {
+                        RecordId recordId = KeyString::decodeRecordIdAtEnd(
+                            data.first.getBuffer(), data.first.getSize());
+                        dupRecords->insert(recordId);
+                        continue;
+                    }
+                    auto dupKey =
+                        KeyString::toBson(data.first, getSortedDataInterface()->getOrdering());
+                    return buildDupKeyErrorStatus(dupKey.getOwned(),
+                                                  _descriptor->parentNS(),
+                                                  _descriptor->indexName(),
+                                                  _descriptor->keyPattern());
                 }
-                auto dupKey =
-                    KeyString::toBson(data.first, getSortedDataInterface()->getOrdering());
-                return buildDupKeyErrorStatus(dupKey.getOwned(),
-                                              _descriptor->parentNS(),
-                                              _descriptor->indexName(),
-                                              _descriptor->keyPattern());
             }
-        }
 
-        Status status = builder->addKey(data.first);
+            Status status = builder->addKey(data.first);
 
-        if (!status.isOK()) {
-            // Duplicates are checked before inserting.
-            invariant(status.code() != ErrorCodes::DuplicateKey);
-            return status;
-        }
+            if (!status.isOK()) {
+                // Duplicates are checked before inserting.
+                invariant(status.code() != ErrorCodes::DuplicateKey);
+                return status;
+            }
+
+            previousKey = data.first;
 
-        previousKey = data.first;
+            if (isDup && dupsAllowed && dupKeysInserted) {
+                auto dupKey =
+                    KeyString::toBson(data.first, getSortedDataInterface()->getOrdering());
+                dupKeysInserted->push_back(dupKey.getOwned());
+            }
 
-        if (isDup && dupsAllowed && dupKeysInserted) {
-            auto dupKey = KeyString::toBson(data.first, getSortedDataInterface()->getOrdering());
-            dupKeysInserted->push_back(dupKey.getOwned());
+            // If we're here either it's a dup and we're cool with it or the addKey went just fine.
+            pm.hit();
         }
 
-        // If we're here either it's a dup and we're cool with it or the addKey went just fine.
-        pm.hit();
         wunit.commit();
     }
 
@@ -204,11 +204,17 @@ public:
 
         /**
          * Insert into the BulkBuilder as-if inserting into an IndexAccessMethod.
+         *
+         * The keys are added to the sorter of 'partition', which must be less than the number of
+         * partitions the BulkBuilder was created with. Inserts into distinct partitions may run
+         * concurrently, but inserts into the same partition must be serialized by the caller.
+         * Callers which don't partition their inserts use partition 0.
          */
         virtual Status insert(OperationContext* opCtx,
                               const BSONObj& obj,
                               const RecordId& loc,
-                              const InsertDeleteOptions& options) = 0;
+                              const InsertDeleteOptions& options,
+                              size_t partition) = 0;
 
         virtual const MultikeyPaths& getMultikeyPaths() const = 0;
 
@@ -216,7 +222,8 @@ public:
 
         /**
          * Inserts all multikey metadata keys cached during the BulkBuilder's lifetime into the
-         * underlying Sorter, finalizes it, and returns an iterator over the sorted dataset.
+         * underlying Sorter, finalizes it, and returns an iterator over the sorted dataset. When
+         * there are several partitions, the iterator merges the output of all their sorters.
          */
         virtual Sorter::Iterator* done() = 0;
 
@@ -235,8 +242,12 @@ public:
      *
      * maxMemoryUsageBytes: amount of memory consumed before the external sorter starts spilling to
      *                      disk
+     * numPartitions: number of independent sorters keys may be inserted into, so that several
+     *                threads can generate keys at once. 'maxMemoryUsageBytes' is shared evenly
+     *                between them.
      */
-    virtual std::unique_ptr<BulkBuilder> initiateBulk(size_t maxMemoryUsageBytes) = 0;
+    virtual std::unique_ptr<BulkBuilder> initiateBulk(size_t maxMemoryUsageBytes,
+                                                      size_t numPartitions) = 0;
 
     /**
      * Call this when you are ready to finish your bulk work.
@@ -489,7 +500,8 @@ public:
 
     void setIndexIsMultikey(OperationContext* opCtx, MultikeyPaths paths) final;
 
-    std::unique_ptr<BulkBuilder> initiateBulk(size_t maxMemoryUsageBytes) final;
+    std::unique_ptr<BulkBuilder> initiateBulk(size_t maxMemoryUsageBytes,
+                                              size_t numPartitions) final;
 
     Status commitBulk(OperationContext* opCtx,
                       BulkBuilder* bulk,
@@ -76,6 +76,16 @@ public:
         processInternal(input, merging);
     }
 
+    /** Process the values at positions 'indices' of 'inputs', in order, and update internal state.
+     *  Equivalent to calling process() on each of those values, but lets accumulators with a
+     *  specialized batch implementation avoid per-value dispatch.
+     */
+    void processBatch(const std::vector<Value>& inputs,
+                      const std::vector<size_t>& indices,
+                      bool merging) {
+        processBatchInternal(inputs, indices, merging);
+    }
+
     /** Marks the end of the evaluate() phase and return accumulated result.
      *  toBeMerged should be true when the outputs will be merged by process().
      */
@@ -105,10 +115,27 @@ public:
         return AccumulatorDocumentsNeeded::kAllDocuments;
     }
 
+    /**
+     * Returns true if this accumulator overrides processBatchInternal() with a specialized loop.
+     * $group only switches to batched execution when all of its accumulators do.
+     */
+    virtual bool hasBatchImplementation() const {
+        return false;
+    }
+
 protected:
     /// Update subclass's internal state based on input
     virtual void processInternal(const Value& input, bool merging) = 0;
 
+    /// Update subclass's internal state based on a batch of inputs. Defaults to processInternal().
+    virtual void processBatchInternal(const std::vector<Value>& inputs,
+                                      const std::vector<size_t>& indices,
+                                      bool merging) {
+        for (auto index : indices) {
+            processInternal(inputs[index], merging);
+        }
+    }
+
     const boost::intrusive_ptr<ExpressionContext>& getExpressionContext() const {
         return _expCtx;
     }
@@ -221,6 +248,15 @@ public:
         return true;
     }
 
+    bool hasBatchImplementation() const final {
+        return true;
+    }
+
+protected:
+    void processBatchInternal(const std::vector<Value>& inputs,
+                              const std::vector<size_t>& indices,
+                              bool merging) final;
+
 private:
     BSONType totalType = NumberInt;
     DoubleDoubleSummation nonDecimalTotal;
@@ -250,6 +286,15 @@ public:
         return true;
     }
 
+    bool hasBatchImplementation() const final {
+        return true;
+    }
+
+protected:
+    void processBatchInternal(const std::vector<Value>& inputs,
+                              const std::vector<size_t>& indices,
+                              bool merging) final;
+
 private:
     Value _val;
     const Sense _sense;
@@ -301,6 +346,15 @@ public:
     static boost::intrusive_ptr<Accumulator> create(
         const boost::intrusive_ptr<ExpressionContext>& expCtx);
 
+    bool hasBatchImplementation() const final {
+        return true;
+    }
+
+protected:
+    void processBatchInternal(const std::vector<Value>& inputs,
+                              const std::vector<size_t>& indices,
+                              bool merging) final;
+
 private:
     /**
      * The total of all values is partitioned between those that are decimals, and those that are
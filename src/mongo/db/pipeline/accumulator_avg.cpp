@@ -37,6 +37,7 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/platform/decimal128.h"
+#include "mongo/platform/overflow_arithmetic.h"
 
 namespace mongo {
 
@@ -93,6 +94,49 @@ void AccumulatorAvg::processInternal(const Value& input, bool merging) {
     _count++;
 }
 
+void AccumulatorAvg::processBatchInternal(const std::vector<Value>& inputs,
+                                          const std::vector<size_t>& indices,
+                                          bool merging) {
+    if (merging) {
+        Accumulator::processBatchInternal(inputs, indices, merging);
+        return;
+    }
+
+    // As in AccumulatorSum, integral inputs are summed exactly in a 64-bit register which is only
+    // folded into '_nonDecimalTotal' on overflow and at the end of the batch.
+    long long longTotal = 0;
+    for (auto index : indices) {
+        const Value& input = inputs[index];
+        switch (input.getType()) {
+            case NumberDecimal:
+                _decimalTotal = _decimalTotal.add(input.getDecimal());
+                _isDecimal = true;
+                break;
+            case NumberInt:
+            case NumberLong: {
+                const long long addend = input.coerceToLong();
+                long long newTotal;
+                if (overflow::add(longTotal, addend, &newTotal)) {
+                    _nonDecimalTotal.addLong(longTotal);
+                    newTotal = addend;
+                }
+                longTotal = newTotal;
+                break;
+            }
+            case NumberDouble:
+                _nonDecimalTotal.addDouble(input.getDouble());
+                break;
+            default:
+                continue;  // Non-numeric values are ignored.
+        }
+        _count++;
+    }
+
+    if (longTotal != 0) {
+        _nonDecimalTotal.addLong(longTotal);
+    }
+}
+
 intrusive_ptr<Accumulator> AccumulatorAvg::create(
     const boost::intrusive_ptr<ExpressionContext>& expCtx) {
     return new AccumulatorAvg(expCtx);
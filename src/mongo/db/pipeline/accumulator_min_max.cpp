@@ -62,6 +62,30 @@ void AccumulatorMinMax::processInternal(const Value& input, bool merging) {
     }
 }
 
+void AccumulatorMinMax::processBatchInternal(const std::vector<Value>& inputs,
+                                             const std::vector<size_t>& indices,
+                                             bool merging) {
+    // Track the current winner by pointer, and only copy it into '_val' once the whole batch has
+    // been scanned.
+    const auto& comparator = getExpressionContext()->getValueComparator();
+    const Value* best = _val.missing() ? nullptr : &_val;
+    for (auto index : indices) {
+        const Value& input = inputs[index];
+        // nullish values should have no impact on result
+        if (input.nullish()) {
+            continue;
+        }
+        if (!best || comparator.compare(*best, input) * _sense > 0) {
+            best = &input;
+        }
+    }
+
+    if (best && best != &_val) {
+        _val = *best;
+        _memUsageBytes = sizeof(*this) + _val.getApproximateSize() - sizeof(Value);
+    }
+}
+
 Value AccumulatorMinMax::getValue(bool toBeMerged) {
     if (_val.missing()) {
         return Value(BSONNULL);
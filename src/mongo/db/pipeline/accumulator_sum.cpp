@@ -37,6 +37,7 @@
 #include "mongo/db/exec/document_value/value.h"
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/expression.h"
+#include "mongo/platform/overflow_arithmetic.h"
 #include "mongo/util/summation.h"
 
 namespace mongo {
@@ -85,6 +86,49 @@ void AccumulatorSum::processInternal(const Value& input, bool merging) {
     }
 }
 
+void AccumulatorSum::processBatchInternal(const std::vector<Value>& inputs,
+                                          const std::vector<size_t>& indices,
+                                          bool merging) {
+    if (merging) {
+        Accumulator::processBatchInternal(inputs, indices, merging);
+        return;
+    }
+
+    // Integral inputs are summed exactly in a plain 64-bit register, and only folded into
+    // 'nonDecimalTotal' on overflow and at the end of the batch.
+    long long longTotal = 0;
+    for (auto index : indices) {
+        const Value& input = inputs[index];
+        const BSONType type = input.getType();
+        switch (type) {
+            case NumberInt:
+            case NumberLong: {
+                const long long addend = input.coerceToLong();
+                long long newTotal;
+                if (overflow::add(longTotal, addend, &newTotal)) {
+                    nonDecimalTotal.addLong(longTotal);
+                    newTotal = addend;
+                }
+                longTotal = newTotal;
+                break;
+            }
+            case NumberDouble:
+                nonDecimalTotal.addDouble(input.getDouble());
+                break;
+            case NumberDecimal:
+                decimalTotal = decimalTotal.add(input.coerceToDecimal());
+                break;
+            default:
+                continue;  // Non-numeric values are ignored.
+        }
+        totalType = Value::getWidestNumeric(totalType, type);
+    }
+
+    if (longTotal != 0) {
+        nonDecimalTotal.addLong(longTotal);
+    }
+}
+
 intrusive_ptr<Accumulator> AccumulatorSum::create(
     const boost::intrusive_ptr<ExpressionContext>& expCtx) {
     return new AccumulatorSum(expCtx);
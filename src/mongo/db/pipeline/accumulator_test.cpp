@@ -30,6 +30,7 @@
 #include "mongo/platform/basic.h"
 
 #include <memory>
+#include <numeric>
 
 #include "mongo/db/exec/document_value/document.h"
 #include "mongo/db/exec/document_value/document_value_test_util.h"
@@ -68,6 +69,17 @@ static void assertExpectedResults(
                 ASSERT_EQUALS(op.second.getType(), result.getType());
             }
 
+            // Asserts that result equals expected result when all input is processed as a batch.
+            {
+                boost::intrusive_ptr<Accumulator> accum(factory(expCtx));
+                std::vector<size_t> indices(op.first.size());
+                std::iota(indices.begin(), indices.end(), 0);
+                accum->processBatch(op.first, indices, false);
+                Value result = accum->getValue(false);
+                ASSERT_VALUE_EQ(op.second, result);
+                ASSERT_EQUALS(op.second.getType(), result.getType());
+            }
+
             // Asserts that result equals expected result when all input is on one shard.
             {
                 boost::intrusive_ptr<Accumulator> accum(factory(expCtx));
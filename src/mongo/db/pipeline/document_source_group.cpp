@@ -30,8 +30,11 @@
 #include "mongo/platform/basic.h"
 
 #include <boost/filesystem/operations.hpp>
+#include <boost/functional/hash.hpp>
 #include <memory>
+#include <numeric>
 
+#include "mongo/db/curop.h"
 #include "mongo/db/exec/document_value/document.h"
 #include "mongo/db/exec/document_value/value.h"
 #include "mongo/db/exec/document_value/value_comparator.h"
@@ -42,6 +45,7 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
+#include "mongo/stdx/unordered_map.h"
 #include "mongo/util/destructor_guard.h"
 
 namespace mongo {
@@ -187,13 +191,17 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextSpilled() {
 }
 
 DocumentSource::GetNextResult DocumentSourceGroup::getNextStandard() {
-    // Not spilled, and not streaming.
-    if (_groups->empty())
-        return GetNextResult::makeEOF();
+    // Not spilled, and not streaming. Once the in-memory groups are exhausted, move on to any
+    // partitions that were spilled by partitioned spilling.
+    while (groupsIterator == _groups->end()) {
+        if (_pendingSpilledPartitions.empty())
+            return GetNextResult::makeEOF();
+        loadNextSpilledPartition();
+    }
 
     Document out = makeDocument(groupsIterator->first, groupsIterator->second, pExpCtx->needsMerge);
 
-    if (++groupsIterator == _groups->end())
+    if (++groupsIterator == _groups->end() && _pendingSpilledPartitions.empty())
         dispose();
 
     return std::move(out);
@@ -203,6 +211,7 @@ void DocumentSourceGroup::doDispose() {
     // Free our resources.
     _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
     _sorterIterator.reset();
+    _pendingSpilledPartitions.clear();
 
     // Make us look done.
     groupsIterator = _groups->end();
@@ -254,6 +263,19 @@ Value DocumentSourceGroup::serialize(boost::optional<ExplainOptions::Verbosity>
         insides["$doingMerge"] = Value(true);
     }
 
+    if (explain && canProcessInBatches()) {
+        insides["$vectorized"] = Value(true);
+    }
+
+    if (explain && *explain >= ExplainOptions::Verbosity::kExecStats) {
+        MutableDocument out;
+        out[getSourceName()] = insides.freezeToValue();
+        out["usedDisk"] = Value(_usedDisk);
+        out["spilledPartitions"] = Value(_spilledPartitions);
+        out["spilledBytes"] = Value(_spilledBytes);
+        return out.freezeToValue();
+    }
+
     return Value(DOC(getSourceName() << insides.freeze()));
 }
 
@@ -334,7 +356,9 @@ DocumentSourceGroup::DocumentSourceGroup(const intrusive_ptr<ExpressionContext>&
       _initialized(false),
       _groups(pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>()),
       _spilled(false),
-      _allowDiskUse(pExpCtx->allowDiskUse && !pExpCtx->inMongos) {
+      _allowDiskUse(pExpCtx->allowDiskUse && !pExpCtx->inMongos),
+      _numSpillPartitions(internalDocumentSourceGroupSpillPartitions.load()),
+      _spillPartitionRuns(_numSpillPartitions) {
     if (!pExpCtx->inMongos && (pExpCtx->allowDiskUse || kDebugBuild)) {
         // We spill to disk in debug mode, regardless of allowDiskUse, to stress the system.
         _fileName = pExpCtx->tempDir + "/" + nextFileName();
@@ -467,17 +491,67 @@ private:
 DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     const size_t numAccumulators = _accumulatedFields.size();
 
+    // Barring any pausing, this exhausts 'pSource' and populates '_groups'.
+    GetNextResult input = canProcessInBatches() ? processInputBatches() : processInputDocuments();
+
+    switch (input.getStatus()) {
+        case DocumentSource::GetNextResult::ReturnStatus::kAdvanced: {
+            MONGO_UNREACHABLE;  // We consumed all advances above.
+        }
+        case DocumentSource::GetNextResult::ReturnStatus::kPauseExecution: {
+            return input;  // Propagate pause.
+        }
+        case DocumentSource::GetNextResult::ReturnStatus::kEOF: {
+            // Do any final steps necessary to prepare to output results.
+            if (!_sortedFiles.empty()) {
+                _spilled = true;
+                if (!_groups->empty()) {
+                    _sortedFiles.push_back(spill());
+                }
+
+                // We won't be using groups again so free its memory.
+                _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
+
+                _sorterIterator.reset(Sorter<Value, Value>::Iterator::merge(
+                    _sortedFiles,
+                    _fileName,
+                    SortOptions(),
+                    SorterComparator(pExpCtx->getValueComparator())));
+                _ownsFileDeletion = false;
+
+                // prepare current to accumulate data
+                _currentAccumulators.reserve(numAccumulators);
+                for (auto&& accumulatedField : _accumulatedFields) {
+                    _currentAccumulators.push_back(accumulatedField.makeAccumulator());
+                }
+
+                verify(_sorterIterator->more());  // we put data in, we should get something out.
+                _firstPartOfNextGroup = _sorterIterator->next();
+            } else {
+                if (_numSpillPartitions > 0) {
+                    finishSpillPartitions();
+                }
+
+                // start the group iterator
+                groupsIterator = _groups->begin();
+            }
+
+            // This must happen last so that, unless control gets here, we will re-enter
+            // initialization after getting a GetNextResult::ResultState::kPauseExecution.
+            _initialized = true;
+            return input;
+        }
+    }
+    MONGO_UNREACHABLE;
+}
+
+DocumentSource::GetNextResult DocumentSourceGroup::processInputDocuments() {
+    const size_t numAccumulators = _accumulatedFields.size();
+
     // Barring any pausing, this loop exhausts 'pSource' and populates '_groups'.
     GetNextResult input = pSource->getNext();
     for (; input.isAdvanced(); input = pSource->getNext()) {
-        if (_memoryUsageBytes > _maxMemoryUsageBytes) {
-            uassert(16945,
-                    "Exceeded memory limit for $group, but didn't allow external sort."
-                    " Pass allowDiskUse:true to opt in.",
-                    _allowDiskUse);
-            _sortedFiles.push_back(spill());
-            _memoryUsageBytes = 0;
-        }
+        spillIfOverMemoryLimit();
 
         // We release the result document here so that it does not outlive the end of this loop
         // iteration. Not releasing could lead to an array copy when this group follows an unwind.
@@ -521,59 +595,124 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
             // In debug mode, spill every time we have a duplicate id to stress merge logic.
             if (!inserted &&                 // is a dup
                 !pExpCtx->inMongos &&        // can't spill to disk in mongos
-                !_allowDiskUse &&            // don't change behavior when testing external sort
-                _sortedFiles.size() < 20) {  // don't open too many FDs
+                !_allowDiskUse &&  // don't change behavior when testing external sort
+                _sortedFiles.size() + _spilledPartitions < 20) {  // don't open too many FDs
 
-                _sortedFiles.push_back(spill());
+                spillToDisk();
             }
         }
     }
 
-    switch (input.getStatus()) {
-        case DocumentSource::GetNextResult::ReturnStatus::kAdvanced: {
-            MONGO_UNREACHABLE;  // We consumed all advances above.
-        }
-        case DocumentSource::GetNextResult::ReturnStatus::kPauseExecution: {
-            return input;  // Propagate pause.
+    return input;
+}
+
+DocumentSource::GetNextResult DocumentSourceGroup::processInputBatches() {
+    const size_t batchSize = internalDocumentSourceGroupBatchSize.load();
+    vector<Document> batch;
+    batch.reserve(batchSize);
+
+    GetNextResult input = pSource->getNext();
+    for (; input.isAdvanced(); input = pSource->getNext()) {
+        batch.push_back(input.releaseDocument());
+        if (batch.size() == batchSize) {
+            processBatch(batch);
+            batch.clear();
         }
-        case DocumentSource::GetNextResult::ReturnStatus::kEOF: {
-            // Do any final steps necessary to prepare to output results.
-            if (!_sortedFiles.empty()) {
-                _spilled = true;
-                if (!_groups->empty()) {
-                    _sortedFiles.push_back(spill());
-                }
+    }
 
-                // We won't be using groups again so free its memory.
-                _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
+    // Flush the partial batch, including when 'pSource' paused, so that no input is held across
+    // calls to initialize().
+    if (!batch.empty()) {
+        processBatch(batch);
+    }
+    return input;
+}
 
-                _sorterIterator.reset(Sorter<Value, Value>::Iterator::merge(
-                    _sortedFiles,
-                    _fileName,
-                    SortOptions(),
-                    SorterComparator(pExpCtx->getValueComparator())));
-                _ownsFileDeletion = false;
+void DocumentSourceGroup::processBatch(const std::vector<Document>& batch) {
+    const size_t numAccumulators = _accumulatedFields.size();
+    const size_t numDocuments = batch.size();
+
+    // Evaluate the group key, then each accumulator argument, across the whole batch so that each
+    // expression produces a column of values.
+    vector<Value> ids;
+    ids.reserve(numDocuments);
+    for (auto&& document : batch) {
+        ids.push_back(computeId(document));
+    }
 
-                // prepare current to accumulate data
-                _currentAccumulators.reserve(numAccumulators);
-                for (auto&& accumulatedField : _accumulatedFields) {
-                    _currentAccumulators.push_back(accumulatedField.makeAccumulator());
-                }
+    vector<vector<Value>> inputs(numAccumulators);
+    for (size_t i = 0; i < numAccumulators; i++) {
+        auto& expression = _accumulatedFields[i].expression;
+        inputs[i].reserve(numDocuments);
+        for (auto&& document : batch) {
+            inputs[i].push_back(expression->evaluate(document, &pExpCtx->variables));
+        }
+    }
 
-                verify(_sorterIterator->more());  // we put data in, we should get something out.
-                _firstPartOfNextGroup = _sorterIterator->next();
-            } else {
-                // start the group iterator
-                groupsIterator = _groups->begin();
+    // Bucket the rows of the batch by group, preserving input order within each group. The
+    // pointers into '_groups' stay valid because it is a node-based map.
+    vector<pair<Accumulators*, vector<size_t>>> buckets;
+    stdx::unordered_map<Accumulators*, size_t> bucketIndexes;
+    bool sawDuplicateId = false;
+    for (size_t row = 0; row < numDocuments; row++) {
+        const size_t oldSize = _groups->size();
+        Accumulators& group = (*_groups)[ids[row]];
+        const bool inserted = _groups->size() != oldSize;
+
+        if (inserted) {
+            _memoryUsageBytes += ids[row].getApproximateSize();
+
+            group.reserve(numAccumulators);
+            for (auto&& accumulatedField : _accumulatedFields) {
+                group.push_back(accumulatedField.makeAccumulator());
+                _memoryUsageBytes += group.back()->memUsageForSorter();
             }
+        } else {
+            sawDuplicateId = true;
+        }
 
-            // This must happen last so that, unless control gets here, we will re-enter
-            // initialization after getting a GetNextResult::ResultState::kPauseExecution.
-            _initialized = true;
-            return input;
+        auto bucketIt = bucketIndexes.emplace(&group, buckets.size()).first;
+        if (bucketIt->second == buckets.size()) {
+            buckets.emplace_back(&group, vector<size_t>{});
         }
+        buckets[bucketIt->second].second.push_back(row);
     }
-    MONGO_UNREACHABLE;
+
+    for (auto&& bucket : buckets) {
+        Accumulators& group = *bucket.first;
+        dassert(numAccumulators == group.size());
+
+        for (size_t i = 0; i < numAccumulators; i++) {
+            _memoryUsageBytes -= group[i]->memUsageForSorter();
+            group[i]->processBatch(inputs[i], bucket.second, _doingMerge);
+            _memoryUsageBytes += group[i]->memUsageForSorter();
+        }
+    }
+
+    // The memory limit is checked once the whole batch has been accumulated, since spilling clears
+    // '_groups' and would invalidate the group pointers collected above. This keeps the groups
+    // held in memory between batches within the limit, as they are between documents when not
+    // batching.
+    spillIfOverMemoryLimit();
+
+    if (kDebugBuild && !storageGlobalParams.readOnly) {
+        // In debug mode, spill after every batch with a duplicate id to stress merge logic.
+        if (sawDuplicateId && !pExpCtx->inMongos && !_allowDiskUse &&
+            _sortedFiles.size() + _spilledPartitions < 20) {
+            spillToDisk();
+        }
+    }
+}
+
+bool DocumentSourceGroup::canProcessInBatches() const {
+    if (internalDocumentSourceGroupBatchSize.load() <= 1) {
+        return false;
+    }
+
+    return std::all_of(
+        _accumulatedFields.begin(), _accumulatedFields.end(), [](const auto& accumulatedField) {
+            return accumulatedField.makeAccumulator()->hasBatchImplementation();
+        });
 }
 
 bool DocumentSourceGroup::usedDisk() {
@@ -620,10 +759,212 @@ shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
     _groups->clear();
 
     Sorter<Value, Value>::Iterator* iteratorPtr = writer.done();
+    recordSpill(0, writer.getFileEndOffset() - _nextSortedFileWriterOffset);
     _nextSortedFileWriterOffset = writer.getFileEndOffset();
     return shared_ptr<Sorter<Value, Value>::Iterator>(iteratorPtr);
 }
 
+void DocumentSourceGroup::spillIfOverMemoryLimit() {
+    if (_memoryUsageBytes > _maxMemoryUsageBytes) {
+        uassert(16945,
+                "Exceeded memory limit for $group, but didn't allow external sort."
+                " Pass allowDiskUse:true to opt in.",
+                _allowDiskUse);
+        spillToDisk();
+    }
+}
+
+void DocumentSourceGroup::spillToDisk() {
+    if (_numSpillPartitions > 0) {
+        spillPartitions(choosePartitionsToSpill());
+    } else {
+        _sortedFiles.push_back(spill());
+        _memoryUsageBytes = 0;
+    }
+}
+
+size_t DocumentSourceGroup::partitionForId(const Value& id) const {
+    // Mix in the level so that a partition which is split again does not map all of its groups
+    // back onto a single sub-partition.
+    size_t hash = pExpCtx->getValueComparator().hash(id);
+    boost::hash_combine(hash, _spillPartitionLevel);
+    return hash % _numSpillPartitions;
+}
+
+vector<size_t> DocumentSourceGroup::choosePartitionsToSpill() const {
+    vector<size_t> partitionBytes(_numSpillPartitions, 0);
+    for (auto&& group : *_groups) {
+        size_t& bytes = partitionBytes[partitionForId(group.first)];
+        bytes += group.first.getApproximateSize();
+        for (auto&& accum : group.second) {
+            bytes += accum->memUsageForSorter();
+        }
+    }
+
+    vector<size_t> partitions(_numSpillPartitions);
+    std::iota(partitions.begin(), partitions.end(), 0);
+    std::sort(partitions.begin(), partitions.end(), [&](size_t lhs, size_t rhs) {
+        return partitionBytes[lhs] > partitionBytes[rhs];
+    });
+
+    // Keep the smallest partitions in memory, spilling the largest ones until at least half of the
+    // memory in use has been freed.
+    size_t bytesToSpill = 0;
+    auto end = partitions.begin();
+    while (end != partitions.end() && partitionBytes[*end] > 0 &&
+           bytesToSpill < _memoryUsageBytes / 2) {
+        bytesToSpill += partitionBytes[*end++];
+    }
+    partitions.erase(end, partitions.end());
+    return partitions;
+}
+
+void DocumentSourceGroup::spillPartitions(const vector<size_t>& partitions) {
+    if (partitions.empty()) {
+        return;
+    }
+    _usedDisk = true;
+
+    // Collect the groups to spill in a single pass over '_groups'.
+    vector<int> spillSlot(_numSpillPartitions, -1);
+    for (size_t i = 0; i < partitions.size(); i++) {
+        spillSlot[partitions[i]] = i;
+    }
+    vector<vector<GroupsMap::iterator>> toSpill(partitions.size());
+    for (auto it = _groups->begin(); it != _groups->end(); ++it) {
+        const int slot = spillSlot[partitionForId(it->first)];
+        if (slot >= 0) {
+            toSpill[slot].push_back(it);
+        }
+    }
+
+    const size_t numAccumulators = _accumulatedFields.size();
+    for (size_t i = 0; i < partitions.size(); i++) {
+        if (toSpill[i].empty()) {
+            continue;
+        }
+
+        SortedFileWriter<Value, Value> writer(
+            SortOptions().TempDir(pExpCtx->tempDir), _fileName, _nextSortedFileWriterOffset);
+        for (auto&& it : toSpill[i]) {
+            // The partial state of the accumulators is serialized as in spill().
+            switch (numAccumulators) {
+                case 0:
+                    writer.addAlreadySorted(it->first, Value());
+                    break;
+                case 1:
+                    writer.addAlreadySorted(it->first,
+                                            it->second[0]->getValue(/*toBeMerged=*/true));
+                    break;
+                default: {
+                    vector<Value> accums;
+                    accums.reserve(numAccumulators);
+                    for (auto&& accum : it->second) {
+                        accums.push_back(accum->getValue(/*toBeMerged=*/true));
+                    }
+                    writer.addAlreadySorted(it->first, Value(std::move(accums)));
+                }
+            }
+
+            _memoryUsageBytes -= it->first.getApproximateSize();
+            for (auto&& accum : it->second) {
+                _memoryUsageBytes -= accum->memUsageForSorter();
+            }
+            _groups->erase(it);
+        }
+
+        _spillPartitionRuns[partitions[i]].emplace_back(writer.done());
+        recordSpill(1, writer.getFileEndOffset() - _nextSortedFileWriterOffset);
+        _nextSortedFileWriterOffset = writer.getFileEndOffset();
+    }
+}
+
+void DocumentSourceGroup::recordSpill(long long partitions, long long bytes) {
+    _spilledPartitions += partitions;
+    _spilledBytes += bytes;
+
+    if (pExpCtx->opCtx) {
+        CurOp::get(pExpCtx->opCtx)->debug().additiveMetrics.incrementGroupSpills(partitions, bytes);
+    }
+}
+
+void DocumentSourceGroup::finishSpillPartitions() {
+    vector<size_t> spilledPartitions;
+    for (size_t partition = 0; partition < _numSpillPartitions; partition++) {
+        if (!_spillPartitionRuns[partition].empty()) {
+            spilledPartitions.push_back(partition);
+        }
+    }
+
+    // Groups of a spilled partition may be spread across several runs and '_groups', so they can
+    // only be returned once the partition has been re-aggregated as a whole.
+    spillPartitions(spilledPartitions);
+    for (auto&& partition : spilledPartitions) {
+        _pendingSpilledPartitions.push_back(
+            {std::move(_spillPartitionRuns[partition]), _spillPartitionLevel + 1});
+        _spillPartitionRuns[partition].clear();
+    }
+}
+
+void DocumentSourceGroup::loadNextSpilledPartition() {
+    invariant(!_pendingSpilledPartitions.empty());
+    SpilledPartition partition = std::move(_pendingSpilledPartitions.front());
+    _pendingSpilledPartitions.pop_front();
+
+    _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
+    _memoryUsageBytes = 0;
+    _spillPartitionLevel = partition.level;
+
+    const size_t numAccumulators = _accumulatedFields.size();
+    for (auto&& run : partition.runs) {
+        run->openSource();
+        while (run->more()) {
+            // Past the last level, let the partition exceed the memory limit rather than
+            // repartitioning forever, e.g. when a single group is larger than the limit.
+            if (_memoryUsageBytes > _maxMemoryUsageBytes &&
+                _spillPartitionLevel <= kMaxSpillPartitionLevel) {
+                spillPartitions(choosePartitionsToSpill());
+            }
+
+            auto next = run->next();
+            const size_t oldSize = _groups->size();
+            Accumulators& group = (*_groups)[next.first];
+            if (_groups->size() != oldSize) {
+                _memoryUsageBytes += next.first.getApproximateSize();
+                group.reserve(numAccumulators);
+                for (auto&& accumulatedField : _accumulatedFields) {
+                    group.push_back(accumulatedField.makeAccumulator());
+                }
+            } else {
+                for (auto&& accum : group) {
+                    _memoryUsageBytes -= accum->memUsageForSorter();
+                }
+            }
+
+            switch (numAccumulators) {  // mirrors switch in spillPartitions()
+                case 1:
+                    group[0]->process(next.second, true);
+                case 0:
+                    break;
+                default: {
+                    const vector<Value>& accumulatorStates = next.second.getArray();
+                    for (size_t i = 0; i < numAccumulators; i++) {
+                        group[i]->process(accumulatorStates[i], true);
+                    }
+                }
+            }
+
+            for (auto&& accum : group) {
+                _memoryUsageBytes += accum->memUsageForSorter();
+            }
+        }
+        run->closeSource();
+    }
+
+    finishSpillPartitions();
+    groupsIterator = _groups->begin();
+}
+
 Value DocumentSourceGroup::computeId(const Document& root) {
     // If only one expression, return result directly
     if (_idExpressions.size() == 1) {
@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
 #include <utility>
 
@@ -160,6 +161,20 @@ public:
      */
     bool usedDisk() final;
 
+    /**
+     * Returns the number of runs this stage has spilled to disk when using partitioned spilling.
+     */
+    long long getSpilledPartitions() const {
+        return _spilledPartitions;
+    }
+
+    /**
+     * Returns the number of bytes this stage has written to disk when spilling.
+     */
+    long long getSpilledBytes() const {
+        return _spilledBytes;
+    }
+
     boost::optional<DistributedPlanLogic> distributedPlanLogic() final;
     bool canRunInParallelBeforeWriteStage(
         const std::set<std::string>& nameOfShardKeyFieldsUponEntryToStage) const final;
@@ -206,6 +221,28 @@ private:
      */
     GetNextResult initialize();
 
+    /**
+     * Helpers for initialize() which consume input from 'pSource' until it is exhausted or pauses,
+     * returning the last GetNextResult encountered. processInputDocuments() accumulates one
+     * document at a time, while processInputBatches() buffers documents into batches of
+     * 'internalDocumentSourceGroupBatchSize' and hands them to processBatch().
+     */
+    GetNextResult processInputDocuments();
+    GetNextResult processInputBatches();
+
+    /**
+     * Accumulates a batch of input documents. The group key and each accumulator argument are
+     * evaluated across the whole batch first, and then every group touched by the batch receives
+     * all of its inputs through a single call to Accumulator::processBatch().
+     */
+    void processBatch(const std::vector<Document>& batch);
+
+    /**
+     * Returns true if this $group will process its input in batches, which requires that every
+     * accumulator has a specialized batch implementation.
+     */
+    bool canProcessInBatches() const;
+
     /**
      * Spill groups map to disk and returns an iterator to the file. Note: Since a sorted $group
      * does not exhaust the previous stage before returning, and thus does not maintain as large a
@@ -213,6 +250,70 @@ private:
      */
     std::shared_ptr<Sorter<Value, Value>::Iterator> spill();
 
+    /**
+     * Frees memory when '_memoryUsageBytes' exceeds the limit, either by sorting all of '_groups'
+     * into a new file with spill(), or, when partitioned spilling is enabled, with
+     * spillPartitions().
+     */
+    void spillToDisk();
+
+    /**
+     * Spills to disk if '_memoryUsageBytes' exceeds the limit. Throws if the limit is exceeded and
+     * spilling isn't allowed.
+     */
+    void spillIfOverMemoryLimit();
+
+    /**
+     * Partitioned ("grace hash") spilling, used when '_numSpillPartitions' is non-zero. Each group
+     * belongs to a partition determined by the hash of its _id. Under memory pressure the largest
+     * partitions have their groups written out as an unsorted run of (id, partial state) pairs,
+     * while the other partitions stay in memory. Once the input is exhausted the in-memory groups
+     * are returned first, and then each spilled partition is re-aggregated in memory one at a time
+     * by loadNextSpilledPartition(). A spilled partition which still does not fit in memory is
+     * partitioned again, using a different hash function, up to kMaxSpillPartitionLevel times.
+     */
+    struct SpilledPartition {
+        std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>> runs;
+
+        // The level at which groups of this partition are partitioned when it is re-aggregated.
+        int level;
+    };
+
+    static constexpr int kMaxSpillPartitionLevel = 3;
+
+    size_t partitionForId(const Value& id) const;
+
+    /**
+     * Returns the partitions to spill in order to free at least half of '_memoryUsageBytes',
+     * largest first.
+     */
+    std::vector<size_t> choosePartitionsToSpill() const;
+
+    /**
+     * Writes the in-memory groups of each partition in 'partitions' to disk as a new run, and
+     * removes them from '_groups'.
+     */
+    void spillPartitions(const std::vector<size_t>& partitions);
+
+    /**
+     * Called once all input for the current level has been consumed. Spills the remaining
+     * in-memory groups of every partition that has already spilled, and queues those partitions
+     * to be re-aggregated.
+     */
+    void finishSpillPartitions();
+
+    /**
+     * Replaces '_groups' with the re-aggregated contents of the next queued spilled partition.
+     */
+    void loadNextSpilledPartition();
+
+    /**
+     * Counts 'partitions' more spilled partitions and 'bytes' more spilled bytes, both in this
+     * stage and in the CurOp of the operation running it, so that $currentOp sees them as the
+     * spills happen.
+     */
+    void recordSpill(long long partitions, long long bytes);
+
     Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
 
     /**
@@ -265,6 +366,22 @@ private:
     const bool _allowDiskUse;
 
     std::pair<Value, Value> _firstPartOfNextGroup;
+
+    // The number of partitions used for partitioned spilling, or 0 if spilling sorts '_groups'.
+    const size_t _numSpillPartitions;
+
+    // The partitioning level of the groups currently in '_groups'.
+    int _spillPartitionLevel = 0;
+
+    // For each partition at '_spillPartitionLevel', the runs spilled so far. A partition is
+    // considered spilled once it has at least one run.
+    std::vector<std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>>> _spillPartitionRuns;
+
+    // Spilled partitions which still need to be re-aggregated and returned.
+    std::deque<SpilledPartition> _pendingSpilledPartitions;
+
+    long long _spilledPartitions = 0;
+    long long _spilledBytes = 0;
 };
 
 }  // namespace mongo
@@ -40,6 +40,7 @@
 #include "mongo/bson/bsonmisc.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/json.h"
+#include "mongo/db/curop.h"
 #include "mongo/db/exec/document_value/document_value_test_util.h"
 #include "mongo/db/exec/document_value/value_comparator.h"
 #include "mongo/db/pipeline/aggregation_context_fixture.h"
@@ -54,6 +55,7 @@
 #include "mongo/stdx/unordered_set.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -231,6 +233,150 @@ TEST_F(DocumentSourceGroupTest, ShouldNotReportDottedGroupKeyAsARename) {
     ASSERT_EQ(modifiedPathsRet.renames.size(), 0UL);
 }
 
+TEST_F(DocumentSourceGroupTest, BatchedExecutionShouldProduceSameResultsAsUnbatched) {
+    auto expCtx = getExpCtx();
+    expCtx->inMongos = true;  // Disallow spilling, which debug builds do on duplicate ids.
+    const int originalBatchSize = internalDocumentSourceGroupBatchSize.load();
+    ON_BLOCK_EXIT([&] { internalDocumentSourceGroupBatchSize.store(originalBatchSize); });
+
+    auto spec = fromjson(
+        "{$group: {_id: '$k', sum: {$sum: '$v'}, avg: {$avg: '$v'}, min: {$min: '$v'}, "
+        "max: {$max: '$v'}}}");
+    auto runGroup = [&](int batchSize) {
+        internalDocumentSourceGroupBatchSize.store(batchSize);
+        auto group = DocumentSourceGroup::createFromBson(spec.firstElement(), expCtx);
+        auto mock = DocumentSourceMock::createForTest(
+            {Document{{"k", 1}, {"v", 3}},
+             Document{{"k", 2}, {"v", 2.5}},
+             DocumentSource::GetNextResult::makePauseExecution(),
+             Document{{"k", 1}, {"v", 4LL}},
+             Document{{"k", 2}, {"v", BSONNULL}},
+             Document{{"k", 1}, {"v", -10}},
+             Document{{"k", 3}}});
+        group->setSource(mock.get());
+
+        ASSERT_TRUE(group->getNext().isPaused());
+        std::map<int, Document> results;
+        for (auto next = group->getNext(); next.isAdvanced(); next = group->getNext()) {
+            auto doc = next.releaseDocument();
+            results[doc["_id"].coerceToInt()] = doc;
+        }
+        return results;
+    };
+
+    auto unbatched = runGroup(0);
+    auto batched = runGroup(2);
+    ASSERT_EQ(unbatched.size(), 3UL);
+    ASSERT_EQ(batched.size(), 3UL);
+    for (auto&& result : unbatched) {
+        ASSERT_DOCUMENT_EQ(result.second, batched[result.first]);
+    }
+    ASSERT_DOCUMENT_EQ(
+        batched[1],
+        (Document{{"_id", 1}, {"sum", -3LL}, {"avg", -1.0}, {"min", -10}, {"max", 4LL}}));
+}
+
+TEST_F(DocumentSourceGroupTest, BatchedExecutionShouldCheckMemoryLimitAfterEachBatch) {
+    auto expCtx = getExpCtx();
+    const size_t maxMemoryUsageBytes = 1000;
+    expCtx->inMongos = true;  // Disallow external sort.
+                              // This is the only way to do this in a debug build.
+    const int originalBatchSize = internalDocumentSourceGroupBatchSize.load();
+    ON_BLOCK_EXIT([&] { internalDocumentSourceGroupBatchSize.store(originalBatchSize); });
+    internalDocumentSourceGroupBatchSize.store(10);
+
+    VariablesParseState vps = expCtx->variablesParseState;
+    auto sumStatement = AccumulationStatement::parseAccumulationStatement(
+        expCtx, BSON("sum" << BSON("$sum" << 1)).firstElement(), vps);
+    auto group = DocumentSourceGroup::create(
+        expCtx, ExpressionFieldPath::parse(expCtx, "$k", vps), {sumStatement}, maxMemoryUsageBytes);
+
+    // All of the input fits in a single batch, but its groups don't fit in memory.
+    string largeStr(maxMemoryUsageBytes / 2, 'x');
+    auto mock = DocumentSourceMock::createForTest({Document{{"k", largeStr + "0"}},
+                                                   Document{{"k", largeStr + "1"}},
+                                                   Document{{"k", largeStr + "2"}}});
+    group->setSource(mock.get());
+
+    ASSERT_THROWS_CODE(group->getNext(), AssertionException, 16945);
+}
+
+TEST_F(DocumentSourceGroupTest, ShouldReportVectorizedInExplainOnlyIfAllAccumulatorsSupportIt) {
+    auto expCtx = getExpCtx();
+    auto explainGroup = [&](const char* json) {
+        auto spec = fromjson(json);
+        auto group = DocumentSourceGroup::createFromBson(spec.firstElement(), expCtx);
+        vector<Value> explained;
+        group->serializeToArray(explained, ExplainOptions::Verbosity::kQueryPlanner);
+        ASSERT_EQ(explained.size(), 1UL);
+        return explained[0].getDocument();
+    };
+
+    auto vectorized = explainGroup("{$group: {_id: '$a', total: {$sum: '$b'}}}");
+    ASSERT_VALUE_EQ(vectorized["$group"]["$vectorized"], Value(true));
+
+    auto notVectorized =
+        explainGroup("{$group: {_id: '$a', total: {$sum: '$b'}, all: {$push: '$b'}}}");
+    ASSERT_TRUE(notVectorized["$group"]["$vectorized"].missing());
+}
+
+TEST_F(DocumentSourceGroupTest, ShouldReaggregateSpilledPartitionsWhenPartitionedSpilling) {
+    auto expCtx = getExpCtx();
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+    const int originalSpillPartitions = internalDocumentSourceGroupSpillPartitions.load();
+    ON_BLOCK_EXIT(
+        [&] { internalDocumentSourceGroupSpillPartitions.store(originalSpillPartitions); });
+    const int originalBatchSize = internalDocumentSourceGroupBatchSize.load();
+    ON_BLOCK_EXIT([&] { internalDocumentSourceGroupBatchSize.store(originalBatchSize); });
+    internalDocumentSourceGroupSpillPartitions.store(4);
+
+    // The smaller limit forces spilled partitions to be partitioned again when re-aggregated.
+    for (auto [batchSize, maxMemoryUsageBytes] :
+         std::vector<std::pair<int, size_t>>{{0, 1000}, {0, 100}, {10, 1000}, {10, 100}}) {
+        internalDocumentSourceGroupBatchSize.store(batchSize);
+        VariablesParseState vps = expCtx->variablesParseState;
+        auto sumStatement = AccumulationStatement::parseAccumulationStatement(
+            expCtx, BSON("sum" << BSON("$sum"
+                                       << "$v"))
+                        .firstElement(),
+            vps);
+        auto group = DocumentSourceGroup::create(expCtx,
+                                                 ExpressionFieldPath::parse(expCtx, "$k", vps),
+                                                 {sumStatement},
+                                                 maxMemoryUsageBytes);
+
+        deque<DocumentSource::GetNextResult> inputs;
+        for (int i = 0; i < 100; ++i) {
+            inputs.emplace_back(Document{{"k", i % 20}, {"v", i}});
+        }
+        auto mock = DocumentSourceMock::createForTest(inputs);
+        group->setSource(mock.get());
+
+        // The spills are counted in the CurOp of the operation as they happen.
+        auto& metrics = CurOp::get(expCtx->opCtx)->debug().additiveMetrics;
+        metrics.reset();
+
+        map<int, int> sums;
+        for (auto next = group->getNext(); next.isAdvanced(); next = group->getNext()) {
+            auto doc = next.releaseDocument();
+            ASSERT_EQ(sums.count(doc["_id"].coerceToInt()), 0UL);
+            sums[doc["_id"].coerceToInt()] = doc["sum"].coerceToInt();
+        }
+
+        ASSERT_TRUE(group->usedDisk());
+        ASSERT_GT(group->getSpilledPartitions(), 0LL);
+        ASSERT_GT(group->getSpilledBytes(), 0LL);
+        ASSERT_EQ(metrics.groupSpilledPartitions.load(), group->getSpilledPartitions());
+        ASSERT_EQ(metrics.groupSpilledBytes.load(), group->getSpilledBytes());
+        ASSERT_EQ(sums.size(), 20UL);
+        for (int k = 0; k < 20; ++k) {
+            ASSERT_EQ(sums[k], 5 * k + 200);
+        }
+    }
+}
+
 BSONObj toBson(const intrusive_ptr<DocumentSource>& source) {
     vector<Value> arr;
     source->serializeToArray(arr);
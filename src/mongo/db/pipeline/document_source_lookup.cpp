@@ -31,17 +31,23 @@
 
 #include "mongo/db/pipeline/document_source_lookup.h"
 
+#include <algorithm>
+#include <functional>
 #include <memory>
 
 #include "mongo/base/init.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/db/exec/document_value/document.h"
 #include "mongo/db/exec/document_value/value.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/index_names.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression_algo.h"
 #include "mongo/db/pipeline/document_path_support.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/util/str.h"
 
 namespace mongo {
 
@@ -232,9 +238,51 @@ BSONObj buildEqualityOrQuery(const std::string& fieldName, const BSONArray& valu
     return orBuilder.obj();
 }
 
+/**
+ * Invokes 'callback' on each value which an equality predicate on 'path' can match within 'doc':
+ * the value at the end of the path, each element of that value if it is an array, and the same for
+ * any subdocuments reached by traversing arrays along the way. 'path' must not contain positional
+ * components. Nothing is visited if the path is missing.
+ */
+void visitForeignJoinKeys(const Document& doc,
+                          const FieldPath& path,
+                          size_t fieldPathIndex,
+                          const std::function<void(const Value&)>& callback) {
+    auto value = doc.getField(path.getFieldName(fieldPathIndex));
+    ++fieldPathIndex;
+
+    if (fieldPathIndex == path.getPathLength()) {
+        if (value.missing()) {
+            return;
+        }
+        callback(value);
+        if (value.isArray()) {
+            for (auto&& elem : value.getArray()) {
+                callback(elem);
+            }
+        }
+        return;
+    }
+
+    if (value.isArray()) {
+        // As in the query system, arrays directly nested within arrays are not traversed.
+        for (auto&& elem : value.getArray()) {
+            if (elem.getType() == BSONType::Object) {
+                visitForeignJoinKeys(elem.getDocument(), path, fieldPathIndex, callback);
+            }
+        }
+    } else if (value.getType() == BSONType::Object) {
+        visitForeignJoinKeys(value.getDocument(), path, fieldPathIndex, callback);
+    }
+}
+
 }  // namespace
 
 DocumentSource::GetNextResult DocumentSourceLookUp::doGetNext() {
+    if (!_joinStrategy) {
+        chooseJoinStrategy();
+    }
+
     if (_unwindSrc) {
         return unwindResult();
     }
@@ -250,36 +298,201 @@ DocumentSource::GetNextResult DocumentSourceLookUp::doGetNext() {
     // '_unwindSrc' would be non-null, and we would not have made it here.
     invariant(!_matchSrc);
 
-    if (!wasConstructedWithPipelineSyntax()) {
-        auto matchStage =
-            makeMatchStageFromInput(inputDoc, *_localField, _foreignField->fullPath(), BSONObj());
-        // We've already allocated space for the trailing $match stage in '_resolvedPipeline'.
-        _resolvedPipeline.back() = matchStage;
-    }
-
-    auto pipeline = buildPipeline(inputDoc);
-
     std::vector<Value> results;
     int objsize = 0;
     const auto maxBytes = internalLookupStageIntermediateDocumentMaxSizeBytes.load();
-    while (auto result = pipeline->getNext()) {
-        objsize += result->getApproximateSize();
+    auto appendResult = [&](Document&& result) {
+        objsize += result.getApproximateSize();
         uassert(4568,
                 str::stream() << "Total size of documents in " << _fromNs.coll()
                               << " matching pipeline's $lookup stage exceeds " << maxBytes
                               << " bytes",
 
                 objsize <= maxBytes);
-        results.emplace_back(std::move(*result));
+        results.emplace_back(std::move(result));
+    };
+
+    if (auto matches = probeHashTable(inputDoc)) {
+        for (auto&& match : *matches) {
+            appendResult(std::move(match));
+        }
+    } else {
+        if (!wasConstructedWithPipelineSyntax()) {
+            auto matchStage = makeMatchStageFromInput(
+                inputDoc, *_localField, _foreignField->fullPath(), BSONObj());
+            // We've already allocated space for the trailing $match stage in '_resolvedPipeline'.
+            _resolvedPipeline.back() = matchStage;
+        }
+
+        auto pipeline = buildPipeline(inputDoc);
+
+        while (auto result = pipeline->getNext()) {
+            appendResult(std::move(*result));
+        }
+        for (auto&& source : pipeline->getSources()) {
+            if (source->usedDisk())
+                _usedDisk = true;
+        }
+    }
+
+    MutableDocument output(std::move(inputDoc));
+    output.setNestedField(_as, Value(std::move(results)));
+    return output.freeze();
+}
+
+void DocumentSourceLookUp::chooseJoinStrategy() {
+    invariant(!_joinStrategy);
+    _joinStrategy = JoinStrategy::kNestedLoop;
+
+    if (wasConstructedWithPipelineSyntax() || internalLookupHashJoinMaxMemoryBytes.load() == 0 ||
+        pExpCtx->inMongos) {
+        return;
+    }
+
+    // Positional path components select array elements by index, which the hash table does not
+    // model.
+    for (size_t i = 0; i < _foreignField->getPathLength(); ++i) {
+        if (str::parseUnsignedBase10Integer(_foreignField->getFieldName(i))) {
+            return;
+        }
+    }
+
+    // A sharded foreign collection cannot be scanned from here, and an index on the foreign field
+    // already makes each per-document query cheap. A foreign collection too large for the table is
+    // not scanned at all, rather than scanned until the table runs out of memory; its absorbed
+    // filter might have rejected enough of it, but that scan would be wasted if not.
+    if (pExpCtx->mongoProcessInterface->isSharded(pExpCtx->opCtx, _fromNs) ||
+        foreignFieldHasSupportingIndex() || !foreignCollectionMayFitInHashTable()) {
+        return;
     }
+
+    if (buildHashTable()) {
+        _joinStrategy = JoinStrategy::kHash;
+    }
+}
+
+bool DocumentSourceLookUp::foreignFieldHasSupportingIndex() const {
+    const auto foreignField = _foreignField->fullPath();
+    const auto* collator = _fromExpCtx->getCollator();
+    const BSONObj collation = collator ? collator->getSpec().toBSON() : BSONObj();
+    for (auto&& indexSpec :
+         pExpCtx->mongoProcessInterface->getIndexSpecs(pExpCtx->opCtx, _resolvedNs)) {
+        const auto keyPattern = indexSpec[IndexDescriptor::kKeyPatternFieldName].Obj();
+        if (keyPattern.firstElementFieldNameStringData() != foreignField ||
+            IndexNames::findPluginName(keyPattern) != IndexNames::BTREE ||
+            indexSpec[IndexDescriptor::kSparseFieldName].trueValue() ||
+            indexSpec.hasField(IndexDescriptor::kPartialFilterExprFieldName)) {
+            continue;
+        }
+
+        const auto indexCollation = indexSpec[IndexDescriptor::kCollationFieldName];
+        if (SimpleBSONObjComparator::kInstance.evaluate(
+                (indexCollation.isABSONObj() ? indexCollation.Obj() : BSONObj()) == collation)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DocumentSourceLookUp::foreignCollectionMayFitInHashTable() const {
+    BSONObjBuilder storageStats;
+    auto status = pExpCtx->mongoProcessInterface->appendStorageStats(
+        pExpCtx->opCtx, _resolvedNs, BSONObj(), &storageStats);
+    if (status == ErrorCodes::NamespaceNotFound) {
+        return true;
+    }
+    if (!status.isOK()) {
+        return false;
+    }
+    return storageStats.obj()["size"].safeNumberLong() <=
+        internalLookupHashJoinMaxMemoryBytes.load();
+}
+
+bool DocumentSourceLookUp::buildHashTable() {
+    // Scan the foreign side once, applying only the filter absorbed from a subsequent $match. The
+    // join predicate itself is evaluated by probing the table.
+    auto buildPipelineSpec = _resolvedPipeline;
+    buildPipelineSpec.back() = BSON("$match" << _additionalFilter.value_or(BSONObj()));
+
+    copyVariablesToExpCtx(_variables, _variablesParseState, _fromExpCtx.get());
+    auto pipeline = pExpCtx->mongoProcessInterface->makePipeline(buildPipelineSpec, _fromExpCtx);
+
+    const auto maxMemoryBytes = internalLookupHashJoinMaxMemoryBytes.load();
+    auto table = _fromExpCtx->getValueComparator().makeUnorderedValueMap<std::vector<size_t>>();
+    std::vector<Document> buildSide;
+    long long memoryUsageBytes = 0;
+    while (auto next = pipeline->getNext()) {
+        const size_t position = buildSide.size();
+        memoryUsageBytes += next->getApproximateSize();
+        visitForeignJoinKeys(*next, *_foreignField, 0, [&](const Value& key) {
+            auto inserted = table.emplace(key, std::vector<size_t>{});
+            auto& positions = inserted.first->second;
+            if (inserted.second) {
+                memoryUsageBytes += key.getApproximateSize() + sizeof(positions);
+            }
+            // All keys of one document are visited together, so a repeated key can only be a
+            // duplicate if it was last added for this same document.
+            if (positions.empty() || positions.back() != position) {
+                positions.push_back(position);
+                memoryUsageBytes += sizeof(size_t);
+            }
+        });
+
+        if (memoryUsageBytes > maxMemoryBytes) {
+            return false;
+        }
+        buildSide.push_back(std::move(*next));
+    }
+
     for (auto&& source : pipeline->getSources()) {
         if (source->usedDisk())
             _usedDisk = true;
     }
 
-    MutableDocument output(std::move(inputDoc));
-    output.setNestedField(_as, Value(std::move(results)));
-    return output.freeze();
+    _hashJoinBuildSide = std::move(buildSide);
+    _hashJoinTable.emplace(std::move(table));
+    return true;
+}
+
+boost::optional<std::vector<Document>> DocumentSourceLookUp::probeHashTable(
+    const Document& input) const {
+    if (_joinStrategy != JoinStrategy::kHash) {
+        return boost::none;
+    }
+
+    // Gather the positions of all foreign documents matching any of the local values. A missing
+    // local value is treated as null, and an equality to null also matches foreign documents in
+    // which the path is missing, so such inputs are left to the nested loop strategy.
+    std::vector<size_t> positions;
+    bool hasLocalValue = false;
+    bool hasNullishLocalValue = false;
+    document_path_support::visitAllValuesAtPath(input, *_localField, [&](const Value& localValue) {
+        hasLocalValue = true;
+        if (localValue.nullish()) {
+            hasNullishLocalValue = true;
+            return;
+        }
+        auto it = _hashJoinTable->find(localValue);
+        if (it != _hashJoinTable->end()) {
+            positions.insert(positions.end(), it->second.begin(), it->second.end());
+        }
+    });
+
+    if (!hasLocalValue || hasNullishLocalValue) {
+        return boost::none;
+    }
+
+    // Return each matching foreign document once, in the order in which the foreign side produced
+    // it.
+    std::sort(positions.begin(), positions.end());
+    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+
+    std::vector<Document> matches;
+    matches.reserve(positions.size());
+    for (auto position : positions) {
+        matches.push_back(_hashJoinBuildSide[position]);
+    }
+    return matches;
 }
 
 std::unique_ptr<Pipeline, PipelineDeleter> DocumentSourceLookUp::buildPipeline(
@@ -469,6 +682,9 @@ void DocumentSourceLookUp::doDispose() {
         _pipeline->dispose(pExpCtx->opCtx);
         _pipeline.reset();
     }
+    _hashJoinTable.reset();
+    _hashJoinBuildSide.clear();
+    _hashJoinMatches.reset();
 }
 
 BSONObj DocumentSourceLookUp::makeMatchStageFromInput(const Document& input,
@@ -561,7 +777,17 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
     // Loop until we get a document that has at least one match.
     // Note we may return early from this loop if our source stage is exhausted or if the unwind
     // source was asked to return empty arrays and we get a document without a match.
-    while (!_pipeline || !_nextValue) {
+    auto nextMatch = [this]() -> boost::optional<Document> {
+        if (_hashJoinMatches) {
+            if (_hashJoinMatchesPos == _hashJoinMatches->size()) {
+                return boost::none;
+            }
+            return std::move((*_hashJoinMatches)[_hashJoinMatchesPos++]);
+        }
+        return _pipeline->getNext();
+    };
+
+    while ((!_pipeline && !_hashJoinMatches) || !_nextValue) {
         auto nextInput = pSource->getNext();
         if (!nextInput.isAdvanced()) {
             return nextInput;
@@ -569,28 +795,34 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
 
         _input = nextInput.releaseDocument();
 
-        if (!wasConstructedWithPipelineSyntax()) {
-            BSONObj filter = _additionalFilter.value_or(BSONObj());
-            auto matchStage =
-                makeMatchStageFromInput(*_input, *_localField, _foreignField->fullPath(), filter);
-            // We've already allocated space for the trailing $match stage in '_resolvedPipeline'.
-            _resolvedPipeline.back() = matchStage;
-        }
+        _hashJoinMatches = probeHashTable(*_input);
+        _hashJoinMatchesPos = 0;
+
+        if (!_hashJoinMatches) {
+            if (!wasConstructedWithPipelineSyntax()) {
+                BSONObj filter = _additionalFilter.value_or(BSONObj());
+                auto matchStage = makeMatchStageFromInput(
+                    *_input, *_localField, _foreignField->fullPath(), filter);
+                // We've already allocated space for the trailing $match stage in
+                // '_resolvedPipeline'.
+                _resolvedPipeline.back() = matchStage;
+            }
 
-        if (_pipeline) {
-            _usedDisk = _usedDisk || _pipeline->usedDisk();
-            _pipeline->dispose(pExpCtx->opCtx);
-        }
+            if (_pipeline) {
+                _usedDisk = _usedDisk || _pipeline->usedDisk();
+                _pipeline->dispose(pExpCtx->opCtx);
+            }
 
-        _pipeline = buildPipeline(*_input);
+            _pipeline = buildPipeline(*_input);
 
-        // The $lookup stage takes responsibility for disposing of its Pipeline, since it will
-        // potentially be used by multiple OperationContexts, and the $lookup stage is part of an
-        // outer Pipeline that will propagate dispose() calls before being destroyed.
-        _pipeline.get_deleter().dismissDisposal();
+            // The $lookup stage takes responsibility for disposing of its Pipeline, since it will
+            // potentially be used by multiple OperationContexts, and the $lookup stage is part of
+            // an outer Pipeline that will propagate dispose() calls before being destroyed.
+            _pipeline.get_deleter().dismissDisposal();
+        }
 
         _cursorIndex = 0;
-        _nextValue = _pipeline->getNext();
+        _nextValue = nextMatch();
 
         if (_unwindSrc->preserveNullAndEmptyArrays() && !_nextValue) {
             // There were no results for this cursor, but the $unwind was asked to preserve empty
@@ -608,7 +840,7 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
 
     invariant(bool(_input) && bool(_nextValue));
     auto currentValue = *_nextValue;
-    _nextValue = _pipeline->getNext();
+    _nextValue = nextMatch();
 
     // Move input document into output if this is the last or only result, otherwise perform a copy.
     MutableDocument output(_nextValue ? *_input : std::move(*_input));
@@ -695,6 +927,11 @@ void DocumentSourceLookUp::serializeToArray(
                           << (indexPath ? Value(indexPath->fullPath()) : Value())));
         }
 
+        if (!wasConstructedWithPipelineSyntax() && _joinStrategy) {
+            output[getSourceName()]["strategy"] =
+                Value(*_joinStrategy == JoinStrategy::kHash ? "HashJoin"_sd : "NestedLoopJoin"_sd);
+        }
+
         // Only add _matchSrc for explain when $lookup was constructed with localField/foreignField
         // syntax. For pipeline sytax, _matchSrc will be included as part of the pipeline
         // definition.
@@ -268,6 +268,41 @@ private:
 
     GetNextResult unwindResult();
 
+    /**
+     * Decides whether this $lookup probes an in-memory hash table built from a single scan of the
+     * foreign collection, or queries the foreign collection once for each input document. Called
+     * once, on the first call to getNext().
+     */
+    void chooseJoinStrategy();
+
+    /**
+     * Returns true if the foreign collection has an index whose leading field is 'foreignField', in
+     * which case the per-document queries of the nested loop strategy are cheap. Only an ascending
+     * or descending index which is neither sparse nor partial, and whose collation is that of the
+     * join, holds keys for every document the queries must find.
+     */
+    bool foreignFieldHasSupportingIndex() const;
+
+    /**
+     * Returns false if the data size of the foreign collection alone exceeds
+     * 'internalLookupHashJoinMaxMemoryBytes', so that a hash table of its documents cannot fit.
+     */
+    bool foreignCollectionMayFitInHashTable() const;
+
+    /**
+     * Scans the foreign side once and indexes each document by the values at 'foreignField'.
+     * Returns false, discarding any partially built table, if the foreign side does not fit within
+     * 'internalLookupHashJoinMaxMemoryBytes'.
+     */
+    bool buildHashTable();
+
+    /**
+     * Returns the foreign documents which join with 'input', in the order they were scanned.
+     * Returns boost::none if the hash join strategy is not in use, or if 'input' joins on a null or
+     * missing value, whose query semantics must be provided by the nested loop strategy.
+     */
+    boost::optional<std::vector<Document>> probeHashTable(const Document& input) const;
+
     /**
      * Copies 'vars' and 'vps' to the Variables and VariablesParseState objects in 'expCtx'. These
      * copies provide access to 'let' defined variables in sub-pipeline execution.
@@ -344,9 +379,23 @@ private:
     boost::intrusive_ptr<DocumentSourceMatch> _matchSrc;
     boost::intrusive_ptr<DocumentSourceUnwind> _unwindSrc;
 
+    // How a $lookup with localField/foreignField syntax executes its join. Chosen on the first call
+    // to getNext(); a $lookup with pipeline syntax always uses the nested loop strategy.
+    enum class JoinStrategy { kNestedLoop, kHash };
+    boost::optional<JoinStrategy> _joinStrategy;
+
+    // When using the hash join strategy, holds every document produced by the foreign side, and a
+    // table mapping each value found at 'foreignField' to the positions of the documents which
+    // contain it.
+    std::vector<Document> _hashJoinBuildSide;
+    boost::optional<ValueUnorderedMap<std::vector<size_t>>> _hashJoinTable;
+
     // The following members are used to hold onto state across getNext() calls when '_unwindSrc' is
-    // not null.
+    // not null. When the current input document was joined by probing the hash table, its matches
+    // are held in '_hashJoinMatches' instead of being produced by '_pipeline'.
     long long _cursorIndex = 0;
+    boost::optional<std::vector<Document>> _hashJoinMatches;
+    size_t _hashJoinMatchesPos = 0;
     std::unique_ptr<Pipeline, PipelineDeleter> _pipeline;
     boost::optional<Document> _input;
     boost::optional<Document> _nextValue;
@@ -48,6 +48,7 @@
 #include "mongo/db/repl/replication_coordinator_mock.h"
 #include "mongo/db/repl/storage_interface_mock.h"
 #include "mongo/db/server_options.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -488,14 +489,34 @@ TEST(MakeMatchStageFromInput, ArrayValueWithRegexUsesOrQuery) {
 class MockMongoInterface final : public StubMongoProcessInterface {
 public:
     MockMongoInterface(deque<DocumentSource::GetNextResult> mockResults,
-                       bool removeLeadingQueryStages = false)
+                       bool removeLeadingQueryStages = false,
+                       std::vector<BSONObj> indexSpecs = {})
         : _mockResults(std::move(mockResults)),
-          _removeLeadingQueryStages(removeLeadingQueryStages) {}
+          _removeLeadingQueryStages(removeLeadingQueryStages),
+          _indexSpecs(std::move(indexSpecs)) {}
 
     bool isSharded(OperationContext* opCtx, const NamespaceString& ns) final {
         return false;
     }
 
+    std::vector<BSONObj> getIndexSpecs(OperationContext* opCtx, const NamespaceString& ns) final {
+        return _indexSpecs;
+    }
+
+    Status appendStorageStats(OperationContext* opCtx,
+                              const NamespaceString& nss,
+                              const BSONObj& param,
+                              BSONObjBuilder* builder) const final {
+        long long size = 0;
+        for (auto&& result : _mockResults) {
+            if (result.isAdvanced()) {
+                size += result.getDocument().toBson().objsize();
+            }
+        }
+        builder->appendNumber("size", size);
+        return Status::OK();
+    }
+
     std::unique_ptr<Pipeline, PipelineDeleter> makePipeline(
         const std::vector<BSONObj>& rawPipeline,
         const boost::intrusive_ptr<ExpressionContext>& expCtx,
@@ -533,6 +554,7 @@ public:
 private:
     deque<DocumentSource::GetNextResult> _mockResults;
     bool _removeLeadingQueryStages = false;
+    std::vector<BSONObj> _indexSpecs;
 };
 
 TEST_F(DocumentSourceLookUpTest, ShouldPropagatePauses) {
@@ -693,6 +715,141 @@ TEST_F(DocumentSourceLookUpTest, LookupReportsFieldsModifiedByAbsorbedUnwind) {
     lookup->dispose();
 }
 
+/**
+ * Runs a localField/foreignField $lookup from 'local' on "x" into 'foreign' on "a", optionally
+ * absorbing an $unwind of the results, and returns the output documents along with the join
+ * strategy reported by explain.
+ */
+std::pair<std::vector<Document>, std::string> runLookupOnX(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    const std::vector<Document>& local,
+    const std::vector<Document>& foreign,
+    bool unwind,
+    std::vector<BSONObj> foreignIndexSpecs = {}) {
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespaces(StringMap<ExpressionContext::ResolvedNamespace>{
+        {fromNs.coll().toString(), {fromNs, std::vector<BSONObj>()}}});
+
+    auto lookupSpec = Document{{"$lookup",
+                                Document{{"from", fromNs.coll()},
+                                         {"localField", "x"_sd},
+                                         {"foreignField", "a"_sd},
+                                         {"as", "joined"_sd}}}}
+                          .toBson();
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+    if (unwind) {
+        lookup->setUnwindStage(DocumentSourceUnwind::create(expCtx, "joined", false, boost::none));
+    }
+
+    deque<DocumentSource::GetNextResult> localResults;
+    for (auto&& doc : local) {
+        localResults.emplace_back(Document(doc));
+    }
+    auto mockLocalSource = DocumentSourceMock::createForTest(std::move(localResults));
+    lookup->setSource(mockLocalSource.get());
+
+    deque<DocumentSource::GetNextResult> foreignResults;
+    for (auto&& doc : foreign) {
+        foreignResults.emplace_back(Document(doc));
+    }
+    expCtx->mongoProcessInterface = std::make_shared<MockMongoInterface>(
+        std::move(foreignResults), false, std::move(foreignIndexSpecs));
+
+    std::vector<Document> results;
+    for (auto next = lookup->getNext(); next.isAdvanced(); next = lookup->getNext()) {
+        results.push_back(next.releaseDocument());
+    }
+
+    std::vector<Value> explain;
+    lookup->serializeToArray(explain, ExplainOptions::Verbosity::kExecStats);
+    auto strategy = explain[0]["$lookup"]["strategy"].getString();
+
+    lookup->dispose();
+    return {std::move(results), std::move(strategy)};
+}
+
+TEST_F(DocumentSourceLookUpTest, HashJoinShouldProduceSameResultsAsNestedLoopJoin) {
+    auto expCtx = getExpCtx();
+
+    const std::vector<Document> foreign{Document(fromjson("{_id: 0, a: 1}")),
+                                        Document(fromjson("{_id: 1, a: [1, 2]}")),
+                                        Document(fromjson("{_id: 2, a: 2}")),
+                                        Document(fromjson("{_id: 3}")),
+                                        Document(fromjson("{_id: 4, a: null}")),
+                                        Document(fromjson("{_id: 5, a: [[1]]}")),
+                                        Document(fromjson("{_id: 6, a: 1.0}")),
+                                        Document(fromjson("{_id: 7, a: 'str'}")),
+                                        Document(fromjson("{_id: 8, a: {b: 1}}"))};
+    const std::vector<Document> local{Document(fromjson("{_id: 0, x: 1}")),
+                                      Document(fromjson("{_id: 1, x: [1, 2]}")),
+                                      Document(fromjson("{_id: 2, x: [[1]]}")),
+                                      Document(fromjson("{_id: 3, x: null}")),
+                                      Document(fromjson("{_id: 4}")),
+                                      Document(fromjson("{_id: 5, x: 3}")),
+                                      Document(fromjson("{_id: 6, x: [2, 'str']}")),
+                                      Document(fromjson("{_id: 7, x: {b: 1}}")),
+                                      Document(fromjson("{_id: 8, x: [1, null]}"))};
+
+    const auto originalMaxMemoryBytes = internalLookupHashJoinMaxMemoryBytes.load();
+    ON_BLOCK_EXIT([&] { internalLookupHashJoinMaxMemoryBytes.store(originalMaxMemoryBytes); });
+
+    for (bool unwind : {false, true}) {
+        internalLookupHashJoinMaxMemoryBytes.store(0);
+        auto nestedLoop = runLookupOnX(expCtx, local, foreign, unwind);
+        ASSERT_EQ(nestedLoop.second, "NestedLoopJoin");
+
+        internalLookupHashJoinMaxMemoryBytes.store(originalMaxMemoryBytes);
+        auto hashJoin = runLookupOnX(expCtx, local, foreign, unwind);
+        ASSERT_EQ(hashJoin.second, "HashJoin");
+
+        ASSERT_EQ(hashJoin.first.size(), nestedLoop.first.size());
+        for (size_t i = 0; i < hashJoin.first.size(); ++i) {
+            ASSERT_DOCUMENT_EQ(hashJoin.first[i], nestedLoop.first[i]);
+        }
+    }
+}
+
+TEST_F(DocumentSourceLookUpTest, ShouldUseNestedLoopJoinWhenForeignFieldIsIndexed) {
+    auto expCtx = getExpCtx();
+    auto result = runLookupOnX(expCtx,
+                               {Document{{"x", 1}}},
+                               {Document{{"a", 1}}},
+                               false,
+                               {fromjson("{key: {a: 1, b: 1}}")});
+    ASSERT_EQ(result.second, "NestedLoopJoin");
+    ASSERT_EQ(result.first.size(), 1U);
+    ASSERT_DOCUMENT_EQ(result.first[0],
+                       (Document{{"x", 1}, {"joined", vector<Value>{Value(Document{{"a", 1}})}}}));
+
+    // An index which does not lead with the foreign field, or which does not hold a key for every
+    // document the per-document queries must find, does not prevent a hash join.
+    for (auto&& indexSpec : {fromjson("{key: {b: 1, a: 1}}"),
+                             fromjson("{key: {a: 1}, sparse: true}"),
+                             fromjson("{key: {a: 1}, partialFilterExpression: {b: 1}}"),
+                             fromjson("{key: {a: 'hashed'}}"),
+                             fromjson("{key: {a: 1}, collation: {locale: 'fr'}}")}) {
+        result =
+            runLookupOnX(expCtx, {Document{{"x", 1}}}, {Document{{"a", 1}}}, false, {indexSpec});
+        ASSERT_EQ(result.second, "HashJoin") << indexSpec;
+    }
+}
+
+TEST_F(DocumentSourceLookUpTest, ShouldFallBackToNestedLoopJoinWhenForeignSideExceedsMemoryLimit) {
+    auto expCtx = getExpCtx();
+
+    const auto originalMaxMemoryBytes = internalLookupHashJoinMaxMemoryBytes.load();
+    ON_BLOCK_EXIT([&] { internalLookupHashJoinMaxMemoryBytes.store(originalMaxMemoryBytes); });
+    internalLookupHashJoinMaxMemoryBytes.store(1);
+
+    auto result = runLookupOnX(
+        expCtx, {Document{{"x", 1}}}, {Document{{"a", 1}}, Document{{"a", 2}}}, false);
+    ASSERT_EQ(result.second, "NestedLoopJoin");
+    ASSERT_EQ(result.first.size(), 1U);
+    ASSERT_DOCUMENT_EQ(result.first[0],
+                       (Document{{"x", 1}, {"joined", vector<Value>{Value(Document{{"a", 1}})}}}));
+}
+
 BSONObj sequentialCacheStageObj(const StringData status = "kBuilding"_sd,
                                 const long long maxSizeBytes = kDefaultMaxCacheSize) {
     return BSON("$sequentialCache" << BSON("maxSizeBytes" << maxSizeBytes << "status" << status));
@@ -175,6 +175,13 @@ public:
     virtual CollectionIndexUsageMap getIndexStats(OperationContext* opCtx,
                                                   const NamespaceString& ns) = 0;
 
+    /**
+     * Returns the specs of the ready indexes on collection 'ns', or an empty vector if it does not
+     * exist.
+     */
+    virtual std::vector<BSONObj> getIndexSpecs(OperationContext* opCtx,
+                                               const NamespaceString& ns) = 0;
+
     /**
      * Appends operation latency statistics for collection "nss" to "builder"
      */
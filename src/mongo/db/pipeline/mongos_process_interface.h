@@ -96,6 +96,10 @@ public:
         MONGO_UNREACHABLE;
     }
 
+    std::vector<BSONObj> getIndexSpecs(OperationContext* opCtx, const NamespaceString& ns) final {
+        MONGO_UNREACHABLE;
+    }
+
     void appendLatencyStats(OperationContext* opCtx,
                             const NamespaceString& nss,
                             bool includeHistograms,
@@ -270,6 +270,23 @@ CollectionIndexUsageMap MongoInterfaceStandalone::getIndexStats(OperationContext
     return CollectionQueryInfo::get(collection).getIndexUsageStats();
 }
 
+std::vector<BSONObj> MongoInterfaceStandalone::getIndexSpecs(OperationContext* opCtx,
+                                                             const NamespaceString& ns) {
+    AutoGetCollectionForReadCommand autoColl(opCtx, ns);
+
+    std::vector<BSONObj> indexSpecs;
+    Collection* collection = autoColl.getCollection();
+    if (!collection) {
+        return indexSpecs;
+    }
+
+    auto indexIterator = collection->getIndexCatalog()->getIndexIterator(opCtx, false);
+    while (indexIterator->more()) {
+        indexSpecs.push_back(indexIterator->next()->descriptor()->infoObj().getOwned());
+    }
+    return indexSpecs;
+}
+
 void MongoInterfaceStandalone::appendLatencyStats(OperationContext* opCtx,
                                                   const NamespaceString& nss,
                                                   bool includeHistograms,
@@ -242,6 +242,9 @@ void CollectionQueryInfo::droppedIndex(OperationContext* opCtx, StringData index
 
     rebuildIndexData(opCtx);
     _indexUsageTracker.unregisterIndex(indexName);
+
+    stdx::lock_guard<Latch> lk(_indexStatisticsMutex);
+    _indexStatistics.erase(indexName.toString());
 }
 
 void CollectionQueryInfo::rebuildIndexData(OperationContext* opCtx) {
@@ -252,6 +255,19 @@ void CollectionQueryInfo::rebuildIndexData(OperationContext* opCtx) {
     updatePlanCacheIndexEntries(opCtx);
 }
 
+std::shared_ptr<const IndexStatistics> CollectionQueryInfo::getIndexStatistics(
+    StringData indexName) const {
+    stdx::lock_guard<Latch> lk(_indexStatisticsMutex);
+    auto it = _indexStatistics.find(indexName);
+    return it == _indexStatistics.end() ? nullptr : it->second;
+}
+
+void CollectionQueryInfo::setIndexStatistics(StringData indexName,
+                                             std::shared_ptr<const IndexStatistics> stats) {
+    stdx::lock_guard<Latch> lk(_indexStatisticsMutex);
+    _indexStatistics[indexName] = std::move(stats);
+}
+
 CollectionIndexUsageMap CollectionQueryInfo::getIndexUsageStats() const {
     return _indexUsageTracker.getUsageStats();
 }
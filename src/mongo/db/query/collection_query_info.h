@@ -33,10 +33,13 @@
 
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/collection_index_usage_tracker.h"
+#include "mongo/db/query/index_statistics.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/plan_summary_stats.h"
 #include "mongo/db/query/query_settings.h"
 #include "mongo/db/update_index_data.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/util/string_map.h"
 
 namespace mongo {
 
@@ -79,6 +82,18 @@ public:
 
     CollectionIndexUsageTracker::CollectionScanStats getCollectionScanStats() const;
 
+    /**
+     * Returns the key distribution statistics last collected for the index named 'indexName' by the
+     * analyze command, or nullptr if there are none. Statistics are held in memory only, and are
+     * discarded when the index is dropped.
+     */
+    std::shared_ptr<const IndexStatistics> getIndexStatistics(StringData indexName) const;
+
+    /**
+     * Replaces the statistics for the index named 'indexName'.
+     */
+    void setIndexStatistics(StringData indexName, std::shared_ptr<const IndexStatistics> stats);
+
     /**
      * Builds internal cache state based on the current state of the Collection's IndexCatalog.
      */
@@ -130,6 +145,12 @@ private:
 
     // Tracks index usage statistics for this collection.
     CollectionIndexUsageTracker _indexUsageTracker;
+
+    // Key distribution statistics, keyed by index name. Guarded by '_indexStatisticsMutex', since
+    // they are replaced by the analyze command while holding only an intent lock.
+    mutable Mutex _indexStatisticsMutex =
+        MONGO_MAKE_LATCH("CollectionQueryInfo::_indexStatisticsMutex");
+    StringMap<std::shared_ptr<const IndexStatistics>> _indexStatistics;
 };
 
 }  // namespace mongo
@@ -49,6 +49,7 @@ const char kBatchFieldInitial[] = "firstBatch";
 const char kBatchDocSequenceField[] = "cursor.nextBatch";
 const char kBatchDocSequenceFieldInitial[] = "cursor.firstBatch";
 const char kPostBatchResumeTokenField[] = "postBatchResumeToken";
+const char kRequestDocumentSequencesField[] = "$_requestDocumentSequences";
 
 }  // namespace
 
@@ -66,6 +67,12 @@ CursorResponseBuilder::CursorResponseBuilder(rpc::ReplyBuilderInterface* replyBu
     }
 }
 
+bool CursorResponseBuilder::shouldUseDocumentSequences(
+    const BSONObj& cmdObj, const rpc::ReplyBuilderInterface& replyBuilder) {
+    return replyBuilder.getProtocol() == rpc::Protocol::kOpMsg &&
+        cmdObj[kRequestDocumentSequencesField].trueValue();
+}
+
 void CursorResponseBuilder::done(CursorId cursorId, StringData cursorNamespace) {
     invariant(_active);
     if (_options.useDocumentSequences) {
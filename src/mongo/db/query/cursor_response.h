@@ -67,6 +67,15 @@ public:
      */
     CursorResponseBuilder(rpc::ReplyBuilderInterface* replyBuilder, Options options);
 
+    /**
+     * Returns true if the batch of the reply to 'cmdObj' should be built as a document sequence,
+     * so that large documents are sent from the buffers which own them rather than copied into the
+     * reply. Clients request this with the '$_requestDocumentSequences' generic argument, and only
+     * OP_MSG replies can carry document sequences.
+     */
+    static bool shouldUseDocumentSequences(const BSONObj& cmdObj,
+                                           const rpc::ReplyBuilderInterface& replyBuilder);
+
     ~CursorResponseBuilder() {
         if (_active)
             abandon();
@@ -80,7 +89,8 @@ public:
     void append(const BSONObj& obj) {
         invariant(_active);
         if (_options.useDocumentSequences) {
-            _docSeqBuilder->append(obj);
+            // Large documents are sent from the buffers which own them rather than copied.
+            _docSeqBuilder->appendReferenced(obj);
         } else {
             _batch->append(obj);
         }
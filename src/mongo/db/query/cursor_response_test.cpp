@@ -31,6 +31,7 @@
 
 #include "mongo/db/query/cursor_response.h"
 
+#include "mongo/rpc/legacy_reply_builder.h"
 #include "mongo/rpc/op_msg_rpc_impls.h"
 
 #include "mongo/db/pipeline/resume_token.h"
@@ -297,6 +298,77 @@ TEST(CursorResponseTest, cursorReturnDocumentSequences) {
     ASSERT_BSONOBJ_EQ(opMsg.body, expectedBody);
 }
 
+TEST(CursorResponseTest, cursorReturnDocumentSequencesReferencesLargeDocuments) {
+    CursorResponseBuilder::Options options;
+    options.useDocumentSequences = true;
+    rpc::OpMsgReplyBuilder builder;
+    BSONObj smallDoc = BSON("_id" << 1);
+    BSONObj largeDoc = BSON(
+        "_id" << 2 << "padding"
+              << std::string(OpMsgBuilder::DocSequenceBuilder::kMinReferencedDocumentBytes, 'x'));
+
+    CursorResponseBuilder crb(&builder, options);
+    crb.append(smallDoc);
+    const auto bytesBefore = crb.bytesUsed();
+    crb.append(largeDoc);
+    ASSERT_EQ(crb.bytesUsed(), bytesBefore + largeDoc.objsize());
+    crb.done(CursorId(123), "db.coll");
+
+    auto msg = builder.done();
+    ASSERT_FALSE(msg.isContiguous());
+    auto buffers = msg.buffers();
+    ASSERT_TRUE(std::any_of(buffers.begin(), buffers.end(), [&](const ConstDataRange& range) {
+        return range.data() == largeDoc.objdata();
+    }));
+
+    msg.flatten();
+    auto opMsg = OpMsg::parse(msg);
+    ASSERT_EQ(opMsg.sequences.size(), 1U);
+    const auto& documentSequence = opMsg.sequences[0];
+    ASSERT_EQ(documentSequence.name, "cursor.nextBatch");
+    ASSERT_EQ(documentSequence.objs.size(), 2U);
+    ASSERT_BSONOBJ_EQ(documentSequence.objs[0], smallDoc);
+    ASSERT_BSONOBJ_EQ(documentSequence.objs[1], largeDoc);
+}
+
+TEST(CursorResponseTest, replyToDocumentSequencesRequestReadsAsNormalReply) {
+    CursorResponseBuilder::Options options;
+    options.isInitialResponse = true;
+    options.useDocumentSequences = true;
+    rpc::OpMsgReplyBuilder builder;
+    BSONObj largeDoc = BSON(
+        "_id" << 1 << "padding"
+              << std::string(OpMsgBuilder::DocSequenceBuilder::kMinReferencedDocumentBytes, 'x'));
+
+    CursorResponseBuilder crb(&builder, options);
+    crb.append(largeDoc);
+    crb.done(CursorId(123), "db.coll");
+    builder.getBodyBuilder().append("ok", 1);
+
+    auto msg = builder.done();
+    msg.flatten();
+    rpc::OpMsgReply reply(&msg);
+    auto response = unittest::assertGet(CursorResponse::parseFromBSON(reply.getCommandReply()));
+    ASSERT_EQ(response.getCursorId(), CursorId(123));
+    ASSERT_EQ(response.getNSS().ns(), "db.coll");
+    ASSERT_EQ(response.getBatch().size(), 1U);
+    ASSERT_BSONOBJ_EQ(response.getBatch()[0], largeDoc);
+}
+
+TEST(CursorResponseTest, documentSequencesOnlyUsedWhenRequestedOverOpMsg) {
+    const auto requested = BSON("find"
+                                << "coll"
+                                << "$_requestDocumentSequences" << true);
+    const auto notRequested = BSON("find"
+                                   << "coll");
+    rpc::OpMsgReplyBuilder opMsgBuilder;
+    rpc::LegacyReplyBuilder legacyBuilder;
+
+    ASSERT_TRUE(CursorResponseBuilder::shouldUseDocumentSequences(requested, opMsgBuilder));
+    ASSERT_FALSE(CursorResponseBuilder::shouldUseDocumentSequences(notRequested, opMsgBuilder));
+    ASSERT_FALSE(CursorResponseBuilder::shouldUseDocumentSequences(requested, legacyBuilder));
+}
+
 }  // namespace
 
 }  // namespace mongo
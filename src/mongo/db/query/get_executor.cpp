@@ -66,7 +66,9 @@
 #include "mongo/db/query/explain.h"
 #include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/query/parameterized_plan.h"
 #include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_cost_model.h"
 #include "mongo/db/query/plan_executor.h"
 #include "mongo/db/query/planner_access.h"
 #include "mongo/db/query/planner_analysis.h"
@@ -451,14 +453,30 @@ StatusWith<PrepareExecutionResult> prepareExecution(OperationContext* opCtx,
             canonical_query_encoder::computeHash(planCacheKey.toString());
 
         // Try to look up a cached solution for the query.
-        if (auto cs = CollectionQueryInfo::get(collection)
-                          .getPlanCache()
-                          ->getCacheEntryIfActive(planCacheKey)) {
-            // We have a CachedSolution.  Have the planner turn it into a QuerySolution.
-            auto statusWithQs = QueryPlanner::planFromCache(*canonicalQuery, plannerParams, *cs);
+        auto planCache = CollectionQueryInfo::get(collection).getPlanCache();
+        if (auto cs = planCache->getCacheEntryIfActive(planCacheKey)) {
+            // We have a CachedSolution. If its plan is parameterized, bind it to this query's
+            // constants. Otherwise have the planner turn it into a QuerySolution.
+            const bool useParameterizedPlans = internalQueryCacheParameterizedPlans.load();
+            std::unique_ptr<QuerySolution> boundSolution;
+            if (useParameterizedPlans && cs->parameterizedPlan) {
+                boundSolution = cs->parameterizedPlan->bind(*canonicalQuery, plannerParams);
+            }
+
+            auto statusWithQs = boundSolution
+                ? StatusWith<std::unique_ptr<QuerySolution>>(std::move(boundSolution))
+                : QueryPlanner::planFromCache(*canonicalQuery, plannerParams, *cs);
 
             if (statusWithQs.isOK()) {
                 auto querySolution = std::move(statusWithQs.getValue());
+                if (useParameterizedPlans && !cs->parameterizedPlan && !cs->cannotParameterize) {
+                    // A null result is cached too, so that shapes which cannot be parameterized
+                    // are not retried on every hit.
+                    planCache->setParameterizedPlan(
+                        *cs,
+                        ParameterizedPlan::make(*canonicalQuery, plannerParams, *querySolution));
+                }
+
                 if ((plannerParams.options & QueryPlannerParams::IS_COUNT) &&
                     turnIxscanIntoCount(querySolution.get())) {
                     LOG(2) << "Using fast count: " << redact(canonicalQuery->toStringShort());
@@ -510,6 +528,8 @@ StatusWith<PrepareExecutionResult> prepareExecution(OperationContext* opCtx,
                                     << " No query solutions");
     }
 
+    plan_cost_model::pruneSolutions(opCtx, collection, *canonicalQuery, &solutions);
+
     // See if one of our solutions is a fast count hack in disguise.
     if (plannerParams.options & QueryPlannerParams::IS_COUNT) {
         for (size_t i = 0; i < solutions.size(); ++i) {
@@ -408,6 +408,15 @@ IndexBounds IndexBounds::reverse() const {
 // Validity checking for bounds
 //
 
+bool OrderedIntervalList::isMinToMax() const {
+    if (intervals.size() != 1) {
+        return false;
+    }
+    const auto& interval = intervals.front();
+    return interval.isMinToMax() ||
+        (interval.start.type() == BSONType::MaxKey && interval.end.type() == BSONType::MinKey);
+}
+
 bool OrderedIntervalList::isValidFor(int expectedOrientation) const {
     // Make sure each interval's start is oriented correctly with respect to its end.
     for (size_t j = 0; j < intervals.size(); ++j) {
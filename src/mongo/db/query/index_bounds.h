@@ -60,6 +60,11 @@ struct OrderedIntervalList {
     bool isValidFor(int expectedOrientation) const;
     std::string toString() const;
 
+    /**
+     * Returns true if the OIL is a single interval covering every value, in either direction.
+     */
+    bool isMinToMax() const;
+
     /**
      * Complements the OIL. Used by the index bounds builder in order
      * to create index bounds for $not predicates.
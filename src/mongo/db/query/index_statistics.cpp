@@ -0,0 +1,224 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/index_statistics.h"
+
+#include <algorithm>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+namespace {
+
+BSONObj ownValue(const BSONElement& value) {
+    BSONObjBuilder bob;
+    bob.appendAs(value, "");
+    return bob.obj();
+}
+
+int compareValues(const BSONElement& lhs, const BSONElement& rhs) {
+    return lhs.woCompare(rhs, false);
+}
+
+/**
+ * The estimated number of keys for each value in the bucket other than its upper bound, assuming
+ * those values are uniformly distributed.
+ */
+double averageFrequency(const IndexStatistics::Bucket& bucket) {
+    const long long numOtherKeys = bucket.numKeys - bucket.numEqualToUpperBound;
+    return static_cast<double>(numOtherKeys) / std::max(1LL, bucket.numDistinct - 1);
+}
+
+}  // namespace
+
+IndexStatistics::Builder::Builder(size_t maxBuckets) : _maxBuckets(std::max<size_t>(1, maxBuckets)) {}
+
+void IndexStatistics::Builder::addKey(const BSONElement& leadingValue) {
+    if (!_buckets.empty()) {
+        auto& last = _buckets.back();
+        const int cmp = compareValues(leadingValue, last.upperBound());
+        dassert(cmp >= 0);
+
+        if (cmp == 0) {
+            ++last.numKeys;
+            ++last.numEqualToUpperBound;
+            return;
+        }
+
+        // A value is never split across buckets, so a bucket is only closed when a new value
+        // arrives after it has reached the current depth.
+        if (last.numKeys < _bucketDepth) {
+            last.upperBoundObj = ownValue(leadingValue);
+            ++last.numKeys;
+            ++last.numDistinct;
+            last.numEqualToUpperBound = 1;
+            return;
+        }
+    }
+
+    Bucket bucket;
+    bucket.lowerBoundObj = ownValue(leadingValue);
+    bucket.upperBoundObj = bucket.lowerBoundObj;
+    bucket.numKeys = 1;
+    bucket.numDistinct = 1;
+    bucket.numEqualToUpperBound = 1;
+    _buckets.push_back(std::move(bucket));
+
+    while (_buckets.size() > 2 * _maxBuckets) {
+        mergeBuckets();
+    }
+}
+
+void IndexStatistics::Builder::mergeBuckets() {
+    _bucketDepth *= 2;
+
+    // Apply the same rule as addKey() at the new depth: a bucket absorbs its successor until it
+    // holds at least '_bucketDepth' keys. A value frequent enough to fill a bucket on its own
+    // therefore always remains the upper bound of its bucket and keeps an exact count.
+    std::vector<Bucket> merged;
+    merged.reserve(_buckets.size() / 2 + 1);
+    for (auto&& bucket : _buckets) {
+        if (merged.empty() || merged.back().numKeys >= _bucketDepth) {
+            merged.push_back(std::move(bucket));
+            continue;
+        }
+
+        auto& last = merged.back();
+        last.upperBoundObj = std::move(bucket.upperBoundObj);
+        last.numKeys += bucket.numKeys;
+        last.numDistinct += bucket.numDistinct;
+        last.numEqualToUpperBound = bucket.numEqualToUpperBound;
+    }
+    _buckets = std::move(merged);
+}
+
+IndexStatistics IndexStatistics::Builder::done() {
+    return IndexStatistics(std::move(_buckets));
+}
+
+IndexStatistics::IndexStatistics(std::vector<Bucket> buckets) : _buckets(std::move(buckets)) {
+    for (auto&& bucket : _buckets) {
+        _numKeys += bucket.numKeys;
+        _numDistinct += bucket.numDistinct;
+    }
+}
+
+double IndexStatistics::estimateKeys(const OrderedIntervalList& oil) const {
+    double numKeys = 0;
+    for (auto&& interval : oil.intervals) {
+        numKeys += estimateKeys(interval);
+    }
+    return std::min(numKeys, static_cast<double>(_numKeys));
+}
+
+double IndexStatistics::estimateKeys(const Interval& interval) const {
+    if (interval.isPoint()) {
+        for (auto&& bucket : _buckets) {
+            if (compareValues(interval.start, bucket.upperBound()) > 0) {
+                continue;
+            }
+            if (compareValues(interval.start, bucket.lowerBound()) < 0) {
+                return 0;
+            }
+            if (compareValues(interval.start, bucket.upperBound()) == 0) {
+                return bucket.numEqualToUpperBound;
+            }
+            return averageFrequency(bucket);
+        }
+        return 0;
+    }
+
+    // Intervals of a descending index or of a backward scan run from high to low.
+    BSONElement low = interval.start;
+    bool lowInclusive = interval.startInclusive;
+    BSONElement high = interval.end;
+    bool highInclusive = interval.endInclusive;
+    if (compareValues(low, high) > 0) {
+        std::swap(low, high);
+        std::swap(lowInclusive, highInclusive);
+    }
+
+    return std::max(0.0,
+                    estimateKeysBelow(high, highInclusive) - estimateKeysBelow(low, !lowInclusive));
+}
+
+double IndexStatistics::estimateKeysBelow(const BSONElement& value, bool inclusive) const {
+    double numKeys = 0;
+    for (auto&& bucket : _buckets) {
+        const int cmpUpper = compareValues(value, bucket.upperBound());
+        if (cmpUpper > 0) {
+            numKeys += bucket.numKeys;
+            continue;
+        }
+
+        const int cmpLower = compareValues(value, bucket.lowerBound());
+        if (cmpLower < 0) {
+            return numKeys;
+        }
+
+        if (cmpUpper == 0) {
+            const long long numOtherKeys = bucket.numKeys - bucket.numEqualToUpperBound;
+            return numKeys + numOtherKeys + (inclusive ? bucket.numEqualToUpperBound : 0);
+        }
+
+        if (cmpLower == 0) {
+            return numKeys + (inclusive ? averageFrequency(bucket) : 0);
+        }
+
+        // Nothing is known about where 'value' lies between the bucket's bounds, so assume half of
+        // the bucket is below it.
+        return numKeys + (bucket.numKeys - bucket.numEqualToUpperBound) / 2.0;
+    }
+    return numKeys;
+}
+
+BSONObj IndexStatistics::toBSON() const {
+    BSONObjBuilder bob;
+    bob.appendNumber("numKeys", _numKeys);
+    bob.appendNumber("numDistinct", _numDistinct);
+
+    BSONArrayBuilder bucketsBuilder(bob.subarrayStart("buckets"));
+    for (auto&& bucket : _buckets) {
+        BSONObjBuilder bucketBuilder(bucketsBuilder.subobjStart());
+        bucketBuilder.appendAs(bucket.lowerBound(), "lowerBound");
+        bucketBuilder.appendAs(bucket.upperBound(), "upperBound");
+        bucketBuilder.appendNumber("numKeys", bucket.numKeys);
+        bucketBuilder.appendNumber("numDistinct", bucket.numDistinct);
+        bucketBuilder.appendNumber("numEqualToUpperBound", bucket.numEqualToUpperBound);
+    }
+    bucketsBuilder.doneFast();
+
+    return bob.obj();
+}
+
+}  // namespace mongo
@@ -0,0 +1,133 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/bson/bsonelement.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/query/index_bounds.h"
+
+namespace mongo {
+
+/**
+ * Summary statistics describing the distribution of keys in an index, used by the query planner to
+ * estimate how many keys an index scan will examine without having to run it.
+ *
+ * The leading field of the index is described by an equi-depth histogram: every bucket covers
+ * roughly the same number of keys, so frequent values get narrow buckets and rare values share
+ * wide ones. Each bucket remembers its smallest and largest value, how many keys and distinct
+ * values fall in the range, and how many keys are equal to its largest value.
+ *
+ * Histogram values are compared without a collator, since index keys already hold collation keys.
+ */
+class IndexStatistics {
+public:
+    static constexpr size_t kDefaultMaxBuckets = 100;
+
+    struct Bucket {
+        BSONElement lowerBound() const {
+            return lowerBoundObj.firstElement();
+        }
+
+        BSONElement upperBound() const {
+            return upperBoundObj.firstElement();
+        }
+
+        // Single-element objects owning the smallest and largest value in the bucket.
+        BSONObj lowerBoundObj;
+        BSONObj upperBoundObj;
+
+        long long numKeys = 0;
+        long long numDistinct = 0;
+        long long numEqualToUpperBound = 0;
+    };
+
+    /**
+     * Builds an IndexStatistics from a single pass over the leading values of an index's keys.
+     * Values must be added in ascending order. The histogram is built with a bucket depth of one
+     * key, and whenever the number of buckets exceeds twice 'maxBuckets' the depth is doubled by
+     * merging neighbouring buckets, so the finished histogram never has more than 2 * 'maxBuckets'
+     * buckets.
+     */
+    class Builder {
+    public:
+        explicit Builder(size_t maxBuckets = kDefaultMaxBuckets);
+
+        void addKey(const BSONElement& leadingValue);
+
+        IndexStatistics done();
+
+    private:
+        void mergeBuckets();
+
+        size_t _maxBuckets;
+        long long _bucketDepth = 1;
+        std::vector<Bucket> _buckets;
+    };
+
+    IndexStatistics() = default;
+
+    /**
+     * Estimates the number of keys whose leading value falls within any of the intervals of 'oil'.
+     * The intervals may be oriented in either direction.
+     */
+    double estimateKeys(const OrderedIntervalList& oil) const;
+    double estimateKeys(const Interval& interval) const;
+
+    long long getNumKeys() const {
+        return _numKeys;
+    }
+
+    long long getNumDistinct() const {
+        return _numDistinct;
+    }
+
+    const std::vector<Bucket>& getBuckets() const {
+        return _buckets;
+    }
+
+    BSONObj toBSON() const;
+
+private:
+    explicit IndexStatistics(std::vector<Bucket> buckets);
+
+    /**
+     * Estimates the number of keys whose leading value is less than 'value', or less than or equal
+     * to it if 'inclusive' is true.
+     */
+    double estimateKeysBelow(const BSONElement& value, bool inclusive) const;
+
+    std::vector<Bucket> _buckets;
+    long long _numKeys = 0;
+    long long _numDistinct = 0;
+};
+
+}  // namespace mongo
@@ -0,0 +1,150 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/index_statistics.h"
+
+#include "mongo/bson/json.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+IndexStatistics buildStatistics(const std::vector<int>& values, size_t maxBuckets) {
+    IndexStatistics::Builder builder(maxBuckets);
+    for (auto value : values) {
+        auto key = BSON("" << value);
+        builder.addKey(key.firstElement());
+    }
+    return builder.done();
+}
+
+std::vector<int> range(int begin, int end) {
+    std::vector<int> values;
+    for (int i = begin; i < end; ++i) {
+        values.push_back(i);
+    }
+    return values;
+}
+
+Interval makeInterval(int start, int end, bool startInclusive, bool endInclusive) {
+    return Interval(BSON("" << start << "" << end), startInclusive, endInclusive);
+}
+
+TEST(IndexStatisticsTest, EmptyIndexEstimatesNoKeys) {
+    auto stats = buildStatistics({}, 10);
+    ASSERT_EQ(stats.getNumKeys(), 0);
+    ASSERT_EQ(stats.getNumDistinct(), 0);
+    ASSERT_EQ(stats.estimateKeys(makeInterval(1, 1, true, true)), 0);
+    ASSERT_EQ(stats.estimateKeys(makeInterval(0, 100, true, true)), 0);
+}
+
+TEST(IndexStatisticsTest, CountsKeysAndDistinctValues) {
+    std::vector<int> values;
+    for (int i = 0; i < 500; ++i) {
+        values.push_back(i);
+        values.push_back(i);
+    }
+    auto stats = buildStatistics(values, 10);
+    ASSERT_EQ(stats.getNumKeys(), 1000);
+    ASSERT_EQ(stats.getNumDistinct(), 500);
+    ASSERT_LTE(stats.getBuckets().size(), 20U);
+    ASSERT_GTE(stats.getBuckets().size(), 10U);
+}
+
+TEST(IndexStatisticsTest, SmallIndexIsDescribedExactly) {
+    auto stats = buildStatistics({1, 2, 2, 3, 3, 3}, 10);
+    ASSERT_EQ(stats.getBuckets().size(), 3U);
+    ASSERT_EQ(stats.estimateKeys(makeInterval(1, 1, true, true)), 1);
+    ASSERT_EQ(stats.estimateKeys(makeInterval(2, 2, true, true)), 2);
+    ASSERT_EQ(stats.estimateKeys(makeInterval(3, 3, true, true)), 3);
+    ASSERT_EQ(stats.estimateKeys(makeInterval(4, 4, true, true)), 0);
+    ASSERT_EQ(stats.estimateKeys(makeInterval(2, 3, true, true)), 5);
+    ASSERT_EQ(stats.estimateKeys(makeInterval(2, 3, false, true)), 3);
+    ASSERT_EQ(stats.estimateKeys(makeInterval(2, 3, true, false)), 2);
+}
+
+TEST(IndexStatisticsTest, RangeEstimatesAreCloseForUniformData) {
+    auto stats = buildStatistics(range(0, 10000), 50);
+
+    auto estimate = stats.estimateKeys(makeInterval(1000, 2000, true, false));
+    ASSERT_GT(estimate, 900);
+    ASSERT_LT(estimate, 1100);
+
+    estimate = stats.estimateKeys(makeInterval(0, 10000, true, true));
+    ASSERT_EQ(estimate, 10000);
+}
+
+TEST(IndexStatisticsTest, DescendingIntervalsAreEstimatedLikeAscendingOnes) {
+    auto stats = buildStatistics(range(0, 10000), 50);
+    ASSERT_EQ(stats.estimateKeys(makeInterval(2000, 1000, false, true)),
+              stats.estimateKeys(makeInterval(1000, 2000, true, false)));
+}
+
+TEST(IndexStatisticsTest, FrequentValueKeepsExactCount) {
+    std::vector<int> values = range(0, 1000);
+    values.insert(values.begin() + 500, 5000, 500);
+    auto stats = buildStatistics(values, 10);
+
+    ASSERT_EQ(stats.estimateKeys(makeInterval(500, 500, true, true)), 5001);
+    ASSERT_LT(stats.estimateKeys(makeInterval(501, 501, true, true)), 100);
+}
+
+TEST(IndexStatisticsTest, EstimatesUnionOfIntervals) {
+    auto stats = buildStatistics({1, 2, 2, 3, 3, 3}, 10);
+
+    OrderedIntervalList oil("a");
+    oil.intervals.push_back(makeInterval(1, 1, true, true));
+    oil.intervals.push_back(makeInterval(3, 3, true, true));
+    ASSERT_EQ(stats.estimateKeys(oil), 4);
+}
+
+TEST(IndexStatisticsTest, MinKeyToMaxKeyCoversWholeIndex) {
+    auto stats = buildStatistics(range(0, 100), 10);
+    BSONObjBuilder bob;
+    bob.appendMinKey("");
+    bob.appendMaxKey("");
+    Interval all(bob.obj(), true, true);
+    ASSERT_EQ(stats.estimateKeys(all), 100);
+}
+
+TEST(IndexStatisticsTest, SerializesBuckets) {
+    auto stats = buildStatistics({1, 2, 2}, 10);
+    ASSERT_BSONOBJ_EQ(stats.toBSON(),
+                      fromjson("{numKeys: 3, numDistinct: 2, buckets: ["
+                               "{lowerBound: 1, upperBound: 1, numKeys: 1, numDistinct: 1, "
+                               "numEqualToUpperBound: 1},"
+                               "{lowerBound: 2, upperBound: 2, numKeys: 2, numDistinct: 1, "
+                               "numEqualToUpperBound: 2}]}"));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -0,0 +1,244 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/parameterized_plan.h"
+
+#include <algorithm>
+
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/index_bounds_builder.h"
+#include "mongo/db/query/query_planner_params.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/util/container_size_helper.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+
+namespace {
+
+using EqualityMap = StringMap<const EqualityMatchExpression*>;
+
+bool canParameterize(const CanonicalQuery& query) {
+    const auto& qr = query.getQueryRequest();
+    return qr.getSort().isEmpty() && !qr.getSkip() && !qr.getLimit() && !qr.getNToReturn() &&
+        qr.getMin().isEmpty() && qr.getMax().isEmpty() && !qr.returnKey();
+}
+
+/**
+ * Collects the predicates of 'root' by path. Returns false unless 'root' is an equality, or a
+ * conjunction of equalities on distinct paths.
+ */
+bool collectEqualities(const MatchExpression* root, EqualityMap* equalities) {
+    auto addEquality = [&](const MatchExpression* expr) {
+        if (expr->matchType() != MatchExpression::EQ) {
+            return false;
+        }
+        auto eq = static_cast<const EqualityMatchExpression*>(expr);
+        return equalities->emplace(eq->path().toString(), eq).second;
+    };
+
+    if (root->matchType() != MatchExpression::AND) {
+        return addEquality(root);
+    }
+    if (root->numChildren() == 0) {
+        return false;
+    }
+    for (size_t i = 0; i < root->numChildren(); ++i) {
+        if (!addEquality(root->getChild(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Returns the index scan at the bottom of 'root', or nullptr if 'root' is not a chain of unfiltered
+ * single-child stages ending in an unfiltered index scan.
+ */
+IndexScanNode* findIndexScan(QuerySolutionNode* root) {
+    auto node = root;
+    while (true) {
+        if (node->filter) {
+            return nullptr;
+        }
+
+        switch (node->getType()) {
+            case STAGE_IXSCAN:
+                return static_cast<IndexScanNode*>(node);
+            case STAGE_FETCH:
+            case STAGE_PROJECTION_DEFAULT:
+            case STAGE_PROJECTION_COVERED:
+            case STAGE_PROJECTION_SIMPLE:
+            case STAGE_SHARDING_FILTER:
+                if (node->children.size() != 1) {
+                    return nullptr;
+                }
+                node = node->children[0];
+                break;
+            default:
+                return nullptr;
+        }
+    }
+}
+
+}  // namespace
+
+ParameterizedPlan::~ParameterizedPlan() = default;
+
+std::unique_ptr<ParameterizedPlan> ParameterizedPlan::make(const CanonicalQuery& query,
+                                                           const QueryPlannerParams& params,
+                                                           const QuerySolution& solution) {
+    if (!solution.root || !canParameterize(query)) {
+        return nullptr;
+    }
+
+    EqualityMap equalities;
+    if (!collectEqualities(query.root(), &equalities)) {
+        return nullptr;
+    }
+
+    std::unique_ptr<ParameterizedPlan> plan(new ParameterizedPlan());
+    plan->_root.reset(solution.root->clone());
+
+    auto ixn = findIndexScan(plan->_root.get());
+    if (!ixn || ixn->index.type != INDEX_BTREE || ixn->bounds.isSimpleRange) {
+        return nullptr;
+    }
+
+    // Every predicate must be answered exactly by a point interval on the field it constrains, and
+    // every other field of the index must be unbounded.
+    for (auto&& oil : ixn->bounds.fields) {
+        if (!equalities.count(oil.name)) {
+            if (!oil.isMinToMax()) {
+                return nullptr;
+            }
+            plan->_parameterPaths.emplace_back();
+            continue;
+        }
+
+        if (oil.intervals.size() != 1 || !oil.intervals.front().isPoint()) {
+            return nullptr;
+        }
+        plan->_parameterPaths.push_back(oil.name);
+        ++plan->_numParameters;
+    }
+    if (plan->_numParameters != equalities.size()) {
+        return nullptr;
+    }
+
+    // The template must not refer to anything owned by 'query'. The collator is rebound from the
+    // query each time the template is bound.
+    ixn->queryCollator = nullptr;
+
+    plan->_hasBlockingStage = solution.hasBlockingStage;
+    plan->_projection = query.getQueryRequest().getProj().getOwned();
+    plan->_plannerOptions = params.options;
+    return plan;
+}
+
+std::unique_ptr<QuerySolution> ParameterizedPlan::bind(const CanonicalQuery& query,
+                                                       const QueryPlannerParams& params) const {
+    if (params.options != _plannerOptions || !canParameterize(query) ||
+        SimpleBSONObjComparator::kInstance.evaluate(query.getQueryRequest().getProj() !=
+                                                    _projection)) {
+        return nullptr;
+    }
+
+    EqualityMap equalities;
+    if (!collectEqualities(query.root(), &equalities) || equalities.size() != _numParameters) {
+        return nullptr;
+    }
+
+    std::unique_ptr<QuerySolutionNode> root(_root->clone());
+    auto ixn = findIndexScan(root.get());
+    invariant(ixn);
+
+    // Take the index from the current planner parameters, since its multikeyness may have changed
+    // since the template was made. A change in multikeyness can change which plans are correct.
+    auto index = std::find_if(params.indices.begin(), params.indices.end(), [&](const auto& entry) {
+        return entry.identifier == ixn->index.identifier;
+    });
+    if (index == params.indices.end() || index->multikey != ixn->index.multikey ||
+        index->multikeyPaths != ixn->index.multikeyPaths) {
+        return nullptr;
+    }
+    ixn->index = *index;
+    ixn->queryCollator = query.getCollator();
+
+    for (size_t i = 0; i < _parameterPaths.size(); ++i) {
+        if (_parameterPaths[i].empty()) {
+            continue;
+        }
+
+        auto it = equalities.find(_parameterPaths[i]);
+        if (it == equalities.end()) {
+            return nullptr;
+        }
+
+        OrderedIntervalList oil(ixn->bounds.fields[i].name);
+        IndexBoundsBuilder::BoundsTightness tightness;
+        IndexBoundsBuilder::translateEquality(
+            it->second->getData(), ixn->index, false, &oil, &tightness);
+        if (tightness != IndexBoundsBuilder::EXACT || oil.intervals.size() != 1 ||
+            !oil.intervals.front().isPoint()) {
+            return nullptr;
+        }
+        ixn->bounds.fields[i] = std::move(oil);
+    }
+
+    auto solution = std::make_unique<QuerySolution>();
+    solution->root = std::move(root);
+    solution->hasBlockingStage = _hasBlockingStage;
+    solution->indexFilterApplied = params.indexFiltersApplied;
+    return solution;
+}
+
+uint64_t ParameterizedPlan::estimateObjectSizeInBytes() const {
+    // Only the index scan holds data of any size.
+    uint64_t size = sizeof(*this) + _projection.objsize() +
+        container_size_helper::estimateObjectSizeInBytes(
+                        _parameterPaths, [](const auto& path) { return path.capacity(); }, true);
+    for (auto node = _root.get(); node; node = node->children.empty() ? nullptr : node->children[0]) {
+        size += sizeof(IndexScanNode);
+        if (node->getType() == STAGE_IXSCAN) {
+            const auto ixn = static_cast<const IndexScanNode*>(node);
+            size += ixn->index.estimateObjectSizeInBytes();
+            for (auto&& oil : ixn->bounds.fields) {
+                size += oil.name.capacity() + oil.intervals.size() * sizeof(Interval);
+            }
+        }
+    }
+    return size;
+}
+
+}  // namespace mongo
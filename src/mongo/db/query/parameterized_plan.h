@@ -0,0 +1,100 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+
+namespace mongo {
+
+class CanonicalQuery;
+struct QueryPlannerParams;
+struct QuerySolution;
+struct QuerySolutionNode;
+
+/**
+ * A cached query plan whose index bounds are parameters bound from the constants of each query
+ * that uses it. A plan cache hit normally has to tag the new query's match expression with the
+ * cached index assignments and run it back through the access planner, which rebuilds every index
+ * bound from scratch. For the plans described here, binding a new query only has to copy the
+ * template and substitute its equality constants as point intervals, so the result can be handed
+ * straight to the stage builder.
+ *
+ * Only plans which answer a conjunction of equality predicates entirely from the bounds of a
+ * single btree index scan, with no residual filter, can be parameterized. Queries with a sort,
+ * skip, limit, min, max or returnKey are never parameterized, since those contribute stages whose
+ * arguments are not part of the query shape.
+ */
+class ParameterizedPlan {
+    ParameterizedPlan(const ParameterizedPlan&) = delete;
+    ParameterizedPlan& operator=(const ParameterizedPlan&) = delete;
+
+public:
+    /**
+     * Returns a template for 'solution', which the planner produced for 'query' with 'params', or
+     * nullptr if the solution cannot be parameterized.
+     */
+    static std::unique_ptr<ParameterizedPlan> make(const CanonicalQuery& query,
+                                                   const QueryPlannerParams& params,
+                                                   const QuerySolution& solution);
+
+    ~ParameterizedPlan();
+
+    /**
+     * Returns a solution for 'query', which must have the same shape as the query this template
+     * was made from, with its parameters bound to the constants of 'query'. Returns nullptr if
+     * 'query' or 'params' differ from the template in a way binding cannot express, for example
+     * an equality to an array or null, in which case the caller must plan the query normally.
+     */
+    std::unique_ptr<QuerySolution> bind(const CanonicalQuery& query,
+                                        const QueryPlannerParams& params) const;
+
+    uint64_t estimateObjectSizeInBytes() const;
+
+private:
+    ParameterizedPlan() = default;
+
+    std::unique_ptr<QuerySolutionNode> _root;
+    bool _hasBlockingStage = false;
+
+    // For each field of the index scan's bounds, the path of the equality predicate which supplies
+    // its point interval, or the empty string if the field is unbounded.
+    std::vector<std::string> _parameterPaths;
+    size_t _numParameters = 0;
+
+    // The template is only valid for queries with the same projection and planner options.
+    BSONObj _projection;
+    size_t _plannerOptions = 0;
+};
+
+}  // namespace mongo
@@ -0,0 +1,187 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/parameterized_plan.h"
+
+#include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/db/query/query_planner_test_fixture.h"
+#include "mongo/db/query/query_planner_test_lib.h"
+
+namespace {
+
+using namespace mongo;
+
+class ParameterizedPlanTest : public QueryPlannerTest {
+protected:
+    /**
+     * Makes a template from the only solution to the most recent query.
+     */
+    std::unique_ptr<ParameterizedPlan> makeTemplate() {
+        ASSERT_EQ(solns.size(), 1U);
+        return ParameterizedPlan::make(*cq, params, *solns.front());
+    }
+
+    void assertBoundSolutionMatches(const ParameterizedPlan& plan, const std::string& solnJson) {
+        auto solution = plan.bind(*cq, params);
+        ASSERT(solution);
+        ASSERT(QueryPlannerTestLib::solutionMatches(solnJson, solution->root.get()))
+            << solution->toString();
+    }
+};
+
+TEST_F(ParameterizedPlanTest, BindsEqualityConstantsIntoPointBounds) {
+    addIndex(BSON("a" << 1 << "b" << 1));
+
+    runQuery(fromjson("{a: 1, b: 2}"));
+    auto plan = makeTemplate();
+    ASSERT(plan);
+
+    runQuery(fromjson("{a: 5, b: 'x'}"));
+    assertBoundSolutionMatches(*plan,
+                               "{fetch: {filter: null, node: {ixscan: {pattern: {a: 1, b: 1}, "
+                               "bounds: {a: [[5,5,true,true]], b: [['x','x',true,true]]}}}}}");
+}
+
+TEST_F(ParameterizedPlanTest, TrailingIndexFieldsRemainUnbounded) {
+    addIndex(BSON("a" << 1 << "b" << -1));
+
+    runQuery(fromjson("{a: 1}"));
+    auto plan = makeTemplate();
+    ASSERT(plan);
+
+    runQuery(fromjson("{a: 7}"));
+    assertBoundSolutionMatches(*plan,
+                               "{fetch: {filter: null, node: {ixscan: {pattern: {a: 1, b: -1}, "
+                               "bounds: {a: [[7,7,true,true]], "
+                               "b: [['MaxKey','MinKey',true,true]]}}}}}");
+}
+
+TEST_F(ParameterizedPlanTest, BindsCoveredPlans) {
+    addIndex(BSON("a" << 1));
+
+    runQuerySortProj(fromjson("{a: 1}"), BSONObj(), fromjson("{_id: 0, a: 1}"));
+    auto plan = makeTemplate();
+    ASSERT(plan);
+
+    runQuerySortProj(fromjson("{a: 3}"), BSONObj(), fromjson("{_id: 0, a: 1}"));
+    assertBoundSolutionMatches(*plan,
+                               "{proj: {spec: {_id: 0, a: 1}, node: {ixscan: {pattern: {a: 1}, "
+                               "bounds: {a: [[3,3,true,true]]}}}}}");
+
+    // The projection is not fully described by the query shape, so it has to match exactly.
+    runQuerySortProj(fromjson("{a: 3}"), BSONObj(), fromjson("{a: 1, _id: 0}"));
+    ASSERT_FALSE(plan->bind(*cq, params));
+}
+
+TEST_F(ParameterizedPlanTest, BindsStringsUsingIndexCollation) {
+    CollatorInterfaceMock collator(CollatorInterfaceMock::MockType::kReverseString);
+    addIndex(BSON("a" << 1), &collator);
+
+    runQueryAsCommand(
+        fromjson("{find: 'testns', filter: {a: 'foo'}, collation: {locale: 'reverse'}}"));
+    auto plan = makeTemplate();
+    ASSERT(plan);
+
+    runQueryAsCommand(
+        fromjson("{find: 'testns', filter: {a: 'bar'}, collation: {locale: 'reverse'}}"));
+    assertBoundSolutionMatches(*plan,
+                               "{fetch: {filter: null, collation: {locale: 'reverse'}, node: "
+                               "{ixscan: {pattern: {a: 1}, bounds: {a: [['rab','rab',true,true]]}}}}}");
+}
+
+TEST_F(ParameterizedPlanTest, DoesNotParameterizeRangePredicates) {
+    addIndex(BSON("a" << 1));
+    runQuery(fromjson("{a: {$gt: 1}}"));
+    ASSERT_FALSE(makeTemplate());
+}
+
+TEST_F(ParameterizedPlanTest, DoesNotParameterizePlansWithResidualFilter) {
+    addIndex(BSON("a" << 1));
+    runQuery(fromjson("{a: 1, b: 2}"));
+    ASSERT_FALSE(makeTemplate());
+}
+
+TEST_F(ParameterizedPlanTest, DoesNotParameterizeQueriesWithLimit) {
+    addIndex(BSON("a" << 1));
+    runQuerySkipNToReturn(fromjson("{a: 1}"), 0, 5);
+    ASSERT_FALSE(makeTemplate());
+}
+
+TEST_F(ParameterizedPlanTest, DoesNotBindConstantsWhichAreNotPoints) {
+    addIndex(BSON("a" << 1));
+
+    runQuery(fromjson("{a: 1}"));
+    auto plan = makeTemplate();
+    ASSERT(plan);
+
+    runQuery(fromjson("{a: null}"));
+    ASSERT_FALSE(plan->bind(*cq, params));
+
+    runQuery(fromjson("{a: [1, 2]}"));
+    ASSERT_FALSE(plan->bind(*cq, params));
+}
+
+TEST_F(ParameterizedPlanTest, DoesNotBindQueriesWithLimit) {
+    addIndex(BSON("a" << 1));
+
+    runQuery(fromjson("{a: 1}"));
+    auto plan = makeTemplate();
+    ASSERT(plan);
+
+    runQuerySkipNToReturn(fromjson("{a: 2}"), 0, 5);
+    ASSERT_FALSE(plan->bind(*cq, params));
+}
+
+TEST_F(ParameterizedPlanTest, DoesNotBindAfterIndexBecomesMultikey) {
+    addIndex(BSON("a" << 1));
+
+    runQuery(fromjson("{a: 1}"));
+    auto plan = makeTemplate();
+    ASSERT(plan);
+
+    params.indices.back().multikey = true;
+    runQuery(fromjson("{a: 2}"));
+    ASSERT_FALSE(plan->bind(*cq, params));
+}
+
+TEST_F(ParameterizedPlanTest, DoesNotBindWithDifferentPlannerOptions) {
+    addIndex(BSON("a" << 1));
+
+    runQuery(fromjson("{a: 1}"));
+    auto plan = makeTemplate();
+    ASSERT(plan);
+
+    params.options |= QueryPlannerParams::NO_TABLE_SCAN;
+    runQuery(fromjson("{a: 2}"));
+    ASSERT_FALSE(plan->bind(*cq, params));
+}
+
+}  // namespace
@@ -47,10 +47,12 @@
 #include "mongo/db/matcher/expression_geo.h"
 #include "mongo/db/query/canonical_query_encoder.h"
 #include "mongo/db/query/collation/collator_interface.h"
+#include "mongo/db/query/parameterized_plan.h"
 #include "mongo/db/query/plan_ranker.h"
 #include "mongo/db/query/planner_ixselect.h"
 #include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_solution.h"
+#include "mongo/stdx/unordered_map.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/hex.h"
 #include "mongo/util/log.h"
@@ -62,6 +64,9 @@ namespace {
 ServerStatusMetricField<Counter64> totalPlanCacheSizeEstimateBytesMetric(
     "query.planCacheTotalSizeEstimateBytes", &PlanCacheEntry::planCacheTotalSizeEstimateBytes);
 
+// Source of PlanCacheEntry::id.
+AtomicWord<uint64_t> nextEntryId{0};
+
 // Delimiters for cache key encoding.
 const char kEncodeDiscriminatorsBegin = '<';
 const char kEncodeDiscriminatorsEnd = '>';
@@ -167,14 +172,21 @@ bool PlanCache::shouldCacheQuery(const CanonicalQuery& query) {
 // CachedSolution
 //
 
-CachedSolution::CachedSolution(const PlanCacheKey& key, const PlanCacheEntry& entry)
+CachedSolution::CachedSolution(const PlanCacheKey& key,
+                               const PlanCacheEntry& entry,
+                               size_t decisionWorks,
+                               std::shared_ptr<const ParameterizedPlan> parameterizedPlan,
+                               bool cannotParameterize)
     : plannerData(entry.plannerData.size()),
       key(key),
       query(entry.query.getOwned()),
       sort(entry.sort.getOwned()),
       projection(entry.projection.getOwned()),
       collation(entry.collation.getOwned()),
-      decisionWorks(entry.works) {
+      decisionWorks(decisionWorks),
+      entryId(entry.id),
+      parameterizedPlan(std::move(parameterizedPlan)),
+      cannotParameterize(cannotParameterize) {
     // CachedSolution should not having any references into
     // cache entry. All relevant data should be cloned/copied.
     for (size_t i = 0; i < entry.plannerData.size(); ++i) {
@@ -263,6 +275,7 @@ PlanCacheEntry::PlanCacheEntry(std::vector<std::unique_ptr<const SolutionCacheDa
       projection(projection),
       collation(collation),
       timeOfCreation(timeOfCreation),
+      id(nextEntryId.fetchAndAdd(1)),
       queryHash(queryHash),
       planCacheKey(planCacheKey),
       decision(std::move(decision)),
@@ -287,18 +300,33 @@ std::unique_ptr<PlanCacheEntry> PlanCacheEntry::clone() const {
     }
 
     auto decisionPtr = std::unique_ptr<PlanRankingDecision>(decision->clone());
-    return std::unique_ptr<PlanCacheEntry>(new PlanCacheEntry(std::move(solutionCacheData),
-                                                              query,
-                                                              sort,
-                                                              projection,
-                                                              collation,
-                                                              timeOfCreation,
-                                                              queryHash,
-                                                              planCacheKey,
-                                                              std::move(decisionPtr),
-                                                              feedback,
-                                                              isActive,
-                                                              works));
+    auto entry = std::unique_ptr<PlanCacheEntry>(new PlanCacheEntry(std::move(solutionCacheData),
+                                                                    query,
+                                                                    sort,
+                                                                    projection,
+                                                                    collation,
+                                                                    timeOfCreation,
+                                                                    queryHash,
+                                                                    planCacheKey,
+                                                                    std::move(decisionPtr),
+                                                                    feedback,
+                                                                    isActive,
+                                                                    works));
+    if (parameterizedPlan) {
+        entry->setParameterizedPlan(parameterizedPlan);
+    }
+    entry->cannotParameterize = cannotParameterize;
+    return entry;
+}
+
+void PlanCacheEntry::setParameterizedPlan(std::shared_ptr<const ParameterizedPlan> plan) {
+    invariant(plan);
+    invariant(!parameterizedPlan);
+
+    const uint64_t planSize = plan->estimateObjectSizeInBytes();
+    parameterizedPlan = std::move(plan);
+    _entireObjectSize += planSize;
+    planCacheTotalSizeEstimateBytes.increment(planSize);
 }
 
 uint64_t PlanCacheEntry::_estimateObjectSizeInBytes() const {
@@ -428,12 +456,97 @@ std::string SolutionCacheData::toString() const {
 // PlanCache
 //
 
+namespace {
+
+// Caches too small to give each partition at least this many entries use fewer partitions, so
+// that eviction stays close to least recently used across the whole cache.
+const size_t kMinEntriesPerPartition = 64;
+
+}  // namespace
+
+struct PlanCache::Partition {
+    struct Slot {
+        std::shared_ptr<PlanCacheEntry> entry;
+
+        // The value of the partition's 'clock' when the entry was last used.
+        uint64_t lastUsed;
+    };
+
+    using SlotMap = stdx::unordered_map<PlanCacheKey, Slot, PlanCacheKeyHasher>;
+
+    explicit Partition(size_t maxSize) : maxSize(maxSize) {}
+
+    /**
+     * Returns the entry for 'key' and marks it as the most recently used entry of the partition,
+     * or returns nullptr if there is no such entry. Using an entry only stamps its slot, so
+     * lookups never restructure the partition.
+     */
+    PlanCacheEntry* find(const PlanCacheKey& key) {
+        auto it = slots.find(key);
+        if (it == slots.end()) {
+            return nullptr;
+        }
+        it->second.lastUsed = ++clock;
+        return it->second.entry.get();
+    }
+
+    /**
+     * Adds 'entry' under 'key', replacing any existing entry for 'key'. If the partition has
+     * grown beyond its allowed size, the least recently used entry is removed and returned.
+     */
+    std::shared_ptr<PlanCacheEntry> add(const PlanCacheKey& key,
+                                        std::unique_ptr<PlanCacheEntry> entry) {
+        slots[key] = {std::move(entry), ++clock};
+        if (slots.size() <= maxSize) {
+            return nullptr;
+        }
+
+        // Eviction only follows the multi-planning of a new query shape, so a linear scan of the
+        // partition is cheap by comparison and spares lookups from maintaining an ordering.
+        auto victim = std::min_element(
+            slots.begin(), slots.end(), [](const auto& lhs, const auto& rhs) {
+                return lhs.second.lastUsed < rhs.second.lastUsed;
+            });
+        auto evicted = std::move(victim->second.entry);
+        slots.erase(victim);
+        return evicted;
+    }
+
+    // Protects the members below.
+    Mutex mutex = MONGO_MAKE_LATCH("PlanCache::Partition::mutex");
+
+    // The maximum number of entries in this partition.
+    const size_t maxSize;
+
+    // Incremented every time an entry is used.
+    uint64_t clock = 0;
+
+    // Entries are held by shared_ptr so that readers can copy an entry's immutable data after
+    // releasing 'mutex', even if the entry is concurrently evicted or replaced.
+    SlotMap slots;
+};
+
 PlanCache::PlanCache() : PlanCache(internalQueryCacheSize.load()) {}
 
-PlanCache::PlanCache(size_t size) : _cache(size) {}
+PlanCache::PlanCache(size_t size) {
+    const size_t numPartitions =
+        std::max(size_t{1},
+                 std::min(static_cast<size_t>(internalQueryCacheNumPartitions.load()),
+                          size / kMinEntriesPerPartition));
+    _partitions.reserve(numPartitions);
+    for (size_t i = 0; i < numPartitions; ++i) {
+        // Spread the remainder over the first partitions so that the sizes add up to 'size'.
+        const size_t partitionSize = size / numPartitions + (i < size % numPartitions ? 1 : 0);
+        _partitions.push_back(std::make_unique<Partition>(partitionSize));
+    }
+}
 
 PlanCache::~PlanCache() {}
 
+PlanCache::Partition& PlanCache::_getPartition(const PlanCacheKey& key) const {
+    return *_partitions[PlanCacheKeyHasher()(key) % _partitions.size()];
+}
+
 std::unique_ptr<CachedSolution> PlanCache::getCacheEntryIfActive(const PlanCacheKey& key) const {
 
     PlanCache::GetResult res = get(key);
@@ -553,7 +666,8 @@ Status PlanCache::set(const CanonicalQuery& query,
 
     const auto key = computeKey(query);
     const size_t newWorks = why->stats[0]->common.works;
-    stdx::lock_guard<Latch> cacheLock(_cacheMutex);
+    auto& partition = _getPartition(key);
+    stdx::lock_guard<Latch> partitionLock(partition.mutex);
     bool isNewEntryActive = false;
     uint32_t queryHash;
     uint32_t planCacheKey;
@@ -563,9 +677,7 @@ Status PlanCache::set(const CanonicalQuery& query,
         planCacheKey = canonical_query_encoder::computeHash(key.stringData());
         queryHash = canonical_query_encoder::computeHash(key.getStableKeyStringData());
     } else {
-        PlanCacheEntry* oldEntry = nullptr;
-        Status cacheStatus = _cache.get(key, &oldEntry);
-        invariant(cacheStatus.isOK() || cacheStatus == ErrorCodes::NoSuchKey);
+        PlanCacheEntry* oldEntry = partition.find(key);
         if (oldEntry) {
             queryHash = oldEntry->queryHash;
             planCacheKey = oldEntry->planCacheKey;
@@ -591,7 +703,7 @@ Status PlanCache::set(const CanonicalQuery& query,
     auto newEntry(PlanCacheEntry::create(
         solns, std::move(why), query, queryHash, planCacheKey, now, isNewEntryActive, newWorks));
 
-    std::unique_ptr<PlanCacheEntry> evictedEntry = _cache.add(key, newEntry.release());
+    auto evictedEntry = partition.add(key, std::move(newEntry));
 
     if (nullptr != evictedEntry.get()) {
         LOG(1) << query.nss() << ": plan cache maximum size exceeded - "
@@ -608,14 +720,12 @@ void PlanCache::deactivate(const CanonicalQuery& query) {
     }
 
     PlanCacheKey key = computeKey(query);
-    stdx::lock_guard<Latch> cacheLock(_cacheMutex);
-    PlanCacheEntry* entry = nullptr;
-    Status cacheStatus = _cache.get(key, &entry);
-    if (!cacheStatus.isOK()) {
-        invariant(cacheStatus == ErrorCodes::NoSuchKey);
+    auto& partition = _getPartition(key);
+    stdx::lock_guard<Latch> partitionLock(partition.mutex);
+    PlanCacheEntry* entry = partition.find(key);
+    if (!entry) {
         return;
     }
-    invariant(entry);
     entry->isActive = false;
 }
 
@@ -625,30 +735,64 @@ PlanCache::GetResult PlanCache::get(const CanonicalQuery& query) const {
 }
 
 PlanCache::GetResult PlanCache::get(const PlanCacheKey& key) const {
-    stdx::lock_guard<Latch> cacheLock(_cacheMutex);
-    PlanCacheEntry* entry = nullptr;
-    Status cacheStatus = _cache.get(key, &entry);
-    if (!cacheStatus.isOK()) {
-        invariant(cacheStatus == ErrorCodes::NoSuchKey);
-        return {CacheEntryState::kNotPresent, nullptr};
+    // Only read the mutable state of the entry under the partition lock. The planner data is
+    // immutable, so the comparatively expensive deep copy into the CachedSolution is made after
+    // the lock is released.
+    std::shared_ptr<const PlanCacheEntry> entry;
+    bool isActive;
+    size_t works;
+    std::shared_ptr<const ParameterizedPlan> parameterizedPlan;
+    bool cannotParameterize;
+    {
+        auto& partition = _getPartition(key);
+        stdx::lock_guard<Latch> partitionLock(partition.mutex);
+        auto it = partition.slots.find(key);
+        if (it == partition.slots.end()) {
+            return {CacheEntryState::kNotPresent, nullptr};
+        }
+        it->second.lastUsed = ++partition.clock;
+        entry = it->second.entry;
+        isActive = entry->isActive;
+        works = entry->works;
+        parameterizedPlan = entry->parameterizedPlan;
+        cannotParameterize = entry->cannotParameterize;
+    }
+
+    auto state = isActive ? CacheEntryState::kPresentActive : CacheEntryState::kPresentInactive;
+    return {state,
+            std::make_unique<CachedSolution>(
+                key, *entry, works, std::move(parameterizedPlan), cannotParameterize)};
+}
+
+void PlanCache::setParameterizedPlan(const CachedSolution& cachedSoln,
+                                     std::shared_ptr<const ParameterizedPlan> plan) {
+    auto& partition = _getPartition(cachedSoln.key);
+    stdx::lock_guard<Latch> partitionLock(partition.mutex);
+    PlanCacheEntry* entry = partition.find(cachedSoln.key);
+    if (!entry) {
+        return;
+    }
+
+    if (entry->id != cachedSoln.entryId || entry->parameterizedPlan) {
+        return;
     }
-    invariant(entry);
 
-    auto state =
-        entry->isActive ? CacheEntryState::kPresentActive : CacheEntryState::kPresentInactive;
-    return {state, std::make_unique<CachedSolution>(key, *entry)};
+    if (!plan) {
+        entry->cannotParameterize = true;
+        return;
+    }
+    entry->setParameterizedPlan(std::move(plan));
 }
 
 Status PlanCache::feedback(const CanonicalQuery& cq, double score) {
     PlanCacheKey ck = computeKey(cq);
 
-    stdx::lock_guard<Latch> cacheLock(_cacheMutex);
-    PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(ck, &entry);
-    if (!cacheStatus.isOK()) {
-        return cacheStatus;
+    auto& partition = _getPartition(ck);
+    stdx::lock_guard<Latch> partitionLock(partition.mutex);
+    PlanCacheEntry* entry = partition.find(ck);
+    if (!entry) {
+        return Status(ErrorCodes::NoSuchKey, "no such key in plan cache");
     }
-    invariant(entry);
 
     // We store up to a constant number of feedback entries.
     if (entry->feedback.size() < static_cast<size_t>(internalQueryCacheFeedbacksStored.load())) {
@@ -659,13 +803,20 @@ Status PlanCache::feedback(const CanonicalQuery& cq, double score) {
 }
 
 Status PlanCache::remove(const CanonicalQuery& canonicalQuery) {
-    stdx::lock_guard<Latch> cacheLock(_cacheMutex);
-    return _cache.remove(computeKey(canonicalQuery));
+    PlanCacheKey key = computeKey(canonicalQuery);
+    auto& partition = _getPartition(key);
+    stdx::lock_guard<Latch> partitionLock(partition.mutex);
+    if (!partition.slots.erase(key)) {
+        return Status(ErrorCodes::NoSuchKey, "no such key in plan cache");
+    }
+    return Status::OK();
 }
 
 void PlanCache::clear() {
-    stdx::lock_guard<Latch> cacheLock(_cacheMutex);
-    _cache.clear();
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<Latch> partitionLock(partition->mutex);
+        partition->slots.clear();
+    }
 }
 
 PlanCacheKey PlanCache::computeKey(const CanonicalQuery& cq) const {
@@ -679,32 +830,36 @@ PlanCacheKey PlanCache::computeKey(const CanonicalQuery& cq) const {
 StatusWith<std::unique_ptr<PlanCacheEntry>> PlanCache::getEntry(const CanonicalQuery& query) const {
     PlanCacheKey key = computeKey(query);
 
-    stdx::lock_guard<Latch> cacheLock(_cacheMutex);
-    PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(key, &entry);
-    if (!cacheStatus.isOK()) {
-        return cacheStatus;
+    auto& partition = _getPartition(key);
+    stdx::lock_guard<Latch> partitionLock(partition.mutex);
+    PlanCacheEntry* entry = partition.find(key);
+    if (!entry) {
+        return Status(ErrorCodes::NoSuchKey, "no such key in plan cache");
     }
-    invariant(entry);
 
     return std::unique_ptr<PlanCacheEntry>(entry->clone());
 }
 
 std::vector<std::unique_ptr<PlanCacheEntry>> PlanCache::getAllEntries() const {
-    stdx::lock_guard<Latch> cacheLock(_cacheMutex);
     std::vector<std::unique_ptr<PlanCacheEntry>> entries;
 
-    for (auto&& cacheEntry : _cache) {
-        auto entry = cacheEntry.second;
-        entries.push_back(std::unique_ptr<PlanCacheEntry>(entry->clone()));
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<Latch> partitionLock(partition->mutex);
+        for (auto&& slot : partition->slots) {
+            entries.push_back(slot.second.entry->clone());
+        }
     }
 
     return entries;
 }
 
 size_t PlanCache::size() const {
-    stdx::lock_guard<Latch> cacheLock(_cacheMutex);
-    return _cache.size();
+    size_t size = 0;
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<Latch> partitionLock(partition->mutex);
+        size += partition->slots.size();
+    }
+    return size;
 }
 
 void PlanCache::notifyOfIndexUpdates(const std::vector<CoreIndexInfo>& indexCores) {
@@ -715,13 +870,14 @@ std::vector<BSONObj> PlanCache::getMatchingStats(
     const std::function<BSONObj(const PlanCacheEntry&)>& serializationFunc,
     const std::function<bool(const BSONObj&)>& filterFunc) const {
     std::vector<BSONObj> results;
-    stdx::lock_guard<Latch> cacheLock(_cacheMutex);
 
-    for (auto&& cacheEntry : _cache) {
-        const auto entry = cacheEntry.second;
-        auto serializedEntry = serializationFunc(*entry);
-        if (filterFunc(serializedEntry)) {
-            results.push_back(serializedEntry);
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<Latch> partitionLock(partition->mutex);
+        for (auto&& slot : partition->slots) {
+            auto serializedEntry = serializationFunc(*slot.second.entry);
+            if (filterFunc(serializedEntry)) {
+                results.push_back(serializedEntry);
+            }
         }
     }
 
@@ -35,7 +35,6 @@
 #include "mongo/db/exec/plan_stats.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/index_tag.h"
-#include "mongo/db/query/lru_key_value.h"
 #include "mongo/db/query/plan_cache_indexability.h"
 #include "mongo/db/query/query_planner_params.h"
 #include "mongo/platform/atomic_word.h"
@@ -265,6 +264,7 @@ struct SolutionCacheData {
 };
 
 class PlanCacheEntry;
+class ParameterizedPlan;
 
 /**
  * Information returned from a get(...) query.
@@ -275,7 +275,16 @@ private:
     CachedSolution& operator=(const CachedSolution&) = delete;
 
 public:
-    CachedSolution(const PlanCacheKey& key, const PlanCacheEntry& entry);
+    /**
+     * Copies the planner data of 'entry'. The fields of 'entry' which may change while it is in
+     * the cache are not read; their values are passed in by the caller instead, which must have
+     * read them under the lock protecting 'entry'.
+     */
+    CachedSolution(const PlanCacheKey& key,
+                   const PlanCacheEntry& entry,
+                   size_t decisionWorks,
+                   std::shared_ptr<const ParameterizedPlan> parameterizedPlan,
+                   bool cannotParameterize);
     ~CachedSolution();
 
     // Owned here.
@@ -298,11 +307,25 @@ public:
     // The number of work cycles taken to decide on a winning plan when the plan was first
     // cached.
     size_t decisionWorks;
+
+    // Identifies the entry this solution was copied from.
+    uint64_t entryId;
+
+    // The winning plan in a form which can be bound to the constants of a new query, if the entry
+    // has one.
+    std::shared_ptr<const ParameterizedPlan> parameterizedPlan;
+
+    // True if the winning plan of the entry is known not to be parameterizable.
+    bool cannotParameterize;
 };
 
 /**
  * Used by the cache to track entries and their performance over time.
  * Also used by the plan cache commands to display plan cache state.
+ *
+ * The planner data and the other const members never change once the entry has been created, and
+ * may be read without synchronization by anyone holding a reference to the entry. The remaining
+ * members are protected by the lock of the cache partition which holds the entry.
  */
 class PlanCacheEntry {
 
@@ -331,6 +354,11 @@ public:
     // For debugging.
     std::string toString() const;
 
+    /**
+     * Attaches a parameterized form of the winning plan to the entry. May only be called once.
+     */
+    void setParameterizedPlan(std::shared_ptr<const ParameterizedPlan> plan);
+
     //
     // Planner data
     //
@@ -340,6 +368,15 @@ public:
     // it from the cache a deep copy is made and returned inside CachedSolution.
     const std::vector<std::unique_ptr<const SolutionCacheData>> plannerData;
 
+    // The winning plan in a form which can be bound to the constants of a new query. It is made
+    // from the solution planned for the first cache hit, and is null until then or if the winning
+    // plan cannot be parameterized.
+    std::shared_ptr<const ParameterizedPlan> parameterizedPlan;
+
+    // Set once the first cache hit has found that the winning plan cannot be parameterized, so
+    // that later hits do not try again.
+    bool cannotParameterize = false;
+
     // TODO: Do we really want to just hold a copy of the CanonicalQuery?  For now we just
     // extract the data we need.
     //
@@ -351,6 +388,9 @@ public:
     const BSONObj collation;
     const Date_t timeOfCreation;
 
+    // Unique to this entry among all the entries created by this process.
+    const uint64_t id;
+
     // Hash of the PlanCacheKey. Intended as an identifier for the query shape in logs and other
     // diagnostic output.
     const uint32_t queryHash;
@@ -408,7 +448,7 @@ private:
 
     // The total runtime size of the current object in bytes. This is the deep size, obtained by
     // recursively following references to all owned objects.
-    const uint64_t _entireObjectSize;
+    uint64_t _entireObjectSize;
 };
 
 /**
@@ -516,6 +556,14 @@ public:
      */
     std::unique_ptr<CachedSolution> getCacheEntryIfActive(const PlanCacheKey& key) const;
 
+    /**
+     * Attaches 'plan' to the entry from which 'cachedSoln' was copied, unless that entry has since
+     * been replaced or already has a parameterized plan. A null 'plan' records that the winning
+     * plan of the entry cannot be parameterized.
+     */
+    void setParameterizedPlan(const CachedSolution& cachedSoln,
+                              std::shared_ptr<const ParameterizedPlan> plan);
+
 
     /**
      * When the CachedPlanStage runs a plan out of the cache, we want to record data about the
@@ -562,7 +610,7 @@ public:
     StatusWith<std::unique_ptr<PlanCacheEntry>> getEntry(const CanonicalQuery& cq) const;
 
     /**
-     * Returns a vector of all cache entries.
+     * Returns a vector of all cache entries, in no particular order.
      * Used by planCacheListQueryShapes and index_filter_commands_test.cpp.
      */
     std::vector<std::unique_ptr<PlanCacheEntry>> getAllEntries() const;
@@ -602,10 +650,18 @@ private:
                                    size_t newWorks,
                                    double growthCoefficient);
 
-    LRUKeyValue<PlanCacheKey, PlanCacheEntry, PlanCacheKeyHasher> _cache;
+    struct Partition;
+
+    /**
+     * Returns the partition responsible for 'key'.
+     */
+    Partition& _getPartition(const PlanCacheKey& key) const;
 
-    // Protects _cache.
-    mutable Mutex _cacheMutex = MONGO_MAKE_LATCH("PlanCache::_cacheMutex");
+    // The cache is split into independently locked partitions, chosen by the hash of the cache
+    // key, so that lookups of different query shapes do not contend with each other. Each
+    // partition holds an equal share of the entries allowed in the cache and evicts its own
+    // least recently used entry when it is full.
+    std::vector<std::unique_ptr<Partition>> _partitions;
 
     // Holds computed information about the collection's indexes.  Used for generating plan
     // cache keys.
@@ -0,0 +1,153 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/db/exec/plan_stats.h"
+#include "mongo/db/matcher/extensions_callback_noop.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_ranker.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/db/query/query_test_service_context.h"
+#include "mongo/util/processinfo.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("test.collection");
+
+// The number of distinct query shapes held in the cache.
+const int kNumShapes = 256;
+
+std::unique_ptr<CanonicalQuery> canonicalize(OperationContext* opCtx, const BSONObj& filter) {
+    auto qr = std::make_unique<QueryRequest>(kNss);
+    qr->setFilter(filter);
+    return uassertStatusOK(
+        CanonicalQuery::canonicalize(opCtx,
+                                     std::move(qr),
+                                     nullptr,
+                                     ExtensionsCallbackNoop(),
+                                     MatchExpressionParser::kAllowAllSpecialFeatures));
+}
+
+std::unique_ptr<PlanRankingDecision> makeDecision() {
+    auto why = std::make_unique<PlanRankingDecision>();
+    why->stats.push_back(
+        std::make_unique<PlanStageStats>(CommonStats("COLLSCAN"), STAGE_COLLSCAN));
+    why->scores.push_back(0);
+    why->candidateOrder.push_back(0);
+    return why;
+}
+
+/**
+ * A plan cache shared by all threads of a benchmark, holding 'kNumShapes' active entries.
+ */
+struct PopulatedPlanCache {
+    explicit PopulatedPlanCache(int numPartitions) {
+        internalQueryCacheNumPartitions.store(numPartitions);
+        cache = std::make_unique<PlanCache>();
+
+        QueryTestServiceContext serviceContext;
+        auto opCtx = serviceContext.makeOperationContext();
+        for (int i = 0; i < kNumShapes; ++i) {
+            auto cq = canonicalize(opCtx.get(), BSON(("a" + std::to_string(i)) << 1));
+            QuerySolution qs;
+            qs.cacheData = std::make_unique<SolutionCacheData>();
+            qs.cacheData->tree = std::make_unique<PlanCacheIndexTree>();
+            std::vector<QuerySolution*> solns = {&qs};
+            uassertStatusOK(cache->set(*cq, solns, makeDecision(), Date_t{}));
+            uassertStatusOK(cache->set(*cq, solns, makeDecision(), Date_t{}));
+            keys.push_back(cache->computeKey(*cq));
+        }
+    }
+
+    std::unique_ptr<PlanCache> cache;
+    std::vector<PlanCacheKey> keys;
+};
+
+/**
+ * Benchmarks cache hits when every thread looks up the same query shape. The argument is the
+ * number of partitions the cache is split into.
+ */
+void BM_PlanCacheGetSameShape(benchmark::State& state) {
+    static std::unique_ptr<PopulatedPlanCache> planCache;
+    if (state.thread_index == 0) {
+        planCache = std::make_unique<PopulatedPlanCache>(state.range(0));
+    }
+
+    for (auto keepRunning : state) {
+        benchmark::DoNotOptimize(planCache->cache->get(planCache->keys[0]));
+    }
+
+    if (state.thread_index == 0) {
+        planCache.reset();
+        internalQueryCacheNumPartitions.store(16);
+    }
+}
+
+/**
+ * Benchmarks cache hits when the threads cycle through all of the cached query shapes, each
+ * starting from a different one. The argument is the number of partitions the cache is split
+ * into.
+ */
+void BM_PlanCacheGetDistinctShapes(benchmark::State& state) {
+    static std::unique_ptr<PopulatedPlanCache> planCache;
+    if (state.thread_index == 0) {
+        planCache = std::make_unique<PopulatedPlanCache>(state.range(0));
+    }
+
+    size_t next = state.thread_index * 17;
+    for (auto keepRunning : state) {
+        benchmark::DoNotOptimize(planCache->cache->get(planCache->keys[next++ % kNumShapes]));
+    }
+
+    if (state.thread_index == 0) {
+        planCache.reset();
+        internalQueryCacheNumPartitions.store(16);
+    }
+}
+
+BENCHMARK(BM_PlanCacheGetSameShape)
+    ->ThreadRange(1, ProcessInfo::getNumAvailableCores())
+    ->ArgName("partitions")
+    ->Arg(1)
+    ->Arg(16);
+
+BENCHMARK(BM_PlanCacheGetDistinctShapes)
+    ->ThreadRange(1, ProcessInfo::getNumAvailableCores())
+    ->ArgName("partitions")
+    ->Arg(1)
+    ->Arg(16);
+
+}  // namespace
+}  // namespace mongo
@@ -567,6 +567,46 @@ TEST(PlanCacheTest, PlanCacheLRUPolicyRemovesInactiveEntries) {
     ASSERT_EQ(planCache.get(*cqC).state, PlanCache::CacheEntryState::kPresentInactive);
 }
 
+TEST(PlanCacheTest, PartitionedCacheHoldsConfiguredNumberOfEntries) {
+    internalQueryCacheNumPartitions.store(16);
+    ON_BLOCK_EXIT([] { internalQueryCacheNumPartitions.store(16); });
+
+    // Large enough for the cache to be split into the configured number of partitions.
+    const size_t kCacheSize = 1024;
+    PlanCache planCache(kCacheSize);
+    QueryTestServiceContext serviceContext;
+
+    for (size_t i = 0; i < 2 * kCacheSize; ++i) {
+        unique_ptr<CanonicalQuery> cq(canonicalize(BSON(("a" + std::to_string(i)) << 1)));
+        addCacheEntryForShape(*cq, &planCache);
+    }
+    ASSERT_EQ(planCache.size(), kCacheSize);
+
+    planCache.clear();
+    ASSERT_EQ(planCache.size(), 0U);
+}
+
+TEST(PlanCacheTest, PartitionedCacheKeepsRecentlyUsedEntries) {
+    internalQueryCacheNumPartitions.store(2);
+    ON_BLOCK_EXIT([] { internalQueryCacheNumPartitions.store(16); });
+
+    const size_t kCacheSize = 128;
+    PlanCache planCache(kCacheSize);
+    QueryTestServiceContext serviceContext;
+
+    unique_ptr<CanonicalQuery> cqHot(canonicalize("{hot: 1}"));
+    addCacheEntryForShape(*cqHot, &planCache);
+
+    // Fill the cache several times over. Since the {hot: 1} entry is used after every insertion,
+    // it is never the least recently used entry of its partition and must not be evicted.
+    for (size_t i = 0; i < 4 * kCacheSize; ++i) {
+        unique_ptr<CanonicalQuery> cq(canonicalize(BSON(("a" + std::to_string(i)) << 1)));
+        addCacheEntryForShape(*cq, &planCache);
+        ASSERT_EQ(planCache.get(*cqHot).state, PlanCache::CacheEntryState::kPresentInactive);
+    }
+    ASSERT_EQ(planCache.size(), kCacheSize);
+}
+
 TEST(PlanCacheTest, PlanCacheRemoveDeletesInactiveEntries) {
     PlanCache planCache;
     unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
@@ -789,6 +829,30 @@ TEST(PlanCacheTest, SetOverwritesWhenNewEntryIsBetter) {
     ASSERT_EQ(entry->works, 10U);
 }
 
+TEST(PlanCacheTest, CannotParameterizeIsRecordedOnlyOnTheEntryItWasFoundFor) {
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+    auto qs = getQuerySolutionForCaching();
+    std::vector<QuerySolution*> solns = {qs.get()};
+
+    QueryTestServiceContext serviceContext;
+    ASSERT_OK(planCache.set(*cq, solns, createDecision(1U, 20), Date_t{}));
+    auto oldSoln = std::move(planCache.get(*cq).cachedSolution);
+    ASSERT_FALSE(oldSoln->cannotParameterize);
+
+    // Replace the entry with one created at the same time.
+    ASSERT_OK(planCache.set(*cq, solns, createDecision(1U, 10), Date_t{}));
+    auto newSoln = std::move(planCache.get(*cq).cachedSolution);
+    ASSERT_NE(oldSoln->entryId, newSoln->entryId);
+
+    // The replaced entry is not the one which is marked.
+    planCache.setParameterizedPlan(*oldSoln, nullptr);
+    ASSERT_FALSE(planCache.get(*cq).cachedSolution->cannotParameterize);
+
+    planCache.setParameterizedPlan(*newSoln, nullptr);
+    ASSERT_TRUE(planCache.get(*cq).cachedSolution->cannotParameterize);
+}
+
 TEST(PlanCacheTest, DeactivateCacheEntry) {
     PlanCache planCache;
     unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
@@ -1134,7 +1198,7 @@ protected:
         uint32_t planCacheKey = queryHash;
         auto entry = PlanCacheEntry::create(
             solutions, createDecision(1U), *scopedCq, queryHash, planCacheKey, Date_t(), false, 0);
-        CachedSolution cachedSoln(ck, *entry);
+        CachedSolution cachedSoln(ck, *entry, entry->works, entry->parameterizedPlan, false);
 
         auto statusWithQs = QueryPlanner::planFromCache(*scopedCq, params, cachedSoln);
         ASSERT_OK(statusWithQs.getStatus());
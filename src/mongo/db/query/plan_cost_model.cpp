@@ -0,0 +1,187 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/plan_cost_model.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/collection_query_info.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+namespace plan_cost_model {
+
+namespace {
+
+constexpr double kIndexKeyCost = 1.0;
+constexpr double kFetchCost = 1.0;
+constexpr double kCollectionScanRecordCost = 1.0;
+
+/**
+ * The histogram describes only the leading field of the index, so a scan can be estimated only if
+ * every other field is unbounded. Constraining a trailing field would make the estimate an upper
+ * bound, which could wrongly prune a selective compound index in favour of a less selective one.
+ */
+boost::optional<double> estimateKeysExamined(const Collection* collection,
+                                             const IndexScanNode& ixn) {
+    if (ixn.index.type != INDEX_BTREE || ixn.bounds.isSimpleRange || ixn.bounds.fields.empty()) {
+        return boost::none;
+    }
+
+    for (size_t i = 1; i < ixn.bounds.fields.size(); ++i) {
+        if (!ixn.bounds.fields[i].isMinToMax()) {
+            return boost::none;
+        }
+    }
+
+    auto stats = CollectionQueryInfo::get(collection)
+                     .getIndexStatistics(ixn.index.identifier.catalogName);
+    if (!stats) {
+        return boost::none;
+    }
+    return stats->estimateKeys(ixn.bounds.fields.front());
+}
+
+}  // namespace
+
+boost::optional<Estimate> estimate(OperationContext* opCtx,
+                                   const Collection* collection,
+                                   QuerySolutionNode* node) {
+    switch (node->getType()) {
+        case STAGE_IXSCAN: {
+            auto ixn = static_cast<IndexScanNode*>(node);
+            ixn->estimatedKeysExamined = estimateKeysExamined(collection, *ixn);
+            if (!ixn->estimatedKeysExamined) {
+                return boost::none;
+            }
+            const double numKeys = *ixn->estimatedKeysExamined;
+            return Estimate{numKeys * kIndexKeyCost, numKeys};
+        }
+        case STAGE_COLLSCAN: {
+            const double numRecords = collection->numRecords(opCtx);
+            return Estimate{numRecords * kCollectionScanRecordCost, numRecords};
+        }
+        case STAGE_FETCH: {
+            auto child = estimate(opCtx, collection, node->children[0]);
+            if (!child) {
+                return boost::none;
+            }
+            return Estimate{child->cost + child->cardinality * kFetchCost, child->cardinality};
+        }
+        case STAGE_AND_HASH:
+        case STAGE_AND_SORTED:
+        case STAGE_OR:
+        case STAGE_SORT_MERGE: {
+            const bool isIntersection =
+                node->getType() == STAGE_AND_HASH || node->getType() == STAGE_AND_SORTED;
+
+            // Estimate every child, even after one fails, so that explain reports as many index
+            // scan estimates as possible.
+            boost::optional<Estimate> result = Estimate{0, 0};
+            for (size_t i = 0; i < node->children.size(); ++i) {
+                auto child = estimate(opCtx, collection, node->children[i]);
+                if (!child || !result) {
+                    result = boost::none;
+                    continue;
+                }
+                result->cost += child->cost;
+                result->cardinality = isIntersection && i > 0
+                    ? std::min(result->cardinality, child->cardinality)
+                    : result->cardinality + child->cardinality;
+            }
+            return result;
+        }
+        case STAGE_PROJECTION_DEFAULT:
+        case STAGE_PROJECTION_COVERED:
+        case STAGE_PROJECTION_SIMPLE:
+        case STAGE_SHARDING_FILTER:
+            return estimate(opCtx, collection, node->children[0]);
+        default:
+            return boost::none;
+    }
+}
+
+void pruneSolutions(OperationContext* opCtx,
+                    const Collection* collection,
+                    const CanonicalQuery& query,
+                    std::vector<std::unique_ptr<QuerySolution>>* solutions) {
+    const double ratio = internalQueryCostBasedPlanSelectionRatio.load();
+    if (ratio <= 0) {
+        return;
+    }
+
+    std::vector<boost::optional<Estimate>> estimates;
+    for (auto&& solution : *solutions) {
+        estimates.push_back(estimate(opCtx, collection, solution->root.get()));
+    }
+
+    const auto& qr = query.getQueryRequest();
+    if (solutions->size() < 2 || !qr.getSort().isEmpty() || qr.getSkip() || qr.getLimit() ||
+        qr.getNToReturn()) {
+        return;
+    }
+
+    double bestCost = std::numeric_limits<double>::max();
+    for (auto&& est : estimates) {
+        if (!est) {
+            return;
+        }
+        bestCost = std::min(bestCost, est->cost);
+    }
+
+    // Always keep at least one unit of work's worth of headroom, so that plans which are all
+    // estimated to be nearly free are left to the trial period.
+    const double maxCost = std::max(bestCost, 1.0) * ratio;
+
+    std::vector<std::unique_ptr<QuerySolution>> survivors;
+    for (size_t i = 0; i < solutions->size(); ++i) {
+        if (estimates[i]->cost <= maxCost) {
+            survivors.push_back(std::move((*solutions)[i]));
+        }
+    }
+
+    if (survivors.size() < solutions->size()) {
+        LOG(2) << "Cost model discarded " << (solutions->size() - survivors.size()) << " of "
+               << solutions->size() << " candidate plans for query "
+               << redact(query.toStringShort());
+    }
+    *solutions = std::move(survivors);
+}
+
+}  // namespace plan_cost_model
+}  // namespace mongo
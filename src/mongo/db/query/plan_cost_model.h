@@ -0,0 +1,83 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <memory>
+#include <vector>
+
+namespace mongo {
+
+class CanonicalQuery;
+class Collection;
+class OperationContext;
+struct QuerySolution;
+struct QuerySolutionNode;
+
+/**
+ * A cost model for candidate query plans, driven by the index statistics collected by the analyze
+ * command. It lets the planner discard candidates that are clearly worse than another before they
+ * are trial-run by the MultiPlanStage, and skip the trial period entirely when a single candidate
+ * is left.
+ *
+ * Costs are expressed in abstract units of work: one unit for each index key examined, each
+ * document fetched and each record read by a collection scan.
+ */
+namespace plan_cost_model {
+
+struct Estimate {
+    double cost;
+    double cardinality;
+};
+
+/**
+ * Estimates the cost of executing the plan rooted at 'node' and the number of results it will
+ * produce, recording the expected number of keys examined on every index scan it can estimate.
+ * Returns boost::none if the plan contains a stage the model does not understand, or an index
+ * scan over an index for which no statistics have been collected.
+ */
+boost::optional<Estimate> estimate(OperationContext* opCtx,
+                                   const Collection* collection,
+                                   QuerySolutionNode* node);
+
+/**
+ * Estimates every candidate in 'solutions' and, if there are several and all of them could be
+ * estimated, removes those whose cost exceeds 'internalQueryCostBasedPlanSelectionRatio' times that
+ * of the cheapest. Queries with a sort, skip or limit are left untouched, since a plan which
+ * produces results in the requested order or stops early may do far less work than its estimate
+ * suggests. Does nothing while the ratio is zero, which is the default.
+ */
+void pruneSolutions(OperationContext* opCtx,
+                    const Collection* collection,
+                    const CanonicalQuery& query,
+                    std::vector<std::unique_ptr<QuerySolution>>* solutions);
+
+}  // namespace plan_cost_model
+}  // namespace mongo
@@ -826,6 +826,7 @@ QuerySolutionNode* IndexScanNode::clone() const {
     copy->addKeyMetadata = this->addKeyMetadata;
     copy->bounds = this->bounds;
     copy->queryCollator = this->queryCollator;
+    copy->estimatedKeysExamined = this->estimatedKeysExamined;
 
     return copy;
 }
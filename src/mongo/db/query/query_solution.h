@@ -538,6 +538,10 @@ struct IndexScanNode : public QuerySolutionNode {
     //
     // The correct set of paths is computed and stored here by computeProperties().
     std::set<StringData> multikeyFields;
+
+    // The number of keys this scan is expected to examine, as estimated by the cost model from the
+    // index's statistics. Unset if the index has no statistics.
+    boost::optional<double> estimatedKeysExamined;
 };
 
 struct ReturnKeyNode : public QuerySolutionNode {
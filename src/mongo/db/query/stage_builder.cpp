@@ -111,6 +111,7 @@ std::unique_ptr<PlanStage> buildStages(OperationContext* opCtx,
             params.direction = ixn->direction;
             params.addKeyMetadata = ixn->addKeyMetadata;
             params.shouldDedup = ixn->shouldDedup;
+            params.estimatedKeysExamined = ixn->estimatedKeysExamined;
             return std::make_unique<IndexScan>(opCtx, std::move(params), ws, ixn->filter.get());
         }
         case STAGE_FETCH: {
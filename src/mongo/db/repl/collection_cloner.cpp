@@ -33,6 +33,7 @@
 
 #include "mongo/db/repl/collection_cloner.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "mongo/base/string_data.h"
@@ -41,12 +42,15 @@
 #include "mongo/client/remote_command_retry_scheduler.h"
 #include "mongo/db/catalog/collection_options.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/db/json.h"
 #include "mongo/db/query/cursor_response.h"
+#include "mongo/db/repl/collection_cloner_gen.h"
 #include "mongo/db/repl/repl_server_parameters_gen.h"
 #include "mongo/db/repl/replication_auth.h"
 #include "mongo/db/repl/storage_interface.h"
 #include "mongo/db/repl/storage_interface_mock.h"
 #include "mongo/rpc/get_status_from_command_result.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/destructor_guard.h"
 #include "mongo/util/fail_point.h"
@@ -66,8 +70,69 @@ constexpr auto kCountResponseDocumentCountFieldName = "n"_sd;
 const int kProgressMeterSecondsBetween = 60;
 const int kProgressMeterCheckInterval = 128;
 
+// The limits of collectionClonerMaxParallelRanges, which each collection's own limit shares.
+const long long kMinParallelRanges = 1;
+const long long kMaxParallelRanges = 64;
+
+// The value of collectionClonerMaxParallelRangesByCollection.
+auto maxParallelRangesByCollectionMutex =
+    MONGO_MAKE_LATCH("CollectionCloner::maxParallelRangesByCollectionMutex");
+BSONObj maxParallelRangesByCollection;
+
+Status setMaxParallelRangesByCollection(const BSONObj& newValue) {
+    for (auto&& elem : newValue) {
+        if (!elem.isNumber() || elem.safeNumberLong() < kMinParallelRanges ||
+            elem.safeNumberLong() > kMaxParallelRanges) {
+            return {ErrorCodes::BadValue,
+                    str::stream() << "The maximum number of parallel ranges of '"
+                                  << elem.fieldNameStringData() << "' must be a number from "
+                                  << kMinParallelRanges << " to " << kMaxParallelRanges};
+        }
+    }
+
+    LockGuard lk(maxParallelRangesByCollectionMutex);
+    maxParallelRangesByCollection = newValue.getOwned();
+    return Status::OK();
+}
+
+/**
+ * Returns the maximum number of ranges of 'nss' to clone concurrently.
+ */
+long long getMaxParallelRanges(const NamespaceString& nss) {
+    {
+        LockGuard lk(maxParallelRangesByCollectionMutex);
+        auto elem = maxParallelRangesByCollection[nss.ns()];
+        if (elem) {
+            return elem.safeNumberLong();
+        }
+    }
+    return collectionClonerMaxParallelRanges.load();
+}
+
 }  // namespace
 
+void CollectionClonerMaxParallelRangesByCollectionServerParameter::append(
+    OperationContext*, BSONObjBuilder& builder, const std::string& name) {
+    LockGuard lk(maxParallelRangesByCollectionMutex);
+    builder.append(name, maxParallelRangesByCollection);
+}
+
+Status CollectionClonerMaxParallelRangesByCollectionServerParameter::set(
+    const BSONElement& newValueElement) {
+    if (newValueElement.type() != BSONType::Object) {
+        return {ErrorCodes::TypeMismatch,
+                str::stream() << "Invalid value for " << name() << ": " << newValueElement};
+    }
+    return setMaxParallelRangesByCollection(newValueElement.Obj());
+}
+
+Status CollectionClonerMaxParallelRangesByCollectionServerParameter::setFromString(
+    const std::string& str) try {
+    return setMaxParallelRangesByCollection(fromjson(str));
+} catch (const DBException& ex) {
+    return ex.toStatus();
+}
+
 // Failpoint which causes initial sync to hang before establishing its cursor to clone the
 // 'namespace' collection.
 MONGO_FAIL_POINT_DEFINE(initialSyncHangBeforeCollectionClone);
@@ -256,6 +321,9 @@ void CollectionCloner::_cancelRemainingWork_inlock() {
     if (_queryState == QueryState::kRunning) {
         _queryState = QueryState::kCanceling;
         _clientConnection->shutdownAndDisallowReconnect();
+        for (auto&& conn : _rangeClientConnections) {
+            conn->shutdownAndDisallowReconnect();
+        }
     } else {
         _queryState = QueryState::kFinished;
     }
@@ -538,20 +606,18 @@ void CollectionCloner::_runQuery(const executor::TaskExecutor::CallbackArgs& cal
         return;
     }
 
-    try {
-        _clientConnection->query(
-            [this, onCompletionGuard](DBClientCursorBatchIterator& iter) {
-                _handleNextBatch(onCompletionGuard, iter);
-            },
-            NamespaceStringOrUUID(_sourceNss.db().toString(), *_options.uuid),
-            QUERY("query" << BSONObj() << "$readOnce" << true),
-            nullptr /* fieldsToReturn */,
-            QueryOption_NoCursorTimeout | QueryOption_SlaveOk |
-                (collectionClonerUsesExhaust ? QueryOption_Exhaust : 0),
-            _collectionClonerBatchSize);
-    } catch (const DBException& e) {
-        auto queryStatus = e.toStatus().withContext(str::stream() << "Error querying collection '"
-                                                                  << _sourceNss.ns());
+    const auto ranges = _splitIntoRanges(_clientConnection.get());
+    {
+        stdx::lock_guard<Latch> lock(_mutex);
+        _stats.ranges = ranges.size();
+    }
+
+    auto queryStatus = ranges.size() == 1
+        ? _queryRange(_clientConnection.get(), ranges.front(), onCompletionGuard)
+        : _queryRangesInParallel(ranges, onCompletionGuard);
+    if (!queryStatus.isOK()) {
+        queryStatus = queryStatus.withContext(str::stream() << "Error querying collection '"
+                                                            << _sourceNss.ns());
         stdx::unique_lock<Latch> lock(_mutex);
         if (queryStatus.code() == ErrorCodes::OperationFailed ||
             queryStatus.code() == ErrorCodes::CursorNotFound ||
@@ -576,11 +642,163 @@ void CollectionCloner::_runQuery(const executor::TaskExecutor::CallbackArgs& cal
     onCompletionGuard->setResultAndCancelRemainingWork_inlock(lock, Status::OK());
 }
 
+std::vector<CollectionCloner::IdRange> CollectionCloner::_splitIntoRanges(
+    DBClientConnection* conn) {
+    std::vector<IdRange> ranges(1);
+
+    long long documentsToCopy;
+    {
+        stdx::lock_guard<Latch> lock(_mutex);
+        documentsToCopy = _stats.documentToCopy;
+    }
+    const long long numRanges =
+        std::min<long long>(getMaxParallelRanges(_sourceNss),
+                            documentsToCopy / collectionClonerMinDocumentsPerRange.load());
+
+    // Capped collections must be inserted in their natural order, and the ranges are taken from
+    // the _id index.
+    if (numRanges < 2 || _options.capped || _idIndexSpec.isEmpty()) {
+        return ranges;
+    }
+
+    const auto dbName = _sourceNss.db().toString();
+    try {
+        BSONObj collStats;
+        if (!conn->runCommand(dbName, BSON("collStats" << _sourceNss.coll()), collStats)) {
+            uassertStatusOK(getStatusFromCommandResult(collStats));
+        }
+        const long long dataSize = collStats["size"].safeNumberLong();
+        const long long count = collStats["count"].safeNumberLong();
+        if (dataSize <= 0 || count < numRanges) {
+            return ranges;
+        }
+
+        // splitVector places a split point every min(maxChunkSizeBytes / (2 * avgObjSize),
+        // maxChunkObjects) keys. With the chunk size set to the size of the whole collection, the
+        // object limit is the one which applies.
+        BSONObj splitVectorResult;
+        if (!conn->runCommand(dbName,
+                              BSON("splitVector" << _sourceNss.ns() << "keyPattern"
+                                                 << BSON("_id" << 1) << "maxChunkSizeBytes"
+                                                 << dataSize << "maxChunkObjects"
+                                                 << count / numRanges << "maxSplitPoints"
+                                                 << numRanges - 1),
+                              splitVectorResult)) {
+            uassertStatusOK(getStatusFromCommandResult(splitVectorResult));
+        }
+
+        for (auto&& splitKey : splitVectorResult["splitKeys"].Array()) {
+            if (static_cast<long long>(ranges.size()) == numRanges) {
+                break;
+            }
+            ranges.back().max = splitKey.Obj().getOwned();
+            ranges.push_back({ranges.back().max, BSONObj()});
+        }
+    } catch (const DBException& e) {
+        log() << "CollectionCloner ns: '" << _sourceNss.ns()
+              << "' could not be split into ranges and will be cloned with a single query: "
+              << redact(e.toStatus());
+        return std::vector<IdRange>(1);
+    }
+
+    LOG(1) << "CollectionCloner ns: '" << _sourceNss.ns() << "' will clone " << ranges.size()
+           << " ranges of _id in parallel";
+    return ranges;
+}
+
+Status CollectionCloner::_queryRange(DBClientConnection* conn,
+                                     const IdRange& range,
+                                     std::shared_ptr<OnCompletionGuard> onCompletionGuard) {
+    BSONObjBuilder queryBob;
+    queryBob.append("query", BSONObj());
+    queryBob.append("$readOnce", true);
+    if (!range.min.isEmpty() || !range.max.isEmpty()) {
+        queryBob.append("$hint", BSON("_id" << 1));
+        if (!range.min.isEmpty()) {
+            queryBob.append("$min", range.min);
+        }
+        if (!range.max.isEmpty()) {
+            queryBob.append("$max", range.max);
+        }
+    }
+
+    try {
+        conn->query(
+            [this, onCompletionGuard](DBClientCursorBatchIterator& iter) {
+                _handleNextBatch(onCompletionGuard, iter);
+            },
+            NamespaceStringOrUUID(_sourceNss.db().toString(), *_options.uuid),
+            Query(queryBob.obj()),
+            nullptr /* fieldsToReturn */,
+            QueryOption_NoCursorTimeout | QueryOption_SlaveOk |
+                (collectionClonerUsesExhaust ? QueryOption_Exhaust : 0),
+            _collectionClonerBatchSize);
+    } catch (const DBException& e) {
+        return e.toStatus();
+    }
+    return Status::OK();
+}
+
+Status CollectionCloner::_queryRangesInParallel(
+    const std::vector<IdRange>& ranges, std::shared_ptr<OnCompletionGuard> onCompletionGuard) {
+    std::vector<DBClientConnection*> conns;
+    {
+        stdx::lock_guard<Latch> lock(_mutex);
+        if (_queryState != QueryState::kRunning) {
+            return {ErrorCodes::CallbackCanceled, "Collection cloning cancelled."};
+        }
+        for (size_t i = 1; i < ranges.size(); ++i) {
+            _rangeClientConnections.push_back(_createClientFn());
+            conns.push_back(_rangeClientConnections.back().get());
+        }
+    }
+
+    // Records the first error and interrupts the queries for all other ranges.
+    Status firstError = Status::OK();
+    auto onRangeDone = [&](Status status) {
+        if (status.isOK()) {
+            return;
+        }
+        stdx::lock_guard<Latch> lock(_mutex);
+        if (!firstError.isOK()) {
+            return;
+        }
+        firstError = status;
+        _clientConnection->shutdownAndDisallowReconnect();
+        for (auto&& conn : _rangeClientConnections) {
+            conn->shutdownAndDisallowReconnect();
+        }
+    };
+
+    std::vector<stdx::thread> threads;
+    for (size_t i = 1; i < ranges.size(); ++i) {
+        threads.emplace_back([&, conn = conns[i - 1], range = ranges[i] ] {
+            try {
+                uassertStatusOK(conn->connect(_source, StringData()));
+                uassert(ErrorCodes::AuthenticationFailed,
+                        str::stream() << "Failed to authenticate to " << _source,
+                        replAuthenticate(conn));
+                onRangeDone(_queryRange(conn, range, onCompletionGuard));
+            } catch (...) {
+                onRangeDone(exceptionToStatus());
+            }
+        });
+    }
+    onRangeDone(_queryRange(_clientConnection.get(), ranges.front(), onCompletionGuard));
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+
+    stdx::lock_guard<Latch> lock(_mutex);
+    _rangeClientConnections.clear();
+    return firstError;
+}
+
 void CollectionCloner::_handleNextBatch(std::shared_ptr<OnCompletionGuard> onCompletionGuard,
                                         DBClientCursorBatchIterator& iter) {
-    _stats.receivedBatches++;
     {
         stdx::lock_guard<Latch> lk(_mutex);
+        _stats.receivedBatches++;
         uassert(ErrorCodes::CallbackCanceled,
                 "Collection cloning cancelled.",
                 _queryState != QueryState::kCanceling);
@@ -798,6 +1016,7 @@ void CollectionCloner::Stats::append(BSONObjBuilder* builder) const {
         }
     }
     builder->appendNumber("receivedBatches", receivedBatches);
+    builder->appendNumber("ranges", ranges);
 }
 }  // namespace repl
 }  // namespace mongo
@@ -82,6 +82,7 @@ public:
         size_t indexes{0};
         size_t fetchedBatches{0};  // This is actually inserted batches.
         size_t receivedBatches{0};
+        size_t ranges{0};  // Number of _id ranges cloned concurrently.
 
         std::string toString() const;
         BSONObj toBSON() const;
@@ -219,6 +220,40 @@ private:
     void _runQuery(const executor::TaskExecutor::CallbackArgs& callbackData,
                    std::shared_ptr<OnCompletionGuard> onCompletionGuard);
 
+    /**
+     * A range of the source collection's _id index. An empty bound leaves that side of the range
+     * unbounded; 'min' is inclusive and 'max' is exclusive.
+     */
+    struct IdRange {
+        BSONObj min;
+        BSONObj max;
+    };
+
+    /**
+     * Splits the collection into at most as many ranges of _id as its entry in
+     * collectionClonerMaxParallelRangesByCollection allows, or collectionClonerMaxParallelRanges
+     * if it has none, using 'conn' to ask the sync source for split points. Returns a single
+     * unbounded range when the collection is too small, capped or has no _id index, or when the
+     * split points cannot be obtained.
+     */
+    std::vector<IdRange> _splitIntoRanges(DBClientConnection* conn);
+
+    /**
+     * Runs the query for the documents in 'range' over 'conn', calling _handleNextBatch with each
+     * batch. Returns the error which terminated the query, if any.
+     */
+    Status _queryRange(DBClientConnection* conn,
+                       const IdRange& range,
+                       std::shared_ptr<OnCompletionGuard> onCompletionGuard);
+
+    /**
+     * Clones all of 'ranges' concurrently. The first range is queried over '_clientConnection' on
+     * the calling thread and every other range over its own connection and thread. Returns the
+     * first error encountered, after which the remaining queries are interrupted.
+     */
+    Status _queryRangesInParallel(const std::vector<IdRange>& ranges,
+                                  std::shared_ptr<OnCompletionGuard> onCompletionGuard);
+
     /**
      * Put all results from a query batch into a buffer to be inserted, and schedule
      * it to be inserted.
@@ -302,6 +337,11 @@ private:
     // allow cancellation, and those other threads may access it only when holding '_mutex'.
     std::unique_ptr<DBClientConnection> _clientConnection;
 
+    // (M) Additional connections used to clone ranges of the collection in parallel with the one
+    // cloned over '_clientConnection'. Each is used by the thread cloning its range, and follows
+    // the same rules as '_clientConnection' otherwise.
+    std::vector<std::unique_ptr<DBClientConnection>> _rangeClientConnections;
+
     // State transitions:
     // PreStart --> Running --> ShuttingDown --> Complete
     // It is possible to skip intermediate states. For example,
@@ -36,11 +36,14 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/repl/base_cloner_test_fixture.h"
 #include "mongo/db/repl/collection_cloner.h"
+#include "mongo/db/repl/repl_server_parameters_gen.h"
 #include "mongo/db/repl/storage_interface.h"
 #include "mongo/db/repl/storage_interface_mock.h"
 #include "mongo/dbtests/mock/mock_dbclient_connection.h"
+#include "mongo/idl/server_parameter.h"
 #include "mongo/unittest/task_executor_proxy.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/str.h"
 
 namespace {
@@ -1075,6 +1078,104 @@ TEST_F(CollectionClonerTest, InsertDocumentsMultipleBatches) {
     ASSERT_FALSE(collectionCloner->isActive());
 }
 
+TEST_F(CollectionClonerTest, InsertDocumentsWithSingleQueryIfCollectionCannotBeSplit) {
+    const auto minDocumentsPerRange = collectionClonerMinDocumentsPerRange.load();
+    collectionClonerMinDocumentsPerRange.store(1);
+    ON_BLOCK_EXIT([&] { collectionClonerMinDocumentsPerRange.store(minDocumentsPerRange); });
+
+    // The mock server has no reply for collStats, so the split fails.
+    _server->insert(nss.ns(), BSON("_id" << 1));
+    _server->insert(nss.ns(), BSON("_id" << 2));
+    _server->insert(nss.ns(), BSON("_id" << 3));
+
+    ASSERT_OK(collectionCloner->startup());
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        processNetworkResponse(createCountResponse(3));
+        processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+    }
+    collectionCloner->join();
+
+    ASSERT_OK(getStatus());
+    ASSERT_EQUALS(3, collectionStats->insertCount);
+    ASSERT_TRUE(collectionStats->commitCalled);
+    auto stats = collectionCloner->getStats();
+    ASSERT_EQUALS(1u, stats.ranges);
+    ASSERT_EQUALS(1u, stats.receivedBatches);
+}
+
+TEST_F(CollectionClonerTest, InsertDocumentsFromRangesClonedOverSeparateConnections) {
+    const auto minDocumentsPerRange = collectionClonerMinDocumentsPerRange.load();
+    collectionClonerMinDocumentsPerRange.store(1);
+    ON_BLOCK_EXIT([&] { collectionClonerMinDocumentsPerRange.store(minDocumentsPerRange); });
+
+    _server->insert(nss.ns(), BSON("_id" << 1));
+    _server->insert(nss.ns(), BSON("_id" << 2));
+    _server->insert(nss.ns(), BSON("_id" << 3));
+    _server->insert(nss.ns(), BSON("_id" << 4));
+    _server->setCommandReply("collStats", BSON("ok" << 1 << "size" << 400 << "count" << 4));
+    _server->setCommandReply("splitVector",
+                             BSON("ok" << 1 << "splitKeys" << BSON_ARRAY(BSON("_id" << 3))));
+
+    int numRangeClients = 0;
+    collectionCloner->setCreateClientFn_forTest([&]() -> std::unique_ptr<DBClientConnection> {
+        if (!_clientCreated) {
+            _clientCreated = true;
+            return std::unique_ptr<DBClientConnection>(_client);
+        }
+        ++numRangeClients;
+        return std::make_unique<FailableMockDBClientConnection>(_server.get(), getNet());
+    });
+
+    ASSERT_OK(collectionCloner->startup());
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        processNetworkResponse(createCountResponse(4));
+        processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+    }
+    collectionCloner->join();
+
+    ASSERT_OK(getStatus());
+    ASSERT_TRUE(collectionStats->commitCalled);
+    ASSERT_EQUALS(1, numRangeClients);
+    auto stats = collectionCloner->getStats();
+    ASSERT_EQUALS(2u, stats.ranges);
+    ASSERT_EQUALS(2u, stats.receivedBatches);
+    // Each document is inserted once, from the range holding it.
+    ASSERT_EQUALS(4, collectionStats->insertCount);
+}
+
+TEST_F(CollectionClonerTest, CollectionWithOwnMaxParallelRangesOfOneIsClonedWithSingleQuery) {
+    const auto minDocumentsPerRange = collectionClonerMinDocumentsPerRange.load();
+    collectionClonerMinDocumentsPerRange.store(1);
+    ON_BLOCK_EXIT([&] { collectionClonerMinDocumentsPerRange.store(minDocumentsPerRange); });
+
+    auto param = ServerParameterSet::getGlobal()->getMap().find(
+        "collectionClonerMaxParallelRangesByCollection");
+    ASSERT(param != ServerParameterSet::getGlobal()->getMap().end());
+    ASSERT_OK(param->second->set(BSON("" << BSON(nss.ns() << 1)).firstElement()));
+    ON_BLOCK_EXIT([&] { ASSERT_OK(param->second->set(BSON("" << BSONObj()).firstElement())); });
+
+    _server->insert(nss.ns(), BSON("_id" << 1));
+    _server->insert(nss.ns(), BSON("_id" << 2));
+    _server->insert(nss.ns(), BSON("_id" << 3));
+    _server->insert(nss.ns(), BSON("_id" << 4));
+
+    ASSERT_OK(collectionCloner->startup());
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        processNetworkResponse(createCountResponse(4));
+        processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+    }
+    collectionCloner->join();
+
+    ASSERT_OK(getStatus());
+    ASSERT_TRUE(collectionStats->commitCalled);
+    auto stats = collectionCloner->getStats();
+    ASSERT_EQUALS(1u, stats.ranges);
+    ASSERT_EQUALS(4, collectionStats->insertCount);
+}
+
 TEST_F(CollectionClonerTest, CollectionClonerTransitionsToCompleteIfShutdownBeforeStartup) {
     collectionCloner->shutdown();
     ASSERT_EQUALS(ErrorCodes::ShutdownInProgress, collectionCloner->startup());
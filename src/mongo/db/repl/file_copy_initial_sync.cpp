@@ -0,0 +1,290 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kReplicationInitialSync
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/file_copy_initial_sync.h"
+
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "mongo/bson/timestamp.h"
+#include "mongo/client/dbclient_connection.h"
+#include "mongo/db/repl/repl_server_parameters_gen.h"
+#include "mongo/db/repl/replication_auth.h"
+#include "mongo/db/storage/storage_engine_init.h"
+#include "mongo/db/storage/storage_file_util.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/rpc/get_status_from_command_result.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/destructor_guard.h"
+#include "mongo/util/log.h"
+#include "mongo/util/net/hostandport.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/str.h"
+#include "mongo/util/timer.h"
+#include "mongo/util/uuid.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+namespace fs = boost::filesystem;
+
+// Files are copied into this directory under the dbpath and only moved into place once all of
+// them have been copied, so that a failed copy never leaves a partial database behind.
+const char kStagingDirName[] = "_fileCopyInitialSync.tmp";
+
+// Created under the dbpath once every file has been copied into the staging directory and synced,
+// and removed once all of them have been moved into place. If startup finds it, the staging
+// directory holds a complete copy, which it finishes moving rather than copying again. Without it,
+// the staging directory is an incomplete copy and nothing has been moved out of it.
+const char kCopyCompleteMarkerName[] = "_fileCopyInitialSync.complete";
+
+// Number of bytes requested from the sync source at a time.
+const int kReadLengthBytes = 8 * 1024 * 1024;
+
+BSONObj runCommandOnSource(DBClientConnection* conn, const BSONObj& cmd) {
+    BSONObj info;
+    if (!conn->runCommand("admin", cmd, info)) {
+        uassertStatusOKWithContext(getStatusFromCommandResult(info),
+                                   str::stream() << "Command failed on sync source: "
+                                                 << cmd.firstElementFieldName());
+    }
+    return info;
+}
+
+/**
+ * Returns 'file' as a path under 'dir', refusing paths which could point outside of it.
+ */
+fs::path pathUnder(const fs::path& dir, const std::string& file) {
+    const fs::path relative(file);
+    uassert(ErrorCodes::BadValue,
+            str::stream() << "Sync source listed an invalid backup file: " << file,
+            !file.empty() && relative.is_relative() &&
+                std::find(relative.begin(), relative.end(), fs::path("..")) == relative.end());
+    return dir / relative;
+}
+
+/**
+ * Copies 'file' from the open backup into 'destination'. Returns the number of bytes copied.
+ */
+long long copyFile(DBClientConnection* conn,
+                   const UUID& backupId,
+                   const std::string& file,
+                   const fs::path& destination) {
+    fs::create_directories(destination.parent_path());
+    std::ofstream out(destination.string(), std::ios::out | std::ios::binary | std::ios::trunc);
+    uassert(ErrorCodes::FileOpenFailed,
+            str::stream() << "Failed to open " << destination.string(),
+            out);
+
+    long long offset = 0;
+    while (true) {
+        BSONObjBuilder cmd;
+        cmd.append(kReadFileCopyBackupFileCmdName, 1);
+        backupId.appendToBuilder(&cmd, "backupId");
+        cmd.append("file", file);
+        cmd.append("offset", offset);
+        cmd.append("length", kReadLengthBytes);
+        const auto reply = runCommandOnSource(conn, cmd.obj());
+
+        int length = 0;
+        const char* data = reply["data"].binData(length);
+        out.write(data, length);
+        uassert(ErrorCodes::FileStreamFailed,
+                str::stream() << "Failed to write " << destination.string(),
+                out);
+        offset += length;
+
+        if (reply["eof"].trueValue()) {
+            break;
+        }
+    }
+
+    out.close();
+    uassert(ErrorCodes::FileStreamFailed,
+            str::stream() << "Failed to write " << destination.string(),
+            out);
+    uassertStatusOK(fsyncFile(destination));
+    return offset;
+}
+
+/**
+ * Syncs the directories holding the given files, so that their entries survive a crash.
+ */
+void fsyncDirectoriesOf(const std::vector<fs::path>& files) {
+    std::set<fs::path> directories;
+    for (auto&& file : files) {
+        if (directories.insert(file.parent_path()).second) {
+            uassertStatusOK(fsyncParentDirectory(file));
+        }
+    }
+}
+
+/**
+ * Durably creates the marker which records that the staging directory holds a complete copy.
+ */
+void writeCopyCompleteMarker(const fs::path& marker) {
+    std::ofstream out(marker.string(), std::ios::out | std::ios::trunc);
+    out.close();
+    uassert(ErrorCodes::FileStreamFailed,
+            str::stream() << "Failed to write " << marker.string(),
+            out);
+    uassertStatusOK(fsyncFile(marker));
+    uassertStatusOK(fsyncParentDirectory(marker));
+}
+
+/**
+ * Moves every file in the staging directory to the same path under the dbpath, moving the
+ * WiredTiger file last since its presence marks the dbpath as holding a database, and then removes
+ * the marker and the staging directory. Files moved by an earlier, interrupted call are no longer
+ * in the staging directory, so calling this again finishes the move.
+ */
+void moveStagedFilesIntoPlace(const fs::path& dbpath,
+                              const fs::path& stagingDir,
+                              const fs::path& marker) {
+    std::vector<fs::path> files;
+    if (fs::exists(stagingDir)) {
+        for (fs::recursive_directory_iterator it(stagingDir), end; it != end; ++it) {
+            if (fs::is_regular_file(it->status())) {
+                files.push_back(it->path().lexically_relative(stagingDir));
+            }
+        }
+    }
+    std::stable_partition(
+        files.begin(), files.end(), [](const fs::path& file) { return file != "WiredTiger"; });
+
+    std::vector<fs::path> destinations;
+    for (auto&& file : files) {
+        destinations.push_back(dbpath / file);
+        fs::create_directories(destinations.back().parent_path());
+        fs::rename(stagingDir / file, destinations.back());
+    }
+
+    // The moves must be durable before the marker goes, since nothing could redo them after.
+    fsyncDirectoriesOf(destinations);
+    fs::remove(marker);
+    uassertStatusOK(fsyncParentDirectory(marker));
+    fs::remove_all(stagingDir);
+}
+
+}  // namespace
+
+void copyDataFilesFromSyncSourceIfNeeded(ServiceContext* service) {
+    const fs::path dbpath(storageGlobalParams.dbpath);
+    const auto stagingDir = dbpath / kStagingDirName;
+    const auto marker = dbpath / kCopyCompleteMarkerName;
+    if (fileCopyBasedInitialSyncSource.empty() && !fs::exists(marker)) {
+        return;
+    }
+
+    // No other process may use the dbpath while files are copied or moved into it.
+    lockDataDirectory(service);
+
+    if (fs::exists(marker)) {
+        log() << "Moving the files copied by an interrupted file copy based initial sync into "
+              << dbpath.string();
+        moveStagedFilesIntoPlace(dbpath, stagingDir, marker);
+        return;
+    }
+
+    if (fileCopyBasedInitialSyncSource.empty()) {
+        return;
+    }
+
+    uassert(ErrorCodes::InvalidOptions,
+            "File copy based initial sync is only supported by the wiredTiger storage engine",
+            storageGlobalParams.engine == "wiredTiger");
+
+    if (fs::exists(dbpath / "WiredTiger")) {
+        log() << "Not running file copy based initial sync because " << dbpath.string()
+              << " already contains data";
+        return;
+    }
+
+    const auto source = HostAndPort(fileCopyBasedInitialSyncSource);
+    log() << "Starting file copy based initial sync from " << source;
+    Timer timer;
+
+    // Remove whatever a previous failed attempt left behind.
+    fs::remove_all(stagingDir);
+
+    DBClientConnection conn;
+    uassertStatusOKWithContext(conn.connect(source, "FileCopyInitialSync"),
+                               str::stream() << "Failed to connect to " << source);
+    uassert(ErrorCodes::AuthenticationFailed,
+            str::stream() << "Failed to authenticate to " << source,
+            replAuthenticate(&conn));
+
+    const auto backup = runCommandOnSource(&conn, BSON(kBeginFileCopyBackupCmdName << 1));
+    const auto backupId = uassertStatusOK(UUID::parse(backup["backupId"]));
+    ON_BLOCK_EXIT([&] {
+        DESTRUCTOR_GUARD({
+            BSONObjBuilder cmd;
+            cmd.append(kEndFileCopyBackupCmdName, 1);
+            backupId.appendToBuilder(&cmd, "backupId");
+            runCommandOnSource(&conn, cmd.obj());
+        });
+    });
+
+    std::vector<std::string> files;
+    for (auto&& file : backup["files"].Array()) {
+        files.push_back(file.str());
+    }
+
+    long long totalBytes = 0;
+    std::vector<fs::path> stagedFiles;
+    for (auto&& file : files) {
+        stagedFiles.push_back(pathUnder(stagingDir, file));
+        const auto bytes = copyFile(&conn, backupId, file, stagedFiles.back());
+        LOG(1) << "Copied " << bytes << " bytes of " << file << " from " << source;
+        totalBytes += bytes;
+    }
+
+    fsyncDirectoriesOf(stagedFiles);
+    writeCopyCompleteMarker(marker);
+    moveStagedFilesIntoPlace(dbpath, stagingDir, marker);
+
+    log() << "File copy based initial sync copied " << files.size() << " files (" << totalBytes
+          << " bytes) from " << source << " in " << timer.millis() << " ms. Startup recovery "
+          << "will replay the oplog from checkpoint timestamp "
+          << (backup.hasField("checkpointTimestamp") ? backup["checkpointTimestamp"].timestamp()
+                                                     : Timestamp());
+}
+
+}  // namespace repl
+}  // namespace mongo
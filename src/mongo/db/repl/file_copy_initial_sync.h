@@ -0,0 +1,70 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include "mongo/base/string_data.h"
+
+namespace mongo {
+
+class ServiceContext;
+
+namespace repl {
+
+/**
+ * File-copy based initial sync.
+ *
+ * Instead of cloning every collection and rebuilding every index, a node started with an empty
+ * dbpath and 'fileCopyBasedInitialSyncSource' set copies the WiredTiger files of its sync source,
+ * as listed by a backup cursor opened on that node, into its dbpath before the storage engine is
+ * started. Opening the copied files recovers the sync source's checkpoint, and startup recovery
+ * then replays the copied oplog from the checkpoint timestamp onwards, after which the node
+ * fetches newer oplog entries through steady state replication like any other secondary.
+ */
+
+// Opens a backup cursor on the sync source and returns the files to copy, relative to its dbpath.
+constexpr StringData kBeginFileCopyBackupCmdName = "_fileCopyInitialSyncBeginBackup"_sd;
+
+// Returns up to 'length' bytes from 'offset' of one of the files listed by the backup cursor.
+constexpr StringData kReadFileCopyBackupFileCmdName = "_fileCopyInitialSyncReadFile"_sd;
+
+// Closes the backup cursor, allowing the sync source to truncate its oplog again.
+constexpr StringData kEndFileCopyBackupCmdName = "_fileCopyInitialSyncEndBackup"_sd;
+
+/**
+ * Copies the data files of 'fileCopyBasedInitialSyncSource' into the dbpath if that parameter is
+ * set and the dbpath does not contain a WiredTiger database yet, or finishes moving the files of a
+ * copy which completed before the node went down. Locks the dbpath first, so must be called before
+ * the storage engine is initialized. Throws if the copy fails, leaving the dbpath as it was.
+ */
+void copyDataFilesFromSyncSourceIfNeeded(ServiceContext* service);
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,366 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kReplicationInitialSync
+
+#include "mongo/platform/basic.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/auth/resource_pattern.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/concurrency/d_concurrency.h"
+#include "mongo/db/repl/file_copy_initial_sync.h"
+#include "mongo/db/repl/repl_server_parameters_gen.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/storage/storage_engine.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/util/log.h"
+#include "mongo/util/periodic_runner.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/uuid.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+// The largest number of bytes returned by a single read of a backup file, which keeps replies well
+// below the maximum BSON document size.
+const int kMaxReadLengthBytes = 8 * 1024 * 1024;
+
+/**
+ * Returns the dbpath without any trailing separators, each of which would otherwise count as a "."
+ * element of the path.
+ */
+boost::filesystem::path getDbpath() {
+    auto dbpath = boost::filesystem::path(storageGlobalParams.dbpath).lexically_normal();
+    while (dbpath.has_parent_path() && dbpath.filename() == ".") {
+        dbpath = dbpath.parent_path();
+    }
+    return dbpath;
+}
+
+/**
+ * The backup cursor opened on behalf of a node doing file-copy based initial sync. At most one is
+ * open at a time, and it is closed once the syncing node hasn't used it for
+ * fileCopyBackupInactivityTimeoutSecs.
+ */
+class FileCopyBackup {
+public:
+    static FileCopyBackup& get(ServiceContext* service);
+
+    struct Backup {
+        UUID backupId;
+        std::set<std::string> files;  // Relative to the dbpath.
+
+        // The timestamp of the checkpoint the backup holds, if the storage engine takes stable
+        // checkpoints.
+        boost::optional<Timestamp> checkpointTimestamp;
+
+        Date_t lastUsed;
+    };
+
+    /**
+     * Opens a backup cursor and returns the backup it describes. Throws if one is already open.
+     */
+    Backup open(OperationContext* opCtx) {
+        stdx::lock_guard<Latch> lk(_mutex);
+        uassert(ErrorCodes::ConflictingOperationInProgress,
+                str::stream() << "A backup for file copy based initial sync is already open: "
+                              << _backup->backupId,
+                !_backup);
+
+        auto storageEngine = opCtx->getServiceContext()->getStorageEngine();
+        uassert(ErrorCodes::IllegalOperation,
+                "File copy based initial sync requires a storage engine which persists data",
+                !storageEngine->isEphemeral());
+
+        Backup backup{UUID::gen(), {}, boost::none, Date_t::now()};
+        std::vector<std::string> files;
+        {
+            // Keeps a checkpoint from completing between opening the backup cursor and reading the
+            // timestamp of the checkpoint it holds.
+            auto checkpointLock = storageEngine->getCheckpointLock(opCtx);
+            files = uassertStatusOK(storageEngine->beginNonBlockingBackup(opCtx));
+            if (storageEngine->supportsRecoverToStableTimestamp()) {
+                backup.checkpointTimestamp = storageEngine->getLastStableRecoveryTimestamp();
+            }
+        }
+        auto endBackupGuard = makeGuard([&] { storageEngine->endNonBlockingBackup(opCtx); });
+
+        // The backup cursor lists absolute paths, which mean nothing on the syncing node.
+        const auto dbpath = getDbpath();
+        for (auto&& file : files) {
+            const auto relativePath =
+                boost::filesystem::path(file).lexically_normal().lexically_relative(dbpath);
+            uassert(ErrorCodes::InternalError,
+                    str::stream() << "Backup file " << file << " is not under the dbpath "
+                                  << dbpath.string(),
+                    !relativePath.empty() && relativePath != "." &&
+                        *relativePath.begin() != "..");
+            backup.files.insert(relativePath.string());
+        }
+
+        _startReaper_inlock(opCtx->getServiceContext());
+        endBackupGuard.dismiss();
+        _backup = backup;
+        return backup;
+    }
+
+    /**
+     * Throws unless 'backupId' is the open backup and 'file' is one of the files it lists.
+     */
+    void checkFile(const UUID& backupId, const std::string& file) {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _checkBackupId_inlock(backupId);
+        uassert(ErrorCodes::BadValue,
+                str::stream() << "File '" << file << "' is not part of backup " << backupId,
+                _backup->files.count(file));
+        _backup->lastUsed = Date_t::now();
+    }
+
+    void close(OperationContext* opCtx, const UUID& backupId) {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _checkBackupId_inlock(backupId);
+        opCtx->getServiceContext()->getStorageEngine()->endNonBlockingBackup(opCtx);
+        _backup = boost::none;
+        _pauseReaper_inlock();
+    }
+
+    /**
+     * Closes the open backup if the syncing node hasn't used it for the inactivity timeout, which
+     * it wouldn't if it failed or went away.
+     */
+    void closeIfInactive(OperationContext* opCtx) {
+        stdx::lock_guard<Latch> lk(_mutex);
+        const auto timeout = Seconds(fileCopyBackupInactivityTimeoutSecs.load());
+        if (!_backup || Date_t::now() - _backup->lastUsed < timeout) {
+            return;
+        }
+
+        log() << "Closing backup " << _backup->backupId << " for file copy based initial sync, "
+              << "which has not been used for " << timeout;
+        opCtx->getServiceContext()->getStorageEngine()->endNonBlockingBackup(opCtx);
+        _backup = boost::none;
+        _pauseReaper_inlock();
+    }
+
+private:
+    void _checkBackupId_inlock(const UUID& backupId) const {
+        uassert(ErrorCodes::NoSuchKey,
+                str::stream() << "Backup " << backupId << " is not open",
+                _backup && _backup->backupId == backupId);
+    }
+
+    /**
+     * Starts the job which closes inactive backups, or resumes it if it was paused when the last
+     * backup was closed. The job only runs while a backup is open, since each run takes the global
+     * lock.
+     */
+    void _startReaper_inlock(ServiceContext* service) {
+        if (_reaper) {
+            _reaper->resume();
+            return;
+        }
+
+        auto periodicRunner = service->getPeriodicRunner();
+        invariant(periodicRunner);
+
+        PeriodicRunner::PeriodicJob job("closeInactiveFileCopyBackup",
+                                        [](Client* client) {
+                                            auto opCtx = client->makeOperationContext();
+                                            Lock::GlobalLock lk(opCtx.get(), MODE_IS);
+                                            FileCopyBackup::get(client->getServiceContext())
+                                                .closeIfInactive(opCtx.get());
+                                        },
+                                        Seconds(1));
+        _reaper = std::make_unique<PeriodicJobAnchor>(periodicRunner->makeJob(std::move(job)));
+        _reaper->start();
+    }
+
+    /**
+     * Pauses the job which closes inactive backups once no backup is open. This may be called from
+     * the job itself.
+     */
+    void _pauseReaper_inlock() {
+        invariant(_reaper);
+        _reaper->pause();
+    }
+
+    mutable Mutex _mutex = MONGO_MAKE_LATCH("FileCopyBackup::_mutex");
+    boost::optional<Backup> _backup;
+    std::unique_ptr<PeriodicJobAnchor> _reaper;
+};
+
+const auto getFileCopyBackup = ServiceContext::declareDecoration<FileCopyBackup>();
+
+FileCopyBackup& FileCopyBackup::get(ServiceContext* service) {
+    return getFileCopyBackup(service);
+}
+
+/**
+ * Base class for the commands a node runs against its sync source during file-copy based initial
+ * sync. They are restricted to internal clients, since they expose the raw data files.
+ */
+class FileCopyInitialSyncCommand : public BasicCommand {
+public:
+    using BasicCommand::BasicCommand;
+
+    AllowedOnSecondary secondaryAllowed(ServiceContext*) const override {
+        return AllowedOnSecondary::kAlways;
+    }
+
+    bool adminOnly() const override {
+        return true;
+    }
+
+    bool supportsWriteConcern(const BSONObj& cmd) const override {
+        return false;
+    }
+
+    Status checkAuthForCommand(Client* client,
+                               const std::string& dbname,
+                               const BSONObj& cmdObj) const override {
+        if (!AuthorizationSession::get(client)->isAuthorizedForActionsOnResource(
+                ResourcePattern::forClusterResource(), ActionType::internal)) {
+            return Status(ErrorCodes::Unauthorized, "Unauthorized");
+        }
+        return Status::OK();
+    }
+};
+
+class CmdBeginFileCopyBackup : public FileCopyInitialSyncCommand {
+public:
+    CmdBeginFileCopyBackup() : FileCopyInitialSyncCommand(kBeginFileCopyBackupCmdName) {}
+
+    std::string help() const override {
+        return "Internal command. Opens a backup cursor for file copy based initial sync.";
+    }
+
+    bool run(OperationContext* opCtx,
+             const std::string& dbname,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        Lock::GlobalLock lk(opCtx, MODE_IS);
+
+        auto backup = FileCopyBackup::get(opCtx->getServiceContext()).open(opCtx);
+
+        log() << "Opened backup " << backup.backupId << " of " << backup.files.size()
+              << " files for file copy based initial sync";
+
+        backup.backupId.appendToBuilder(&result, "backupId");
+        if (backup.checkpointTimestamp) {
+            result.append("checkpointTimestamp", *backup.checkpointTimestamp);
+        }
+        BSONArrayBuilder filesBuilder(result.subarrayStart("files"));
+        for (auto&& file : backup.files) {
+            filesBuilder.append(file);
+        }
+        filesBuilder.done();
+        return true;
+    }
+} cmdBeginFileCopyBackup;
+
+class CmdReadFileCopyBackupFile : public FileCopyInitialSyncCommand {
+public:
+    CmdReadFileCopyBackupFile() : FileCopyInitialSyncCommand(kReadFileCopyBackupFileCmdName) {}
+
+    std::string help() const override {
+        return "Internal command. Reads part of a file listed by a file copy based initial sync "
+               "backup cursor.";
+    }
+
+    bool run(OperationContext* opCtx,
+             const std::string& dbname,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        const auto backupId = uassertStatusOK(UUID::parse(cmdObj["backupId"]));
+        const auto file = cmdObj["file"].str();
+        const auto offset = cmdObj["offset"].safeNumberLong();
+        const auto length = cmdObj["length"].safeNumberLong();
+        uassert(ErrorCodes::BadValue, "offset must be non-negative", offset >= 0);
+        uassert(ErrorCodes::BadValue,
+                str::stream() << "length must be between 1 and " << kMaxReadLengthBytes,
+                length > 0 && length <= kMaxReadLengthBytes);
+
+        FileCopyBackup::get(opCtx->getServiceContext()).checkFile(backupId, file);
+
+        const auto path = (getDbpath() / file).string();
+        std::ifstream in(path, std::ios::in | std::ios::binary);
+        uassert(ErrorCodes::FileOpenFailed, str::stream() << "Failed to open " << path, in);
+
+        std::vector<char> buffer(length);
+        in.seekg(offset);
+        in.read(buffer.data(), length);
+        const auto bytesRead = static_cast<int>(in.gcount());
+        uassert(ErrorCodes::FileStreamFailed,
+                str::stream() << "Failed to read " << path,
+                in || in.eof());
+
+        result.appendBinData("data", bytesRead, BinDataGeneral, buffer.data());
+        result.append("eof", bytesRead < length);
+        return true;
+    }
+} cmdReadFileCopyBackupFile;
+
+class CmdEndFileCopyBackup : public FileCopyInitialSyncCommand {
+public:
+    CmdEndFileCopyBackup() : FileCopyInitialSyncCommand(kEndFileCopyBackupCmdName) {}
+
+    std::string help() const override {
+        return "Internal command. Closes a file copy based initial sync backup cursor.";
+    }
+
+    bool run(OperationContext* opCtx,
+             const std::string& dbname,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        const auto backupId = uassertStatusOK(UUID::parse(cmdObj["backupId"]));
+
+        Lock::GlobalLock lk(opCtx, MODE_IS);
+        FileCopyBackup::get(opCtx->getServiceContext()).close(opCtx, backupId);
+
+        log() << "Closed backup " << backupId << " for file copy based initial sync";
+        return true;
+    }
+} cmdEndFileCopyBackup;
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
@@ -87,7 +87,7 @@ StatusWith<InsertGroup::ConstIterator> InsertGroup::groupAndApplyInserts(ConstIt
     // Make sure to include the first op in the group size.
     size_t groupSize = entry.getObject().objsize();
     auto opCount = MultiApplier::OperationPtrs::size_type(1);
-    auto groupNamespace = entry.getNss();
+    const auto& groupNamespace = entry.getNss();
 
     /**
      * Search for the op that delimits this insert group, and save its position
@@ -105,7 +105,7 @@ StatusWith<InsertGroup::ConstIterator> InsertGroup::groupAndApplyInserts(ConstIt
      */
     auto endOfGroupableOpsIterator =
         std::find_if(it + 1, _end, [&](const OplogEntry* nextEntry) -> bool {
-            auto opNamespace = nextEntry->getNss();
+            const auto& opNamespace = nextEntry->getNss();
             groupSize += nextEntry->getObject().objsize();
             opCount += 1;
 
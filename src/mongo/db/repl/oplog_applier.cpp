@@ -291,10 +291,14 @@ std::unique_ptr<ThreadPool> makeReplWriterPool() {
     return makeReplWriterPool(replWriterThreadCount);
 }
 
-std::unique_ptr<ThreadPool> makeReplWriterPool(int threadCount) {
+namespace {
+
+std::unique_ptr<ThreadPool> makeReplPool(int threadCount,
+                                         std::string threadNamePrefix,
+                                         std::string poolName) {
     ThreadPool::Options options;
-    options.threadNamePrefix = "repl-writer-worker-";
-    options.poolName = "repl writer worker Pool";
+    options.threadNamePrefix = std::move(threadNamePrefix);
+    options.poolName = std::move(poolName);
     options.maxThreads = options.minThreads = static_cast<size_t>(threadCount);
     options.onCreateThread = [](const std::string&) {
         Client::initThread(getThreadName());
@@ -305,10 +309,24 @@ std::unique_ptr<ThreadPool> makeReplWriterPool(int threadCount) {
     return pool;
 }
 
+}  // namespace
+
+std::unique_ptr<ThreadPool> makeReplWriterPool(int threadCount) {
+    return makeReplPool(threadCount, "repl-writer-worker-", "repl writer worker Pool");
+}
+
+std::unique_ptr<ThreadPool> makeReplOplogWriterPool(int threadCount) {
+    return makeReplPool(threadCount, "repl-oplog-writer-", "repl oplog writer Pool");
+}
+
 std::size_t getBatchLimitOplogEntries() {
     return std::size_t(replBatchLimitOperations.load());
 }
 
+std::size_t getBatcherMaxReadyBatches() {
+    return std::size_t(replBatcherMaxReadyBatches.load());
+}
+
 std::size_t getBatchLimitOplogBytes(OperationContext* opCtx, StorageInterface* storageInterface) {
     auto oplogMaxSizeResult =
         storageInterface->getOplogMaxSize(opCtx, NamespaceString::kRsOplogNamespace);
@@ -266,12 +266,23 @@ extern NoopOplogApplierObserver noopOplogApplierObserver;
 std::unique_ptr<ThreadPool> makeReplWriterPool();
 std::unique_ptr<ThreadPool> makeReplWriterPool(int threadCount);
 
+/**
+ * Creates the thread pool which writes the next batch's entries to the oplog while the current
+ * batch is being applied by the writer pool.
+ */
+std::unique_ptr<ThreadPool> makeReplOplogWriterPool(int threadCount);
+
 /**
  * Returns maximum number of operations in each batch that can be applied using
  * applyOplogBatch().
  */
 std::size_t getBatchLimitOplogEntries();
 
+/**
+ * Returns the maximum number of batches the batcher may form ahead of the applier.
+ */
+std::size_t getBatcherMaxReadyBatches();
+
 /**
  * Calculates batch limit size (in bytes) using the maximum capped collection size of the oplog
  * size.
@@ -31,6 +31,8 @@
 
 #include "mongo/db/repl/oplog_applier_impl.h"
 
+#include <queue>
+
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/collection_catalog.h"
 #include "mongo/db/catalog/database.h"
@@ -43,6 +45,7 @@
 #include "mongo/db/logical_session_id.h"
 #include "mongo/db/repl/apply_ops.h"
 #include "mongo/db/repl/insert_group.h"
+#include "mongo/db/repl/repl_server_parameters_gen.h"
 #include "mongo/db/repl/transaction_oplog_application.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/platform/basic.h"
@@ -70,6 +73,23 @@ ServerStatusMetricField<Counter64> displayOplogApplicationBatchSize("repl.apply.
 TimerStats applyBatchStats;
 ServerStatusMetricField<TimerStats> displayOpBatchesApplied("repl.apply.batches", &applyBatchStats);
 
+// Parallelism of each batch, summed over all batches. Dividing by the number of batches gives the
+// average number of independent groups of operations, the average number of writer threads given
+// work, and the average size of the largest group, which bounds how long a batch takes.
+Counter64 conflictGroupsStats;
+ServerStatusMetricField<Counter64> displayConflictGroups("repl.apply.parallelism.conflictGroups",
+                                                         &conflictGroupsStats);
+Counter64 writersUsedStats;
+ServerStatusMetricField<Counter64> displayWritersUsed("repl.apply.parallelism.writersUsed",
+                                                      &writersUsedStats);
+Counter64 largestConflictGroupStats;
+ServerStatusMetricField<Counter64> displayLargestConflictGroup(
+    "repl.apply.parallelism.largestConflictGroupOps", &largestConflictGroupStats);
+
+// Operations are hashed into this many conflict groups per writer thread before the groups are
+// balanced over the writers, so that two hot documents rarely end up sharing a writer.
+const size_t kConflictGroupsPerWriter = 64;
+
 NamespaceString parseUUIDOrNs(OperationContext* opCtx, const OplogEntry& oplogEntry) {
     auto optionalUuid = oplogEntry.getUuid();
     if (!optionalUuid) {
@@ -205,7 +225,7 @@ void processCrudOp(OperationContext* opCtx,
 }
 
 /**
- * Adds a single oplog entry to the appropriate writer vector.
+ * Adds a single oplog entry to the appropriate writer vector, or conflict group.
  */
 void addToWriterVector(OplogEntry* op,
                        std::vector<MultiApplier::OperationPtrs>* writerVectors,
@@ -378,6 +398,24 @@ void OplogApplierImpl::_run(OplogBuffer* oplogBuffer) {
 
     OpQueueBatcher batcher(this, _storageInterface, oplogBuffer, getNextApplierBatchFn);
 
+    // Writes the entries of the batch after the one being applied into the oplog, so that they
+    // overlap with its application rather than delaying the start of the next one.
+    std::unique_ptr<ThreadPool> oplogWriterPool;
+    if (replOplogWriterThreadCount > 0 && !getOptions().skipWritesToOplog) {
+        oplogWriterPool = makeReplOplogWriterPool(replOplogWriterThreadCount);
+    }
+    ON_BLOCK_EXIT([&] {
+        if (oplogWriterPool) {
+            oplogWriterPool->shutdown();
+            oplogWriterPool->join();
+        }
+    });
+
+    // A batch taken from the batcher while the previous batch was being applied, and whether its
+    // entries have already been written to the oplog.
+    boost::optional<OpQueue> pendingOps;
+    bool pendingOpsWrittenToOplog = false;
+
     std::unique_ptr<ApplyBatchFinalizer> finalizer{
         getGlobalServiceContext()->getStorageEngine()->isDurable()
             ? new ApplyBatchFinalizerForJournal(_replCoord)
@@ -406,7 +444,10 @@ void OplogApplierImpl::_run(OplogBuffer* oplogBuffer) {
 
         // Blocks up to a second waiting for a batch to be ready to apply. If one doesn't become
         // ready in time, we'll loop again so we can do the above checks periodically.
-        OpQueue ops = batcher.getNextBatch(Seconds(1));
+        OpQueue ops = pendingOps ? std::move(*pendingOps) : batcher.getNextBatch(Seconds(1));
+        const bool opsWrittenToOplog = pendingOps && pendingOpsWrittenToOplog;
+        pendingOps = boost::none;
+        pendingOpsWrittenToOplog = false;
         if (ops.empty()) {
             if (ops.mustShutdown()) {
                 // Shut down and exit oplog application loop.
@@ -428,9 +469,8 @@ void OplogApplierImpl::_run(OplogBuffer* oplogBuffer) {
 
         // Extract some info from ops that we'll need after releasing the batch below.
         const auto firstOpTimeInBatch = ops.front().getOpTime();
-        const auto lastOpInBatch = ops.back();
-        const auto lastOpTimeInBatch = lastOpInBatch.getOpTime();
-        const auto lastWallTimeInBatch = lastOpInBatch.getWallClockTime();
+        const auto lastOpTimeInBatch = ops.back().getOpTime();
+        const auto lastWallTimeInBatch = ops.back().getWallClockTime();
         const auto lastAppliedOpTimeAtStartOfBatch = _replCoord->getMyLastAppliedOpTime();
 
         // Make sure the oplog doesn't go back in time or repeat an entry.
@@ -446,10 +486,30 @@ void OplogApplierImpl::_run(OplogBuffer* oplogBuffer) {
         // Don't allow the fsync+lock thread to see intermediate states of batch application.
         stdx::lock_guard<SimpleMutex> fsynclk(filesLockedFsync);
 
+        // If the batcher has already formed the next batch, write it to the oplog while this one
+        // is applied. Empty batches only carry signals, which are handled in order next time.
+        if (oplogWriterPool) {
+            pendingOps = batcher.getNextBatch(Seconds(0));
+            if (pendingOps->empty() && !pendingOps->mustShutdown() &&
+                !pendingOps->termWhenExhausted()) {
+                pendingOps = boost::none;
+            }
+        }
+        const MultiApplier::Operations* nextOps = nullptr;
+        if (pendingOps && !pendingOps->empty()) {
+            nextOps = &pendingOps->getBatch();
+            pendingOpsWrittenToOplog = true;
+        }
+
         // Apply the operations in this batch. '_applyOplogBatch' returns the optime of the
         // last op that was applied, which should be the last optime in the batch.
         auto lastOpTimeAppliedInBatch =
-            fassertNoTrace(34437, _applyOplogBatch(&opCtx, ops.releaseBatch()));
+            fassertNoTrace(34437,
+                           _applyOplogBatchAndWriteNext(&opCtx,
+                                                        ops.releaseBatch(),
+                                                        opsWrittenToOplog,
+                                                        oplogWriterPool.get(),
+                                                        nextOps));
         invariant(lastOpTimeAppliedInBatch == lastOpTimeInBatch);
 
         // Update various things that care about our last applied optime. Tests rely on 1 happening
@@ -554,7 +614,18 @@ void scheduleWritesToOplog(OperationContext* opCtx,
 
 StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
                                                       MultiApplier::Operations ops) {
+    return _applyOplogBatchAndWriteNext(opCtx, std::move(ops), false, nullptr, nullptr);
+}
+
+StatusWith<OpTime> OplogApplierImpl::_applyOplogBatchAndWriteNext(
+    OperationContext* opCtx,
+    MultiApplier::Operations ops,
+    bool opsWrittenToOplog,
+    ThreadPool* oplogWriterPool,
+    const MultiApplier::Operations* nextOps) {
     invariant(!ops.empty());
+    invariant(!nextOps || (oplogWriterPool && !nextOps->empty()));
+    invariant(!(opsWrittenToOplog || nextOps) || !getOptions().skipWritesToOplog);
 
     LOG(2) << "replication batch size is " << ops.size();
 
@@ -580,11 +651,17 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
         TimerHolder timer(&applyBatchStats);
 
         // We must wait for the all work we've dispatched to complete before leaving this block
-        // because the spawned threads refer to objects on the stack
-        ON_BLOCK_EXIT([&] { _writerPool->waitForIdle(); });
+        // because the spawned threads refer to objects on the stack. The next batch's oplog writes
+        // must also be finished before we release the PBWM lock.
+        ON_BLOCK_EXIT([&] {
+            _writerPool->waitForIdle();
+            if (nextOps) {
+                oplogWriterPool->waitForIdle();
+            }
+        });
 
         // Write batch of ops into oplog.
-        if (!getOptions().skipWritesToOplog) {
+        if (!getOptions().skipWritesToOplog && !opsWrittenToOplog) {
             _consistencyMarkers->setOplogTruncateAfterPoint(opCtx, ops.front().getTimestamp());
             scheduleWritesToOplog(opCtx, _storageInterface, _writerPool, ops);
         }
@@ -612,12 +689,21 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
             pauseBatchApplicationAfterWritingOplogEntries.pauseWhileSet(opCtx);
         }
 
-        // Reset consistency markers in case the node fails while applying ops.
+        // Reset consistency markers in case the node fails while applying ops. If the next
+        // batch's entries are about to be written, the truncate after point moves to the first of
+        // them rather than being cleared, so that a crash before they are all written (or before
+        // this batch is applied) leaves no hole in the oplog.
         if (!getOptions().skipWritesToOplog) {
-            _consistencyMarkers->setOplogTruncateAfterPoint(opCtx, Timestamp());
+            _consistencyMarkers->setOplogTruncateAfterPoint(
+                opCtx, nextOps ? nextOps->front().getTimestamp() : Timestamp());
             _consistencyMarkers->setMinValidToAtLeast(opCtx, ops.back().getOpTime());
         }
 
+        // Write the next batch into the oplog while this one is applied.
+        if (nextOps) {
+            scheduleWritesToOplog(opCtx, _storageInterface, oplogWriterPool, *nextOps);
+        }
+
         {
             std::vector<Status> statusVector(_writerPool->getStats().numThreads, Status::OK());
 
@@ -711,7 +797,8 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
 /**
  * ops - This only modifies the isForCappedCollection field on each op. It does not alter the ops
  *      vector in any other way.
- * writerVectors - Set of operations for each worker thread to apply.
+ * writerVectors - Conflict groups to fill. Each op goes to the group selected by its hash modulo
+ *      the number of groups.
  * derivedOps - If provided, this function inserts a decomposition of applyOps operations
  *      and instructions for updating the transactions table.  Required if processing oplogs
  *      with transactions.
@@ -826,15 +913,62 @@ void OplogApplierImpl::fillWriterVectors(
     std::vector<MultiApplier::OperationPtrs>* writerVectors,
     std::vector<MultiApplier::Operations>* derivedOps) noexcept {
 
+    // Operations with the same hash are put in the same conflict group, in the order in which
+    // they appear in the batch. The hash covers the namespace and, where operations on different
+    // documents may be applied concurrently, the _id.
+    std::vector<MultiApplier::OperationPtrs> conflictGroups(writerVectors->size() *
+                                                            kConflictGroupsPerWriter);
+
     SessionUpdateTracker sessionUpdateTracker;
-    _deriveOpsAndFillWriterVectors(opCtx, ops, writerVectors, derivedOps, &sessionUpdateTracker);
+    _deriveOpsAndFillWriterVectors(opCtx, ops, &conflictGroups, derivedOps, &sessionUpdateTracker);
 
     auto newOplogWrites = sessionUpdateTracker.flushAll();
     if (!newOplogWrites.empty()) {
         derivedOps->emplace_back(std::move(newOplogWrites));
         _deriveOpsAndFillWriterVectors(
-            opCtx, &derivedOps->back(), writerVectors, derivedOps, nullptr);
+            opCtx, &derivedOps->back(), &conflictGroups, derivedOps, nullptr);
     }
+
+    assignConflictGroupsToWriters(&conflictGroups, writerVectors);
+}
+
+void assignConflictGroupsToWriters(std::vector<MultiApplier::OperationPtrs>* conflictGroups,
+                                   std::vector<MultiApplier::OperationPtrs>* writerVectors) {
+    invariant(!writerVectors->empty());
+
+    std::vector<MultiApplier::OperationPtrs*> groups;
+    for (auto&& group : *conflictGroups) {
+        if (!group.empty()) {
+            groups.push_back(&group);
+        }
+    }
+    std::stable_sort(groups.begin(), groups.end(), [](const auto* l, const auto* r) {
+        return l->size() > r->size();
+    });
+
+    // Writers ordered by the number of operations assigned to them so far, fewest first.
+    using WriterLoad = std::pair<size_t, size_t>;
+    std::priority_queue<WriterLoad, std::vector<WriterLoad>, std::greater<WriterLoad>> writers;
+    for (size_t i = 0; i < writerVectors->size(); ++i) {
+        writers.emplace((*writerVectors)[i].size(), i);
+    }
+
+    size_t writersUsed = 0;
+    for (auto* group : groups) {
+        auto [load, writerIndex] = writers.top();
+        writers.pop();
+
+        auto& writer = (*writerVectors)[writerIndex];
+        if (writer.empty()) {
+            ++writersUsed;
+        }
+        writer.insert(writer.end(), group->begin(), group->end());
+        writers.emplace(load + group->size(), writerIndex);
+    }
+
+    conflictGroupsStats.increment(groups.size());
+    writersUsedStats.increment(writersUsed);
+    largestConflictGroupStats.increment(groups.empty() ? 0 : groups.front()->size());
 }
 
 Status applyOplogEntryOrGroupedInserts(OperationContext* opCtx,
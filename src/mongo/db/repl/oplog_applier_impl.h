@@ -98,6 +98,24 @@ private:
      */
     StatusWith<OpTime> _applyOplogBatch(OperationContext* opCtx, MultiApplier::Operations ops);
 
+    /**
+     * Like _applyOplogBatch(), but pipelines the oplog writes of consecutive batches.
+     *
+     * If 'opsWrittenToOplog' is true, the entries of 'ops' were already written to the oplog
+     * while the previous batch was applied, and the oplog truncate after point still covers them.
+     *
+     * If 'nextOps' is not null, its entries are written to the oplog on 'oplogWriterPool' while
+     * 'ops' is being applied, with the oplog truncate after point moved to its first entry so
+     * that a crash truncates a partially written 'nextOps' away again. The writes are complete
+     * when this returns, and the caller must pass 'nextOps' back as 'ops' with
+     * 'opsWrittenToOplog' set on the following call.
+     */
+    StatusWith<OpTime> _applyOplogBatchAndWriteNext(OperationContext* opCtx,
+                                                    MultiApplier::Operations ops,
+                                                    bool opsWrittenToOplog,
+                                                    ThreadPool* oplogWriterPool,
+                                                    const MultiApplier::Operations* nextOps);
+
     void _deriveOpsAndFillWriterVectors(OperationContext* opCtx,
                                         MultiApplier::Operations* ops,
                                         std::vector<MultiApplier::OperationPtrs>* writerVectors,
@@ -140,6 +158,15 @@ protected:
                                             WorkerMultikeyPathInfo* workerMultikeyPathInfo);
 };
 
+/**
+ * Distributes 'conflictGroups' over 'writerVectors'. The operations within a group may conflict
+ * with each other, so every group is appended whole and in order to a single writer, while groups
+ * are independent of one another. Groups are placed largest first on the writer with the fewest
+ * operations so far, which keeps all writers busy even when a few documents are hot.
+ */
+void assignConflictGroupsToWriters(std::vector<MultiApplier::OperationPtrs>* conflictGroups,
+                                   std::vector<MultiApplier::OperationPtrs>* writerVectors);
+
 /**
  * Applies either a single oplog entry or a set of grouped insert operations.
  */
@@ -31,6 +31,7 @@
 
 #include <algorithm>
 #include <memory>
+#include <set>
 #include <utility>
 #include <vector>
 
@@ -312,6 +313,86 @@ Status TrackOpsAppliedApplier::applyOplogBatchPerWorker(
     return Status::OK();
 }
 
+TEST(AssignConflictGroupsToWritersTest, SkewedGroupsStillUseAllWriters) {
+    NamespaceString nss("test.t");
+    MultiApplier::Operations ops(16, makeOplogEntry(OpTypeEnum::kInsert, nss, boost::none));
+
+    // One hot group holding half of the operations, and eight groups of one operation each.
+    std::vector<MultiApplier::OperationPtrs> conflictGroups(32);
+    for (size_t i = 0; i < 8; ++i) {
+        conflictGroups[5].push_back(&ops[i]);
+        conflictGroups[8 + i].push_back(&ops[8 + i]);
+    }
+
+    std::vector<MultiApplier::OperationPtrs> writerVectors(4);
+    assignConflictGroupsToWriters(&conflictGroups, &writerVectors);
+
+    // The hot group stays whole and in order on a writer of its own, and the remaining operations
+    // are spread evenly over the other writers.
+    std::vector<size_t> sizes;
+    std::set<const OplogEntry*> assigned;
+    for (auto&& writer : writerVectors) {
+        ASSERT_FALSE(writer.empty());
+        sizes.push_back(writer.size());
+        assigned.insert(writer.begin(), writer.end());
+        if (writer.front() == &ops[0]) {
+            ASSERT_EQUALS(8U, writer.size());
+            for (size_t i = 0; i < 8; ++i) {
+                ASSERT_EQUALS(&ops[i], writer[i]);
+            }
+        }
+    }
+    std::sort(sizes.begin(), sizes.end());
+    ASSERT_TRUE(sizes == std::vector<size_t>({2, 3, 3, 8}));
+    ASSERT_EQUALS(ops.size(), assigned.size());
+}
+
+TEST(AssignConflictGroupsToWritersTest, GroupsAreNeverSplitAcrossWriters) {
+    NamespaceString nss("test.t");
+    MultiApplier::Operations ops(12, makeOplogEntry(OpTypeEnum::kInsert, nss, boost::none));
+
+    std::vector<MultiApplier::OperationPtrs> conflictGroups(3);
+    for (size_t i = 0; i < ops.size(); ++i) {
+        conflictGroups[i % 3].push_back(&ops[i]);
+    }
+
+    std::vector<MultiApplier::OperationPtrs> writerVectors(8);
+    assignConflictGroupsToWriters(&conflictGroups, &writerVectors);
+
+    size_t writersUsed = 0;
+    for (auto&& writer : writerVectors) {
+        if (writer.empty()) {
+            continue;
+        }
+        ++writersUsed;
+        ASSERT_EQUALS(4U, writer.size());
+        for (size_t i = 1; i < writer.size(); ++i) {
+            ASSERT_EQUALS(writer[i - 1] + 3, writer[i]);
+        }
+    }
+    ASSERT_EQUALS(3U, writersUsed);
+}
+
+TEST(OpQueueTest, TakesOverBatchWithoutCopyingEntries) {
+    NamespaceString nss("test.a_namespace_too_long_for_the_small_string_buffer");
+    MultiApplier::Operations ops(5, makeOplogEntry(OpTypeEnum::kInsert, nss, boost::none));
+    size_t expectedBytes = 0;
+    for (const auto& op : ops) {
+        expectedBytes += op.getRawObjSizeBytes();
+    }
+    const auto* entries = ops.data();
+    const auto* nssData = ops.front().getNss().ns().data();
+
+    OpQueue queue(std::move(ops));
+    ASSERT_EQUALS(5U, queue.getCount());
+    ASSERT_EQUALS(expectedBytes, queue.getBytes());
+    ASSERT_EQUALS(entries, queue.getBatch().data());
+
+    auto released = queue.releaseBatch();
+    ASSERT_EQUALS(entries, released.data());
+    ASSERT_EQUALS(nssData, released.front().getNss().ns().data());
+}
+
 DEATH_TEST_F(OplogApplierImplTest, MultiApplyAbortsWhenNoOperationsAreGiven, "!ops.empty()") {
     auto writerPool = makeReplWriterPool();
     NoopOplogApplierObserver observer;
@@ -134,6 +134,26 @@ TEST(OplogEntryTest, OpTimeAndWallTimeBaseNonStrictParsing) {
         40414);
 }
 
+TEST(OplogEntryTest, ParsingSharesTheBufferOfTheFetchedBatch) {
+    const BSONObj doc = BSON("_id" << docId << "a" << 5);
+    const BSONObj reply =
+        BSON("cursor" << BSON("nextBatch" << BSON_ARRAY(
+                                  makeInsertDocumentOplogEntry(entryOpTime, nss, doc).toBSON())));
+
+    // Fetched documents are views into the reply, which they share ownership of.
+    BSONObj fetched = reply["cursor"]["nextBatch"].Obj().firstElement().Obj();
+    fetched.shareOwnershipWith(reply);
+
+    const OplogEntry entry(fetched);
+    ASSERT_EQ(fetched.objdata(), entry.getRaw().objdata());
+    ASSERT_EQ(fetched["o"].Obj().objdata(), entry.getObject().objdata());
+    ASSERT_BSONOBJ_EQ(doc, entry.getObject());
+
+    const auto copied = entry;
+    ASSERT_EQ(fetched.objdata(), copied.getRaw().objdata());
+    ASSERT_EQ(fetched["o"].Obj().objdata(), copied.getObject().objdata());
+}
+
 
 }  // namespace
 }  // namespace repl
@@ -44,7 +44,6 @@ OpQueueBatcher::OpQueueBatcher(OplogApplier* oplogApplier,
       _storageInterface(storageInterface),
       _oplogBuffer(oplogBuffer),
       _getNextApplierBatchFn(getNextApplierBatchFn),
-      _ops(0),
       _thread([this] { run(); }) {}
 OpQueueBatcher::~OpQueueBatcher() {
     invariant(_isDead);
@@ -54,23 +53,25 @@ OpQueueBatcher::~OpQueueBatcher() {
 
 OpQueue OpQueueBatcher::getNextBatch(Seconds maxWaitTime) {
     stdx::unique_lock<Latch> lk(_mutex);
-    // _ops can indicate the following cases:
+    // The front of _readyBatches can indicate the following cases:
     // 1. A new batch is ready to consume.
     // 2. Shutdown.
     // 3. The batch has (or had) exhausted the buffer in draining mode.
-    // 4. Empty batch since the batch has/had exhausted the buffer but not in draining mode,
-    //    so there could be new oplog entries coming.
-    // 5. Empty batch since the batcher is still running.
     //
-    // In case (4) and (5), we wait for up to "maxWaitTime".
-    if (_ops.empty() && !_ops.mustShutdown() && !_ops.termWhenExhausted()) {
+    // If no batch is ready, either because the batch has/had exhausted the buffer but not in
+    // draining mode, so there could be new oplog entries coming, or because the batcher is still
+    // running, we wait for up to "maxWaitTime".
+    if (_readyBatches.empty()) {
         // We intentionally don't care about whether this returns due to signaling or timeout
-        // since we do the same thing either way: return whatever is in _ops.
+        // since we do the same thing either way: return whatever is ready.
         (void)_cv.wait_for(lk, maxWaitTime.toSystemDuration());
     }
+    if (_readyBatches.empty()) {
+        return OpQueue(0);
+    }
 
-    OpQueue ops = std::move(_ops);
-    _ops = OpQueue(0);
+    OpQueue ops = std::move(_readyBatches.front());
+    _readyBatches.pop_front();
     _cv.notify_all();
     return ops;
 }
@@ -103,7 +104,7 @@ void OpQueueBatcher::run() {
         // Check the limits once per batch since users can change them at runtime.
         batchLimits.ops = getBatchLimitOplogEntries();
 
-        OpQueue ops(batchLimits.ops);
+        OpQueue ops(0);
         {
             auto opCtx = cc().makeOperationContext();
 
@@ -118,14 +119,12 @@ void OpQueueBatcher::run() {
             // Locks the oplog to check its max size, do this in the UninterruptibleLockGuard.
             batchLimits.bytes = getBatchLimitOplogBytes(opCtx.get(), _storageInterface);
 
-            auto oplogEntries =
-                fassertNoTrace(31004, _getNextApplierBatchFn(opCtx.get(), batchLimits));
-            for (const auto& oplogEntry : oplogEntries) {
-                ops.emplace_back(oplogEntry);
-            }
+            // The entries are moved rather than copied into the batch, since they are applied
+            // from the batch and copying them would duplicate their parsed fields.
+            ops = OpQueue(fassertNoTrace(31004, _getNextApplierBatchFn(opCtx.get(), batchLimits)));
 
             // If we don't have anything in the queue, wait a bit for something to appear.
-            if (oplogEntries.empty()) {
+            if (ops.empty()) {
                 if (_oplogApplier->inShutdown()) {
                     ops.setMustShutdownFlag();
                 } else {
@@ -166,11 +165,17 @@ void OpQueueBatcher::run() {
         }
 
         stdx::unique_lock<Latch> lk(_mutex);
-        // Block until the previous batch has been taken.
-        _cv.wait(lk, [&] { return _ops.empty() && !_ops.termWhenExhausted(); });
-        _ops = std::move(ops);
+        // Block until there is room for another ready batch. Nothing may be queued behind a
+        // drained batch until the applier has taken it, since signaling drain complete can end
+        // the applier's use of the buffer.
+        _cv.wait(lk, [&] {
+            return _readyBatches.size() < getBatcherMaxReadyBatches() &&
+                (_readyBatches.empty() || !_readyBatches.back().termWhenExhausted());
+        });
+        const bool mustShutdown = ops.mustShutdown();
+        _readyBatches.push_back(std::move(ops));
         _cv.notify_all();
-        if (_ops.mustShutdown()) {
+        if (mustShutdown) {
             _isDead = true;
             return;
         }
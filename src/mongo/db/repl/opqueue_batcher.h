@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <deque>
+
 #include "mongo/db/repl/initial_syncer.h"
 #include "mongo/db/repl/oplog_applier_impl.h"
 
@@ -41,6 +43,15 @@ public:
         _batch.reserve(batchLimitOps);
     }
 
+    /**
+     * Takes over the entries of 'batch' without copying them.
+     */
+    explicit OpQueue(std::vector<OplogEntry> batch) : _batch(std::move(batch)), _bytes(0) {
+        for (const auto& entry : _batch) {
+            _bytes += entry.getRawObjSizeBytes();
+        }
+    }
+
     size_t getBytes() const {
         return _bytes;
     }
@@ -130,7 +141,11 @@ public:
     virtual ~OpQueueBatcher();
 
     /**
-     *  Retrieves the next batch of ops that are ready to apply.
+     * Retrieves the next batch of ops that are ready to apply. Waits up to 'maxWaitTime' for one
+     * to be formed, and returns an empty batch with no flags set if none was.
+     *
+     * The batcher forms up to 'replBatcherMaxReadyBatches' batches ahead of the applier, so the
+     * next batch is usually already waiting when the applier finishes the current one.
      */
     OpQueue getNextBatch(Seconds maxWaitTime);
 
@@ -150,7 +165,9 @@ private:
 
     Mutex _mutex = MONGO_MAKE_LATCH("OpQueueBatcher::_mutex");
     stdx::condition_variable _cv;
-    OpQueue _ops;
+
+    // Batches formed but not yet handed to the applier, oldest first.
+    std::deque<OpQueue> _readyBatches;
 
     // This only exists so the destructor invariants rather than deadlocking.
     bool _isDead = false;
@@ -0,0 +1,154 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <deque>
+#include <exception>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "mongo/db/sorter/sorter.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_name.h"
+
+namespace mongo {
+
+/**
+ * Drains a SortIteratorInterface on a background thread and hands its output to the consumer in
+ * batches, so that reading and merging spilled files overlaps with whatever the consumer does
+ * with the data. At most 'maxQueuedBatches' batches are read ahead.
+ *
+ * The source iterator is only ever touched by the background thread, which is joined before the
+ * prefetcher is destroyed. Errors thrown by the source are rethrown by nextBatch().
+ */
+template <typename Key, typename Value>
+class SortIteratorPrefetcher {
+    SortIteratorPrefetcher(const SortIteratorPrefetcher&) = delete;
+    SortIteratorPrefetcher& operator=(const SortIteratorPrefetcher&) = delete;
+
+public:
+    using Data = std::pair<Key, Value>;
+    using Iterator = SortIteratorInterface<Key, Value>;
+
+    SortIteratorPrefetcher(std::unique_ptr<Iterator> source,
+                           size_t batchSize,
+                           size_t maxQueuedBatches)
+        : _source(std::move(source)),
+          _batchSize(batchSize),
+          _maxQueuedBatches(maxQueuedBatches) {
+        invariant(_batchSize > 0);
+        invariant(_maxQueuedBatches > 0);
+        _thread = stdx::thread([this] { _run(); });
+    }
+
+    ~SortIteratorPrefetcher() {
+        {
+            stdx::lock_guard<Latch> lk(_mutex);
+            _shutdown = true;
+        }
+        _spaceAvailable.notify_one();
+        _thread.join();
+    }
+
+    /**
+     * Replaces the contents of 'batch' with the next data in the source's order. Blocks until a
+     * batch has been read ahead. Returns false once the source is exhausted.
+     */
+    bool nextBatch(std::vector<Data>* batch) {
+        stdx::unique_lock<Latch> lk(_mutex);
+        _batchAvailable.wait(lk, [&] { return !_batches.empty() || _exhausted || _error; });
+        if (_error) {
+            std::rethrow_exception(_error);
+        }
+        if (_batches.empty()) {
+            return false;
+        }
+
+        *batch = std::move(_batches.front());
+        _batches.pop_front();
+        lk.unlock();
+        _spaceAvailable.notify_one();
+        return true;
+    }
+
+private:
+    void _run() {
+        setThreadName("SortIteratorPrefetcher");
+        try {
+            while (_source->more()) {
+                std::vector<Data> batch;
+                batch.reserve(_batchSize);
+                while (batch.size() < _batchSize && _source->more()) {
+                    batch.push_back(_source->next());
+                }
+
+                stdx::unique_lock<Latch> lk(_mutex);
+                _spaceAvailable.wait(
+                    lk, [&] { return _batches.size() < _maxQueuedBatches || _shutdown; });
+                if (_shutdown) {
+                    return;
+                }
+                _batches.push_back(std::move(batch));
+                lk.unlock();
+                _batchAvailable.notify_one();
+            }
+
+            stdx::lock_guard<Latch> lk(_mutex);
+            _exhausted = true;
+        } catch (...) {
+            stdx::lock_guard<Latch> lk(_mutex);
+            _error = std::current_exception();
+        }
+        _batchAvailable.notify_one();
+    }
+
+    const std::unique_ptr<Iterator> _source;
+    const size_t _batchSize;
+    const size_t _maxQueuedBatches;
+
+    Mutex _mutex = MONGO_MAKE_LATCH("SortIteratorPrefetcher::_mutex");
+    stdx::condition_variable _batchAvailable;
+    stdx::condition_variable _spaceAvailable;
+
+    // Guarded by '_mutex'.
+    std::deque<std::vector<Data>> _batches;
+    bool _exhausted = false;
+    bool _shutdown = false;
+    std::exception_ptr _error;
+
+    stdx::thread _thread;
+};
+
+}  // namespace mongo
@@ -38,6 +38,7 @@
 #include "mongo/base/static_assert.h"
 #include "mongo/config.h"
 #include "mongo/db/service_context_test_fixture.h"
+#include "mongo/db/sorter/sort_iterator_prefetcher.h"
 #include "mongo/platform/random.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/unittest/temp_dir.h"
@@ -366,6 +367,71 @@ public:
     }
 };
 
+class PrefetcherTests {
+public:
+    void run() {
+        {  // test empty
+            SortIteratorPrefetcher<IntWrapper, IntWrapper> prefetcher(
+                std::make_unique<EmptyIterator>(), 10, 2);
+            std::vector<IWPair> batch;
+            ASSERT_FALSE(prefetcher.nextBatch(&batch));
+        }
+        {  // test batches which do not evenly divide the input
+            SortIteratorPrefetcher<IntWrapper, IntWrapper> prefetcher(
+                std::make_unique<IntIterator>(0, 10007), 100, 2);
+            std::vector<IWPair> batch;
+            int expected = 0;
+            size_t numBatches = 0;
+            while (prefetcher.nextBatch(&batch)) {
+                ASSERT_LTE(batch.size(), 100U);
+                for (auto&& data : batch) {
+                    ASSERT_EQUALS(data.first, expected);
+                    ASSERT_EQUALS(data.second, -expected);
+                    expected++;
+                }
+                numBatches++;
+            }
+            ASSERT_EQUALS(expected, 10007);
+            ASSERT_EQUALS(numBatches, 101U);
+        }
+        {  // test stopping before the source is exhausted
+            SortIteratorPrefetcher<IntWrapper, IntWrapper> prefetcher(
+                std::make_unique<IntIterator>(0, 1000 * 1000), 10, 1);
+            std::vector<IWPair> batch;
+            ASSERT_TRUE(prefetcher.nextBatch(&batch));
+            ASSERT_EQUALS(batch.size(), 10U);
+        }
+        {  // test errors from the source are rethrown to the consumer
+            class ThrowingIterator : public IWIterator {
+            public:
+                void openSource() {}
+                void closeSource() {}
+                bool more() {
+                    return true;
+                }
+                IWPair next() {
+                    if (_pos == 25) {
+                        uasserted(ErrorCodes::InternalError, "source failed");
+                    }
+                    _pos++;
+                    return IWPair(_pos, -_pos);
+                }
+
+            private:
+                int _pos = 0;
+            };
+
+            SortIteratorPrefetcher<IntWrapper, IntWrapper> prefetcher(
+                std::make_unique<ThrowingIterator>(), 10, 4);
+            std::vector<IWPair> batch;
+            ASSERT_TRUE(prefetcher.nextBatch(&batch));
+            ASSERT_TRUE(prefetcher.nextBatch(&batch));
+            ASSERT_THROWS_CODE(
+                prefetcher.nextBatch(&batch), DBException, ErrorCodes::InternalError);
+        }
+    }
+};
+
 namespace SorterTests {
 class Basic : public ScopedGlobalServiceContextForTest {
 public:
@@ -589,6 +655,7 @@ public:
         add<InMemIterTests>();
         add<SortedFileWriterAndFileIteratorTests>();
         add<MergeIteratorTests>();
+        add<PrefetcherTests>();
         add<SorterTests::Basic>();
         add<SorterTests::Limit>();
         add<SorterTests::Dupes>();
@@ -37,6 +37,7 @@
 #include <type_traits>
 
 #include "mongo/base/data_cursor.h"
+#include "mongo/base/data_type_endian.h"
 #include "mongo/base/data_view.h"
 #include "mongo/bson/bson_depth.h"
 #include "mongo/platform/bits.h"
@@ -246,6 +247,16 @@ void memcpy_flipBits(void* dst, const void* src, size_t bytes) {
     const char* input = static_cast<const char*>(src);
     char* output = static_cast<char*>(dst);
     const char* const end = input + bytes;
+
+    // Flip a word at a time, which the compiler is also free to widen to vector registers, and
+    // finish the tail byte by byte.
+    for (; end - input >= static_cast<ptrdiff_t>(sizeof(uint64_t));
+         input += sizeof(uint64_t), output += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, input, sizeof(word));
+        word = ~word;
+        memcpy(output, &word, sizeof(word));
+    }
     while (input != end) {
         *output++ = ~(*input++);
     }
@@ -2547,7 +2558,20 @@ int compare(const char* leftBuf, const char* rightBuf, size_t leftSize, size_t r
     else if (MONGO_unlikely(rightSize == 0))
         return 1;
 
-    int min = std::min(leftSize, rightSize);
+    size_t min = std::min(leftSize, rightSize);
+
+    // Most keys which differ do so within their first few bytes. Comparing the first word as a
+    // big-endian integer orders the same as memcmp and settles those cases without a library call.
+    if (min >= sizeof(uint64_t)) {
+        const uint64_t leftPrefix = ConstDataView(leftBuf).read<BigEndian<uint64_t>>();
+        const uint64_t rightPrefix = ConstDataView(rightBuf).read<BigEndian<uint64_t>>();
+        if (leftPrefix != rightPrefix) {
+            return leftPrefix < rightPrefix ? -1 : 1;
+        }
+        leftBuf += sizeof(uint64_t);
+        rightBuf += sizeof(uint64_t);
+        min -= sizeof(uint64_t);
+    }
 
     int cmp = memcmp(leftBuf, rightBuf, min);
 
@@ -2565,6 +2589,22 @@ int compare(const char* leftBuf, const char* rightBuf, size_t leftSize, size_t r
     return leftSize < rightSize ? -1 : 1;
 }
 
+std::vector<Value> encodeBatch(Version version, const std::vector<BSONObj>& objs, Ordering ord) {
+    std::vector<Value> values;
+    values.reserve(objs.size());
+
+    Builder builder(version, ord);
+    for (auto&& obj : objs) {
+        builder.resetToEmpty(ord);
+        for (auto&& elem : obj) {
+            builder.appendBSONElement(elem);
+        }
+        builder.appendDiscriminator(Discriminator::kInclusive);
+        values.push_back(builder.getValueCopy());
+    }
+    return values;
+}
+
 template class BuilderBase<BufBuilder>;
 template class BuilderBase<StackBufBuilder>;
 
@@ -30,6 +30,7 @@
 #pragma once
 
 #include <limits>
+#include <vector>
 
 #include "mongo/base/static_assert.h"
 #include "mongo/bson/bsonelement_comparator_interface.h"
@@ -857,6 +858,15 @@ size_t sizeWithoutRecordIdAtEnd(const void* bufferRaw, size_t bufSize);
  */
 RecordId decodeRecordId(BufReader* reader);
 
+/**
+ * Encodes each object in 'objs' as a KeyString with ordering 'ord', ignoring field names, so the
+ * objects may be shard keys or other keys which still have them. The results are the same as
+ * releasing a HeapBuilder constructed from each object with its field names stripped, but a
+ * single builder is reused for the whole batch, so each key costs one allocation of exactly its
+ * encoded size rather than a series of buffer growths.
+ */
+std::vector<Value> encodeBatch(Version version, const std::vector<BSONObj>& objs, Ordering ord);
+
 int compare(const char* leftBuf, const char* rightBuf, size_t leftSize, size_t rightSize);
 
 template <class BufferT>
@@ -134,6 +134,37 @@ void BM_BSONToKeyString(benchmark::State& state,
     state.SetItemsProcessed(state.iterations() * kSampleSize);
 }
 
+void BM_BSONToKeyStringBatch(benchmark::State& state,
+                             const KeyString::Version version,
+                             BsonValueType bsonType) {
+    const BsonsAndKeyStrings bsonsAndKeyStrings = generateBsonsAndKeyStrings(bsonType, version);
+    const std::vector<BSONObj> bsons(std::begin(bsonsAndKeyStrings.bsons),
+                                     std::end(bsonsAndKeyStrings.bsons));
+    for (auto _ : state) {
+        benchmark::ClobberMemory();
+        benchmark::DoNotOptimize(KeyString::encodeBatch(version, bsons, ALL_ASCENDING));
+    }
+    state.SetBytesProcessed(state.iterations() * bsonsAndKeyStrings.bsonSize);
+    state.SetItemsProcessed(state.iterations() * kSampleSize);
+}
+
+void BM_KeyStringCompare(benchmark::State& state,
+                         const KeyString::Version version,
+                         BsonValueType bsonType) {
+    const BsonsAndKeyStrings bsonsAndKeyStrings = generateBsonsAndKeyStrings(bsonType, version);
+    for (auto _ : state) {
+        benchmark::ClobberMemory();
+        for (size_t i = 1; i < kSampleSize; i++) {
+            benchmark::DoNotOptimize(KeyString::compare(bsonsAndKeyStrings.keystrings[i - 1].get(),
+                                                        bsonsAndKeyStrings.keystrings[i].get(),
+                                                        bsonsAndKeyStrings.keystringLens[i - 1],
+                                                        bsonsAndKeyStrings.keystringLens[i]));
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * bsonsAndKeyStrings.keystringSize);
+    state.SetItemsProcessed(state.iterations() * (kSampleSize - 1));
+}
+
 void BM_KeyStringToBSON(benchmark::State& state,
                         const KeyString::Version version,
                         BsonValueType bsonType) {
@@ -236,6 +267,18 @@ BENCHMARK_CAPTURE(BM_BSONToKeyString, V1_String, KeyString::Version::V1, STRING)
 BENCHMARK_CAPTURE(BM_BSONToKeyString, V0_Array, KeyString::Version::V0, ARRAY);
 BENCHMARK_CAPTURE(BM_BSONToKeyString, V1_Array, KeyString::Version::V1, ARRAY);
 
+BENCHMARK_CAPTURE(BM_BSONToKeyStringBatch, V1_Int, KeyString::Version::V1, INT);
+BENCHMARK_CAPTURE(BM_BSONToKeyStringBatch, V1_Double, KeyString::Version::V1, DOUBLE);
+BENCHMARK_CAPTURE(BM_BSONToKeyStringBatch, V1_Decimal, KeyString::Version::V1, DECIMAL);
+BENCHMARK_CAPTURE(BM_BSONToKeyStringBatch, V1_String, KeyString::Version::V1, STRING);
+BENCHMARK_CAPTURE(BM_BSONToKeyStringBatch, V1_Array, KeyString::Version::V1, ARRAY);
+
+BENCHMARK_CAPTURE(BM_KeyStringCompare, V1_Int, KeyString::Version::V1, INT);
+BENCHMARK_CAPTURE(BM_KeyStringCompare, V1_Double, KeyString::Version::V1, DOUBLE);
+BENCHMARK_CAPTURE(BM_KeyStringCompare, V1_Decimal, KeyString::Version::V1, DECIMAL);
+BENCHMARK_CAPTURE(BM_KeyStringCompare, V1_String, KeyString::Version::V1, STRING);
+BENCHMARK_CAPTURE(BM_KeyStringCompare, V1_Array, KeyString::Version::V1, ARRAY);
+
 BENCHMARK_CAPTURE(BM_KeyStringToBSON, V0_Int, KeyString::Version::V0, INT);
 BENCHMARK_CAPTURE(BM_KeyStringToBSON, V1_Int, KeyString::Version::V1, INT);
 BENCHMARK_CAPTURE(BM_KeyStringToBSON, V0_Double, KeyString::Version::V0, DOUBLE);
@@ -1292,6 +1292,71 @@ int compareNumbers(const BSONElement& lhs, const BSONElement& rhs) {
     }
 }
 
+TEST_F(KeyStringBuilderTest, EncodeBatchMatchesIndividualEncoding) {
+    const std::string withNuls("a\0bcdefghij\0\0klmnopqrstuvwxyz\0", 30);
+    const std::vector<BSONObj> objs = {
+        BSON("" << 1 << "" << 2.5),
+        BSON("" << withNuls << "" << -3LL),
+        BSON("" << std::string(600, 'x') << "" << 0.1),
+        BSON("" << BSON("a" << withNuls) << "" << MINKEY),
+        BSON("" << Decimal128("1.10") << "" << BSONNULL),
+        BSON("" << 12.75 << "" << std::string(17, '\0')),
+    };
+
+    // Field names are ignored, as they are when shard keys are looked up in the routing table.
+    std::vector<BSONObj> namedObjs;
+    for (auto&& obj : objs) {
+        BSONObjIterator it(obj);
+        namedObjs.push_back(BSON("a" << it.next() << "b" << it.next()));
+    }
+
+    const Ordering allDescending = Ordering::make(BSON("a" << -1 << "b" << -1));
+    for (auto&& ord : {ALL_ASCENDING, ONE_DESCENDING, allDescending}) {
+        const auto values = KeyString::encodeBatch(version, objs, ord);
+        const auto namedValues = KeyString::encodeBatch(version, namedObjs, ord);
+        ASSERT_EQ(values.size(), objs.size());
+        ASSERT_EQ(namedValues.size(), objs.size());
+        for (size_t i = 0; i < objs.size(); ++i) {
+            KeyString::HeapBuilder expected(version, objs[i], ord);
+            ASSERT_EQ(values[i].compare(expected), 0);
+            ASSERT_EQ(namedValues[i].compare(expected), 0);
+            ASSERT_EQ(values[i].getTypeBits().getSize(), expected.getTypeBits().getSize());
+            ASSERT_EQ(0,
+                      memcmp(values[i].getTypeBits().getBuffer(),
+                             expected.getTypeBits().getBuffer(),
+                             expected.getTypeBits().getSize()));
+            ASSERT_BSONOBJ_EQ(KeyString::toBson(values[i], ord), objs[i]);
+        }
+    }
+}
+
+TEST(KeyStringTest, CompareMatchesMemcmpOrdering) {
+    std::mt19937 gen(1234);
+    std::uniform_int_distribution<int> lenDist(0, 20);
+    // A small alphabet makes long common prefixes, and prefixes of other keys, common.
+    std::uniform_int_distribution<int> byteDist(0xFE, 0x101);
+
+    const auto referenceCompare = [](const std::string& lhs, const std::string& rhs) {
+        const int cmp = lhs.compare(rhs);
+        return cmp < 0 ? -1 : (cmp > 0 ? 1 : 0);
+    };
+
+    for (int i = 0; i < 10000; ++i) {
+        std::string lhs(lenDist(gen), '\0');
+        std::string rhs(lenDist(gen), '\0');
+        for (auto&& c : lhs) {
+            c = static_cast<char>(byteDist(gen));
+        }
+        for (auto&& c : rhs) {
+            c = static_cast<char>(byteDist(gen));
+        }
+        ASSERT_EQ(KeyString::compare(lhs.data(), rhs.data(), lhs.size(), rhs.size()),
+                  referenceCompare(lhs, rhs))
+            << "lhs: " << hexdump(lhs.data(), lhs.size())
+            << " rhs: " << hexdump(rhs.data(), rhs.size());
+    }
+}
+
 TEST_F(KeyStringBuilderTest, NaNs) {
     // TODO use hex floats to force distinct NaNs
     const double nan1 = std::numeric_limits<double>::quiet_NaN();
@@ -66,7 +66,7 @@ void initializeStorageEngine(ServiceContext* service, const StorageEngineInitFla
     invariant(!service->getStorageEngine());
 
     if (0 == (initFlags & StorageEngineInitFlags::kAllowNoLockFile)) {
-        createLockFile(service);
+        lockDataDirectory(service);
     }
 
     const std::string dbpath = storageGlobalParams.dbpath;
@@ -145,6 +145,7 @@ void initializeStorageEngine(ServiceContext* service, const StorageEngineInitFla
         auto& lockFile = StorageEngineLockFile::get(service);
         if (lockFile) {
             lockFile->close();
+            lockFile = boost::none;
         }
     });
 
@@ -177,6 +178,7 @@ void shutdownGlobalStorageEngineCleanly(ServiceContext* service) {
     auto& lockFile = StorageEngineLockFile::get(service);
     if (lockFile) {
         lockFile->clearPidAndUnlock();
+        lockFile = boost::none;
     }
 }
 
@@ -217,6 +219,12 @@ auto storageFactories = ServiceContext::declareDecoration<FactoryMap>();
 
 }  // namespace
 
+void lockDataDirectory(ServiceContext* service) {
+    if (!StorageEngineLockFile::get(service)) {
+        createLockFile(service);
+    }
+}
+
 void registerStorageEngine(ServiceContext* service,
                            std::unique_ptr<StorageEngine::Factory> factory) {
     // No double-registering.
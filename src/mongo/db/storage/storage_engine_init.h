@@ -51,6 +51,12 @@ enum StorageEngineInitFlags {
  */
 void initializeStorageEngine(ServiceContext* service, StorageEngineInitFlags initFlags);
 
+/**
+ * Locks the dbpath by opening mongod.lock, unless it is locked already. initializeStorageEngine()
+ * does this itself; anything which writes to the dbpath before it must call this first.
+ */
+void lockDataDirectory(ServiceContext* service);
+
 /**
  * Shuts down storage engine cleanly and releases any locks on mongod.lock.
  */
@@ -142,7 +142,9 @@ public:
                                 _written < _maxLogSize);
 
                         out.write(db.getCursor().data(), db.size());
-                        out.write(toWrite.buf(), toWrite.size());
+                        for (auto&& range : toWrite.buffers()) {
+                            out.write(range.data(), range.length());
+                        }
                     }
                 }
             } catch (const ExceptionFor<ErrorCodes::ProducerConsumerQueueConsumed>&) {
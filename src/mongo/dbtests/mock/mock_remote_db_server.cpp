@@ -194,10 +194,25 @@ mongo::BSONArray MockRemoteDBServer::query(MockRemoteDBServer::InstanceID id,
     scoped_spinlock sLock(_lock);
     _queryCount++;
 
+    // The query filter is ignored, but the $min and $max index bounds are honored so that a
+    // collection can be read in ranges.
+    const auto minElem = query.obj["$min"];
+    const auto maxElem = query.obj["$max"];
+    const BSONObj min = minElem.isABSONObj() ? minElem.Obj() : BSONObj();
+    const BSONObj max = maxElem.isABSONObj() ? maxElem.Obj() : BSONObj();
+
     auto ns = nsOrUuid.uuid() ? _uuidToNs[*nsOrUuid.uuid()] : nsOrUuid.nss()->ns();
     const vector<BSONObj>& coll = _dataMgr[ns];
     BSONArrayBuilder result;
     for (vector<BSONObj>::const_iterator iter = coll.begin(); iter != coll.end(); ++iter) {
+        if (!min.isEmpty() &&
+            iter->extractFieldsUnDotted(min).woCompare(min, BSONObj(), false) < 0) {
+            continue;
+        }
+        if (!max.isEmpty() &&
+            iter->extractFieldsUnDotted(max).woCompare(max, BSONObj(), false) >= 0) {
+            continue;
+        }
         result.append(iter->copy());
     }
 
@@ -47,10 +47,12 @@
 #include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/storage/record_store.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/fail_point.h"
+#include "mongo/util/scopeguard.h"
 
 namespace query_stage_collection_scan {
 
@@ -179,6 +181,52 @@ TEST_F(QueryStageCollectionScanTest, QueryStageCollscanBasicBackwardWithMatch) {
     ASSERT_EQUALS(25, countResults(CollectionScanParams::BACKWARD, obj));
 }
 
+// Evaluate the filter with several threads, in both directions.
+TEST_F(QueryStageCollectionScanTest, QueryStageCollscanWithParallelFilter) {
+    internalQueryCollectionScanFilterWorkers.store(4);
+    ON_BLOCK_EXIT([] { internalQueryCollectionScanFilterWorkers.store(1); });
+
+    BSONObj obj = BSON("foo" << BSON("$lt" << 25));
+    ASSERT_EQUALS(25, countResults(CollectionScanParams::FORWARD, obj));
+    ASSERT_EQUALS(25, countResults(CollectionScanParams::BACKWARD, obj));
+
+    obj = BSON("$or" << BSON_ARRAY(BSON("foo" << 3) << BSON("foo" << BSON("$gte" << 40))));
+    ASSERT_EQUALS(11, countResults(CollectionScanParams::FORWARD, obj));
+}
+
+// A parallel filter still returns matching objects in the order we inserted them.
+TEST_F(QueryStageCollectionScanTest, QueryStageCollscanParallelFilterObjectsInOrder) {
+    AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+    auto collection = ctx.getCollection();
+
+    internalQueryCollectionScanFilterWorkers.store(4);
+    ON_BLOCK_EXIT([] { internalQueryCollectionScanFilterWorkers.store(1); });
+
+    CollectionScanParams params;
+    params.direction = CollectionScanParams::FORWARD;
+
+    const boost::intrusive_ptr<ExpressionContext> expCtx(new ExpressionContext(&_opCtx, nullptr));
+    auto filterExpr = uassertStatusOK(
+        MatchExpressionParser::parse(BSON("foo" << BSON("$mod" << BSON_ARRAY(3 << 0))), expCtx));
+
+    unique_ptr<WorkingSet> ws = std::make_unique<WorkingSet>();
+    unique_ptr<PlanStage> ps = std::make_unique<CollectionScan>(
+        &_opCtx, collection, params, ws.get(), filterExpr.get());
+
+    auto statusWithPlanExecutor = PlanExecutor::make(
+        &_opCtx, std::move(ws), std::move(ps), collection, PlanExecutor::NO_YIELD);
+    ASSERT_OK(statusWithPlanExecutor.getStatus());
+    auto exec = std::move(statusWithPlanExecutor.getValue());
+
+    int expected = 0;
+    BSONObj obj;
+    while (PlanExecutor::ADVANCED == exec->getNext(&obj, nullptr)) {
+        ASSERT_EQUALS(expected, obj["foo"].numberInt());
+        expected += 3;
+    }
+    ASSERT_EQUALS(51, expected);
+}
+
 // Get objects in the order we inserted them.
 TEST_F(QueryStageCollectionScanTest, QueryStageCollscanObjectsInOrderForward) {
     AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
@@ -409,6 +409,8 @@ void client_wire_protocol_rpc(mongo_embedded_v1_client* const client,
     Message msg(std::move(sb));
 
     client->response = sep->handleRequest(opCtx.get(), msg);
+    // The reply is handed back as a single buffer.
+    client->response.response.flatten();
 
     // Note that we skip OP_MSG's optional checksum for embedded.
     MsgData::View outMessage(client->response.response.buf());
@@ -31,6 +31,8 @@
 
 #include "mongo/rpc/message.h"
 
+#include <cstring>
+
 #include "mongo/platform/atomic_word.h"
 
 namespace mongo {
@@ -39,6 +41,52 @@ namespace {
 AtomicWord<int32_t> NextMsgId;
 }  // namespace
 
+void Message::flatten() {
+    if (_segments.empty()) {
+        return;
+    }
+
+    auto flat = SharedBuffer::allocate(size());
+    auto out = flat.get();
+    for (auto&& range : buffers()) {
+        std::memcpy(out, range.data(), range.length());
+        out += range.length();
+    }
+    invariant(out == flat.get() + size());
+
+    _buf = std::move(flat);
+    _segments.clear();
+}
+
+std::vector<ConstDataRange> Message::buffers() const {
+    if (empty()) {
+        return {};
+    }
+
+    std::vector<ConstDataRange> ranges;
+    ranges.reserve(_segments.size() * 2 + 1);
+
+    // The contiguous buffer holds every byte of the message which isn't in a segment.
+    size_t bufSize = size();
+    for (auto&& segment : _segments) {
+        bufSize -= segment.size;
+    }
+
+    size_t consumed = 0;
+    for (auto&& segment : _segments) {
+        invariant(segment.offset >= consumed && segment.offset <= bufSize);
+        if (segment.offset > consumed) {
+            ranges.emplace_back(_buf.get() + consumed, segment.offset - consumed);
+            consumed = segment.offset;
+        }
+        ranges.emplace_back(segment.data, segment.size);
+    }
+    if (bufSize > consumed) {
+        ranges.emplace_back(_buf.get() + consumed, bufSize - consumed);
+    }
+    return ranges;
+}
+
 int32_t nextMessageId() {
     return NextMsgId.fetchAndAdd(1);
 }
@@ -30,11 +30,14 @@
 #pragma once
 
 #include <cstdint>
+#include <vector>
 
+#include "mongo/base/data_range.h"
 #include "mongo/base/data_type_endian.h"
 #include "mongo/base/data_view.h"
 #include "mongo/base/encoded_value_storage.h"
 #include "mongo/base/static_assert.h"
+#include "mongo/util/shared_buffer.h"
 #include "mongo/util/str.h"
 
 namespace mongo {
@@ -390,11 +393,38 @@ inline int ConstView::dataLen() const {
 
 }  // namespace MsgData
 
+/**
+ * A wire protocol message.
+ *
+ * A message is normally a single contiguous buffer. Replies may additionally reference ranges of
+ * bytes owned by other buffers (such as large documents returned from a cursor), which are
+ * logically spliced into the message rather than copied into it. Such a message is written to the
+ * network with a scatter/gather send; anything that needs the message as one contiguous buffer
+ * must call flatten() first. The header and any OP_MSG flags always live in the contiguous buffer.
+ */
 class Message {
 public:
+    /**
+     * A range of bytes which logically follows the first 'offset' bytes of the contiguous buffer
+     * (and of any earlier segments at the same offset). 'owner' keeps 'data' alive.
+     */
+    struct ReferencedSegment {
+        size_t offset;
+        ConstSharedBuffer owner;
+        const char* data;
+        size_t size;
+    };
+
     Message() = default;
     explicit Message(SharedBuffer data) : _buf(std::move(data)) {}
 
+    /**
+     * Builds a message from a contiguous buffer and segments sorted by offset. The length in the
+     * header of 'data' must already account for the bytes in 'segments'.
+     */
+    Message(SharedBuffer data, std::vector<ReferencedSegment> segments)
+        : _buf(std::move(data)), _segments(std::move(segments)) {}
+
     MsgData::View header() const {
         verify(!empty());
         return _buf.get();
@@ -405,10 +435,27 @@ public:
     }
 
     MsgData::View singleData() const {
-        massert(13273, "single data buffer expected", _buf);
+        massert(13273, "single data buffer expected", _buf && _segments.empty());
         return header();
     }
 
+    /**
+     * Returns true if the whole message is in one buffer, i.e. it references no other buffers.
+     */
+    bool isContiguous() const {
+        return _segments.empty();
+    }
+
+    /**
+     * Copies any referenced segments into a single buffer holding the whole message.
+     */
+    void flatten();
+
+    /**
+     * Returns the ranges of bytes making up the message, in the order they are to be sent.
+     */
+    std::vector<ConstDataRange> buffers() const;
+
     bool empty() const {
         return !_buf;
     }
@@ -429,11 +476,13 @@ public:
     }
 
     void realloc(size_t size) {
+        invariant(_segments.empty());
         _buf.reallocOrCopy(size);
     }
 
     void reset() {
         _buf = {};
+        _segments.clear();
     }
 
     // use to set first buffer if empty
@@ -473,6 +522,7 @@ public:
 
 private:
     SharedBuffer _buf;
+    std::vector<ReferencedSegment> _segments;
 };
 
 /**
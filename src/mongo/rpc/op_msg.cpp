@@ -83,7 +83,8 @@ uint32_t OpMsg::flags(const Message& message) {
     if (message.operation() != dbMsg)
         return 0;  // Other command protocols are the same as no flags set.
 
-    return BufReader(message.singleData().data(), message.dataSize())
+    // The flags are always in the message's contiguous buffer, even if it references others.
+    return BufReader(message.header().data(), message.dataSize())
         .read<LittleEndian<uint32_t>>();
 }
 
@@ -92,7 +93,7 @@ void OpMsg::replaceFlags(Message* message, uint32_t flags) {
     invariant(message->operation() == dbMsg);
     invariant(message->dataSize() >= static_cast<int>(sizeof(uint32_t)));
 
-    DataView(message->singleData().data()).write<LittleEndian<uint32_t>>(flags);
+    DataView(message->header().data()).write<LittleEndian<uint32_t>>(flags);
 }
 
 uint32_t OpMsg::getChecksum(const Message& message) {
@@ -114,6 +115,8 @@ void OpMsg::appendChecksum(Message* message) {
     }
 
     invariant(!isFlagSet(*message, kChecksumPresent));
+    // The checksum covers the whole message, so it needs every byte in one buffer.
+    message->flatten();
     setFlag(message, kChecksumPresent);
     const size_t newSize = message->size() + kCrc32Size;
     if (message->capacity() < newSize) {
@@ -248,6 +251,75 @@ void OpMsg::shareOwnershipWith(const ConstSharedBuffer& buffer) {
     }
 }
 
+namespace {
+
+/**
+ * Appends the fields of 'obj', the object at 'prefix' (empty, or a dotted path ending in '.'), to
+ * 'bob', together with an array for each of 'sequences' whose name is a field of that object.
+ */
+void appendWithSequences(const BSONObj& obj,
+                         StringData prefix,
+                         const std::vector<OpMsg::DocumentSequence>& sequences,
+                         BSONObjBuilder* bob) {
+    // The first component of the rest of each sequence name nested deeper than this object.
+    std::set<std::string> nestedFields;
+    for (auto&& seq : sequences) {
+        StringData name(seq.name);
+        if (!name.startsWith(prefix)) {
+            continue;
+        }
+        const auto rest = name.substr(prefix.size());
+        const auto dot = rest.find('.');
+        if (dot != std::string::npos) {
+            nestedFields.insert(rest.substr(0, dot).toString());
+        }
+    }
+
+    for (auto&& elem : obj) {
+        const auto fieldName = elem.fieldNameStringData();
+        if (elem.type() != Object || !nestedFields.count(fieldName.toString())) {
+            bob->append(elem);
+            continue;
+        }
+        nestedFields.erase(fieldName.toString());
+        BSONObjBuilder sub(bob->subobjStart(fieldName));
+        appendWithSequences(
+            elem.Obj(), std::string(str::stream() << prefix << fieldName << "."), sequences, &sub);
+    }
+
+    // Sequences may be nested in objects which aren't in the body at all.
+    for (auto&& fieldName : nestedFields) {
+        BSONObjBuilder sub(bob->subobjStart(fieldName));
+        appendWithSequences(
+            BSONObj(), std::string(str::stream() << prefix << fieldName << "."), sequences, &sub);
+    }
+
+    for (auto&& seq : sequences) {
+        StringData name(seq.name);
+        if (!name.startsWith(prefix) ||
+            name.substr(prefix.size()).find('.') != std::string::npos) {
+            continue;
+        }
+        BSONArrayBuilder arr(bob->subarrayStart(name.substr(prefix.size())));
+        for (auto&& seqObj : seq.objs) {
+            arr.append(seqObj);
+        }
+    }
+}
+
+}  // namespace
+
+void OpMsg::moveSequencesIntoBody() {
+    if (sequences.empty()) {
+        return;
+    }
+
+    BSONObjBuilder bob;
+    appendWithSequences(body, "", sequences, &bob);
+    body = bob.obj();
+    sequences.clear();
+}
+
 auto OpMsgBuilder::beginDocSequence(StringData name) -> DocSequenceBuilder {
     invariant(_state == kEmpty || _state == kDocSequence);
     invariant(!_openBuilder);
@@ -264,7 +336,13 @@ void OpMsgBuilder::finishDocumentStream(DocSequenceBuilder* docSequenceBuilder)
     invariant(_state == kDocSequence);
     invariant(_openBuilder);
     _openBuilder = false;
-    const int32_t size = _buf.len() - docSequenceBuilder->_sizeOffset;
+    int32_t size = _buf.len() - docSequenceBuilder->_sizeOffset;
+    // Segments are in offset order, so those referenced by this sequence are at the back.
+    for (auto it = _segments.rbegin();
+         it != _segments.rend() && it->offset > size_t(docSequenceBuilder->_sizeOffset);
+         ++it) {
+        size += it->size;
+    }
     invariant(size > 0);
     DataView(_buf.buf()).write<LittleEndian<int32_t>>(size, docSequenceBuilder->_sizeOffset);
 }
@@ -303,19 +381,20 @@ Message OpMsgBuilder::finish() {
     invariant(!_openBuilder);
     _state = kDone;
 
-    const auto size = _buf.len();
+    const auto size = _buf.len() + _referencedBytes;
     MSGHEADER::View header(_buf.buf());
     header.setMessageLength(size);
     // header.setRequestMsgId(...); // These are currently filled in by the networking layer.
     // header.setResponseToMsgId(...);
     header.setOpCode(dbMsg);
-    return Message(_buf.release());
+    return Message(_buf.release(), std::move(_segments));
 }
 
 BSONObj OpMsgBuilder::releaseBody() {
     invariant(_state == kBody);
     invariant(_bodyStart);
     invariant(_bodyStart == sizeof(MSGHEADER::Layout) + 4 /*flags*/ + 1 /*body kind byte*/);
+    invariant(_segments.empty());
     invariant(!_openBuilder);
     _state = kDone;
 
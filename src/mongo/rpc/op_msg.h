@@ -125,6 +125,13 @@ struct OpMsg {
      */
     void shareOwnershipWith(const ConstSharedBuffer& buffer);
 
+    /**
+     * Appends each document sequence to the body as an array at the (possibly dotted) path given by
+     * its name, and then removes the sequences. For example, a reply whose batch was sent as the
+     * sequence "cursor.firstBatch" gets the usual cursor.firstBatch array in its body.
+     */
+    void moveSequencesIntoBody();
+
     /**
      * Returns a pointer to the sequence with the given name or nullptr if there are none.
      */
@@ -234,6 +241,8 @@ public:
 
     /**
      * Finish building and return a Message ready to give to the networking layer for transmission.
+     * The Message references any documents appended with DocSequenceBuilder::appendReferenced()
+     * rather than holding copies of them, so it may not be contiguous (see Message::flatten()).
      * It is illegal to call any methods on this object after calling this.
      */
     Message finish();
@@ -246,6 +255,8 @@ public:
 
         _buf.reset();
         skipHeaderAndFlags();
+        _segments.clear();
+        _referencedBytes = 0;
         _bodyStart = 0;
         _state = kEmpty;
         _openBuilder = false;
@@ -297,6 +308,9 @@ private:
 
     // When adding members, remember to update reset().
     BufBuilder _buf;
+    // Documents referenced by the message rather than copied into _buf, and their total size.
+    std::vector<Message::ReferencedSegment> _segments;
+    int _referencedBytes = 0;
     int _bodyStart = 0;
     State _state = kEmpty;
     bool _openBuilder = false;
@@ -311,6 +325,8 @@ private:
  *
  * docSeq.append(BSON("a" << 1)); // Copy an obj into the sequence
  *
+ * docSeq.appendReferenced(ownedObj); // Reference a large owned obj rather than copying it
+ *
  * auto bob = docSeq.appendBuilder(); // Build an obj in-place
  * bob.append("a", 2);
  * bob.doneFast();
@@ -349,6 +365,22 @@ public:
         _buf->appendBuf(obj.objdata(), obj.objsize());
     }
 
+    /**
+     * Appends a single document to this sequence by sharing ownership of its buffer until the
+     * message is sent, rather than by copying it. Documents which aren't owned, or are too small
+     * for referencing them to be cheaper than copying them, are copied as if by append().
+     */
+    void appendReferenced(const BSONObj& obj) {
+        if (!obj.isOwned() || obj.objsize() < kMinReferencedDocumentBytes) {
+            return append(obj);
+        }
+        _msgBuilder->_segments.push_back({static_cast<size_t>(_buf->len()),
+                                          obj.sharedBuffer(),
+                                          obj.objdata(),
+                                          static_cast<size_t>(obj.objsize())});
+        _msgBuilder->_referencedBytes += obj.objsize();
+    }
+
     /**
      * Returns a BSONObjBuilder that appends a single document to this sequence in place.
      * It is illegal to call any methods on this DocSequenceBuilder until the returned builder
@@ -358,10 +390,18 @@ public:
         return BSONObjBuilder(*_buf);
     }
 
+    /**
+     * Returns the size of the message built so far, including any referenced documents.
+     */
     int len() const {
-        return _buf->len();
+        return _buf->len() + _msgBuilder->_referencedBytes;
     }
 
+    /**
+     * Documents smaller than this are always copied into the message by appendReferenced().
+     */
+    static constexpr int kMinReferencedDocumentBytes = 4 * 1024;
+
 private:
     friend OpMsgBuilder;
 
@@ -38,8 +38,11 @@ namespace rpc {
 
 class OpMsgReply final : public rpc::ReplyInterface {
 public:
-    explicit OpMsgReply(const Message* message) : _msg(OpMsg::parseOwned(*message)) {}
-    explicit OpMsgReply(OpMsg msg) : _msg(std::move(msg)) {}
+    explicit OpMsgReply(const Message* message) : OpMsgReply(OpMsg::parseOwned(*message)) {}
+    explicit OpMsgReply(OpMsg msg) : _msg(std::move(msg)) {
+        // Replies may send large batches as document sequences, which callers expect in the body.
+        _msg.moveSequencesIntoBody();
+    }
     const BSONObj& getCommandReply() const override {
         return _msg.body;
     }
@@ -828,6 +828,73 @@ TEST(OpMsgSerializer, BodyAndInPlaceSequenceInPlaceWithReset) {
                    });
 }
 
+TEST(OpMsgSerializer, BodyAndReferencedSequences) {
+    const std::string padding(OpMsgBuilder::DocSequenceBuilder::kMinReferencedDocumentBytes, 'x');
+    const auto big1 = BSON("_id" << 1 << "padding" << padding);
+    const auto big2 = BSON("_id" << 2 << "padding" << padding);
+    const auto small = fromjson("{_id: 3}");
+    const auto unowned = BSONObj(big1.objdata());
+
+    OpMsgBuilder builder;
+    {
+        auto seq = builder.beginDocSequence("docs");
+        seq.appendReferenced(big1);
+        seq.appendReferenced(small);
+        seq.appendReferenced(unowned);
+        seq.appendReferenced(big2);
+    }
+    {
+        auto seq = builder.beginDocSequence("more");
+        seq.appendReferenced(big2);
+    }
+    builder.beginBody().append("ping", 1);
+    auto msg = builder.finish();
+
+    // Only the owned, large documents are referenced rather than copied.
+    ASSERT_FALSE(msg.isContiguous());
+    std::vector<const char*> referenced;
+    size_t totalSize = 0;
+    for (auto&& range : msg.buffers()) {
+        if (range.data() == big1.objdata() || range.data() == big2.objdata()) {
+            referenced.push_back(range.data());
+        }
+        totalSize += range.length();
+    }
+    ASSERT_EQ(totalSize, size_t(msg.size()));
+    ASSERT(referenced ==
+           std::vector<const char*>({big1.objdata(), big2.objdata(), big2.objdata()}));
+
+    // Flags can be read and changed without flattening the message.
+    OpMsg::setFlag(&msg, OpMsg::kMoreToCome);
+    ASSERT_TRUE(OpMsg::isFlagSet(msg, OpMsg::kMoreToCome));
+    ASSERT_FALSE(msg.isContiguous());
+    OpMsg::clearFlag(&msg, OpMsg::kMoreToCome);
+
+    msg.flatten();
+    ASSERT_TRUE(msg.isContiguous());
+    testSerializer(msg,
+                   OpMsgBytes{
+                       kNoFlags,  //
+                       kDocSequenceSection,
+                       Sized{
+                           "docs",  //
+                           big1,
+                           small,
+                           big1,
+                           big2,
+                       },
+
+                       kDocSequenceSection,
+                       Sized{
+                           "more",  //
+                           big2,
+                       },
+
+                       kBodySection,
+                       fromjson("{ping: 1}"),
+                   });
+}
+
 TEST(OpMsgSerializer, ReplaceFlagsWorks) {
     {
         auto msg = OpMsgBytes{~0u}.done();
@@ -931,6 +998,39 @@ TEST(OpMsgTest, ChecksumResizesMessage) {
     OpMsg::parse(msg);
 }
 
+TEST(OpMsgTest, ChecksumFlattensMessage) {
+    const std::string padding(OpMsgBuilder::DocSequenceBuilder::kMinReferencedDocumentBytes, 'x');
+    const auto big = BSON("padding" << padding);
+    OpMsgBuilder builder;
+    builder.beginDocSequence("docs").appendReferenced(big);
+    builder.beginBody().append("ping", 1);
+    auto msg = builder.finish();
+    ASSERT_FALSE(msg.isContiguous());
+
+    // The checksum covers the referenced document, so the message is copied into one buffer.
+    OpMsg::appendChecksum(&msg);
+    ASSERT_TRUE(msg.isContiguous());
+    auto parsed = OpMsg::parse(msg);
+    ASSERT_EQ(parsed.sequences.size(), 1U);
+    ASSERT_BSONOBJ_EQ(parsed.sequences[0].objs[0], big);
+}
+
+TEST(OpMsgTest, MoveSequencesIntoBody) {
+    OpMsg msg;
+    msg.body = fromjson("{ok: 1, cursor: {id: 0, ns: 'db.coll'}}");
+    msg.sequences = {{"cursor.firstBatch", {fromjson("{_id: 1}"), fromjson("{_id: 2}")}},
+                     {"a.b.c", {fromjson("{_id: 3}")}},
+                     {"top", {}}};
+
+    msg.moveSequencesIntoBody();
+    ASSERT(msg.sequences.empty());
+    ASSERT_BSONOBJ_EQ(msg.body,
+                      fromjson("{ok: 1,"
+                               " cursor: {id: 0, ns: 'db.coll', firstBatch: [{_id: 1}, {_id: 2}]},"
+                               " a: {b: {c: [{_id: 3}]}},"
+                               " top: []}"));
+}
+
 TEST(OpMsgTest, EmptyMessageWithChecksumFlag) {
     // Checks that an empty message that would normally be invalid because it's
     // missing a body, is invalid because a checksum was specified in the flag
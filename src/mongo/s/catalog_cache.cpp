@@ -662,23 +662,29 @@ void CatalogCache::_scheduleCollectionRefresh(WithLock lk,
             return;
         }
 
-        stdx::lock_guard<Latch> lg(_mutex);
+        {
+            stdx::lock_guard<Latch> lg(_mutex);
 
-        collEntry->needsRefresh = false;
-        collEntry->refreshCompletionNotification->set(Status::OK());
-        collEntry->refreshCompletionNotification = nullptr;
+            collEntry->needsRefresh = false;
+            collEntry->refreshCompletionNotification->set(Status::OK());
+            collEntry->refreshCompletionNotification = nullptr;
 
-        if (!newRoutingInfo) {
-            // The refresh found that collection was dropped, so remove it from our cache.
-            auto itDb = _collectionsByDb.find(nss.db());
-            if (itDb == _collectionsByDb.end()) {
-                // The entire database was dropped.
+            if (!newRoutingInfo) {
+                // The refresh found that collection was dropped, so remove it from our cache.
+                auto itDb = _collectionsByDb.find(nss.db());
+                if (itDb == _collectionsByDb.end()) {
+                    // The entire database was dropped.
+                    return;
+                }
+                itDb->second.erase(nss.ns());
                 return;
             }
-            itDb->second.erase(nss.ns());
-            return;
+            collEntry->routingInfo = newRoutingInfo;
         }
-        collEntry->routingInfo = std::move(newRoutingInfo);
+
+        // Targeting searches the chunk map until the new routing table's boundary index is built,
+        // which happens here, after the operations waiting for the refresh have been released.
+        newRoutingInfo->buildBoundaryIndex();
     };
 
     const ChunkVersion startingCollectionVersion =
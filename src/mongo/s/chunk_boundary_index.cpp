@@ -0,0 +1,127 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/chunk_boundary_index.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "mongo/base/data_view.h"
+
+namespace mongo {
+namespace {
+
+uint64_t keyPrefix(StringData key) {
+    char bytes[sizeof(uint64_t)] = {};
+    std::memcpy(bytes, key.rawData(), std::min(key.size(), sizeof(bytes)));
+    return ConstDataView(bytes).read<BigEndian<uint64_t>>();
+}
+
+}  // namespace
+
+ChunkBoundaryIndex::ChunkBoundaryIndex(const ChunkInfoMap& chunkMap) {
+    _prefixes.reserve(chunkMap.size());
+    _offsets.reserve(chunkMap.size() + 1);
+    _chunks.reserve(chunkMap.size());
+
+    for (const auto& entry : chunkMap) {
+        _prefixes.push_back(keyPrefix(entry.first));
+        _offsets.push_back(_keys.size());
+        _keys.append(entry.first);
+        _chunks.push_back(entry.second.get());
+    }
+    _offsets.push_back(_keys.size());
+
+    for (size_t first = 0; first < _prefixes.size(); first += kBlockSize) {
+        _blockPrefixes.push_back(_prefixes[std::min(first + kBlockSize, _prefixes.size()) - 1]);
+    }
+}
+
+ChunkInfo* ChunkBoundaryIndex::upperBound(StringData keyString) const {
+    const auto prefix = keyPrefix(keyString);
+
+    // Finds the first block whose last key is greater than the key string
+    size_t lowBlock = 0;
+    size_t highBlock = _blockPrefixes.size();
+    while (lowBlock < highBlock) {
+        const auto block = lowBlock + (highBlock - lowBlock) / 2;
+        const auto last = std::min((block + 1) * kBlockSize, _chunks.size()) - 1;
+        if (_isGreater(_blockPrefixes[block], last, keyString, prefix)) {
+            highBlock = block;
+        } else {
+            lowBlock = block + 1;
+        }
+    }
+    if (lowBlock == _blockPrefixes.size()) {
+        return nullptr;
+    }
+
+    // Then the first such key within that block
+    size_t low = lowBlock * kBlockSize;
+    size_t high = std::min(low + kBlockSize, _chunks.size());
+    while (low < high) {
+        const auto i = low + (high - low) / 2;
+        if (_isGreater(_prefixes[i], i, keyString, prefix)) {
+            high = i;
+        } else {
+            low = i + 1;
+        }
+    }
+    return _chunks[low];
+}
+
+size_t ChunkBoundaryIndex::upperBoundFrom(StringData keyString, size_t from) const {
+    const auto prefix = keyPrefix(keyString);
+
+    // Checks the positions 1, 2, 4, ... after "from" until one is greater, which brackets the
+    // position between the last two checked
+    size_t low = from;
+    size_t high = from;
+    size_t step = 1;
+    while (high < _chunks.size() && !_isGreater(_prefixes[high], high, keyString, prefix)) {
+        low = high + 1;
+        high = std::min(high + step, _chunks.size());
+        step *= 2;
+    }
+
+    while (low < high) {
+        const auto i = low + (high - low) / 2;
+        if (_isGreater(_prefixes[i], i, keyString, prefix)) {
+            high = i;
+        } else {
+            low = i + 1;
+        }
+    }
+    return low;
+}
+
+}  // namespace mongo
@@ -0,0 +1,118 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mongo/base/string_data.h"
+#include "mongo/s/chunk_info_map.h"
+
+namespace mongo {
+
+/**
+ * Read-only index over the max key strings of the chunks of one routing table, for finding the
+ * chunk which contains a shard key.
+ *
+ * The key strings are stored back to back in one buffer, alongside their first 8 bytes as
+ * integers, so that most comparisons compare two integers from contiguous memory instead of
+ * chasing a pointer per key. The keys are split into blocks of kBlockSize, and a search first looks
+ * for the block among the blocks' last keys, which are few enough to stay in cache.
+ */
+class ChunkBoundaryIndex {
+    ChunkBoundaryIndex(const ChunkBoundaryIndex&) = delete;
+    ChunkBoundaryIndex& operator=(const ChunkBoundaryIndex&) = delete;
+
+public:
+    static constexpr size_t kBlockSize = 32;
+
+    explicit ChunkBoundaryIndex(const ChunkInfoMap& chunkMap);
+
+    /**
+     * Returns the first chunk whose max key string is greater than "keyString", which is the only
+     * chunk that may contain the key, or nullptr if there is no such chunk.
+     */
+    ChunkInfo* upperBound(StringData keyString) const;
+
+    /**
+     * Returns the position of the first max key string greater than "keyString", looking only at
+     * those from position "from" onwards, or size() if there is none. The search gallops forward
+     * from "from", so looking up keys in ascending order, each from the position of the one before,
+     * costs O(log d) per key for a distance d between their positions.
+     */
+    size_t upperBoundFrom(StringData keyString, size_t from) const;
+
+    ChunkInfo* chunkAt(size_t i) const {
+        return _chunks[i];
+    }
+
+    size_t size() const {
+        return _chunks.size();
+    }
+
+private:
+    /**
+     * Returns whether the key with "candidatePrefix" at position "i" is greater than "keyString",
+     * whose prefix is "prefix".
+     */
+    bool _isGreater(uint64_t candidatePrefix,
+                    size_t i,
+                    StringData keyString,
+                    uint64_t prefix) const {
+        if (candidatePrefix != prefix) {
+            return candidatePrefix > prefix;
+        }
+        return _key(i).compare(keyString) > 0;
+    }
+
+    StringData _key(size_t i) const {
+        return {_keys.data() + _offsets[i], _offsets[i + 1] - _offsets[i]};
+    }
+
+    // The first 8 bytes of each max key string, zero padded and read as a big-endian integer, so
+    // that keys whose prefixes differ compare the same way as their prefixes.
+    std::vector<uint64_t> _prefixes;
+
+    // The prefix of the last key of each block.
+    std::vector<uint64_t> _blockPrefixes;
+
+    // The max key strings, back to back, and the offset of each of them within '_keys', followed
+    // by the size of '_keys'.
+    std::string _keys;
+    std::vector<size_t> _offsets;
+
+    // The chunk which each max key string belongs to. The map which the index is built from owns
+    // them.
+    std::vector<ChunkInfo*> _chunks;
+};
+
+}  // namespace mongo
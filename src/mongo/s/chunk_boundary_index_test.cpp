@@ -0,0 +1,131 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/namespace_string.h"
+#include "mongo/platform/random.h"
+#include "mongo/s/catalog/type_chunk.h"
+#include "mongo/s/chunk_boundary_index.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("test.foo");
+const ShardId kShard("shard0");
+
+std::shared_ptr<ChunkInfo> makeChunk(int i) {
+    return std::make_shared<ChunkInfo>(ChunkType(kNss,
+                                                 ChunkRange{BSON("a" << i), BSON("a" << i + 1)},
+                                                 ChunkVersion(1, 0, OID::gen()),
+                                                 kShard));
+}
+
+// Returns a key of random length, which often shares a prefix of 8 bytes or more with others.
+std::string makeKey(PseudoRandom& random) {
+    std::string key(random.nextInt32(20), 'a');
+    for (auto& c : key) {
+        c = "\x00\x01\x7f\x80\xff"[random.nextInt32(5)];
+    }
+    return key;
+}
+
+void assertMatchesMap(const ChunkInfoMap& map, const ChunkBoundaryIndex& index, StringData key) {
+    const auto it = map.upper_bound(key.toString());
+    ASSERT_EQ(index.upperBound(key), it == map.end() ? nullptr : it->second.get());
+}
+
+TEST(ChunkBoundaryIndexTest, Empty) {
+    ChunkInfoMap map;
+    ChunkBoundaryIndex index(map);
+    ASSERT_EQ(index.size(), 0ull);
+    ASSERT_EQ(index.upperBound("a"), nullptr);
+    ASSERT_EQ(index.upperBound(""), nullptr);
+}
+
+TEST(ChunkBoundaryIndexTest, UpperBoundMatchesMap) {
+    PseudoRandom random(12345);
+
+    // Sizes around whole and partial blocks
+    for (int size : {1, 2, 31, 32, 33, 64, 100, 1000}) {
+        ChunkInfoMap map;
+        while (map.size() < size_t(size)) {
+            map.insert_or_assign(makeKey(random), makeChunk(map.size()));
+        }
+
+        ChunkBoundaryIndex index(map);
+        ASSERT_EQ(index.size(), map.size());
+
+        // Every max key and some around it, and random keys
+        for (const auto& entry : map) {
+            assertMatchesMap(map, index, entry.first);
+            assertMatchesMap(map, index, entry.first + '\0');
+            assertMatchesMap(map, index, StringData(entry.first).substr(0, entry.first.size() / 2));
+        }
+        for (int i = 0; i < 1000; ++i) {
+            assertMatchesMap(map, index, makeKey(random));
+        }
+    }
+}
+
+TEST(ChunkBoundaryIndexTest, UpperBoundFromSortedKeysMatchesMap) {
+    PseudoRandom random(54321);
+
+    for (int size : {1, 33, 1000}) {
+        ChunkInfoMap map;
+        while (map.size() < size_t(size)) {
+            map.insert_or_assign(makeKey(random), makeChunk(map.size()));
+        }
+        ChunkBoundaryIndex index(map);
+
+        // Sweeping sorted keys, each from the position of the one before, with both near and
+        // distant neighbours
+        for (int numKeys : {10, 5000}) {
+            std::vector<std::string> keys;
+            for (int i = 0; i < numKeys; ++i) {
+                keys.push_back(makeKey(random));
+            }
+            std::sort(keys.begin(), keys.end());
+
+            size_t pos = 0;
+            for (const auto& key : keys) {
+                pos = index.upperBoundFrom(key, pos);
+                const auto it = map.upper_bound(key);
+                ASSERT_EQ(pos, size_t(std::distance(map.begin(), it)));
+                ASSERT_EQ(pos < index.size() ? index.chunkAt(pos) : nullptr,
+                          it == map.end() ? nullptr : it->second.get());
+            }
+        }
+    }
+}
+
+}  // namespace
+}  // namespace mongo
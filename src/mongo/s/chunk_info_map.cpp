@@ -0,0 +1,316 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/chunk_info_map.h"
+
+#include <algorithm>
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace {
+
+bool entryKeyLess(const ChunkInfoMap::value_type& entry, const std::string& key) {
+    return entry.first < key;
+}
+
+bool keyLessThanEntry(const std::string& key, const ChunkInfoMap::value_type& entry) {
+    return key < entry.first;
+}
+
+}  // namespace
+
+void ChunkInfoMap::const_iterator::_descendToFirst(const Node* node) {
+    while (true) {
+        invariant(_depth < kMaxDepth);
+        _path[_depth++] = {node, 0};
+        if (node->isLeaf()) {
+            return;
+        }
+        node = node->children.front().get();
+    }
+}
+
+ChunkInfoMap::const_iterator& ChunkInfoMap::const_iterator::operator++() {
+    auto& leaf = _path[_depth - 1];
+    if (++leaf.pos < leaf.node->entries.size()) {
+        return *this;
+    }
+
+    // Climbs to the nearest ancestor with a child after the one taken, and descends to the first
+    // entry under that child. Climbing past the root leaves the end of the map.
+    --_depth;
+    while (_depth > 0) {
+        auto& frame = _path[_depth - 1];
+        if (++frame.pos < frame.node->children.size()) {
+            _descendToFirst(frame.node->children[frame.pos].get());
+            break;
+        }
+        --_depth;
+    }
+    return *this;
+}
+
+ChunkInfoMap::const_iterator ChunkInfoMap::begin() const {
+    const_iterator it;
+    if (_root) {
+        it._descendToFirst(_root.get());
+    }
+    return it;
+}
+
+template <typename ChildBound, typename EntryBound>
+ChunkInfoMap::const_iterator ChunkInfoMap::_seek(const std::string& key,
+                                                 ChildBound childBound,
+                                                 EntryBound entryBound) const {
+    const_iterator it;
+    const Node* node = _root.get();
+    if (!node) {
+        return it;
+    }
+
+    // The largest key within each child tells which child holds the first entry within the bound,
+    // so the search never has to backtrack.
+    while (!node->isLeaf()) {
+        const size_t pos =
+            childBound(node->maxKeys.begin(), node->maxKeys.end(), key) - node->maxKeys.begin();
+        if (pos == node->children.size()) {
+            return end();
+        }
+        invariant(it._depth < kMaxDepth);
+        it._path[it._depth++] = {node, pos};
+        node = node->children[pos].get();
+    }
+
+    const size_t pos = entryBound(node->entries.begin(), node->entries.end(), key) -
+        node->entries.begin();
+    if (pos == node->entries.size()) {
+        return end();
+    }
+    invariant(it._depth < kMaxDepth);
+    it._path[it._depth++] = {node, pos};
+    return it;
+}
+
+ChunkInfoMap::const_iterator ChunkInfoMap::lower_bound(const std::string& key) const {
+    return _seek(
+        key,
+        [](auto first, auto last, const std::string& key) {
+            return std::lower_bound(first, last, key);
+        },
+        [](auto first, auto last, const std::string& key) {
+            return std::lower_bound(first, last, key, entryKeyLess);
+        });
+}
+
+ChunkInfoMap::const_iterator ChunkInfoMap::upper_bound(const std::string& key) const {
+    return _seek(
+        key,
+        [](auto first, auto last, const std::string& key) {
+            return std::upper_bound(first, last, key);
+        },
+        [](auto first, auto last, const std::string& key) {
+            return std::upper_bound(first, last, key, keyLessThanEntry);
+        });
+}
+
+ChunkInfoMap::const_iterator ChunkInfoMap::find(const std::string& key) const {
+    const auto it = lower_bound(key);
+    return (it != end() && it->first == key) ? it : end();
+}
+
+const ChunkInfoMap::mapped_type& ChunkInfoMap::at(const std::string& key) const {
+    const auto it = find(key);
+    invariant(it != end());
+    return it->second;
+}
+
+void ChunkInfoMap::insert_or_assign(const std::string& key, mapped_type chunk) {
+    if (!_root) {
+        _root = std::make_shared<Node>();
+    }
+
+    bool inserted = false;
+    auto root = _exclusive(_root);
+    if (auto sibling = _insert(root, key, std::move(chunk), &inserted)) {
+        auto newRoot = std::make_shared<Node>();
+        newRoot->maxKeys = {root->maxKey(), sibling->maxKey()};
+        newRoot->children = {std::move(_root), std::move(sibling)};
+        _root = std::move(newRoot);
+    }
+
+    if (inserted) {
+        ++_size;
+    }
+}
+
+size_t ChunkInfoMap::erase(const std::string& key) {
+    // Looks the key up first, so that erasing a missing key doesn't copy any nodes.
+    if (find(key) == end()) {
+        return 0;
+    }
+
+    auto root = _exclusive(_root);
+    _erase(root, key);
+    --_size;
+
+    if (_size == 0) {
+        _root.reset();
+    } else if (!root->isLeaf() && root->children.size() == 1) {
+        auto child = std::move(root->children.front());
+        _root = std::move(child);
+    }
+    return 1;
+}
+
+void ChunkInfoMap::erase(const_iterator first, const_iterator last) {
+    std::vector<std::string> keys;
+    for (auto it = first; it != last; ++it) {
+        keys.push_back(it->first);
+    }
+    for (const auto& key : keys) {
+        erase(key);
+    }
+}
+
+ChunkInfoMap::Node* ChunkInfoMap::_exclusive(std::shared_ptr<Node>& node) {
+    // Only the caller's parent node refers to a node which isn't shared, and no other copy of the
+    // map can reach that parent either, since the caller already made it exclusive.
+    if (node.use_count() != 1) {
+        node = std::make_shared<Node>(*node);
+    }
+    return node.get();
+}
+
+std::shared_ptr<ChunkInfoMap::Node> ChunkInfoMap::_split(Node* node) {
+    auto sibling = std::make_shared<Node>();
+    const auto half = node->size() / 2;
+    if (node->isLeaf()) {
+        auto first = node->entries.begin() + half;
+        sibling->entries.assign(std::make_move_iterator(first),
+                                std::make_move_iterator(node->entries.end()));
+        node->entries.erase(first, node->entries.end());
+    } else {
+        auto firstChild = node->children.begin() + half;
+        sibling->children.assign(std::make_move_iterator(firstChild),
+                                 std::make_move_iterator(node->children.end()));
+        node->children.erase(firstChild, node->children.end());
+
+        auto firstKey = node->maxKeys.begin() + half;
+        sibling->maxKeys.assign(std::make_move_iterator(firstKey),
+                                std::make_move_iterator(node->maxKeys.end()));
+        node->maxKeys.erase(firstKey, node->maxKeys.end());
+    }
+    return sibling;
+}
+
+std::shared_ptr<ChunkInfoMap::Node> ChunkInfoMap::_insert(Node* node,
+                                                          const std::string& key,
+                                                          mapped_type chunk,
+                                                          bool* inserted) {
+    if (node->isLeaf()) {
+        auto it = std::lower_bound(node->entries.begin(), node->entries.end(), key, entryKeyLess);
+        if (it != node->entries.end() && it->first == key) {
+            it->second = std::move(chunk);
+            *inserted = false;
+            return nullptr;
+        }
+        node->entries.emplace(it, key, std::move(chunk));
+        *inserted = true;
+    } else {
+        // A key beyond the largest in the subtree goes to the last child.
+        const size_t pos = std::min<size_t>(
+            std::lower_bound(node->maxKeys.begin(), node->maxKeys.end(), key) -
+                node->maxKeys.begin(),
+            node->children.size() - 1);
+
+        auto child = _exclusive(node->children[pos]);
+        auto sibling = _insert(child, key, std::move(chunk), inserted);
+        node->maxKeys[pos] = child->maxKey();
+        if (sibling) {
+            node->maxKeys.insert(node->maxKeys.begin() + pos + 1, sibling->maxKey());
+            node->children.insert(node->children.begin() + pos + 1, std::move(sibling));
+        }
+    }
+
+    return node->size() > kMaxNodeSize ? _split(node) : nullptr;
+}
+
+void ChunkInfoMap::_erase(Node* node, const std::string& key) {
+    if (node->isLeaf()) {
+        auto it = std::lower_bound(node->entries.begin(), node->entries.end(), key, entryKeyLess);
+        invariant(it != node->entries.end() && it->first == key);
+        node->entries.erase(it);
+        return;
+    }
+
+    const size_t pos =
+        std::lower_bound(node->maxKeys.begin(), node->maxKeys.end(), key) - node->maxKeys.begin();
+    invariant(pos < node->children.size());
+
+    auto child = _exclusive(node->children[pos]);
+    _erase(child, key);
+    if (child->size() == 0) {
+        node->children.erase(node->children.begin() + pos);
+        node->maxKeys.erase(node->maxKeys.begin() + pos);
+        return;
+    }
+
+    node->maxKeys[pos] = child->maxKey();
+    if (child->size() >= kMinNodeSize || node->children.size() == 1) {
+        return;
+    }
+
+    // Merges the child with its neighbour, and splits them again if they hold too much for one
+    // node. The neighbour is only read, so it may stay shared.
+    const size_t leftPos = pos + 1 < node->children.size() ? pos : pos - 1;
+    auto left = _exclusive(node->children[leftPos]);
+    const Node* right = node->children[leftPos + 1].get();
+    if (left->isLeaf()) {
+        left->entries.insert(left->entries.end(), right->entries.begin(), right->entries.end());
+    } else {
+        left->children.insert(
+            left->children.end(), right->children.begin(), right->children.end());
+        left->maxKeys.insert(left->maxKeys.end(), right->maxKeys.begin(), right->maxKeys.end());
+    }
+    node->children.erase(node->children.begin() + leftPos + 1);
+    node->maxKeys.erase(node->maxKeys.begin() + leftPos + 1);
+
+    if (left->size() > kMaxNodeSize) {
+        auto sibling = _split(left);
+        node->maxKeys.insert(node->maxKeys.begin() + leftPos + 1, sibling->maxKey());
+        node->children.insert(node->children.begin() + leftPos + 1, std::move(sibling));
+    }
+    node->maxKeys[leftPos] = left->maxKey();
+}
+
+}  // namespace mongo
@@ -0,0 +1,233 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <array>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mongo/s/chunk.h"
+
+namespace mongo {
+
+/**
+ * Ordered map from the max key string of each chunk to an entry describing the chunk.
+ *
+ * The map is a B+ tree whose nodes copies of the map share. Modifying a map copies only the nodes
+ * on the path to the changed entry which it shares with other copies, so a map with n entries can
+ * be copied and then have k entries changed in O(k log n), while the map it was copied from stays
+ * as it was. Nodes which no other copy shares are modified in place.
+ *
+ * A map may be read by several threads at once, but must not be modified while it is read.
+ * Modifying a map invalidates its iterators, but not those of other copies.
+ */
+class ChunkInfoMap {
+    struct Node;
+
+public:
+    using key_type = std::string;
+    using mapped_type = std::shared_ptr<ChunkInfo>;
+    using value_type = std::pair<std::string, std::shared_ptr<ChunkInfo>>;
+
+    // The most entries a leaf holds, and the most children an internal node has.
+    static constexpr size_t kMaxNodeSize = 64;
+
+    // Every node other than the root holds at least this many entries or children.
+    static constexpr size_t kMinNodeSize = kMaxNodeSize / 4;
+
+    // Bounds the depth of the tree, which this many levels of nodes of the minimum size are enough
+    // for any map which fits in memory.
+    static constexpr size_t kMaxDepth = 12;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ChunkInfoMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        const_iterator() = default;
+
+        reference operator*() const {
+            const auto& leaf = _path[_depth - 1];
+            return leaf.node->entries[leaf.pos];
+        }
+        pointer operator->() const {
+            return &**this;
+        }
+
+        const_iterator& operator++();
+        const_iterator operator++(int) {
+            auto result = *this;
+            ++*this;
+            return result;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            if (_depth == 0 || other._depth == 0) {
+                return _depth == other._depth;
+            }
+            const auto& leaf = _path[_depth - 1];
+            const auto& otherLeaf = other._path[other._depth - 1];
+            return leaf.node == otherLeaf.node && leaf.pos == otherLeaf.pos;
+        }
+        bool operator!=(const const_iterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        friend class ChunkInfoMap;
+
+        // Descends from 'node' to its first entry.
+        void _descendToFirst(const Node* node);
+
+        struct Frame {
+            const Node* node;
+            size_t pos;
+        };
+
+        // The nodes from the root to the leaf holding the current entry, and the position of the
+        // child or entry taken within each. An empty path is the end of the map.
+        std::array<Frame, kMaxDepth> _path;
+        size_t _depth = 0;
+    };
+
+    using iterator = const_iterator;
+
+    size_t size() const {
+        return _size;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    const_iterator begin() const;
+    const_iterator end() const {
+        return {};
+    }
+    const_iterator cbegin() const {
+        return begin();
+    }
+    const_iterator cend() const {
+        return end();
+    }
+
+    /**
+     * Returns the first entry whose key is not less than, or greater than, 'key'.
+     */
+    const_iterator lower_bound(const std::string& key) const;
+    const_iterator upper_bound(const std::string& key) const;
+
+    const_iterator find(const std::string& key) const;
+
+    /**
+     * Returns the chunk of the entry with 'key', which must exist.
+     */
+    const mapped_type& at(const std::string& key) const;
+
+    /**
+     * Inserts an entry for 'key', or replaces the chunk of the existing one.
+     */
+    void insert_or_assign(const std::string& key, mapped_type chunk);
+
+    /**
+     * Erases the entry with 'key', returning the number of entries erased.
+     */
+    size_t erase(const std::string& key);
+
+    /**
+     * Erases the entries in [first, last), which must be iterators of this map.
+     */
+    void erase(const_iterator first, const_iterator last);
+
+private:
+    struct Node {
+        bool isLeaf() const {
+            return children.empty();
+        }
+
+        size_t size() const {
+            return isLeaf() ? entries.size() : children.size();
+        }
+
+        const std::string& maxKey() const {
+            return isLeaf() ? entries.back().first : maxKeys.back();
+        }
+
+        // The entries of a leaf.
+        std::vector<value_type> entries;
+
+        // The children of an internal node, and the largest key within each.
+        std::vector<std::shared_ptr<Node>> children;
+        std::vector<std::string> maxKeys;
+    };
+
+    /**
+     * Returns 'node' for modifying in place, after copying it if any other copy of the map shares
+     * it.
+     */
+    static Node* _exclusive(std::shared_ptr<Node>& node);
+
+    /**
+     * Moves the upper half of the entries or children of 'node' to a new node, which it returns.
+     */
+    static std::shared_ptr<Node> _split(Node* node);
+
+    /**
+     * Inserts or assigns the entry for 'key' in the subtree under 'node', returning the new node
+     * which should follow 'node' if it had to be split.
+     */
+    static std::shared_ptr<Node> _insert(Node* node,
+                                         const std::string& key,
+                                         mapped_type chunk,
+                                         bool* inserted);
+
+    /**
+     * Erases the entry for 'key', which must exist, from the subtree under 'node', and merges any
+     * child which it leaves with too few entries or children into a neighbour.
+     */
+    static void _erase(Node* node, const std::string& key);
+
+    template <typename ChildBound, typename EntryBound>
+    const_iterator _seek(const std::string& key,
+                         ChildBound childBound,
+                         EntryBound entryBound) const;
+
+    std::shared_ptr<Node> _root;
+    size_t _size = 0;
+};
+
+}  // namespace mongo
@@ -0,0 +1,161 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <map>
+
+#include "mongo/db/namespace_string.h"
+#include "mongo/platform/random.h"
+#include "mongo/s/catalog/type_chunk.h"
+#include "mongo/s/chunk_info_map.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("test.foo");
+const ShardId kShard("shard0");
+
+using ReferenceMap = std::map<std::string, std::shared_ptr<ChunkInfo>>;
+
+std::shared_ptr<ChunkInfo> makeChunk(int i) {
+    return std::make_shared<ChunkInfo>(ChunkType(kNss,
+                                                 ChunkRange{BSON("a" << i), BSON("a" << i + 1)},
+                                                 ChunkVersion(1, 0, OID::gen()),
+                                                 kShard));
+}
+
+std::string makeKey(int i) {
+    return str::stream() << "key" << (1000000 + i);
+}
+
+void assertSameEntries(const ChunkInfoMap& map, const ReferenceMap& reference) {
+    ASSERT_EQ(map.size(), reference.size());
+    ASSERT_EQ(map.empty(), reference.empty());
+    auto it = map.begin();
+    for (const auto& entry : reference) {
+        ASSERT(it != map.end());
+        ASSERT_EQ(it->first, entry.first);
+        ASSERT(it->second == entry.second);
+        ++it;
+    }
+    ASSERT(it == map.end());
+}
+
+TEST(ChunkInfoMapTest, Empty) {
+    ChunkInfoMap map;
+    ASSERT(map.empty());
+    ASSERT(map.begin() == map.end());
+    ASSERT(map.lower_bound("a") == map.end());
+    ASSERT(map.upper_bound("a") == map.end());
+    ASSERT_EQ(map.erase("a"), 0ull);
+}
+
+TEST(ChunkInfoMapTest, LookupsMatchStdMap) {
+    ChunkInfoMap map;
+    ReferenceMap reference;
+    for (int i = 0; i < 10000; i += 2) {
+        auto chunk = makeChunk(i);
+        map.insert_or_assign(makeKey(i), chunk);
+        reference.emplace(makeKey(i), chunk);
+    }
+    assertSameEntries(map, reference);
+
+    for (int i = -1; i < 10001; ++i) {
+        const auto key = makeKey(i);
+        const auto checkBound = [&](ChunkInfoMap::const_iterator it, ReferenceMap::iterator refIt) {
+            ASSERT_EQ(it == map.end(), refIt == reference.end());
+            if (refIt != reference.end()) {
+                ASSERT_EQ(it->first, refIt->first);
+            }
+        };
+        checkBound(map.lower_bound(key), reference.lower_bound(key));
+        checkBound(map.upper_bound(key), reference.upper_bound(key));
+        checkBound(map.find(key), reference.find(key));
+    }
+}
+
+TEST(ChunkInfoMapTest, RandomUpdatesMatchStdMapAndLeaveCopiesUnchanged) {
+    PseudoRandom random(12345);
+    std::vector<std::shared_ptr<ChunkInfo>> chunks;
+    for (int i = 0; i < 100; ++i) {
+        chunks.push_back(makeChunk(i));
+    }
+
+    ChunkInfoMap map;
+    ReferenceMap reference;
+    std::vector<std::pair<ChunkInfoMap, ReferenceMap>> copies;
+
+    for (int step = 0; step < 50000; ++step) {
+        const auto key = makeKey(random.nextInt32(5000));
+        const auto op = random.nextInt32(10);
+        if (op < 6) {
+            const auto& chunk = chunks[random.nextInt32(chunks.size())];
+            map.insert_or_assign(key, chunk);
+            reference[key] = chunk;
+        } else if (op < 9) {
+            ASSERT_EQ(map.erase(key), reference.erase(key));
+        } else {
+            // Erases a few consecutive entries
+            auto first = map.lower_bound(key);
+            auto refFirst = reference.lower_bound(key);
+            auto last = first;
+            auto refLast = refFirst;
+            for (int i = 0; i < 3 && last != map.end(); ++i) {
+                ++last;
+                ++refLast;
+            }
+            map.erase(first, last);
+            reference.erase(refFirst, refLast);
+        }
+
+        if (step % 2500 == 0) {
+            assertSameEntries(map, reference);
+            copies.emplace_back(map, reference);
+        }
+    }
+    assertSameEntries(map, reference);
+
+    // Erasing every entry must not change any of the copies either
+    while (!reference.empty()) {
+        ASSERT_EQ(map.erase(reference.begin()->first), 1ull);
+        reference.erase(reference.begin());
+    }
+    assertSameEntries(map, reference);
+
+    for (const auto& copy : copies) {
+        assertSameEntries(copy.first, copy.second);
+    }
+}
+
+}  // namespace
+}  // namespace mongo
@@ -33,6 +33,8 @@
 
 #include "mongo/s/chunk_manager.h"
 
+#include <numeric>
+
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/db/matcher/extensions_callback_noop.h"
@@ -68,6 +70,17 @@ std::string extractKeyStringInternal(const BSONObj& shardKeyValue, Ordering orde
     return {ks.getBuffer(), ks.getSize()};
 }
 
+/**
+ * Appends the key string which looks up "shardKey" in a ChunkBoundaryIndex to "keyString". Builds
+ * it in place, rather than stripping the field names of the shard key into a new object first.
+ */
+void appendLookupKeyString(const BSONObj& shardKey, KeyString::Builder* keyString) {
+    for (const auto& elem : shardKey) {
+        keyString->appendBSONElement(elem);
+    }
+    keyString->appendDiscriminator(KeyString::Discriminator::kInclusive);
+}
+
 }  // namespace
 
 RoutingTableHistory::RoutingTableHistory(NamespaceString nss,
@@ -76,7 +89,8 @@ RoutingTableHistory::RoutingTableHistory(NamespaceString nss,
                                          std::unique_ptr<CollatorInterface> defaultCollator,
                                          bool unique,
                                          ChunkInfoMap chunkMap,
-                                         ChunkVersion collectionVersion)
+                                         ChunkVersion collectionVersion,
+                                         ShardVersionTargetingMap shardVersions)
     : _sequenceNumber(nextCMSequenceNumber.addAndFetch(1)),
       _nss(std::move(nss)),
       _uuid(uuid),
@@ -86,7 +100,7 @@ RoutingTableHistory::RoutingTableHistory(NamespaceString nss,
       _unique(unique),
       _chunkMap(std::move(chunkMap)),
       _collectionVersion(collectionVersion),
-      _shardVersions(_constructShardVersionMap()) {}
+      _shardVersions(std::move(shardVersions)) {}
 
 Chunk ChunkManager::findIntersectingChunk(const BSONObj& shardKey, const BSONObj& collation) const {
     const bool hasSimpleCollation = (collation.isEmpty() && !_rt->getDefaultCollator()) ||
@@ -100,26 +114,45 @@ Chunk ChunkManager::findIntersectingChunk(const BSONObj& shardKey, const BSONObj
         }
     }
 
-    const auto it = _rt->getChunkMap().upper_bound(_rt->_extractKeyString(shardKey));
+    const auto chunkInfo = _rt->_findIntersectingChunk(shardKey);
     uassert(ErrorCodes::ShardKeyNotFound,
             str::stream() << "Cannot target single shard using key " << shardKey
                           << " for namespace " << getns(),
-            it != _rt->getChunkMap().end() && it->second->containsKey(shardKey));
+            chunkInfo && chunkInfo->containsKey(shardKey));
 
-    return Chunk(*(it->second), _clusterTime);
+    return Chunk(*chunkInfo, _clusterTime);
+}
+
+std::vector<StatusWith<Chunk>> ChunkManager::findIntersectingChunksWithSimpleCollation(
+    const std::vector<BSONObj>& shardKeys) const {
+    const auto chunkInfos = _rt->_findIntersectingChunks(shardKeys);
+
+    std::vector<StatusWith<Chunk>> chunks;
+    chunks.reserve(shardKeys.size());
+    for (size_t i = 0; i < shardKeys.size(); ++i) {
+        if (chunkInfos[i] && chunkInfos[i]->containsKey(shardKeys[i])) {
+            chunks.emplace_back(Chunk(*chunkInfos[i], _clusterTime));
+        } else {
+            chunks.emplace_back(Status{ErrorCodes::ShardKeyNotFound,
+                                       str::stream() << "Cannot target single shard using key "
+                                                     << shardKeys[i] << " for namespace "
+                                                     << getns()});
+        }
+    }
+    return chunks;
 }
 
 bool ChunkManager::keyBelongsToShard(const BSONObj& shardKey, const ShardId& shardId) const {
     if (shardKey.isEmpty())
         return false;
 
-    const auto it = _rt->getChunkMap().upper_bound(_rt->_extractKeyString(shardKey));
-    if (it == _rt->getChunkMap().end())
+    const auto chunkInfo = _rt->_findIntersectingChunk(shardKey);
+    if (!chunkInfo)
         return false;
 
-    invariant(it->second->containsKey(shardKey));
+    invariant(chunkInfo->containsKey(shardKey));
 
-    return it->second->getShardIdAt(_clusterTime) == shardId;
+    return chunkInfo->getShardIdAt(_clusterTime) == shardId;
 }
 
 void ChunkManager::getShardIdsForQuery(OperationContext* opCtx,
@@ -231,7 +264,7 @@ void RoutingTableHistory::getAllShardIds(std::set<ShardId>* all) const {
     std::transform(_shardVersions.begin(),
                    _shardVersions.end(),
                    std::inserter(*all, all->begin()),
-                   [](const ShardVersionMap::value_type& pair) { return pair.first; });
+                   [](const ShardVersionTargetingMap::value_type& pair) { return pair.first; });
 }
 
 std::pair<ChunkInfoMap::const_iterator, ChunkInfoMap::const_iterator>
@@ -385,7 +418,7 @@ ChunkVersion RoutingTableHistory::getVersion(const ShardId& shardName) const {
         return ChunkVersion(0, 0, _collectionVersion.epoch());
     }
 
-    return it->second;
+    return it->second.shardVersion;
 }
 
 std::string RoutingTableHistory::toString() const {
@@ -399,95 +432,134 @@ std::string RoutingTableHistory::toString() const {
 
     sb << "Shard versions:\n";
     for (const auto& entry : _shardVersions) {
-        sb << "\t" << entry.first << ": " << entry.second.toString() << '\n';
+        sb << "\t" << entry.first << ": " << entry.second.shardVersion.toString() << '\n';
     }
 
     return sb.str();
 }
 
-ShardVersionMap RoutingTableHistory::_constructShardVersionMap() const {
-    const OID& epoch = _collectionVersion.epoch();
-
-    ShardVersionMap shardVersions;
-    ChunkInfoMap::const_iterator current = _chunkMap.cbegin();
+void RoutingTableHistory::_checkContinuity(
+    const ChunkInfoMap& chunkMap,
+    const std::vector<std::shared_ptr<ChunkInfo>>* changedChunks) const {
+    const auto throwDiscontinuity = [](const ChunkInfo& chunk, const ChunkInfo& nextChunk) {
+        uasserted(ErrorCodes::ConflictingOperationInProgress,
+                  str::stream() << (SimpleBSONObjComparator::kInstance.evaluate(
+                                        chunk.getMax() < nextChunk.getMin())
+                                        ? "Gap"
+                                        : "Overlap")
+                                << " exists in the routing table between chunks "
+                                << chunk.getRange().toString() << " and "
+                                << nextChunk.getRange().toString());
+    };
+
+    if (!changedChunks) {
+        const ChunkInfo* lastChunk = nullptr;
+        for (const auto& entry : chunkMap) {
+            const auto& chunk = *entry.second;
+            if (!lastChunk) {
+                checkAllElementsAreOfType(MinKey, chunk.getMin());
+            } else if (!SimpleBSONObjComparator::kInstance.evaluate(lastChunk->getMax() ==
+                                                                    chunk.getMin())) {
+                throwDiscontinuity(*lastChunk, chunk);
+            }
+            lastChunk = &chunk;
+        }
 
-    boost::optional<BSONObj> firstMin = boost::none;
-    boost::optional<BSONObj> lastMax = boost::none;
+        if (lastChunk) {
+            checkAllElementsAreOfType(MaxKey, lastChunk->getMax());
+        }
+        return;
+    }
 
-    while (current != _chunkMap.cend()) {
-        const auto& firstChunkInRange = current->second;
-        const auto& currentRangeShardId = firstChunkInRange->getShardIdAt(boost::none);
+    for (const auto& chunk : *changedChunks) {
+        // Skips the chunks which later changes replaced
+        const auto it = chunkMap.find(_extractKeyString(chunk->getMax()));
+        if (it == chunkMap.end() || it->second != chunk) {
+            continue;
+        }
 
-        // Tracks the max shard version for the shard on which the current range will reside
-        auto shardVersionIt = shardVersions.find(currentRangeShardId);
-        if (shardVersionIt == shardVersions.end()) {
-            shardVersionIt =
-                shardVersions.emplace(currentRangeShardId, ChunkVersion(0, 0, epoch)).first;
+        // No other chunk may end within this one, and unless this is the first chunk, another
+        // chunk must end where it starts
+        const auto minKeyString = _extractKeyString(chunk->getMin());
+        const auto firstEndingAfterMin = chunkMap.upper_bound(minKeyString);
+        if (firstEndingAfterMin != it) {
+            throwDiscontinuity(*firstEndingAfterMin->second, *chunk);
         }
 
-        auto& maxShardVersion = shardVersionIt->second;
-
-        current =
-            std::find_if(current,
-                         _chunkMap.cend(),
-                         [&currentRangeShardId,
-                          &maxShardVersion](const ChunkInfoMap::value_type& chunkMapEntry) {
-                             const auto& currentChunk = chunkMapEntry.second;
-
-                             if (currentChunk->getShardIdAt(boost::none) != currentRangeShardId)
-                                 return true;
-
-                             if (currentChunk->getLastmod() > maxShardVersion)
-                                 maxShardVersion = currentChunk->getLastmod();
-
-                             return false;
-                         });
-
-        const auto rangeLast = std::prev(current);
-
-        const auto& rangeMin = firstChunkInRange->getMin();
-        const auto& rangeMax = rangeLast->second->getMax();
-
-        // Check the continuity of the chunks map
-        if (lastMax && !SimpleBSONObjComparator::kInstance.evaluate(*lastMax == rangeMin)) {
-            if (SimpleBSONObjComparator::kInstance.evaluate(*lastMax < rangeMin))
-                uasserted(ErrorCodes::ConflictingOperationInProgress,
-                          str::stream()
-                              << "Gap exists in the routing table between chunks "
-                              << _chunkMap.at(_extractKeyString(*lastMax))->getRange().toString()
-                              << " and " << rangeLast->second->getRange().toString());
-            else
-                uasserted(ErrorCodes::ConflictingOperationInProgress,
-                          str::stream()
-                              << "Overlap exists in the routing table between chunks "
-                              << _chunkMap.at(_extractKeyString(*lastMax))->getRange().toString()
-                              << " and " << rangeLast->second->getRange().toString());
+        if (it == chunkMap.begin()) {
+            checkAllElementsAreOfType(MinKey, chunk->getMin());
+        } else {
+            uassert(ErrorCodes::ConflictingOperationInProgress,
+                    str::stream() << "Gap exists in the routing table before chunk "
+                                  << chunk->getRange().toString(),
+                    chunkMap.find(minKeyString) != chunkMap.end());
         }
 
-        if (!firstMin)
-            firstMin = rangeMin;
+        // Unless this is the last chunk, the next chunk must start where this one ends
+        const auto next = std::next(it);
+        if (next == chunkMap.end()) {
+            checkAllElementsAreOfType(MaxKey, chunk->getMax());
+        } else if (!SimpleBSONObjComparator::kInstance.evaluate(chunk->getMax() ==
+                                                                next->second->getMin())) {
+            throwDiscontinuity(*chunk, *next->second);
+        }
+    }
+}
 
-        lastMax = rangeMax;
+std::string RoutingTableHistory::_extractKeyString(const BSONObj& shardKeyValue) const {
+    return extractKeyStringInternal(shardKeyValue, _shardKeyOrdering);
+}
 
-        // If a shard has chunks it must have a shard version, otherwise we have an invalid chunk
-        // somewhere, which should have been caught at chunk load time
-        invariant(maxShardVersion.isSet());
+void RoutingTableHistory::buildBoundaryIndex() {
+    if (_boundaryIndexBuildStarted.swap(true)) {
+        return;
     }
+    _ownedBoundaryIndex = std::make_unique<ChunkBoundaryIndex>(_chunkMap);
+    _boundaryIndex.store(_ownedBoundaryIndex.get());
+}
 
-    if (!_chunkMap.empty()) {
-        invariant(!shardVersions.empty());
-        invariant(firstMin.is_initialized());
-        invariant(lastMax.is_initialized());
+ChunkInfo* RoutingTableHistory::_findIntersectingChunk(const BSONObj& shardKey) const {
+    KeyString::Builder keyString(KeyString::Version::V1, _shardKeyOrdering);
+    appendLookupKeyString(shardKey, &keyString);
 
-        checkAllElementsAreOfType(MinKey, firstMin.get());
-        checkAllElementsAreOfType(MaxKey, lastMax.get());
+    if (const auto index = _boundaryIndex.load()) {
+        return index->upperBound({keyString.getBuffer(), keyString.getSize()});
     }
 
-    return shardVersions;
+    const auto it = _chunkMap.upper_bound({keyString.getBuffer(), keyString.getSize()});
+    return it != _chunkMap.end() ? it->second.get() : nullptr;
 }
 
-std::string RoutingTableHistory::_extractKeyString(const BSONObj& shardKeyValue) const {
-    return extractKeyStringInternal(shardKeyValue, _shardKeyOrdering);
+std::vector<ChunkInfo*> RoutingTableHistory::_findIntersectingChunks(
+    const std::vector<BSONObj>& shardKeys) const {
+    // Encodes the same key strings as appendLookupKeyString, which also ignores field names
+    const auto keyStrings =
+        KeyString::encodeBatch(KeyString::Version::V1, shardKeys, _shardKeyOrdering);
+
+    std::vector<ChunkInfo*> chunks(shardKeys.size());
+    const auto index = _boundaryIndex.load();
+    if (!index) {
+        for (size_t i = 0; i < shardKeys.size(); ++i) {
+            const auto it =
+                _chunkMap.upper_bound({keyStrings[i].getBuffer(), keyStrings[i].getSize()});
+            chunks[i] = it != _chunkMap.end() ? it->second.get() : nullptr;
+        }
+        return chunks;
+    }
+
+    std::vector<size_t> order(shardKeys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return keyStrings[a].compare(keyStrings[b]) < 0;
+    });
+
+    // Each key's chunk is at or after the chunk of the key before it in sorted order
+    size_t pos = 0;
+    for (const auto i : order) {
+        pos = index->upperBoundFrom({keyStrings[i].getBuffer(), keyStrings[i].getSize()}, pos);
+        chunks[i] = pos < index->size() ? index->chunkAt(pos) : nullptr;
+    }
+    return chunks;
 }
 
 std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeNew(
@@ -504,7 +576,8 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeNew(
                                std::move(defaultCollator),
                                std::move(unique),
                                {},
-                               {0, 0, epoch})
+                               {0, 0, epoch},
+                               {})
         .makeUpdated(chunks);
 }
 
@@ -512,7 +585,45 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeUpdated(
     const std::vector<ChunkType>& changedChunks) {
 
     const auto startingCollectionVersion = getVersion();
+    const auto& epoch = startingCollectionVersion.epoch();
+
+    // Copying the map and the shard versions doesn't depend on the number of chunks, since the
+    // copy shares the map's nodes until it changes them
     auto chunkMap = _chunkMap;
+    auto shardVersions = _shardVersions;
+
+    // Shards which lost the chunk with their max version, and so need it recalculated, unless they
+    // get a newer chunk later on
+    std::set<ShardId> shardsToRecalculate;
+
+    const auto removeChunk = [&](const ChunkInfo& chunk) {
+        const auto& shardId = chunk.getShardIdAt(boost::none);
+        auto it = shardVersions.find(shardId);
+        invariant(it != shardVersions.end());
+        if (--it->second.numChunks == 0) {
+            shardVersions.erase(it);
+            shardsToRecalculate.erase(shardId);
+        } else if (chunk.getLastmod() == it->second.shardVersion) {
+            shardsToRecalculate.insert(shardId);
+        }
+    };
+
+    const auto addChunk = [&](const ChunkInfo& chunk) {
+        const auto& shardId = chunk.getShardIdAt(boost::none);
+        auto& info = shardVersions
+                         .emplace(shardId, ShardVersionTargetingInfo{ChunkVersion(0, 0, epoch), 0})
+                         .first->second;
+        ++info.numChunks;
+
+        // Chunks come in ascending order of version, so this is the newest chunk on the shard
+        if (chunk.getLastmod() > info.shardVersion) {
+            info.shardVersion = chunk.getLastmod();
+        }
+        shardsToRecalculate.erase(shardId);
+    };
+
+    std::vector<std::shared_ptr<ChunkInfo>> newChunks;
+    newChunks.reserve(changedChunks.size());
 
     ChunkVersion collectionVersion = startingCollectionVersion;
     for (const auto& chunk : changedChunks) {
@@ -563,10 +674,15 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeUpdated(
         }
 
         // Erase all chunks from the map, which overlap the chunk we got from the persistent store
+        for (auto it = low; it != high; ++it) {
+            removeChunk(*it->second);
+        }
         chunkMap.erase(low, high);
 
         // Insert only the chunk itself
-        chunkMap.insert(std::make_pair(chunkMaxKeyString, newChunk));
+        chunkMap.insert_or_assign(chunkMaxKeyString, newChunk);
+        addChunk(*newChunk);
+        newChunks.push_back(std::move(newChunk));
     }
 
     // If at least one diff was applied, the metadata is correct, but it might not have changed so
@@ -580,6 +696,30 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeUpdated(
         return shared_from_this();
     }
 
+    // Only the chunks around the changed ones need checking, unless the whole map is new
+    _checkContinuity(chunkMap, _chunkMap.empty() ? nullptr : &newChunks);
+
+    // Shards rarely lose the chunk with their max version without getting a newer one, since
+    // migrations bump the version of a chunk which stays on the donor, so this pass over all of the
+    // chunks is rarely needed
+    if (!shardsToRecalculate.empty()) {
+        for (const auto& shardId : shardsToRecalculate) {
+            shardVersions[shardId].shardVersion = ChunkVersion(0, 0, epoch);
+        }
+        for (const auto& entry : chunkMap) {
+            const auto& chunk = *entry.second;
+            const auto& shardId = chunk.getShardIdAt(boost::none);
+            if (shardsToRecalculate.count(shardId) &&
+                chunk.getLastmod() > shardVersions[shardId].shardVersion) {
+                shardVersions[shardId].shardVersion = chunk.getLastmod();
+            }
+        }
+    }
+
+    // If a shard has chunks it must have a shard version, otherwise we have an invalid chunk
+    // somewhere, which should have been caught at chunk load time
+    invariant(chunkMap.empty() == shardVersions.empty());
+
     return std::shared_ptr<RoutingTableHistory>(
         new RoutingTableHistory(_nss,
                                 _uuid,
@@ -587,7 +727,8 @@ std::shared_ptr<RoutingTableHistory> RoutingTableHistory::makeUpdated(
                                 CollatorInterface::cloneCollator(getDefaultCollator()),
                                 isUnique(),
                                 std::move(chunkMap),
-                                collectionVersion));
+                                collectionVersion,
+                                std::move(shardVersions)));
 }
 
 }  // namespace mongo
@@ -36,7 +36,10 @@
 
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/query/collation/collator_interface.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/chunk.h"
+#include "mongo/s/chunk_boundary_index.h"
+#include "mongo/s/chunk_info_map.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/client/shard.h"
 #include "mongo/s/shard_key_pattern.h"
@@ -49,12 +52,20 @@ struct QuerySolutionNode;
 class OperationContext;
 class ChunkManager;
 
-// Ordered map from the max for each chunk to an entry describing the chunk
-using ChunkInfoMap = std::map<std::string, std::shared_ptr<ChunkInfo>>;
-
 // Map from a shard is to the max chunk version on that shard
 using ShardVersionMap = std::map<ShardId, ChunkVersion>;
 
+struct ShardVersionTargetingInfo {
+    // Max chunk version for the shard
+    ChunkVersion shardVersion;
+
+    // Number of chunks the shard owns
+    size_t numChunks;
+};
+
+// Map from a shard id to the max chunk version on that shard, and the number of chunks it owns
+using ShardVersionTargetingMap = std::map<ShardId, ShardVersionTargetingInfo>;
+
 /**
  * In-memory representation of the routing table for a single sharded collection at various points
  * in time.
@@ -90,6 +101,10 @@ public:
      *
      * The changes in "changedChunks" must be sorted in ascending order by chunk version, and adhere
      * to the requirements of the routing table update algorithm.
+     *
+     * The new instance shares the parts of the chunk map which the changes don't touch with this
+     * one, so applying k changes to a routing table with n chunks costs O(k log n), and this
+     * instance stays valid for the operations which still use it.
      */
     std::shared_ptr<RoutingTableHistory> makeUpdated(const std::vector<ChunkType>& changedChunks);
 
@@ -149,6 +164,13 @@ public:
     std::pair<ChunkInfoMap::const_iterator, ChunkInfoMap::const_iterator> overlappingRanges(
         const BSONObj& min, const BSONObj& max, bool isMaxInclusive) const;
 
+    /**
+     * Builds the index over the chunk map which single shard key lookups use once it is ready.
+     * Until then they search the chunk map. It is safe to call concurrently with lookups, and only
+     * the first call builds the index. The CatalogCache calls it after it has installed this
+     * routing table, so that no lookup waits for the O(n) build.
+     */
+    void buildBoundaryIndex();
 
 private:
     RoutingTableHistory(NamespaceString nss,
@@ -157,15 +179,31 @@ private:
                         std::unique_ptr<CollatorInterface> defaultCollator,
                         bool unique,
                         ChunkInfoMap chunkMap,
-                        ChunkVersion collectionVersion);
+                        ChunkVersion collectionVersion,
+                        ShardVersionTargetingMap shardVersions);
 
     /**
-     * Does a single pass over the chunkMap and constructs the ShardVersionMap object.
+     * Checks that the chunks in "chunkMap" cover the complete space from [MinKey, MaxKey) without
+     * gaps or overlaps. If "changedChunks" is set, only checks the bounds of those chunks which are
+     * still in the map, which is enough if the map was consistent before they were applied.
      */
-    ShardVersionMap _constructShardVersionMap() const;
+    void _checkContinuity(const ChunkInfoMap& chunkMap,
+                          const std::vector<std::shared_ptr<ChunkInfo>>* changedChunks) const;
 
     std::string _extractKeyString(const BSONObj& shardKeyValue) const;
 
+    /**
+     * Returns the only chunk which may contain "shardKey", which is the first chunk whose max is
+     * greater than it, or nullptr if there is no such chunk.
+     */
+    ChunkInfo* _findIntersectingChunk(const BSONObj& shardKey) const;
+
+    /**
+     * Same as _findIntersectingChunk for each of "shardKeys", in the same order, but sorts their
+     * key strings and looks them up in one forward sweep over the chunk boundaries.
+     */
+    std::vector<ChunkInfo*> _findIntersectingChunks(const std::vector<BSONObj>& shardKeys) const;
+
     // The shard versioning mechanism hinges on keeping track of the number of times we reload
     // ChunkManagers.
     const unsigned long long _sequenceNumber;
@@ -196,7 +234,13 @@ private:
 
     // Map from shard id to the maximum chunk version for that shard. If a shard contains no
     // chunks, it won't be present in this map.
-    const ShardVersionMap _shardVersions;
+    const ShardVersionTargetingMap _shardVersions;
+
+    // Index over the chunk map for looking up single keys, which buildBoundaryIndex() publishes in
+    // '_boundaryIndex' once it is built. Lookups search the chunk map while it is null.
+    AtomicWord<bool> _boundaryIndexBuildStarted{false};
+    std::unique_ptr<ChunkBoundaryIndex> _ownedBoundaryIndex;
+    AtomicWord<const ChunkBoundaryIndex*> _boundaryIndex{nullptr};
 
     friend class ChunkManager;
 };
@@ -337,6 +381,15 @@ public:
         return findIntersectingChunk(shardKey, CollationSpec::kSimpleSpec);
     }
 
+    /**
+     * Same as findIntersectingChunkWithSimpleCollation for each of "shardKeys", returning the
+     * chunks in the same order, or a ShardKeyNotFound status for the keys which can't be targeted.
+     * Sorts the keys once and sweeps the chunk boundaries in one pass, which is cheaper than
+     * looking up the keys one by one for large batches.
+     */
+    std::vector<StatusWith<Chunk>> findIntersectingChunksWithSimpleCollation(
+        const std::vector<BSONObj>& shardKeys) const;
+
     /**
      * Finds the shard IDs for a given filter and collation. If collation is empty, we use the
      * collection default collation for targeting.
@@ -488,5 +488,91 @@ TEST_F(ChunkManagerQueryTest, SimpleCollationNumbersMultiShard) {
         {ShardId("0")});
 }
 
+TEST_F(ChunkManagerQueryTest, FindIntersectingChunksMatchesSingleLookups) {
+    const ShardKeyPattern shardKeyPattern(BSON("a" << 1 << "b" << -1));
+    auto chunkManager = makeChunkManager(kNss,
+                                         shardKeyPattern,
+                                         nullptr,
+                                         false,
+                                         {BSON("a" << -100 << "b" << 0),
+                                          BSON("a" << 0 << "b" << 10),
+                                          BSON("a" << 0 << "b" << -10),
+                                          BSON("a" << 100 << "b" << 0)});
+
+    // Unsorted keys, including repeated ones, keys on chunk boundaries and keys of other types
+    const std::vector<BSONObj> shardKeys{BSON("a" << 100 << "b" << 0),
+                                         BSON("a" << -1000 << "b" << 5),
+                                         BSON("a" << 0 << "b" << 10),
+                                         BSON("a" << 0 << "b" << 0),
+                                         BSON("a" << 100 << "b" << 0),
+                                         BSON("a"
+                                              << "x"
+                                              << "b" << 1),
+                                         BSON("a" << MINKEY << "b" << MAXKEY),
+                                         BSON("a" << 0 << "b" << -10),
+                                         BSON("a" << -100 << "b" << 1)};
+
+    const auto chunks = chunkManager->findIntersectingChunksWithSimpleCollation(shardKeys);
+    ASSERT_EQ(chunks.size(), shardKeys.size());
+    for (size_t i = 0; i < shardKeys.size(); ++i) {
+        const auto expected = chunkManager->findIntersectingChunkWithSimpleCollation(shardKeys[i]);
+        ASSERT_OK(chunks[i].getStatus());
+        ASSERT_BSONOBJ_EQ(chunks[i].getValue().getMin(), expected.getMin());
+        ASSERT_EQ(chunks[i].getValue().getShardId(), expected.getShardId());
+    }
+}
+
+TEST_F(ChunkManagerQueryTest, LookupsMatchWithAndWithoutBoundaryIndex) {
+    const OID epoch = OID::gen();
+    const KeyPattern keyPattern(BSON("a" << 1));
+    const std::vector<BSONObj> bounds{keyPattern.globalMin(),
+                                      BSON("a" << -100),
+                                      BSON("a" << 0),
+                                      BSON("a" << 100),
+                                      keyPattern.globalMax()};
+    std::vector<ChunkType> chunks;
+    for (size_t i = 0; i + 1 < bounds.size(); ++i) {
+        chunks.emplace_back(kNss,
+                            ChunkRange(bounds[i], bounds[i + 1]),
+                            ChunkVersion(i + 1, 0, epoch),
+                            ShardId(std::to_string(i)));
+    }
+
+    // Routing tables made outside of the CatalogCache don't have a boundary index until asked
+    auto rt =
+        RoutingTableHistory::makeNew(kNss, UUID::gen(), keyPattern, nullptr, false, epoch, chunks);
+    ChunkManager chunkManager(rt, boost::none);
+
+    const std::vector<BSONObj> shardKeys{BSON("a" << 100),
+                                         BSON("a" << -1000),
+                                         BSON("a" << -100),
+                                         BSON("a" << -1),
+                                         BSON("a" << 0),
+                                         BSON("a" << 99)};
+    const std::vector<ShardId> expected{
+        ShardId("3"), ShardId("0"), ShardId("1"), ShardId("1"), ShardId("2"), ShardId("2")};
+
+    const auto assertLookupsMatch = [&] {
+        const auto batch = chunkManager.findIntersectingChunksWithSimpleCollation(shardKeys);
+        ASSERT_EQ(batch.size(), shardKeys.size());
+        for (size_t i = 0; i < shardKeys.size(); ++i) {
+            ASSERT_EQ(chunkManager.findIntersectingChunkWithSimpleCollation(shardKeys[i])
+                          .getShardId(),
+                      expected[i]);
+            ASSERT_OK(batch[i].getStatus());
+            ASSERT_EQ(batch[i].getValue().getShardId(), expected[i]);
+        }
+    };
+
+    // Lookups search the chunk map until the index is built, then use the index
+    assertLookupsMatch();
+    rt->buildBoundaryIndex();
+    assertLookupsMatch();
+
+    // Building it again is a no-op
+    rt->buildBoundaryIndex();
+    assertLookupsMatch();
+}
+
 }  // namespace
 }  // namespace mongo
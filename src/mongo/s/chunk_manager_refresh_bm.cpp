@@ -71,6 +71,7 @@ auto makeChunkManagerWithShardSelector(int nShards, uint32_t nChunks, ShardSelec
 
     auto routingTableHistory = RoutingTableHistory::makeNew(
         collName, UUID::gen(), shardKeyPattern, nullptr, true, collEpoch, chunks);
+    routingTableHistory->buildBoundaryIndex();
     auto chunkManager = std::make_shared<ChunkManager>(routingTableHistory, boost::none);
     return std::make_unique<CollectionMetadata>(std::move(chunkManager), ShardId("shard0"));
 }
@@ -122,7 +123,46 @@ void BM_IncrementalRefreshOfPessimalBalancedDistribution(benchmark::State& state
     }
 }
 
-BENCHMARK(BM_IncrementalRefreshOfPessimalBalancedDistribution)->Args({2, 50000});
+BENCHMARK(BM_IncrementalRefreshOfPessimalBalancedDistribution)
+    ->Args({2, 50000})
+    ->Args({2, 500000});
+
+// Splits state.range(1) chunks spread across the routing table in one refresh, which should cost
+// time proportional to the number of splits rather than to the number of chunks.
+void BM_IncrementalRefreshOfSplits(benchmark::State& state) {
+    const int nChunks = state.range(0);
+    const int nSplits = state.range(1);
+    auto cm = makeChunkManagerWithOptimalBalancedDistribution(2, nChunks);
+
+    auto postSplitVersion = cm->getChunkManager()->getVersion();
+    const auto collName = NamespaceString(cm->getChunkManager()->getns());
+    std::vector<ChunkType> newChunks;
+    for (int i = 0; i < nSplits; ++i) {
+        const auto chunkToSplit = 1 + int64_t(i) * (nChunks - 2) / nSplits;
+        const auto range = getRangeForChunk(chunkToSplit, nChunks);
+        const auto shardId = optimalShardSelector(chunkToSplit, 2, nChunks);
+        const auto splitPoint = BSON("_id" << range.getMin()["_id"].numberInt() + 50);
+
+        postSplitVersion.incMinor();
+        newChunks.emplace_back(
+            collName, ChunkRange(range.getMin(), splitPoint), postSplitVersion, shardId);
+        postSplitVersion.incMinor();
+        newChunks.emplace_back(
+            collName, ChunkRange(splitPoint, range.getMax()), postSplitVersion, shardId);
+    }
+
+    for (auto keepRunning : state) {
+        benchmark::DoNotOptimize(runIncrementalUpdate(*cm, newChunks));
+    }
+
+    state.SetItemsProcessed(state.iterations() * nSplits);
+}
+
+BENCHMARK(BM_IncrementalRefreshOfSplits)
+    ->Args({50000, 1})
+    ->Args({50000, 100})
+    ->Args({500000, 1})
+    ->Args({500000, 100});
 
 template <typename ShardSelectorFn>
 auto BM_FullBuildOfChunkManager(benchmark::State& state, ShardSelectorFn selectShard) {
@@ -247,6 +287,79 @@ void BM_FindIntersectingChunk(benchmark::State& state,
     state.SetItemsProcessed(state.iterations());
 }
 
+// Targets the documents of an insert batch together, which the per-key lookups above should be
+// compared with by items processed.
+template <typename CollectionMetadataBuilderFn>
+void BM_FindIntersectingChunksForBatch(benchmark::State& state,
+                                       CollectionMetadataBuilderFn makeCollectionMetadata) {
+    const int nShards = state.range(0);
+    const int nChunks = state.range(1);
+    const int batchSize = state.range(2);
+
+    auto cm = makeCollectionMetadata(nShards, nChunks);
+    auto keys = makeKeys(nChunks);
+    keys.resize(batchSize);
+
+    for (auto keepRunning : state) {
+        benchmark::DoNotOptimize(
+            cm->getChunkManager()->findIntersectingChunksWithSimpleCollation(keys));
+    }
+
+    state.SetItemsProcessed(state.iterations() * batchSize);
+}
+
+std::string makeStringKey(int64_t i) {
+    // The common prefix makes lookups compare whole key strings rather than only their prefixes
+    const auto digits = std::to_string(i);
+    return "user:" + std::string(12 - digits.size(), '0') + digits;
+}
+
+// Targets documents by a string shard key, such as an account name, which has a long common prefix.
+void BM_FindIntersectingChunkWithStringKeys(benchmark::State& state) {
+    const int nShards = state.range(0);
+    const int nChunks = state.range(1);
+
+    const auto collEpoch = OID::gen();
+    const auto collName = NamespaceString("test.foo");
+    const auto shardKeyPattern = KeyPattern(BSON("name" << 1));
+
+    std::vector<ChunkType> chunks;
+    chunks.reserve(nChunks);
+    for (int i = 0; i < nChunks; ++i) {
+        const auto min = i == 0 ? shardKeyPattern.globalMin()
+                                : BSON("name" << makeStringKey(int64_t(i) * 100));
+        const auto max = i + 1 == nChunks ? shardKeyPattern.globalMax()
+                                          : BSON("name" << makeStringKey(int64_t(i + 1) * 100));
+        chunks.emplace_back(collName,
+                            ChunkRange(min, max),
+                            ChunkVersion{uint32_t(i + 1), 0, collEpoch},
+                            pessimalShardSelector(i, nShards, nChunks));
+    }
+    auto routingTableHistory = RoutingTableHistory::makeNew(
+        collName, UUID::gen(), shardKeyPattern, nullptr, true, collEpoch, chunks);
+    routingTableHistory->buildBoundaryIndex();
+    ChunkManager cm(routingTableHistory, boost::none);
+
+    PseudoRandom rand(12345);
+    std::vector<BSONObj> keys;
+    for (int i = 0; i < 200000; ++i) {
+        keys.emplace_back(BSON("name" << makeStringKey(rand.nextInt64(int64_t(nChunks) * 100))));
+    }
+    auto keysIter = makeCircularIterator(keys);
+
+    for (auto keepRunning : state) {
+        benchmark::DoNotOptimize(cm.findIntersectingChunkWithSimpleCollation(*keysIter));
+        ++keysIter;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_FindIntersectingChunkWithStringKeys)
+    ->Args({2, 2})
+    ->Args({10, 50000})
+    ->Args({10, 500000});
+
 template <typename CollectionMetadataBuilderFn>
 void BM_GetShardIdsForRange(benchmark::State& state,
                             CollectionMetadataBuilderFn makeCollectionMetadata) {
@@ -348,9 +461,19 @@ MONGO_INITIALIZER(RegisterBenchmarks)(InitializerContext* context) {
             ->Args({10, 50000})
             ->Args({100, 50000})
             ->Args({1000, 50000})
+            ->Args({2, 500000})
+            ->Args({100, 500000})
             ->Args({2, 2});
     }
 
+    // The batch size is the number of documents in a large insert batch
+    REGISTER_BENCHMARK_CAPTURE(BM_FindIntersectingChunksForBatch,
+                               Pessimal,
+                               makeChunkManagerWithPessimalBalancedDistribution)
+        ->Args({10, 50000, 1000})
+        ->Args({10, 50000, 100000})
+        ->Args({10, 500000, 100000});
+
     return Status::OK();
 }
 
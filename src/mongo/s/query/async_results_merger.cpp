@@ -39,6 +39,8 @@
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/killcursors_request.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/executor/remote_command_request.h"
 #include "mongo/executor/remote_command_response.h"
 #include "mongo/util/assert_util.h"
@@ -79,6 +81,18 @@ int compareSortKeys(BSONObj leftSortKey, BSONObj rightSortKey, BSONObj sortKeyPa
     return leftSortKey.woCompare(rightSortKey, sortKeyPattern, considerFieldName);
 }
 
+/**
+ * Returns the ordering by which to normalize sort keys into KeyStrings for 'params', or boost::none
+ * if there is no sort or sort keys must be compared as BSON.
+ */
+boost::optional<Ordering> makeSortKeyOrdering(const AsyncResultsMergerParams& params) {
+    const auto& sort = params.getSort();
+    if (!sort || static_cast<size_t>(sort->nFields()) > Ordering::kMaxCompoundIndexKeys) {
+        return boost::none;
+    }
+    return Ordering::make(*sort);
+}
+
 }  // namespace
 
 AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
@@ -91,8 +105,12 @@ AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
       // since that is not supported we treat boost::none (unspecified) to mean 'kNormal'.
       _tailableMode(params.getTailableMode().value_or(TailableModeEnum::kNormal)),
       _params(std::move(params)),
-      _mergeQueue(MergingComparator(
-          _remotes, _params.getSort().value_or(BSONObj()), _params.getCompareWholeSortKey())),
+      _sortKeyOrdering(makeSortKeyOrdering(_params)),
+      _mergeTree(_params.getRemotes().size(),
+                 MergingComparator(_remotes,
+                                   _params.getSort().value_or(BSONObj()),
+                                   _params.getCompareWholeSortKey(),
+                                   bool(_sortKeyOrdering))),
       _promisedMinSortKeys(PromisedMinSortKeyComparator(_params.getSort().value_or(BSONObj()))) {
     if (params.getTxnNumber()) {
         invariant(params.getSessionId());
@@ -184,6 +202,7 @@ void AsyncResultsMerger::addNewShardCursors(std::vector<RemoteCursor>&& newCurso
         _remotes.emplace_back(remote.getHostAndPort(),
                               remote.getCursorResponse().getNSS(),
                               remote.getCursorResponse().getCursorId());
+        _mergeTree.addStream();
         _addBatchToBuffer(lk, newIndex, remote.getCursorResponse());
     }
 }
@@ -242,12 +261,12 @@ bool AsyncResultsMerger::_readySorted(WithLock lk) {
 }
 
 bool AsyncResultsMerger::_readySortedTailable(WithLock lk) {
-    if (_mergeQueue.empty()) {
+    auto smallestRemote = _getSmallestRemote(lk);
+    if (!smallestRemote) {
         return false;
     }
 
-    auto smallestRemote = _mergeQueue.top();
-    auto smallestResult = _remotes[smallestRemote].docBuffer.front();
+    auto smallestResult = _remotes[*smallestRemote].docBuffer.front();
     auto keyWeWantToReturn =
         extractSortKey(*smallestResult.getResult(), _params.getCompareWholeSortKey());
     // We should always have a minPromisedSortKey from every shard in the sorted tailable case.
@@ -256,6 +275,18 @@ bool AsyncResultsMerger::_readySortedTailable(WithLock lk) {
     return compareSortKeys(keyWeWantToReturn, minPromisedSortKey, *_params.getSort()) <= 0;
 }
 
+boost::optional<size_t> AsyncResultsMerger::_getSmallestRemote(WithLock) {
+    if (_remotes.empty()) {
+        return boost::none;
+    }
+
+    auto smallestRemote = _mergeTree.winner();
+    if (!_remotes[smallestRemote].hasNext()) {
+        return boost::none;
+    }
+    return smallestRemote;
+}
+
 bool AsyncResultsMerger::_readyUnsorted(WithLock) {
     bool allExhausted = true;
     for (const auto& remote : _remotes) {
@@ -290,27 +321,26 @@ StatusWith<ClusterQueryResult> AsyncResultsMerger::nextReady() {
     return _params.getSort() ? _nextReadySorted(lk) : _nextReadyUnsorted(lk);
 }
 
-ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
+ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock lk) {
     // Tailable non-awaitData cursors cannot have a sort.
     invariant(_tailableMode != TailableModeEnum::kTailable);
 
-    if (_mergeQueue.empty()) {
+    auto smallestRemote = _getSmallestRemote(lk);
+    if (!smallestRemote) {
         return {};
     }
 
-    size_t smallestRemote = _mergeQueue.top();
-    _mergeQueue.pop();
-
-    invariant(!_remotes[smallestRemote].docBuffer.empty());
-    invariant(_remotes[smallestRemote].status.isOK());
+    auto& remote = _remotes[*smallestRemote];
+    invariant(remote.status.isOK());
 
-    ClusterQueryResult front = _remotes[smallestRemote].docBuffer.front();
-    _remotes[smallestRemote].docBuffer.pop();
+    ClusterQueryResult front = _popNextResult(lk, *smallestRemote);
 
-    // Re-populate the merging queue with the next result from 'smallestRemote', if it has a
-    // next result.
-    if (!_remotes[smallestRemote].docBuffer.empty()) {
-        _mergeQueue.push(smallestRemote);
+    // A remote which runs out of buffered results stays the winner of the merge until its next
+    // batch arrives, since that can only sort after what it has returned, and the merge isn't
+    // ready until then anyway. Sorted tailable cursors move on without it instead.
+    if (remote.hasNext() || remote.exhausted() ||
+        _tailableMode == TailableModeEnum::kTailableAndAwaitData) {
+        _mergeTree.update(*smallestRemote);
     }
 
     // For sorted tailable awaitData cursors, update the high water mark to the document's sort key.
@@ -322,15 +352,14 @@ ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
     return front;
 }
 
-ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock) {
+ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock lk) {
     size_t remotesAttempted = 0;
     while (remotesAttempted < _remotes.size()) {
         // It is illegal to call this method if there is an error received from any shard.
         invariant(_remotes[_gettingFromRemote].status.isOK());
 
         if (_remotes[_gettingFromRemote].hasNext()) {
-            ClusterQueryResult front = _remotes[_gettingFromRemote].docBuffer.front();
-            _remotes[_gettingFromRemote].docBuffer.pop();
+            ClusterQueryResult front = _popNextResult(lk, _gettingFromRemote);
 
             if (_tailableMode == TailableModeEnum::kTailable &&
                 !_remotes[_gettingFromRemote].hasNext()) {
@@ -353,6 +382,55 @@ ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock) {
     return {};
 }
 
+ClusterQueryResult AsyncResultsMerger::_popNextResult(WithLock lk, size_t remoteIndex) {
+    auto& remote = _remotes[remoteIndex];
+
+    ClusterQueryResult front = remote.docBuffer.front();
+    remote.docBuffer.pop();
+    if (_sortKeyOrdering) {
+        remote.sortKeyBuffer.pop();
+    }
+
+    const auto bytes = front.getResult()->objsize();
+    remote.bufferedBytes -= bytes;
+    _bufferedBytes -= bytes;
+
+    _readAheadIfNeeded(lk, remoteIndex);
+    return front;
+}
+
+void AsyncResultsMerger::_readAheadIfNeeded(WithLock lk, size_t remoteIndex) {
+    if (!internalQueryClusterCursorReadAhead.load() || !_opCtx || _lifecycleState != kAlive ||
+        _tailableMode != TailableModeEnum::kNormal || _params.getTxnNumber() ||
+        _opCtx->getDeadline() != Date_t::max()) {
+        return;
+    }
+
+    auto& remote = _remotes[remoteIndex];
+    if (!remote.status.isOK() || remote.exhausted() || remote.cbHandle.isValid()) {
+        return;
+    }
+
+    // The watermark follows the size of the batches the remote returns
+    const auto watermarkPercent = internalQueryClusterCursorReadAheadWatermarkPercent.load();
+    if (remote.docBuffer.size() * 100 > remote.lastBatchSize * watermarkPercent) {
+        return;
+    }
+
+    // Batches which are still in flight count against the budget as much as those which arrived,
+    // or the remotes could all read ahead at once
+    if (_bufferedBytes + _readAheadReservedBytes + remote.lastBatchBytes >
+        internalQueryClusterCursorReadAheadMaxBufferedBytes.load()) {
+        return;
+    }
+
+    remote.status = _askForNextBatch(lk, remoteIndex);
+    if (remote.status.isOK()) {
+        remote.readAheadReservedBytes = remote.lastBatchBytes;
+        _readAheadReservedBytes += remote.readAheadReservedBytes;
+    }
+}
+
 Status AsyncResultsMerger::_askForNextBatch(WithLock, size_t remoteIndex) {
     invariant(_opCtx, "Cannot schedule a getMore without an OperationContext");
     auto& remote = _remotes[remoteIndex];
@@ -535,7 +613,12 @@ void AsyncResultsMerger::_handleBatchResponse(WithLock lk,
                                               CbData const& cbData,
                                               size_t remoteIndex) {
     // Got a response from remote, so indicate we are no longer waiting for one.
-    _remotes[remoteIndex].cbHandle = executor::TaskExecutor::CallbackHandle();
+    auto& remote = _remotes[remoteIndex];
+    remote.cbHandle = executor::TaskExecutor::CallbackHandle();
+
+    // Whether it succeeded or not, the response takes the place of the bytes reserved for it.
+    _readAheadReservedBytes -= remote.readAheadReservedBytes;
+    remote.readAheadReservedBytes = 0;
 
     //  On shutdown, there is no need to process the response.
     if (_lifecycleState != kAlive) {
@@ -546,7 +629,7 @@ void AsyncResultsMerger::_handleBatchResponse(WithLock lk,
     try {
         _processBatchResults(lk, cbData.response, remoteIndex);
     } catch (DBException const& e) {
-        _remotes[remoteIndex].status = e.toStatus();
+        remote.status = e.toStatus();
     }
     _signalCurrentEventIfReady(lk);  // Wake up anyone waiting on '_currentEvent'.
 }
@@ -582,7 +665,15 @@ void AsyncResultsMerger::_cleanUpFailedBatch(WithLock lk, Status status, size_t
         // Clear the results buffer and cursor id.
         std::queue<ClusterQueryResult> emptyBuffer;
         std::swap(remote.docBuffer, emptyBuffer);
+        std::queue<std::string> emptySortKeyBuffer;
+        std::swap(remote.sortKeyBuffer, emptySortKeyBuffer);
+        _bufferedBytes -= remote.bufferedBytes;
+        remote.bufferedBytes = 0;
         remote.cursorId = 0;
+
+        if (_params.getSort()) {
+            _mergeTree.update(remoteIndex);
+        }
     }
 }
 
@@ -635,7 +726,9 @@ bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
                                            size_t remoteIndex,
                                            const CursorResponse& response) {
     auto& remote = _remotes[remoteIndex];
+    const bool hadNext = remote.hasNext();
     _updateRemoteMetadata(lk, remoteIndex, response);
+    long long batchBytes = 0;
     for (const auto& obj : response.getBatch()) {
         // If there's a sort, we're expecting the remote node to have given us back a sort key.
         if (_params.getSort()) {
@@ -658,12 +751,27 @@ bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
         ClusterQueryResult result(obj);
         remote.docBuffer.push(result);
         ++remote.fetchedCount;
+        remote.bufferedBytes += obj.objsize();
+        _bufferedBytes += obj.objsize();
+        batchBytes += obj.objsize();
+
+        if (_sortKeyOrdering) {
+            KeyString::Builder sortKey(KeyString::Version::V1,
+                                       extractSortKey(obj, _params.getCompareWholeSortKey()),
+                                       *_sortKeyOrdering);
+            remote.sortKeyBuffer.emplace(sortKey.getBuffer(), sortKey.getSize());
+        }
     }
 
-    // If we're doing a sorted merge, then we have to make sure to put this remote onto the merge
-    // queue.
-    if (_params.getSort() && !response.getBatch().empty()) {
-        _mergeQueue.push(remoteIndex);
+    if (!response.getBatch().empty()) {
+        remote.lastBatchSize = response.getBatch().size();
+        remote.lastBatchBytes = batchBytes;
+    }
+
+    // If we're doing a sorted merge, then we have to make sure the merge sees this remote's next
+    // result, or that it has no more. Results added behind ones already buffered don't change it.
+    if (_params.getSort() && !hadNext && (remote.hasNext() || remote.exhausted())) {
+        _mergeTree.update(remoteIndex);
     }
     return true;
 }
@@ -774,13 +882,23 @@ bool AsyncResultsMerger::RemoteCursorData::exhausted() const {
 // AsyncResultsMerger::MergingComparator
 //
 
-bool AsyncResultsMerger::MergingComparator::operator()(const size_t& lhs, const size_t& rhs) {
-    const ClusterQueryResult& leftDoc = _remotes[lhs].docBuffer.front();
-    const ClusterQueryResult& rightDoc = _remotes[rhs].docBuffer.front();
+bool AsyncResultsMerger::MergingComparator::operator()(size_t lhs, size_t rhs) const {
+    const auto& left = _remotes[lhs];
+    const auto& right = _remotes[rhs];
+    if (!left.hasNext() || !right.hasNext()) {
+        return left.hasNext() || (!right.hasNext() && lhs < rhs);
+    }
+
+    if (_compareNormalizedSortKeys) {
+        const int comparison = left.sortKeyBuffer.front().compare(right.sortKeyBuffer.front());
+        return comparison < 0 || (comparison == 0 && lhs < rhs);
+    }
 
-    return compareSortKeys(extractSortKey(*leftDoc.getResult(), _compareWholeSortKey),
-                           extractSortKey(*rightDoc.getResult(), _compareWholeSortKey),
-                           _sort) > 0;
+    const int comparison =
+        compareSortKeys(extractSortKey(*left.docBuffer.front().getResult(), _compareWholeSortKey),
+                        extractSortKey(*right.docBuffer.front().getResult(), _compareWholeSortKey),
+                        _sort);
+    return comparison < 0 || (comparison == 0 && lhs < rhs);
 }
 
 bool AsyncResultsMerger::PromisedMinSortKeyComparator::operator()(
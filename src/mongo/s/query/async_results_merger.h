@@ -31,15 +31,18 @@
 
 #include <boost/optional.hpp>
 #include <queue>
+#include <string>
 #include <vector>
 
 #include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj.h"
+#include "mongo/bson/ordering.h"
 #include "mongo/db/cursor_id.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/platform/mutex.h"
 #include "mongo/s/query/async_results_merger_params_gen.h"
 #include "mongo/s/query/cluster_query_result.h"
+#include "mongo/s/query/loser_tree.h"
 #include "mongo/util/concurrency/with_lock.h"
 #include "mongo/util/net/hostandport.h"
 #include "mongo/util/time_support.h"
@@ -88,8 +91,8 @@ public:
      * the hosts on which they exist in _remotes.
      *
      * Additionally copies each remote's first batch of results, if one exists, into that remote's
-     * docBuffer. If a sort is specified in the ClusterClientCursorParams, places the remotes with
-     * buffered results onto _mergeQueue.
+     * docBuffer. If a sort is specified in the ClusterClientCursorParams, adds the remotes to
+     * _mergeTree.
      *
      * The TaskExecutor* must remain valid for the lifetime of the ARM.
      *
@@ -292,6 +295,10 @@ private:
         // The buffer of results that have been retrieved but not yet returned to the caller.
         std::queue<ClusterQueryResult> docBuffer;
 
+        // When merging by normalized sort keys, the KeyString of the sort key of each result in
+        // 'docBuffer', in the same order, so that merging compares them as plain bytes.
+        std::queue<std::string> sortKeyBuffer;
+
         // Is valid if there is currently a pending request to this remote.
         executor::TaskExecutor::CallbackHandle cbHandle;
 
@@ -302,16 +309,34 @@ private:
         // Count of fetched docs during ARM processing of the current batch. Used to reduce the
         // batchSize in getMore when mongod returned less docs than the requested batchSize.
         long long fetchedCount = 0;
+
+        // The number of results and bytes in the last non-empty batch received from this remote,
+        // and the bytes of the results in 'docBuffer'. Used to decide when to read ahead.
+        size_t lastBatchSize = 0;
+        long long lastBatchBytes = 0;
+        long long bufferedBytes = 0;
+
+        // The bytes reserved in the buffer budget for a batch requested ahead of time, which are
+        // released once its response arrives.
+        long long readAheadReservedBytes = 0;
     };
 
+    /**
+     * Returns whether the next result of the remote at index 'lhs' sorts before that of the remote
+     * at index 'rhs'. Ties are broken by index, and remotes without buffered results sort last.
+     */
     class MergingComparator {
     public:
         MergingComparator(const std::vector<RemoteCursorData>& remotes,
                           const BSONObj& sort,
-                          bool compareWholeSortKey)
-            : _remotes(remotes), _sort(sort), _compareWholeSortKey(compareWholeSortKey) {}
+                          bool compareWholeSortKey,
+                          bool compareNormalizedSortKeys)
+            : _remotes(remotes),
+              _sort(sort),
+              _compareWholeSortKey(compareWholeSortKey),
+              _compareNormalizedSortKeys(compareNormalizedSortKeys) {}
 
-        bool operator()(const size_t& lhs, const size_t& rhs);
+        bool operator()(size_t lhs, size_t rhs) const;
 
     private:
         const std::vector<RemoteCursorData>& _remotes;
@@ -322,6 +347,9 @@ private:
         // We extract the sort key {$sortKey: <value>}. The sort key pattern '_sort' is verified to
         // be {$sortKey: 1}.
         const bool _compareWholeSortKey;
+
+        // Whether to compare the remotes' 'sortKeyBuffer' entries rather than their sort keys.
+        const bool _compareNormalizedSortKeys;
     };
 
     using MinSortKeyRemoteIdPair = std::pair<BSONObj, size_t>;
@@ -370,6 +398,12 @@ private:
     bool _readySortedTailable(WithLock);
     bool _readyUnsorted(WithLock);
 
+    /**
+     * Returns the index of the remote whose next buffered result sorts first, or boost::none if no
+     * remote has buffered results. Used only if there is a sort.
+     */
+    boost::optional<size_t> _getSmallestRemote(WithLock);
+
     //
     // Helpers for nextReady().
     //
@@ -377,6 +411,22 @@ private:
     ClusterQueryResult _nextReadySorted(WithLock);
     ClusterQueryResult _nextReadyUnsorted(WithLock);
 
+    /**
+     * Removes and returns the next buffered result of the remote at 'remoteIndex', then reads
+     * ahead from it if it has few enough results left.
+     */
+    ClusterQueryResult _popNextResult(WithLock, size_t remoteIndex);
+
+    /**
+     * Requests the next batch of the remote at 'remoteIndex' ahead of time if read-ahead is
+     * enabled, the remote has no more than the watermark of its last batch left buffered, and
+     * another batch like it fits in the buffer budget.
+     *
+     * Read-ahead is only used for non-tailable cursors outside of transactions, while attached to
+     * an operation without a deadline, since the request outlives the operation.
+     */
+    void _readAheadIfNeeded(WithLock, size_t remoteIndex);
+
     using CbData = executor::TaskExecutor::RemoteCommandCallbackArgs;
     using CbResponse = executor::TaskExecutor::ResponseStatus;
 
@@ -456,14 +506,25 @@ private:
     // Data tracking the state of our communication with each of the remote nodes.
     std::vector<RemoteCursorData> _remotes;
 
-    // The top of this priority queue is the index into '_remotes' for the remote host that has the
-    // next document to return, according to the sort order. Used only if there is a sort.
-    std::priority_queue<size_t, std::vector<size_t>, MergingComparator> _mergeQueue;
+    // When set, the ordering of the sort pattern, by which the sort keys of the remotes' results
+    // are normalized into KeyStrings. Set if there is a sort, unless it has more fields than a
+    // KeyString ordering can describe, in which case the sort keys are compared as BSON.
+    const boost::optional<Ordering> _sortKeyOrdering;
+
+    // Picks the index into '_remotes' for the remote host that has the next document to return,
+    // according to the sort order. Used only if there is a sort.
+    LoserTree<MergingComparator> _mergeTree;
 
     // The index into '_remotes' for the remote from which we are currently retrieving results.
     // Used only if there is *not* a sort.
     size_t _gettingFromRemote = 0;
 
+    // The bytes of the results buffered from all of the remotes.
+    long long _bufferedBytes = 0;
+
+    // The bytes reserved for the batches which are being read ahead from all of the remotes.
+    long long _readAheadReservedBytes = 0;
+
     Status _status = Status::OK();
 
     executor::TaskExecutor::EventHandle _currentEvent;
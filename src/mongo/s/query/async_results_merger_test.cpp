@@ -38,12 +38,14 @@
 #include "mongo/db/pipeline/resume_token.h"
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/getmore_request.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_request.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/query/results_merger_test_fixture.h"
 #include "mongo/unittest/death_test.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -443,6 +445,83 @@ TEST_F(AsyncResultsMergerTest, CompoundSortKey) {
     ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
 }
 
+TEST_F(AsyncResultsMergerTest, SortedMergeOfMixedTypeKeysAcrossBatches) {
+    const BSONObj sortPattern = BSON("a" << 1 << "b" << -1);
+    BSONObj findCmd = BSON("find"
+                           << "testcoll"
+                           << "sort" << sortPattern);
+    const size_t numShards = 3;
+    const size_t batchSize = 4;
+
+    // Distinct sort keys of several types, in sorted order
+    BSONArrayBuilder values;
+    values << MINKEY << BSONNULL << -5 << 2.5 << 3LL << Decimal128("3.75") << "abc"
+           << "abd" << BSON("x" << 1) << OID() << false << true << MAXKEY;
+    std::vector<BSONObj> sortKeys;
+    for (const auto& value : values.arr()) {
+        for (int b = 2; b >= 0; --b) {
+            BSONObjBuilder sortKey;
+            sortKey.appendAs(value, "");
+            sortKey.append("", b);
+            sortKeys.push_back(sortKey.obj());
+        }
+    }
+
+    // Spreads the keys over the shards in runs of varying length, and splits each shard's results
+    // into batches
+    std::vector<std::vector<std::vector<BSONObj>>> batches(numShards);
+    for (size_t i = 0; i < sortKeys.size(); ++i) {
+        const size_t shard = (i / 3 + i) % numShards;
+        auto& shardBatches = batches[shard];
+        if (shardBatches.empty() || shardBatches.back().size() == batchSize) {
+            shardBatches.emplace_back();
+        }
+        shardBatches.back().push_back(BSON("shard" << int(shard) << "$sortKey" << sortKeys[i]));
+    }
+    const auto cursorIdAfterBatch = [&](size_t shard, size_t batch) {
+        return batch + 1 < batches[shard].size() ? CursorId(5 + shard) : CursorId(0);
+    };
+
+    std::vector<RemoteCursor> cursors;
+    for (size_t shard = 0; shard < numShards; ++shard) {
+        cursors.push_back(makeRemoteCursor(
+            kTestShardIds[shard],
+            kTestShardHosts[shard],
+            CursorResponse(kTestNss, cursorIdAfterBatch(shard, 0), batches[shard][0])));
+    }
+    auto arm = makeARMFromExistingCursors(std::move(cursors), findCmd);
+
+    std::vector<size_t> nextBatch(numShards, 1);
+    std::vector<BSONObj> results;
+    while (true) {
+        if (!arm->ready()) {
+            // The remote which returned the last result has run out of buffered results
+            const size_t shard = results.back()["shard"].numberInt();
+            auto readyEvent = unittest::assertGet(arm->nextEvent());
+
+            std::vector<CursorResponse> responses;
+            responses.emplace_back(kTestNss,
+                                   cursorIdAfterBatch(shard, nextBatch[shard]),
+                                   batches[shard][nextBatch[shard]]);
+            ++nextBatch[shard];
+            scheduleNetworkResponses(std::move(responses));
+            executor()->waitForEvent(readyEvent);
+            continue;
+        }
+
+        auto next = unittest::assertGet(arm->nextReady());
+        if (next.isEOF()) {
+            break;
+        }
+        results.push_back(*next.getResult());
+    }
+
+    ASSERT_EQ(results.size(), sortKeys.size());
+    for (size_t i = 0; i < results.size(); ++i) {
+        ASSERT_BSONOBJ_EQ(results[i]["$sortKey"].Obj(), sortKeys[i]);
+    }
+}
+
 TEST_F(AsyncResultsMergerTest, SortedButNoSortKey) {
     BSONObj findCmd = fromjson("{find: 'testcoll', sort: {a: -1, b: 1}}");
     std::vector<RemoteCursor> cursors;
@@ -471,6 +550,148 @@ TEST_F(AsyncResultsMergerTest, SortedButNoSortKey) {
     executor()->waitForEvent(killEvent);
 }
 
+TEST_F(AsyncResultsMergerTest, ReadAheadRequestsNextBatchBelowWatermark) {
+    internalQueryClusterCursorReadAhead.store(true);
+    ON_BLOCK_EXIT([] { internalQueryClusterCursorReadAhead.store(false); });
+
+    std::vector<BSONObj> batch1 = {
+        fromjson("{_id: 1}"), fromjson("{_id: 2}"), fromjson("{_id: 3}"), fromjson("{_id: 4}")};
+    std::vector<RemoteCursor> cursors;
+    cursors.push_back(makeRemoteCursor(
+        kTestShardIds[0], kTestShardHosts[0], CursorResponse(kTestNss, 5, batch1)));
+    auto arm = makeARMFromExistingCursors(std::move(cursors));
+
+    // Three of the four results left is above the watermark of half of the last batch.
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_FALSE(networkHasReadyRequests());
+
+    // Two left is at the watermark, so the next batch is requested while results remain.
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 2}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(networkHasReadyRequests());
+    ASSERT_EQ(getNthPendingRequest(0).cmdObj["getMore"].numberLong(), 5);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 3}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 4}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_FALSE(arm->ready());
+
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch2 = {fromjson("{_id: 5}"), fromjson("{_id: 6}")};
+    responses.emplace_back(kTestNss, CursorId(0), batch2);
+    scheduleNetworkResponses(std::move(responses));
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 5}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 6}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
+TEST_F(AsyncResultsMergerTest, ReadAheadWaitsForRoomInBufferBudget) {
+    const long long docSize = fromjson("{_id: 1}").objsize();
+
+    // Fits the batch of the second shard and all but two of the first shard's results, in addition
+    // to another batch from the first shard.
+    internalQueryClusterCursorReadAhead.store(true);
+    internalQueryClusterCursorReadAheadMaxBufferedBytes.store(10 * docSize - 1);
+    ON_BLOCK_EXIT([] {
+        internalQueryClusterCursorReadAhead.store(false);
+        internalQueryClusterCursorReadAheadMaxBufferedBytes.store(16 * 1024 * 1024);
+    });
+
+    std::vector<BSONObj> batch1 = {
+        fromjson("{_id: 1}"), fromjson("{_id: 2}"), fromjson("{_id: 3}"), fromjson("{_id: 4}")};
+    std::vector<BSONObj> batch2 = {fromjson("{_id: 11}"),
+                                   fromjson("{_id: 12}"),
+                                   fromjson("{_id: 13}"),
+                                   fromjson("{_id: 14}")};
+    std::vector<RemoteCursor> cursors;
+    cursors.push_back(makeRemoteCursor(
+        kTestShardIds[0], kTestShardHosts[0], CursorResponse(kTestNss, 5, batch1)));
+    cursors.push_back(makeRemoteCursor(
+        kTestShardIds[1], kTestShardHosts[1], CursorResponse(kTestNss, 0, batch2)));
+    auto arm = makeARMFromExistingCursors(std::move(cursors));
+
+    // The first shard reaches the watermark, but another batch doesn't fit in the budget yet.
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 2}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_FALSE(networkHasReadyRequests());
+
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 3}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(networkHasReadyRequests());
+
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch3 = {fromjson("{_id: 5}")};
+    responses.emplace_back(kTestNss, CursorId(0), batch3);
+    scheduleNetworkResponses(std::move(responses));
+
+    for (int id : {4, 5, 11, 12, 13, 14}) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_BSONOBJ_EQ(BSON("_id" << id), *unittest::assertGet(arm->nextReady()).getResult());
+    }
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
+TEST_F(AsyncResultsMergerTest, ReadAheadCountsBatchesInFlightAgainstBufferBudget) {
+    const long long docSize = fromjson("{$sortKey: {'': 1}}").objsize();
+
+    // Fits the results of all three shards but one, in addition to one more batch.
+    internalQueryClusterCursorReadAhead.store(true);
+    internalQueryClusterCursorReadAheadMaxBufferedBytes.store(7 * docSize);
+    ON_BLOCK_EXIT([] {
+        internalQueryClusterCursorReadAhead.store(false);
+        internalQueryClusterCursorReadAheadMaxBufferedBytes.store(16 * 1024 * 1024);
+    });
+
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {_id: 1}}");
+    std::vector<RemoteCursor> cursors;
+    for (size_t i = 0; i < kTestShardIds.size(); i++) {
+        std::vector<BSONObj> batch = {BSON("$sortKey" << BSON("" << int(i + 1))),
+                                      BSON("$sortKey" << BSON("" << int(i + 4)))};
+        cursors.push_back(makeRemoteCursor(
+            kTestShardIds[i], kTestShardHosts[i], CursorResponse(kTestNss, 5 + i, batch)));
+    }
+    auto arm = makeARMFromExistingCursors(std::move(cursors), findCmd);
+
+    // The first shard reads ahead, and its batch in flight leaves no room for the second shard's.
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 1}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(networkHasReadyRequests());
+    ASSERT_EQ(getNthPendingRequest(0).target, kTestShardHosts[0]);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 2}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch4 = {fromjson("{$sortKey: {'': 7}}"),
+                                   fromjson("{$sortKey: {'': 8}}")};
+    responses.emplace_back(kTestNss, CursorId(5), batch4);
+    scheduleNetworkResponses(std::move(responses));
+    ASSERT_FALSE(networkHasReadyRequests());
+
+    // Once the batch arrived, its reservation is released and the third shard may read ahead.
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 3}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(networkHasReadyRequests());
+    ASSERT_EQ(getNthPendingRequest(0).target, kTestShardHosts[2]);
+
+    responses.clear();
+    std::vector<BSONObj> batch5 = {fromjson("{$sortKey: {'': 9}}")};
+    responses.emplace_back(kTestNss, CursorId(0), batch5);
+    scheduleNetworkResponses(std::move(responses));
+
+    // Kill the cursor before deleting it, as the first two remote cursors are not exhausted.
+    auto killEvent = arm->kill(operationContext());
+    executor()->waitForEvent(killEvent);
+}
+
 TEST_F(AsyncResultsMergerTest, HasFirstBatch) {
     std::vector<BSONObj> firstBatch = {
         fromjson("{_id: 1}"), fromjson("{_id: 2}"), fromjson("{_id: 3}")};
@@ -0,0 +1,177 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <utility>
+#include <vector>
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+/**
+ * A tournament tree which repeatedly picks the smallest of the heads of several sorted streams,
+ * for example the remotes of a sorted AsyncResultsMerger.
+ *
+ * The tree doesn't hold the streams' heads itself, but compares the streams by their indexes
+ * through 'Less', which must order them strictly, for example by breaking ties between equal heads
+ * by index, and must sort streams which have no head after all others.
+ *
+ * Each internal node keeps the loser of the match played there, so that when the winning stream
+ * advances, its new head is replayed against only the losers on its path to the root, with one
+ * comparison per level. While the winner's new head still sorts before the runner-up, it doesn't
+ * need to be replayed at all, so a run of results from one stream costs one comparison each.
+ */
+template <typename Less>
+class LoserTree {
+public:
+    LoserTree(size_t numStreams, Less less)
+        : _numStreams(numStreams), _less(std::move(less)), _losers(numStreams) {}
+
+    size_t numStreams() const {
+        return _numStreams;
+    }
+
+    /**
+     * Adds a stream after the existing ones, with the next index.
+     */
+    void addStream() {
+        ++_numStreams;
+        _losers.resize(_numStreams);
+        _needsRebuild = true;
+    }
+
+    /**
+     * Returns the index of the stream whose head sorts first. If no stream has a head, that is the
+     * index of one of them. There must be at least one stream.
+     */
+    size_t winner() {
+        invariant(_numStreams > 0);
+        if (_needsRebuild) {
+            _rebuild();
+        }
+        return _winner;
+    }
+
+    /**
+     * Notes that the head of stream 'stream' changed. When it is the winner and its head can only
+     * have moved forward, that costs at most one comparison per level of the tree. Otherwise the
+     * whole tree is rebuilt on the next call to winner().
+     */
+    void update(size_t stream) {
+        invariant(stream < _numStreams);
+        if (_needsRebuild || stream != _winner) {
+            _needsRebuild = true;
+            return;
+        }
+
+        // The winner's head still sorts first, so the tree is unchanged
+        if (_runnerUp && _less(_winner, *_runnerUp)) {
+            return;
+        }
+
+        _replay();
+    }
+
+    /**
+     * Notes that the heads of any of the streams may have changed.
+     */
+    void updateAll() {
+        _needsRebuild = true;
+    }
+
+private:
+    // Nodes are numbered as in a binary heap, with the root at 1, the children of node n at 2n and
+    // 2n + 1, and stream i at leaf _numStreams + i.
+    size_t _leaf(size_t stream) const {
+        return _numStreams + stream;
+    }
+
+    void _rebuild() {
+        // The winners of the matches at each node, of which only the last is kept
+        std::vector<size_t> winners(2 * _numStreams);
+        for (size_t stream = 0; stream < _numStreams; ++stream) {
+            winners[_leaf(stream)] = stream;
+        }
+        for (size_t node = _numStreams - 1; node >= 1; --node) {
+            auto left = winners[2 * node];
+            auto right = winners[2 * node + 1];
+            if (_less(right, left)) {
+                std::swap(left, right);
+            }
+            winners[node] = left;
+            _losers[node] = right;
+        }
+
+        _winner = _numStreams > 1 ? winners[1] : 0;
+        _runnerUp = boost::none;
+        _needsRebuild = false;
+    }
+
+    void _replay() {
+        const auto previousWinner = _winner;
+
+        auto candidate = _winner;
+        for (auto node = _leaf(candidate) / 2; node >= 1; node /= 2) {
+            if (_less(_losers[node], candidate)) {
+                std::swap(_losers[node], candidate);
+            }
+        }
+        _winner = candidate;
+
+        // The same stream winning again suggests that its results come in runs, which can skip the
+        // replay while they sort before the runner-up, which is one of the losers on its path.
+        _runnerUp = boost::none;
+        if (_winner == previousWinner) {
+            for (auto node = _leaf(_winner) / 2; node >= 1; node /= 2) {
+                if (!_runnerUp || _less(_losers[node], *_runnerUp)) {
+                    _runnerUp = _losers[node];
+                }
+            }
+        }
+    }
+
+    size_t _numStreams;
+    Less _less;
+
+    // The loser of the match at each internal node, indexed by node, of which 0 is unused
+    std::vector<size_t> _losers;
+
+    size_t _winner = 0;
+
+    // When set, the stream with the smallest head other than the winner
+    boost::optional<size_t> _runnerUp;
+
+    bool _needsRebuild = true;
+};
+
+}  // namespace mongo
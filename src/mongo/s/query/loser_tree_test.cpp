@@ -0,0 +1,143 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/query/loser_tree.h"
+
+#include <algorithm>
+#include <deque>
+
+#include "mongo/platform/random.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+using Streams = std::vector<std::deque<int>>;
+
+// Orders streams by their heads, then by index, with empty streams last.
+struct StreamLess {
+    bool operator()(size_t lhs, size_t rhs) const {
+        const auto& left = (*streams)[lhs];
+        const auto& right = (*streams)[rhs];
+        if (left.empty() || right.empty()) {
+            return !left.empty() || (right.empty() && lhs < rhs);
+        }
+        return left.front() < right.front() || (left.front() == right.front() && lhs < rhs);
+    }
+
+    const Streams* streams;
+};
+
+Streams makeStreams(PseudoRandom& random, size_t numStreams, int maxRun) {
+    Streams streams(numStreams);
+    for (int value = 0; value < 2000; value += random.nextInt32(3)) {
+        // Runs of consecutive values from the same stream, and equal values in several streams
+        auto& stream = streams[random.nextInt32(numStreams)];
+        for (int run = 1 + random.nextInt32(maxRun); run > 0; --run) {
+            stream.push_back(value++);
+        }
+    }
+    return streams;
+}
+
+std::vector<int> mergeAll(Streams& streams, LoserTree<StreamLess>& tree) {
+    std::vector<int> merged;
+    while (true) {
+        const auto winner = tree.winner();
+        if (streams[winner].empty()) {
+            return merged;
+        }
+        merged.push_back(streams[winner].front());
+        streams[winner].pop_front();
+        tree.update(winner);
+    }
+}
+
+std::vector<int> sortedValues(const Streams& streams) {
+    std::vector<int> values;
+    for (const auto& stream : streams) {
+        values.insert(values.end(), stream.begin(), stream.end());
+    }
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+TEST(LoserTreeTest, MergesSortedStreams) {
+    PseudoRandom random(12345);
+    for (size_t numStreams : {1, 2, 3, 7, 8, 200}) {
+        for (int maxRun : {1, 50}) {
+            auto streams = makeStreams(random, numStreams, maxRun);
+            const auto expected = sortedValues(streams);
+
+            LoserTree<StreamLess> tree(numStreams, StreamLess{&streams});
+            ASSERT_EQ(tree.numStreams(), numStreams);
+            ASSERT(mergeAll(streams, tree) == expected);
+        }
+    }
+}
+
+TEST(LoserTreeTest, BreaksTiesByStreamIndex) {
+    Streams streams{{1, 2}, {1, 1}, {0, 2}};
+    LoserTree<StreamLess> tree(streams.size(), StreamLess{&streams});
+
+    std::vector<size_t> winners;
+    while (!streams[tree.winner()].empty()) {
+        const auto winner = tree.winner();
+        winners.push_back(winner);
+        streams[winner].pop_front();
+        tree.update(winner);
+    }
+    ASSERT(winners == std::vector<size_t>({2, 0, 1, 1, 0, 2}));
+}
+
+TEST(LoserTreeTest, StreamsRefilledWhileNotWinning) {
+    Streams streams{{5, 10}, {}, {7}};
+    LoserTree<StreamLess> tree(streams.size(), StreamLess{&streams});
+    ASSERT_EQ(tree.winner(), 0u);
+
+    // A stream which was empty receives a head which sorts first
+    streams[1].push_back(1);
+    tree.update(1);
+    ASSERT_EQ(tree.winner(), 1u);
+
+    // A stream added later
+    streams.push_back({0, 20});
+    tree.addStream();
+    tree.update(3);
+    ASSERT_EQ(tree.winner(), 3u);
+
+    std::vector<int> merged = mergeAll(streams, tree);
+    ASSERT(merged == std::vector<int>({0, 1, 5, 7, 10, 20}));
+}
+
+}  // namespace
+}  // namespace mongo
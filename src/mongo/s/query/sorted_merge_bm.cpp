@@ -0,0 +1,169 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/ordering.h"
+#include "mongo/db/storage/key_string.h"
+#include "mongo/platform/random.h"
+#include "mongo/s/query/loser_tree.h"
+
+namespace mongo {
+namespace {
+
+const int kNumResults = 100 * 1000;
+
+// The sort keys of the results of each remote of a sorted merge, as returned in $sortKey.
+struct MergeInput {
+    BSONObj sortPattern;
+    std::vector<std::vector<BSONObj>> streams;
+};
+
+MergeInput makeMergeInput(int numStreams, int numFields) {
+    MergeInput input;
+
+    BSONObjBuilder sortPattern;
+    for (int field = 0; field < numFields; ++field) {
+        sortPattern.append("f" + std::to_string(field), 1);
+    }
+    input.sortPattern = sortPattern.obj();
+
+    // Leading fields which are long strings with a common prefix, which vary slowly, and a last
+    // field which is an ascending number, so that the keys are in sorted order. Consecutive keys
+    // are spread over the streams in short runs.
+    PseudoRandom random(12345);
+    input.streams.resize(numStreams);
+    auto* stream = &input.streams[0];
+    for (int i = 0; i < kNumResults; ++i) {
+        if (random.nextInt32(4) == 0) {
+            stream = &input.streams[random.nextInt32(numStreams)];
+        }
+
+        BSONObjBuilder sortKey;
+        for (int field = 0; field + 1 < numFields; ++field) {
+            const auto digits = std::to_string(i / 1000);
+            sortKey.append("", "customer-account-" + std::string(8 - digits.size(), '0') + digits);
+        }
+        sortKey.append("", i);
+        stream->push_back(sortKey.obj());
+    }
+    return input;
+}
+
+// Merges the streams as AsyncResultsMerger used to, with a priority queue of the streams which
+// compares their next sort keys as BSON.
+void BM_MergeWithPriorityQueue(benchmark::State& state) {
+    const auto input = makeMergeInput(state.range(0), state.range(1));
+    const auto& streams = input.streams;
+    std::vector<size_t> positions(streams.size());
+
+    const auto greater = [&](size_t lhs, size_t rhs) {
+        return streams[lhs][positions[lhs]].woCompare(
+                   streams[rhs][positions[rhs]], input.sortPattern, false) > 0;
+    };
+
+    for (auto keepRunning : state) {
+        std::fill(positions.begin(), positions.end(), 0);
+        std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> mergeQueue(greater);
+        for (size_t stream = 0; stream < streams.size(); ++stream) {
+            if (!streams[stream].empty()) {
+                mergeQueue.push(stream);
+            }
+        }
+
+        while (!mergeQueue.empty()) {
+            const auto stream = mergeQueue.top();
+            mergeQueue.pop();
+            benchmark::DoNotOptimize(streams[stream][positions[stream]]);
+            if (++positions[stream] < streams[stream].size()) {
+                mergeQueue.push(stream);
+            }
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * kNumResults);
+}
+
+// Merges the streams as AsyncResultsMerger does, normalizing each sort key into a KeyString as it
+// arrives, and picking the next stream with a loser tree which compares those as bytes.
+void BM_MergeWithLoserTree(benchmark::State& state) {
+    const auto input = makeMergeInput(state.range(0), state.range(1));
+    const auto& streams = input.streams;
+    const auto ordering = Ordering::make(input.sortPattern);
+    std::vector<std::vector<std::string>> sortKeys(streams.size());
+    std::vector<size_t> positions(streams.size());
+
+    const auto less = [&](size_t lhs, size_t rhs) {
+        const bool leftHasNext = positions[lhs] < sortKeys[lhs].size();
+        const bool rightHasNext = positions[rhs] < sortKeys[rhs].size();
+        if (!leftHasNext || !rightHasNext) {
+            return leftHasNext || (!rightHasNext && lhs < rhs);
+        }
+        const int comparison = sortKeys[lhs][positions[lhs]].compare(sortKeys[rhs][positions[rhs]]);
+        return comparison < 0 || (comparison == 0 && lhs < rhs);
+    };
+
+    for (auto keepRunning : state) {
+        for (size_t stream = 0; stream < streams.size(); ++stream) {
+            sortKeys[stream].clear();
+            for (const auto& sortKey : streams[stream]) {
+                KeyString::Builder keyString(KeyString::Version::V1, sortKey, ordering);
+                sortKeys[stream].emplace_back(keyString.getBuffer(), keyString.getSize());
+            }
+        }
+        std::fill(positions.begin(), positions.end(), 0);
+
+        LoserTree<decltype(less)> mergeTree(streams.size(), less);
+        while (true) {
+            const auto stream = mergeTree.winner();
+            if (positions[stream] == streams[stream].size()) {
+                break;
+            }
+            benchmark::DoNotOptimize(streams[stream][positions[stream]]);
+            ++positions[stream];
+            mergeTree.update(stream);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * kNumResults);
+}
+
+// Arguments are the number of streams and the number of fields in the sort keys.
+BENCHMARK(BM_MergeWithPriorityQueue)->Args({2, 1})->Args({16, 1})->Args({200, 1})->Args({200, 4});
+BENCHMARK(BM_MergeWithLoserTree)->Args({2, 1})->Args({16, 1})->Args({200, 1})->Args({200, 4});
+
+}  // namespace
+}  // namespace mongo
@@ -318,5 +318,95 @@ TEST_F(RoutingTableHistoryTestThreeInitialChunks,
                               expectedBytesInChunksNotSplit);
 }
 
+TEST_F(RoutingTableHistoryTestThreeInitialChunks, UpdateLeavesEarlierRoutingTableUnchanged) {
+    const ShardId kOtherShard("otherShard");
+    const auto& rt = getInitialRoutingTable();
+    const auto epoch = rt->getVersion().epoch();
+    const auto thisShardVersion = rt->getVersion(kThisShard);
+
+    // Move the middle chunk to another shard
+    auto version = rt->getVersion();
+    version.incMajor();
+    auto newRt = rt->makeUpdated(
+        {ChunkType{kNss, ChunkRange{BSON("a" << 10), BSON("a" << 20)}, version, kOtherShard}});
+
+    ASSERT_EQ(newRt->getChunkMap().size(), 3ull);
+    ASSERT_EQ(newRt->getVersion(), version);
+    ASSERT_EQ(newRt->getVersion(kOtherShard), version);
+    ASSERT_EQ(newRt->getVersion(kThisShard), thisShardVersion);
+    std::set<ShardId> newShardIds;
+    newRt->getAllShardIds(&newShardIds);
+    ASSERT_EQ(newShardIds.size(), 2ull);
+
+    // The earlier routing table still has all of the chunks on this shard
+    ASSERT_EQ(rt->getChunkMap().size(), 3ull);
+    for (const auto& kv : rt->getChunkMap()) {
+        ASSERT_EQ(kv.second->getShardIdAt(boost::none), kThisShard);
+    }
+    ASSERT_EQ(rt->getVersion(kOtherShard), ChunkVersion(0, 0, epoch));
+    ASSERT_EQ(rt->getVersion(kThisShard), thisShardVersion);
+    std::set<ShardId> shardIds;
+    rt->getAllShardIds(&shardIds);
+    ASSERT_EQ(shardIds.size(), 1ull);
+}
+
+TEST_F(RoutingTableHistoryTestThreeInitialChunks, ShardVersionFollowsChunksLeavingTheShard) {
+    const ShardId kOtherShard("otherShard");
+    const auto& rt = getInitialRoutingTable();
+    const auto epoch = rt->getVersion().epoch();
+
+    // Moving the newest chunk off this shard leaves it with the version of its next newest one
+    auto lastChunkVersion = rt->getVersion();
+    auto middleChunkVersion = getChunkToSplit(rt, BSON("a" << 10), BSON("a" << 20))->getLastmod();
+    auto version = rt->getVersion();
+    version.incMajor();
+    auto newRt = rt->makeUpdated(
+        {ChunkType{kNss,
+                   ChunkRange{BSON("a" << 20), getShardKeyPattern().globalMax()},
+                   version,
+                   kOtherShard}});
+    ASSERT_EQ(rt->getVersion(kThisShard), lastChunkVersion);
+    ASSERT_EQ(newRt->getVersion(kThisShard), middleChunkVersion);
+    ASSERT_EQ(newRt->getVersion(kOtherShard), version);
+
+    // Moving the rest of its chunks off this shard leaves it without any
+    std::vector<ChunkType> changedChunks;
+    for (const auto& range : {ChunkRange{getShardKeyPattern().globalMin(), BSON("a" << 10)},
+                              ChunkRange{BSON("a" << 10), BSON("a" << 20)}}) {
+        version.incMajor();
+        changedChunks.emplace_back(kNss, range, version, kOtherShard);
+    }
+    newRt = newRt->makeUpdated(changedChunks);
+    ASSERT_EQ(newRt->getVersion(kThisShard), ChunkVersion(0, 0, epoch));
+    ASSERT_EQ(newRt->getVersion(kOtherShard), version);
+    std::set<ShardId> shardIds;
+    newRt->getAllShardIds(&shardIds);
+    ASSERT_EQ(shardIds.size(), 1ull);
+    ASSERT_EQ(*shardIds.begin(), kOtherShard);
+}
+
+TEST_F(RoutingTableHistoryTestThreeInitialChunks, UpdateLeavingGapOrOverlapFails) {
+    const auto& rt = getInitialRoutingTable();
+    auto version = rt->getVersion();
+    version.incMajor();
+
+    // Replacing the middle chunk with one which starts after it leaves a gap before it
+    ASSERT_THROWS_CODE(
+        rt->makeUpdated(
+            {ChunkType{kNss, ChunkRange{BSON("a" << 12), BSON("a" << 20)}, version, kThisShard}}),
+        DBException,
+        ErrorCodes::ConflictingOperationInProgress);
+
+    // A chunk which ends within the middle chunk overlaps it
+    ASSERT_THROWS_CODE(
+        rt->makeUpdated(
+            {ChunkType{kNss, ChunkRange{BSON("a" << 10), BSON("a" << 15)}, version, kThisShard}}),
+        DBException,
+        ErrorCodes::ConflictingOperationInProgress);
+
+    // The earlier routing table is still intact
+    ASSERT_EQ(rt->getChunkMap().size(), 3ull);
+}
+
 }  // namespace
 }  // namespace mongo
@@ -52,6 +52,11 @@ using std::vector;
 
 namespace {
 
+// The number of inserts targeted together the first time targetBatch needs them. It doubles every
+// time they are all used, so that ordered batches which stop early don't target many documents
+// they won't send, while large batches are still targeted in a few large lookups.
+const size_t kInitialInsertTargetingWindow = 16;
+
 struct WriteErrorDetailComp {
     bool operator()(const WriteErrorDetail* errorA, const WriteErrorDetail* errorB) const {
         return errorA->getIndex() < errorB->getIndex();
@@ -304,6 +309,35 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
 
     const size_t numWriteOps = _clientRequest.sizeWriteOps();
 
+    // Inserts are targeted ahead of time in windows of ready documents, which lets the targeter
+    // look up their shard keys together rather than one at a time
+    const bool isInsert = _clientRequest.getBatchType() == BatchedCommandRequest::BatchType_Insert;
+    std::vector<boost::optional<StatusWith<ShardEndpoint>>> insertEndpoints;
+    size_t insertsTargetedUpTo = 0;
+    size_t insertTargetingWindow = kInitialInsertTargetingWindow;
+
+    const auto targetInsertWindow = [&](size_t from) {
+        const auto& docs = _clientRequest.getInsertRequest().getDocuments();
+        std::vector<size_t> indexes;
+        std::vector<BSONObj> windowDocs;
+        size_t i = from;
+        for (; i < numWriteOps && indexes.size() < insertTargetingWindow; ++i) {
+            if (_writeOps[i].getWriteState() == WriteOpState_Ready) {
+                indexes.push_back(i);
+                windowDocs.push_back(docs[i]);
+            }
+        }
+
+        auto endpoints = targeter.targetInserts(_opCtx, windowDocs);
+        insertEndpoints.resize(numWriteOps);
+        for (size_t j = 0; j < indexes.size(); ++j) {
+            insertEndpoints[indexes[j]] = std::move(endpoints[j]);
+        }
+
+        insertsTargetedUpTo = i;
+        insertTargetingWindow *= 2;
+    };
+
     for (size_t i = 0; i < numWriteOps; ++i) {
         WriteOp& writeOp = _writeOps[i];
 
@@ -311,6 +345,10 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
         if (writeOp.getWriteState() != WriteOpState_Ready)
             continue;
 
+        if (isInsert && i >= insertsTargetedUpTo) {
+            targetInsertWindow(i);
+        }
+
         //
         // Get TargetedWrites from the targeter for the write operation
         //
@@ -319,7 +357,9 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
         OwnedPointerVector<TargetedWrite> writesOwned;
         vector<TargetedWrite*>& writes = writesOwned.mutableVector();
 
-        Status targetStatus = writeOp.targetWrites(_opCtx, targeter, &writes);
+        Status targetStatus = isInsert
+            ? writeOp.targetWrites(_opCtx, targeter, std::move(*insertEndpoints[i]), &writes)
+            : writeOp.targetWrites(_opCtx, targeter, &writes);
 
         if (!targetStatus.isOK()) {
             WriteErrorDetail targetError;
@@ -404,6 +404,47 @@ StatusWith<ShardEndpoint> ChunkManagerTargeter::targetInsert(OperationContext* o
     return Status::OK();
 }
 
+std::vector<StatusWith<ShardEndpoint>> ChunkManagerTargeter::targetInserts(
+    OperationContext* opCtx, const std::vector<BSONObj>& docs) const {
+    const auto cm = _routingInfo->cm();
+    if (!cm) {
+        return NSTargeter::targetInserts(opCtx, docs);
+    }
+
+    std::vector<boost::optional<StatusWith<ShardEndpoint>>> endpoints(docs.size());
+    std::vector<size_t> keyedDocs;
+    std::vector<BSONObj> shardKeys;
+    keyedDocs.reserve(docs.size());
+    shardKeys.reserve(docs.size());
+    for (size_t i = 0; i < docs.size(); ++i) {
+        auto shardKey = cm->getShardKeyPattern().extractShardKeyFromDoc(docs[i]);
+        if (shardKey.isEmpty()) {
+            endpoints[i] = targetInsert(opCtx, docs[i]);
+        } else {
+            keyedDocs.push_back(i);
+            shardKeys.push_back(std::move(shardKey));
+        }
+    }
+
+    auto chunks = cm->findIntersectingChunksWithSimpleCollation(shardKeys);
+    for (size_t j = 0; j < keyedDocs.size(); ++j) {
+        if (!chunks[j].isOK()) {
+            endpoints[keyedDocs[j]] = chunks[j].getStatus();
+            continue;
+        }
+        const auto& shardId = chunks[j].getValue().getShardId();
+        endpoints[keyedDocs[j]] = StatusWith<ShardEndpoint>(
+            ShardEndpoint(shardId, cm->getVersion(shardId)));
+    }
+
+    std::vector<StatusWith<ShardEndpoint>> results;
+    results.reserve(docs.size());
+    for (auto& endpoint : endpoints) {
+        results.push_back(std::move(*endpoint));
+    }
+    return results;
+}
+
 StatusWith<std::vector<ShardEndpoint>> ChunkManagerTargeter::targetUpdate(
     OperationContext* opCtx, const write_ops::UpdateOpEntry& updateDoc) const {
     // If the update is replacement-style:
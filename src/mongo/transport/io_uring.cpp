@@ -0,0 +1,234 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/io_uring.h"
+
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "mongo/util/assert_util.h"
+#include "mongo/util/errno_util.h"
+#include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace transport {
+namespace {
+
+int ioUringSetup(unsigned entries, io_uring_params* params) {
+    return ::syscall(__NR_io_uring_setup, entries, params);
+}
+
+int ioUringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return ::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0);
+}
+
+int ioUringRegister(int fd, unsigned opcode, const void* arg, unsigned nrArgs) {
+    return ::syscall(__NR_io_uring_register, fd, opcode, arg, nrArgs);
+}
+
+void* mapRing(int fd, size_t size, off_t offset) {
+    void* ptr =
+        ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+    if (ptr == MAP_FAILED) {
+        auto e = errno;
+        uasserted(ErrorCodes::InternalError,
+                  str::stream() << "Failed to map io_uring queue: " << errnoWithDescription(e));
+    }
+    return ptr;
+}
+
+// Every operation the io_uring transport layer submits.
+const uint8_t kRequiredOps[] = {IORING_OP_ACCEPT,
+                                IORING_OP_READ,
+                                IORING_OP_READ_FIXED,
+                                IORING_OP_RECV,
+                                IORING_OP_SEND,
+                                IORING_OP_SENDMSG,
+                                IORING_OP_ASYNC_CANCEL,
+                                IORING_OP_LINK_TIMEOUT};
+
+}  // namespace
+
+bool IoUring::isSupported() {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = ioUringSetup(8, &params);
+    if (fd < 0) {
+        LOG(1) << "io_uring is not available: " << errnoWithDescription(errno);
+        return false;
+    }
+    ON_BLOCK_EXIT([&] { ::close(fd); });
+
+    constexpr size_t kProbeOps = 256;
+    std::vector<char> storage(sizeof(io_uring_probe) + kProbeOps * sizeof(io_uring_probe_op));
+    auto probe = reinterpret_cast<io_uring_probe*>(storage.data());
+    if (ioUringRegister(fd, IORING_REGISTER_PROBE, probe, kProbeOps) < 0) {
+        LOG(1) << "Failed to probe io_uring operations: " << errnoWithDescription(errno);
+        return false;
+    }
+
+    for (auto op : kRequiredOps) {
+        if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+            LOG(1) << "io_uring does not support operation " << static_cast<int>(op);
+            return false;
+        }
+    }
+    return true;
+}
+
+IoUring::IoUring(unsigned entries) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    _fd = ioUringSetup(entries, &params);
+    if (_fd < 0) {
+        auto e = errno;
+        uasserted(ErrorCodes::InternalError,
+                  str::stream() << "Failed to create io_uring: " << errnoWithDescription(e));
+    }
+    auto guard = makeGuard([&] { _release(); });
+
+    _sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    _cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        _sqRingSize = std::max(_sqRingSize, _cqRingSize);
+        _sqRing = mapRing(_fd, _sqRingSize, IORING_OFF_SQ_RING);
+        _cqRing = _sqRing;
+        _cqRingSize = 0;
+    } else {
+        _sqRing = mapRing(_fd, _sqRingSize, IORING_OFF_SQ_RING);
+        _cqRing = mapRing(_fd, _cqRingSize, IORING_OFF_CQ_RING);
+    }
+
+    _sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    _sqes = static_cast<io_uring_sqe*>(mapRing(_fd, _sqesSize, IORING_OFF_SQES));
+
+    auto sq = static_cast<char*>(_sqRing);
+    _sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    _sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    _sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    _sqEntries = params.sq_entries;
+    _sqeTail = *_sqTail;
+
+    // Submission queue entries are always handed out in order, so the indirection array maps each
+    // slot to the entry of the same index.
+    auto sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    for (unsigned i = 0; i < _sqEntries; ++i) {
+        sqArray[i] = i;
+    }
+
+    auto cq = static_cast<char*>(_cqRing);
+    _cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    _cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    _cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    _cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    guard.dismiss();
+}
+
+IoUring::~IoUring() {
+    _release();
+}
+
+void IoUring::_release() {
+    if (_sqes) {
+        ::munmap(_sqes, _sqesSize);
+    }
+    if (_cqRing && _cqRing != _sqRing) {
+        ::munmap(_cqRing, _cqRingSize);
+    }
+    if (_sqRing) {
+        ::munmap(_sqRing, _sqRingSize);
+    }
+    if (_fd >= 0) {
+        ::close(_fd);
+    }
+}
+
+io_uring_sqe* IoUring::getSqe() {
+    const unsigned head = __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE);
+    if (_sqeTail - head >= _sqEntries) {
+        return nullptr;
+    }
+
+    auto sqe = &_sqes[_sqeTail & _sqMask];
+    ++_sqeTail;
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+Status IoUring::submitAndWait(unsigned waitFor) {
+    __atomic_store_n(_sqTail, _sqeTail, __ATOMIC_RELEASE);
+
+    while (true) {
+        // Entries which an earlier call failed to submit are still between the kernel's head and
+        // our tail, so this submits them as well.
+        const unsigned toSubmit = _sqeTail - __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE);
+        if (toSubmit == 0 && waitFor == 0) {
+            return Status::OK();
+        }
+
+        const unsigned flags = waitFor ? IORING_ENTER_GETEVENTS : 0;
+        if (ioUringEnter(_fd, toSubmit, waitFor, flags) >= 0) {
+            return Status::OK();
+        }
+
+        auto e = errno;
+        if (e == EINTR) {
+            continue;
+        }
+        // The completion queue is full, so the caller must reap completions before anything more
+        // can be submitted.
+        if (e == EBUSY || e == EAGAIN) {
+            return Status::OK();
+        }
+        return Status(ErrorCodes::InternalError,
+                      str::stream() << "io_uring_enter failed: " << errnoWithDescription(e));
+    }
+}
+
+Status IoUring::registerBuffers(const std::vector<iovec>& buffers) {
+    if (ioUringRegister(_fd, IORING_REGISTER_BUFFERS, buffers.data(), buffers.size()) < 0) {
+        auto e = errno;
+        return Status(ErrorCodes::InternalError,
+                      str::stream()
+                          << "Failed to register io_uring buffers: " << errnoWithDescription(e));
+    }
+    return Status::OK();
+}
+
+}  // namespace transport
+}  // namespace mongo
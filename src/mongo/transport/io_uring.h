@@ -0,0 +1,136 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <linux/io_uring.h>
+#include <sys/uio.h>
+#include <vector>
+
+#include "mongo/base/status.h"
+
+namespace mongo {
+namespace transport {
+
+/**
+ * A thin wrapper around a Linux io_uring instance, driven directly through the io_uring_setup,
+ * io_uring_enter and io_uring_register system calls.
+ *
+ * The ring is not thread safe: getSqe(), submitAndWait() and reapCompletions() must all be called
+ * from one thread at a time.
+ */
+class IoUring {
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+public:
+    /**
+     * Returns whether the running kernel supports io_uring and every operation which the io_uring
+     * transport layer submits.
+     */
+    static bool isSupported();
+
+    /**
+     * Creates a ring with room for 'entries' submission queue entries. Throws if the kernel
+     * refuses to create it.
+     */
+    explicit IoUring(unsigned entries);
+    ~IoUring();
+
+    /**
+     * Returns a zeroed submission queue entry to fill in, or nullptr if the submission queue is
+     * full and must be submitted first.
+     */
+    io_uring_sqe* getSqe();
+
+    /**
+     * Returns how many more entries getSqe() can return before the next submission.
+     */
+    unsigned spaceLeft() const {
+        return _sqEntries - (_sqeTail - __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE));
+    }
+
+    /**
+     * Submits every entry returned by getSqe() since the last submission, then waits until at
+     * least 'waitFor' completions are available.
+     */
+    Status submitAndWait(unsigned waitFor);
+
+    /**
+     * Calls 'cb' with each available completion queue entry, oldest first, and returns how many
+     * there were. The entry is only valid for the duration of the call.
+     */
+    template <typename Callback>
+    size_t reapCompletions(Callback&& cb) {
+        unsigned head = *_cqHead;
+        const unsigned tail = __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE);
+        size_t reaped = 0;
+        for (; head != tail; ++head, ++reaped) {
+            cb(_cqes[head & _cqMask]);
+        }
+        __atomic_store_n(_cqHead, head, __ATOMIC_RELEASE);
+        return reaped;
+    }
+
+    /**
+     * Registers 'buffers' with the kernel, so that IORING_OP_READ_FIXED can read into them without
+     * pinning their pages for every read. The buffers must outlive the ring.
+     */
+    Status registerBuffers(const std::vector<iovec>& buffers);
+
+private:
+    void _release();
+
+    int _fd = -1;
+
+    void* _sqRing = nullptr;
+    size_t _sqRingSize = 0;
+    void* _cqRing = nullptr;
+    size_t _cqRingSize = 0;
+
+    unsigned* _sqHead = nullptr;
+    unsigned* _sqTail = nullptr;
+    unsigned _sqMask = 0;
+    unsigned _sqEntries = 0;
+    io_uring_sqe* _sqes = nullptr;
+    size_t _sqesSize = 0;
+
+    // The tail of the entries handed out by getSqe(), which is published to the kernel on the next
+    // submission.
+    unsigned _sqeTail = 0;
+
+    unsigned* _cqHead = nullptr;
+    unsigned* _cqTail = nullptr;
+    unsigned _cqMask = 0;
+    io_uring_cqe* _cqes = nullptr;
+};
+
+}  // namespace transport
+}  // namespace mongo
@@ -34,20 +34,35 @@
 #include "mongo/base/string_data.h"
 #include "mongo/platform/atomic_word.h"
 
+#include <memory>
 #include <type_traits>
 
 namespace mongo {
+class BSONObjBuilder;
+
 enum class MessageCompressor : uint8_t {
     kNoop = 0,
     kSnappy = 1,
     kZlib = 2,
     kZstd = 3,
+    kZstdDictionary = 4,
+    kZstdStream = 5,
     kExtended = 255,
 };
 
 StringData getMessageCompressorName(MessageCompressor id);
 using MessageCompressorId = std::underlying_type<MessageCompressor>::type;
 
+/*
+ * State that a compressor carries from one message to the next on a single session, such as a
+ * dictionary it has shared with the peer. Each MessageCompressorManager owns the states of its
+ * session, and only uses them from one thread at a time.
+ */
+class MessageCompressorSessionState {
+public:
+    virtual ~MessageCompressorSessionState() = default;
+};
+
 class MessageCompressorBase {
     MessageCompressorBase(const MessageCompressorBase&) = delete;
     MessageCompressorBase& operator=(const MessageCompressorBase&) = delete;
@@ -89,6 +104,41 @@ public:
      */
     virtual StatusWith<std::size_t> decompressData(ConstDataRange input, DataRange output) = 0;
 
+    /*
+     * Compressors which carry state between the messages of a session return a new state for each
+     * session here. Stateless compressors return nullptr.
+     */
+    virtual std::unique_ptr<MessageCompressorSessionState> makeSessionState() {
+        return nullptr;
+    }
+
+    /*
+     * These are used instead of getMaxCompressedSize, compressData and decompressData for the
+     * messages of a session, and are passed the state makeSessionState returned for it. Stateless
+     * compressors don't need to override them.
+     */
+    virtual std::size_t getMaxSessionCompressedSize(MessageCompressorSessionState* state,
+                                                    size_t inputSize) {
+        return getMaxCompressedSize(inputSize);
+    }
+
+    virtual StatusWith<std::size_t> compressSessionData(MessageCompressorSessionState* state,
+                                                        ConstDataRange input,
+                                                        DataRange output) {
+        return compressData(input, output);
+    }
+
+    virtual StatusWith<std::size_t> decompressSessionData(MessageCompressorSessionState* state,
+                                                          ConstDataRange input,
+                                                          DataRange output) {
+        return decompressData(input, output);
+    }
+
+    /*
+     * Appends any statistics specific to this compressor to its serverStatus section.
+     */
+    virtual void appendStats(BSONObjBuilder* b) const {}
+
     /*
      * This returns the number of bytes passed in the input for compressData
      */
@@ -117,6 +167,20 @@ public:
         return _decompressBytesOut.loadRelaxed();
     }
 
+    /*
+     * This returns the time spent in compressData, in microseconds
+     */
+    int64_t getCompressorMicros() const {
+        return _compressMicros.loadRelaxed();
+    }
+
+    /*
+     * This returns the time spent in decompressData, in microseconds
+     */
+    int64_t getDecompressorMicros() const {
+        return _decompressMicros.loadRelaxed();
+    }
+
 
 protected:
     /*
@@ -143,13 +207,26 @@ protected:
     }
 
 private:
+    // The MessageCompressorManager times the calls it makes to compress and decompress data.
+    friend class MessageCompressorManager;
+
+    void counterHitCompressMicros(int64_t micros) {
+        _compressMicros.addAndFetch(micros);
+    }
+
+    void counterHitDecompressMicros(int64_t micros) {
+        _decompressMicros.addAndFetch(micros);
+    }
+
     const MessageCompressorId _id;
     const std::string _name;
 
     AtomicWord<long long> _compressBytesIn;
     AtomicWord<long long> _compressBytesOut;
+    AtomicWord<long long> _compressMicros;
 
     AtomicWord<long long> _decompressBytesIn;
     AtomicWord<long long> _decompressBytesOut;
+    AtomicWord<long long> _decompressMicros;
 };
 }  // namespace mongo
@@ -41,6 +41,7 @@
 #include "mongo/transport/message_compressor_registry.h"
 #include "mongo/transport/session.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 namespace {
@@ -97,8 +98,9 @@ StatusWith<Message> MessageCompressorManager::compressMessage(
 
     LOG(3) << "Compressing message with " << compressor->getName();
 
+    auto sessionState = _getSessionState(compressor);
     auto inputHeader = msg.header();
-    size_t bufferSize = compressor->getMaxCompressedSize(msg.dataSize()) +
+    size_t bufferSize = compressor->getMaxSessionCompressedSize(sessionState, msg.dataSize()) +
         CompressionHeader::size() + MsgData::MsgDataHeaderSize;
 
     CompressionHeader compressionHeader(
@@ -122,7 +124,9 @@ StatusWith<Message> MessageCompressorManager::compressMessage(
     compressionHeader.serialize(&output);
     ConstDataRange input(inputHeader.data(), inputHeader.data() + inputHeader.dataLen());
 
-    auto sws = compressor->compressData(input, output);
+    Timer timer;
+    auto sws = compressor->compressSessionData(sessionState, input, output);
+    compressor->counterHitCompressMicros(timer.micros());
 
     if (!sws.isOK())
         return sws.getStatus();
@@ -173,7 +177,9 @@ StatusWith<Message> MessageCompressorManager::decompressMessage(const Message& m
 
     DataRangeCursor output(outMessage.data(), outMessage.data() + outMessage.dataLen());
 
-    auto sws = compressor->decompressData(input, output);
+    Timer timer;
+    auto sws = compressor->decompressSessionData(_getSessionState(compressor), input, output);
+    compressor->counterHitDecompressMicros(timer.micros());
 
     if (!sws.isOK())
         return sws.getStatus();
@@ -193,6 +199,9 @@ void MessageCompressorManager::clientBegin(BSONObjBuilder* output) {
     // We're about to update the compressor list with the negotiation result from the server.
     _negotiated.clear();
 
+    // Negotiation starts a new connection, whose peer has none of the state of the last one.
+    _sessionStates.clear();
+
     auto& compressorList = _registry->getCompressorNames();
     if (compressorList.size() == 0)
         return;
@@ -253,8 +262,10 @@ void MessageCompressorManager::serverNegotiate(const BSONObj& input, BSONObjBuil
     }
 
     // If compression has already been negotiated, then this is a renegotiation, so we should
-    // reset the state of the manager.
+    // reset the state of the manager. The client resets its compressors' session states when it
+    // starts negotiating, so those are reset too.
     _negotiated.clear();
+    _sessionStates.clear();
 
     // First we go through all the compressor names that the client has requested support for
     BSONObj theirObj = elem.Obj();
@@ -290,6 +301,18 @@ void MessageCompressorManager::serverNegotiate(const BSONObj& input, BSONObjBuil
     }
 }
 
+MessageCompressorSessionState* MessageCompressorManager::_getSessionState(
+    MessageCompressorBase* compressor) {
+    for (auto&& [id, state] : _sessionStates) {
+        if (id == compressor->getId()) {
+            return state.get();
+        }
+    }
+
+    _sessionStates.emplace_back(compressor->getId(), compressor->makeSessionState());
+    return _sessionStates.back().second.get();
+}
+
 MessageCompressorManager& MessageCompressorManager::forSession(
     const transport::SessionHandle& session) {
     return getForSession(session.get());
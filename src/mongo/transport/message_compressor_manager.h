@@ -33,6 +33,8 @@
 #include "mongo/transport/message_compressor_base.h"
 #include "mongo/transport/session.h"
 
+#include <memory>
+#include <utility>
 #include <vector>
 
 namespace mongo {
@@ -127,8 +129,20 @@ public:
     static MessageCompressorManager& forSession(const transport::SessionHandle& session);
 
 private:
+    /*
+     * Returns the state of 'compressor' for this session, creating it if need be. Returns nullptr
+     * for stateless compressors.
+     */
+    MessageCompressorSessionState* _getSessionState(MessageCompressorBase* compressor);
+
     std::vector<MessageCompressorBase*> _negotiated;
     MessageCompressorRegistry* _registry;
+
+    // The state of each compressor used on this session so far. Negotiating compression again
+    // resets it, since a client negotiates whenever it connects, including when it reconnects a
+    // manager to a new peer.
+    std::vector<std::pair<MessageCompressorId, std::unique_ptr<MessageCompressorSessionState>>>
+        _sessionStates;
 };
 
 }  // namespace mongo
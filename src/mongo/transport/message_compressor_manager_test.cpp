@@ -43,8 +43,12 @@
 #include "mongo/transport/message_compressor_snappy.h"
 #include "mongo/transport/message_compressor_zlib.h"
 #include "mongo/transport/message_compressor_zstd.h"
+#include "mongo/transport/message_compressor_zstd_dictionary.h"
+#include "mongo/transport/message_compressor_zstd_dictionary_gen.h"
+#include "mongo/transport/message_compressor_zstd_stream.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -168,8 +172,7 @@ void checkOverflow(std::unique_ptr<MessageCompressorBase> compressor) {
         compressor->decompressData(tooSmallRange, DataRange(scratch.data(), scratch.size())));
 }
 
-Message buildMessage() {
-    const auto data = std::string{"Hello, world!"};
+Message buildMessage(const std::string& data = "Hello, world!") {
     const auto bufferSize = MsgData::MsgDataHeaderSize + data.size();
     auto buf = SharedBuffer::allocate(bufferSize);
     MsgData::View testView(buf.get());
@@ -241,6 +244,16 @@ TEST(ZstdMessageCompressor, Fidelity) {
     checkFidelity(testMessage, std::make_unique<ZstdMessageCompressor>());
 }
 
+TEST(ZstdDictionaryMessageCompressor, Fidelity) {
+    auto testMessage = buildMessage();
+    checkFidelity(testMessage, std::make_unique<ZstdDictionaryMessageCompressor>());
+}
+
+TEST(ZstdStreamMessageCompressor, Fidelity) {
+    auto testMessage = buildMessage();
+    checkFidelity(testMessage, std::make_unique<ZstdStreamMessageCompressor>());
+}
+
 TEST(SnappyMessageCompressor, Overflow) {
     checkOverflow(std::make_unique<SnappyMessageCompressor>());
 }
@@ -253,6 +266,188 @@ TEST(ZstdMessageCompressor, Overflow) {
     checkOverflow(std::make_unique<ZstdMessageCompressor>());
 }
 
+TEST(ZstdDictionaryMessageCompressor, Overflow) {
+    checkOverflow(std::make_unique<ZstdDictionaryMessageCompressor>());
+}
+
+TEST(ZstdStreamMessageCompressor, Overflow) {
+    checkOverflow(std::make_unique<ZstdStreamMessageCompressor>());
+}
+
+TEST(ZstdDictionaryMessageCompressor, TrainsAndSendsDictionary) {
+    const auto oldSampleBytes = zstdDictionaryTrainingSampleBytes.load();
+    zstdDictionaryTrainingSampleBytes.store(16 * 1024);
+    ON_BLOCK_EXIT([&] { zstdDictionaryTrainingSampleBytes.store(oldSampleBytes); });
+
+    MessageCompressorRegistry registry;
+    auto ownedCompressor = std::make_unique<ZstdDictionaryMessageCompressor>();
+    auto compressor = ownedCompressor.get();
+    registry.setSupportedCompressors({compressor->getName()});
+    registry.registerImplementation(std::move(ownedCompressor));
+    ASSERT_OK(registry.finalizeSupportedCompressors());
+
+    auto negotiate = [](MessageCompressorManager& client, MessageCompressorManager& server) {
+        BSONObjBuilder clientOutput;
+        client.clientBegin(&clientOutput);
+        BSONObjBuilder serverOutput;
+        server.serverNegotiate(clientOutput.obj(), &serverOutput);
+        client.clientFinish(serverOutput.obj());
+    };
+
+    auto dictionariesSent = [&] {
+        BSONObjBuilder stats;
+        compressor->appendStats(&stats);
+        return stats.obj()["dictionary"]["sent"].numberLong();
+    };
+
+    // Small messages which differ in their values but share most of their content.
+    auto makeMessage = [](int i) {
+        return buildMessage(str::stream()
+                            << "{insert: 'coll', documents: [{_id: " << i << ", name: 'user"
+                            << i * 7 << "', email: 'user" << i * 13 << "@example.com', age: "
+                            << i % 90 << ", city: 'City" << i % 50
+                            << "', active: true}], ordered: true, $db: 'test'}");
+    };
+
+    // Returns the compressed size of a message sent from 'sender' to 'receiver'.
+    auto sendMessage = [&](MessageCompressorManager& sender,
+                           MessageCompressorManager& receiver,
+                           int i) {
+        auto original = makeMessage(i);
+        auto compressed = assertOk(sender.compressMessage(original));
+        ASSERT_EQ(compressed.operation(), dbCompressed);
+
+        auto decompressed = assertOk(receiver.decompressMessage(compressed));
+        ASSERT_EQ(decompressed.size(), original.size());
+        ASSERT_EQ(memcmp(decompressed.buf(), original.buf(), original.size()), 0);
+        return compressed.size();
+    };
+
+    MessageCompressorManager client(&registry);
+    MessageCompressorManager server(&registry);
+    negotiate(client, server);
+
+    // The dictionary is trained in the background once the session has sampled enough messages.
+    int i = 0;
+    int sizeWithoutDictionary = 0;
+    while (compressor->getDictionariesTrained() == 0) {
+        ASSERT_LT(i, 100 * 1000);
+        sizeWithoutDictionary = sendMessage(client, server, i++);
+        compressor->waitForTrainingForTest();
+    }
+
+    // The next message carries the dictionary, and later ones are compressed with it.
+    ASSERT_GT(sendMessage(client, server, i++), sizeWithoutDictionary);
+    ASSERT_LT(sendMessage(client, server, i++), sizeWithoutDictionary);
+    ASSERT_EQ(dictionariesSent(), 1);
+
+    // A session which never received the dictionary can't decompress messages that use it.
+    MessageCompressorManager otherServer(&registry);
+    auto compressed = assertOk(client.compressMessage(makeMessage(i++)));
+    ASSERT_NOT_OK(otherServer.decompressMessage(compressed).getStatus());
+
+    // Another session never gets the dictionary trained from the messages of the first one.
+    MessageCompressorManager otherClient(&registry);
+    negotiate(otherClient, otherServer);
+    for (int j = 0; j < 10; ++j) {
+        sendMessage(otherClient, otherServer, i++);
+    }
+    ASSERT_EQ(dictionariesSent(), 1);
+}
+
+TEST(ZstdStreamMessageCompressor, LaterMessagesReferToEarlierOnes) {
+    MessageCompressorRegistry registry;
+    auto ownedCompressor = std::make_unique<ZstdStreamMessageCompressor>();
+    registry.setSupportedCompressors({ownedCompressor->getName()});
+    registry.registerImplementation(std::move(ownedCompressor));
+    ASSERT_OK(registry.finalizeSupportedCompressors());
+
+    MessageCompressorManager client(&registry);
+    MessageCompressorManager server(&registry);
+    BSONObjBuilder clientOutput;
+    client.clientBegin(&clientOutput);
+    BSONObjBuilder serverOutput;
+    server.serverNegotiate(clientOutput.obj(), &serverOutput);
+    client.clientFinish(serverOutput.obj());
+
+    auto makeMessage = [](int i) {
+        return buildMessage(str::stream()
+                            << "{insert: 'coll', documents: [{_id: " << i << ", name: 'user"
+                            << i * 7 << "', email: 'user" << i * 13 << "@example.com', age: "
+                            << i % 90 << ", city: 'City" << i % 50
+                            << "', active: true}], ordered: true, $db: 'test'}");
+    };
+
+    // Returns the compressed size of a message sent from the client to the server.
+    auto sendMessage = [&](int i) {
+        auto original = makeMessage(i);
+        auto compressed = assertOk(client.compressMessage(original));
+        ASSERT_EQ(compressed.operation(), dbCompressed);
+
+        auto decompressed = assertOk(server.decompressMessage(compressed));
+        ASSERT_EQ(decompressed.size(), original.size());
+        ASSERT_EQ(memcmp(decompressed.buf(), original.buf(), original.size()), 0);
+        return compressed.size();
+    };
+
+    // Once the stream has seen one message, the ones like it compress much smaller.
+    const auto firstSize = sendMessage(0);
+    for (int i = 1; i < 100; ++i) {
+        ASSERT_LT(sendMessage(i), firstSize);
+    }
+
+    // A session which didn't see the start of the stream can't decompress the rest of it.
+    MessageCompressorManager otherServer(&registry);
+    auto compressed = assertOk(client.compressMessage(makeMessage(100)));
+    ASSERT_NOT_OK(otherServer.decompressMessage(compressed).getStatus());
+}
+
+TEST(MessageCompressorManager, ReconnectResetsSessionState) {
+    MessageCompressorRegistry registry;
+    auto ownedCompressor = std::make_unique<ZstdStreamMessageCompressor>();
+    registry.setSupportedCompressors({ownedCompressor->getName()});
+    registry.registerImplementation(std::move(ownedCompressor));
+    ASSERT_OK(registry.finalizeSupportedCompressors());
+
+    auto negotiate = [](MessageCompressorManager& client, MessageCompressorManager& server) {
+        BSONObjBuilder clientOutput;
+        client.clientBegin(&clientOutput);
+        BSONObjBuilder serverOutput;
+        server.serverNegotiate(clientOutput.obj(), &serverOutput);
+        client.clientFinish(serverOutput.obj());
+    };
+
+    auto exchangeMessages = [](MessageCompressorManager& client,
+                               MessageCompressorManager& server) {
+        for (int i = 0; i < 10; ++i) {
+            auto original = buildMessage(str::stream() << "{find: 'coll', filter: {_id: " << i
+                                                       << "}, $db: 'test'}");
+            auto compressed = assertOk(client.compressMessage(original));
+            auto decompressed = assertOk(server.decompressMessage(compressed));
+            ASSERT_EQ(memcmp(decompressed.buf(), original.buf(), original.size()), 0);
+
+            compressed = assertOk(server.compressMessage(original));
+            decompressed = assertOk(client.decompressMessage(compressed));
+            ASSERT_EQ(memcmp(decompressed.buf(), original.buf(), original.size()), 0);
+        }
+    };
+
+    MessageCompressorManager client(&registry);
+    MessageCompressorManager server(&registry);
+    negotiate(client, server);
+    exchangeMessages(client, server);
+
+    // The client reconnects to a new server, which has to be able to follow its messages from
+    // the start of a new stream, and vice versa.
+    MessageCompressorManager newServer(&registry);
+    negotiate(client, newServer);
+    exchangeMessages(client, newServer);
+
+    // A client which negotiates again on the same connection starts over with the server too.
+    negotiate(client, newServer);
+    exchangeMessages(client, newServer);
+}
+
 TEST(MessageCompressorManager, SERVER_28008) {
 
     // Create a client and server that will negotiate the same compressors,
@@ -36,6 +36,15 @@ namespace mongo {
 namespace {
 const auto kBytesIn = "bytesIn"_sd;
 const auto kBytesOut = "bytesOut"_sd;
+const auto kMicros = "micros"_sd;
+const auto kRatio = "ratio"_sd;
+
+// Appends how many times larger the uncompressed data was than the compressed data.
+void appendRatio(BSONObjBuilder* b, int64_t uncompressed, int64_t compressed) {
+    if (compressed > 0) {
+        b->append(kRatio, static_cast<double>(uncompressed) / compressed);
+    }
+}
 }  // namespace
 
 void appendMessageCompressionStats(BSONObjBuilder* b) {
@@ -52,13 +61,23 @@ void appendMessageCompressionStats(BSONObjBuilder* b) {
 
         BSONObjBuilder compressorSection(base.subobjStart("compressor"));
         compressorSection << kBytesIn << compressor->getCompressorBytesIn() << kBytesOut
-                          << compressor->getCompressorBytesOut();
+                          << compressor->getCompressorBytesOut() << kMicros
+                          << compressor->getCompressorMicros();
+        appendRatio(&compressorSection,
+                    compressor->getCompressorBytesIn(),
+                    compressor->getCompressorBytesOut());
         compressorSection.doneFast();
 
         BSONObjBuilder decompressorSection(base.subobjStart("decompressor"));
         decompressorSection << kBytesIn << compressor->getDecompressorBytesIn() << kBytesOut
-                            << compressor->getDecompressorBytesOut();
+                            << compressor->getDecompressorBytesOut() << kMicros
+                            << compressor->getDecompressorMicros();
+        appendRatio(&decompressorSection,
+                    compressor->getDecompressorBytesOut(),
+                    compressor->getDecompressorBytesIn());
         decompressorSection.doneFast();
+
+        compressor->appendStats(&base);
         base.doneFast();
     }
     compressionSection.doneFast();
@@ -57,6 +57,10 @@ StringData getMessageCompressorName(MessageCompressor id) {
             return "zlib"_sd;
         case MessageCompressor::kZstd:
             return "zstd"_sd;
+        case MessageCompressor::kZstdDictionary:
+            return "zstd-dict"_sd;
+        case MessageCompressor::kZstdStream:
+            return "zstd-stream"_sd;
         default:
             fassert(40269, "Invalid message compressor ID");
     }
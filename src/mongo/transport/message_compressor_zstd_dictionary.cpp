@@ -0,0 +1,469 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/message_compressor_zstd_dictionary.h"
+
+#include <cstring>
+
+#include <zdict.h>
+#include <zstd.h>
+
+#include "mongo/base/checked_cast.h"
+#include "mongo/base/data_range_cursor.h"
+#include "mongo/base/data_type_endian.h"
+#include "mongo/base/init.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/transport/message_compressor_registry.h"
+#include "mongo/transport/message_compressor_zstd_dictionary_gen.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+namespace {
+
+// The flags byte, the dictionary version and the dictionary size.
+constexpr size_t kMaxHeaderBytes = sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint32_t);
+
+struct CDictDeleter {
+    void operator()(ZSTD_CDict* cdict) {
+        ZSTD_freeCDict(cdict);
+    }
+};
+
+struct DDictDeleter {
+    void operator()(ZSTD_DDict* ddict) {
+        ZSTD_freeDDict(ddict);
+    }
+};
+
+struct CCtxDeleter {
+    void operator()(ZSTD_CCtx* cctx) {
+        ZSTD_freeCCtx(cctx);
+    }
+};
+
+struct DCtxDeleter {
+    void operator()(ZSTD_DCtx* dctx) {
+        ZSTD_freeDCtx(dctx);
+    }
+};
+
+}  // namespace
+
+struct ZstdDictionaryMessageCompressor::Dictionary {
+    uint32_t version;
+    std::string data;
+    std::unique_ptr<ZSTD_CDict, CDictDeleter> cdict;
+};
+
+struct ZstdDictionaryMessageCompressor::Training {
+    Mutex mutex = MONGO_MAKE_LATCH("ZstdDictionaryMessageCompressor::Training::mutex");
+
+    // The last dictionary trained for the session, which it sends to the peer before using it.
+    std::shared_ptr<const Dictionary> latest;
+    bool inProgress = false;
+    Date_t lastTrained;
+};
+
+class ZstdDictionaryMessageCompressor::SessionState final : public MessageCompressorSessionState {
+public:
+    std::shared_ptr<const Dictionary> latestDictionary() const {
+        stdx::lock_guard<Latch> lk(training->mutex);
+        return training->latest;
+    }
+
+    // Shared with the training pool, which may still be training a dictionary for the session
+    // after it ends.
+    const std::shared_ptr<Training> training = std::make_shared<Training>();
+
+    // The samples of the messages sent on the session since the last dictionary was trained.
+    long long messageCount = 0;
+    std::string samples;
+    std::vector<size_t> sampleSizes;
+
+    // The last dictionary sent to the peer, which messages to it are compressed with.
+    std::shared_ptr<const Dictionary> sent;
+
+    // The last dictionary received from the peer, which messages from it are compressed with.
+    uint32_t receivedVersion = 0;
+    std::unique_ptr<ZSTD_DDict, DDictDeleter> received;
+
+    // Created when the session first compresses or decompresses a message, and reused for every
+    // message after. The dictionaries are loaded into their ZSTD_CDict and ZSTD_DDict once, and
+    // only referenced by the contexts for each message.
+    std::unique_ptr<ZSTD_CCtx, CCtxDeleter> cctx;
+    std::unique_ptr<ZSTD_DCtx, DCtxDeleter> dctx;
+};
+
+ZstdDictionaryMessageCompressor::ZstdDictionaryMessageCompressor()
+    : MessageCompressorBase(MessageCompressor::kZstdDictionary), _trainingPool([] {
+          ThreadPool::Options options;
+          options.poolName = "ZstdDictionaryTraining";
+          options.minThreads = 0;
+          options.maxThreads = 1;
+          return options;
+      }()) {
+    _trainingPool.startup();
+}
+
+ZstdDictionaryMessageCompressor::~ZstdDictionaryMessageCompressor() = default;
+
+std::size_t ZstdDictionaryMessageCompressor::getMaxCompressedSize(size_t inputSize) {
+    return getMaxSessionCompressedSize(nullptr, inputSize);
+}
+
+StatusWith<std::size_t> ZstdDictionaryMessageCompressor::compressData(ConstDataRange input,
+                                                                      DataRange output) {
+    return compressSessionData(nullptr, input, output);
+}
+
+StatusWith<std::size_t> ZstdDictionaryMessageCompressor::decompressData(ConstDataRange input,
+                                                                        DataRange output) {
+    return decompressSessionData(nullptr, input, output);
+}
+
+std::unique_ptr<MessageCompressorSessionState>
+ZstdDictionaryMessageCompressor::makeSessionState() {
+    return std::make_unique<SessionState>();
+}
+
+std::size_t ZstdDictionaryMessageCompressor::getMaxSessionCompressedSize(
+    MessageCompressorSessionState* stateBase, size_t inputSize) {
+    auto size = kMaxHeaderBytes + ZSTD_compressBound(inputSize);
+    auto state = checked_cast<SessionState*>(stateBase);
+    if (!state) {
+        return size;
+    }
+
+    // Leave room to send the latest dictionary if this session hasn't yet. If a newer one is
+    // trained before the message is compressed, then the session waits for its next message.
+    auto latest = state->latestDictionary();
+    if (latest && latest != state->sent) {
+        size += latest->data.size();
+    }
+    return size;
+}
+
+StatusWith<std::size_t> ZstdDictionaryMessageCompressor::compressSessionData(
+    MessageCompressorSessionState* stateBase, ConstDataRange input, DataRange output) {
+    auto state = checked_cast<SessionState*>(stateBase);
+
+    std::shared_ptr<const Dictionary> dictionary;
+    bool carryDictionary = false;
+    if (state) {
+        dictionary = state->sent;
+        auto latest = state->latestDictionary();
+        if (latest && latest != dictionary &&
+            output.length() >=
+                kMaxHeaderBytes + latest->data.size() + ZSTD_compressBound(input.length())) {
+            dictionary = std::move(latest);
+            carryDictionary = true;
+        }
+    }
+
+    DataRangeCursor cursor(output);
+    uint8_t flags = 0;
+    if (dictionary) {
+        flags |= kUsesDictionary;
+    }
+    if (carryDictionary) {
+        flags |= kCarriesDictionary;
+    }
+    auto status = cursor.writeAndAdvanceNoThrow<LittleEndian<uint8_t>>(flags);
+    if (status.isOK() && dictionary) {
+        status = cursor.writeAndAdvanceNoThrow<LittleEndian<uint32_t>>(dictionary->version);
+    }
+    if (status.isOK() && carryDictionary) {
+        status = cursor.writeAndAdvanceNoThrow<LittleEndian<uint32_t>>(dictionary->data.size());
+        if (status.isOK() && cursor.length() < dictionary->data.size()) {
+            status = {ErrorCodes::Overflow, "No room for the dictionary in the output"};
+        }
+        if (status.isOK()) {
+            std::memcpy(const_cast<char*>(cursor.data()),
+                        dictionary->data.data(),
+                        dictionary->data.size());
+            status = cursor.advanceNoThrow(dictionary->data.size());
+        }
+    }
+    if (!status.isOK()) {
+        return Status{ErrorCodes::BadValue,
+                      str::stream() << "Could not compress input: " << status.reason()};
+    }
+
+    size_t ret;
+    if (state) {
+        if (!state->cctx) {
+            state->cctx.reset(ZSTD_createCCtx());
+            if (!state->cctx) {
+                return Status{ErrorCodes::ExceededMemoryLimit, "Could not create a zstd context"};
+            }
+        }
+        ret = dictionary ? ZSTD_compress_usingCDict(state->cctx.get(),
+                                                    const_cast<char*>(cursor.data()),
+                                                    cursor.length(),
+                                                    input.data(),
+                                                    input.length(),
+                                                    dictionary->cdict.get())
+                         : ZSTD_compressCCtx(state->cctx.get(),
+                                             const_cast<char*>(cursor.data()),
+                                             cursor.length(),
+                                             input.data(),
+                                             input.length(),
+                                             ZSTD_CLEVEL_DEFAULT);
+    } else {
+        ret = ZSTD_compress(const_cast<char*>(cursor.data()),
+                            cursor.length(),
+                            input.data(),
+                            input.length(),
+                            ZSTD_CLEVEL_DEFAULT);
+    }
+
+    if (ZSTD_isError(ret)) {
+        return Status{ErrorCodes::BadValue,
+                      str::stream() << "Could not compress input: " << ZSTD_getErrorName(ret)};
+    }
+
+    if (carryDictionary) {
+        state->sent = std::move(dictionary);
+        _dictionariesSent.addAndFetch(1);
+    }
+
+    ret += cursor.data() - output.data();
+    counterHitCompress(input.length(), ret);
+    if (state) {
+        _sample(state, input);
+    }
+    return {ret};
+}
+
+StatusWith<std::size_t> ZstdDictionaryMessageCompressor::decompressSessionData(
+    MessageCompressorSessionState* stateBase, ConstDataRange input, DataRange output) {
+    auto state = checked_cast<SessionState*>(stateBase);
+    ConstDataRangeCursor cursor(input);
+
+    auto swFlags = cursor.readAndAdvanceNoThrow<LittleEndian<uint8_t>>();
+    if (!swFlags.isOK()) {
+        return swFlags.getStatus();
+    }
+    const uint8_t flags = swFlags.getValue();
+    if ((flags & ~(kUsesDictionary | kCarriesDictionary)) ||
+        ((flags & kCarriesDictionary) && !(flags & kUsesDictionary))) {
+        return Status{ErrorCodes::BadValue,
+                      str::stream() << "Invalid zstd dictionary flags " << uint32_t(flags)};
+    }
+
+    const ZSTD_DDict* ddict = nullptr;
+    if (flags & kUsesDictionary) {
+        auto swVersion = cursor.readAndAdvanceNoThrow<LittleEndian<uint32_t>>();
+        if (!swVersion.isOK()) {
+            return swVersion.getStatus();
+        }
+        const uint32_t version = swVersion.getValue();
+
+        if (flags & kCarriesDictionary) {
+            auto swSize = cursor.readAndAdvanceNoThrow<LittleEndian<uint32_t>>();
+            if (!swSize.isOK()) {
+                return swSize.getStatus();
+            }
+            const size_t size = swSize.getValue();
+            if (size > kMaxDictionaryBytes || size > cursor.length()) {
+                return Status{ErrorCodes::BadValue,
+                              str::stream() << "Invalid zstd dictionary size " << size};
+            }
+            if (!state) {
+                return Status{ErrorCodes::BadValue,
+                              "Received a zstd dictionary outside of a session"};
+            }
+
+            state->received.reset(ZSTD_createDDict(cursor.data(), size));
+            if (!state->received) {
+                state->receivedVersion = 0;
+                return Status{ErrorCodes::BadValue, "Could not load the received zstd dictionary"};
+            }
+            state->receivedVersion = version;
+            _dictionariesReceived.addAndFetch(1);
+            invariant(cursor.advanceNoThrow(size));
+        }
+
+        if (!state || !state->received || state->receivedVersion != version) {
+            return Status{ErrorCodes::BadValue,
+                          str::stream() << "Message was compressed with zstd dictionary version "
+                                        << version << ", which was not received on this session"};
+        }
+        ddict = state->received.get();
+    }
+
+    size_t ret;
+    if (state) {
+        if (!state->dctx) {
+            state->dctx.reset(ZSTD_createDCtx());
+            if (!state->dctx) {
+                return Status{ErrorCodes::ExceededMemoryLimit, "Could not create a zstd context"};
+            }
+        }
+        // A null 'ddict' decompresses without a dictionary.
+        ret = ZSTD_decompress_usingDDict(state->dctx.get(),
+                                         const_cast<char*>(output.data()),
+                                         output.length(),
+                                         cursor.data(),
+                                         cursor.length(),
+                                         ddict);
+    } else {
+        ret = ZSTD_decompress(
+            const_cast<char*>(output.data()), output.length(), cursor.data(), cursor.length());
+    }
+
+    if (ZSTD_isError(ret)) {
+        return Status{ErrorCodes::BadValue,
+                      str::stream() << "Could not decompress message: " << ZSTD_getErrorName(ret)};
+    }
+
+    counterHitDecompress(input.length(), ret);
+    return {ret};
+}
+
+void ZstdDictionaryMessageCompressor::appendStats(BSONObjBuilder* b) const {
+    BSONObjBuilder section(b->subobjStart("dictionary"));
+    section.append("trained", _dictionariesTrained.loadRelaxed());
+    section.append("trainingQueued",
+                   static_cast<long long>(_trainingPool.getStats().numPendingTasks));
+    section.append("sent", _dictionariesSent.loadRelaxed());
+    section.append("received", _dictionariesReceived.loadRelaxed());
+}
+
+long long ZstdDictionaryMessageCompressor::getDictionariesTrained() const {
+    return _dictionariesTrained.load();
+}
+
+void ZstdDictionaryMessageCompressor::waitForTrainingForTest() {
+    _trainingPool.waitForIdle();
+}
+
+void ZstdDictionaryMessageCompressor::_sample(SessionState* state, ConstDataRange input) {
+    if (state->messageCount++ % kSampleInterval != 0 || input.length() > kMaxSampleBytes) {
+        return;
+    }
+
+    const auto sampleBytes = static_cast<size_t>(zstdDictionaryTrainingSampleBytes.load());
+    if (sampleBytes == 0) {
+        return;
+    }
+
+    const auto& training = state->training;
+    {
+        stdx::lock_guard<Latch> lk(training->mutex);
+        if (training->inProgress ||
+            (training->latest &&
+             Date_t::now() - training->lastTrained <
+                 Seconds(zstdDictionaryRetrainIntervalSecs.load()))) {
+            return;
+        }
+    }
+
+    state->samples.append(input.data(), input.length());
+    state->sampleSizes.push_back(input.length());
+    if (state->samples.size() < sampleBytes) {
+        return;
+    }
+
+    {
+        stdx::lock_guard<Latch> lk(training->mutex);
+        training->inProgress = true;
+    }
+    auto samples = std::move(state->samples);
+    auto sampleSizes = std::move(state->sampleSizes);
+    state->samples.clear();
+    state->sampleSizes.clear();
+
+    _trainingPool.schedule([this,
+                            training = training,
+                            samples = std::move(samples),
+                            sampleSizes = std::move(sampleSizes)](Status status) mutable {
+        // Don't bother training for a session which has ended since.
+        if (!status.isOK() || training.use_count() == 1) {
+            stdx::lock_guard<Latch> lk(training->mutex);
+            training->inProgress = false;
+            return;
+        }
+        _train(training.get(), std::move(samples), std::move(sampleSizes));
+    });
+}
+
+void ZstdDictionaryMessageCompressor::_train(Training* training,
+                                             std::string samples,
+                                             std::vector<size_t> sampleSizes) {
+    auto trained = std::make_shared<Dictionary>();
+    trained->data.resize(static_cast<size_t>(zstdDictionaryMaxSizeBytes.load()));
+    size_t ret = ZDICT_trainFromBuffer(&trained->data[0],
+                                       trained->data.size(),
+                                       samples.data(),
+                                       sampleSizes.data(),
+                                       sampleSizes.size());
+    if (ZDICT_isError(ret)) {
+        LOG(1) << "Could not train a zstd dictionary from " << sampleSizes.size()
+               << " messages: " << ZDICT_getErrorName(ret);
+        trained.reset();
+    } else {
+        trained->data.resize(ret);
+        trained->cdict.reset(
+            ZSTD_createCDict(trained->data.data(), trained->data.size(), ZSTD_CLEVEL_DEFAULT));
+        if (!trained->cdict) {
+            trained.reset();
+        }
+    }
+
+    stdx::lock_guard<Latch> lk(training->mutex);
+    training->inProgress = false;
+    training->lastTrained = Date_t::now();
+    if (!trained) {
+        return;
+    }
+
+    trained->version = training->latest ? training->latest->version + 1 : 1;
+    LOG(2) << "Trained zstd dictionary version " << trained->version << " of "
+           << trained->data.size() << " bytes from " << sampleSizes.size() << " messages";
+    training->latest = std::move(trained);
+    _dictionariesTrained.addAndFetch(1);
+}
+
+MONGO_INITIALIZER_GENERAL(ZstdDictionaryMessageCompressorInit,
+                          ("EndStartupOptionHandling"),
+                          ("AllCompressorsRegistered"))
+(InitializerContext* context) {
+    auto& compressorRegistry = MessageCompressorRegistry::get();
+    compressorRegistry.registerImplementation(std::make_unique<ZstdDictionaryMessageCompressor>());
+    return Status::OK();
+}
+}  // namespace mongo
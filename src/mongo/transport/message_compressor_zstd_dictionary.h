@@ -0,0 +1,134 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/transport/message_compressor_base.h"
+#include "mongo/util/concurrency/thread_pool.h"
+
+namespace mongo {
+
+/**
+ * A zstd compressor which compresses the messages of a session with a dictionary trained from the
+ * messages that session has sent, so that small messages repeating the same field names and values
+ * compress well.
+ *
+ * One in kSampleInterval of the messages a session compresses is sampled, and once enough samples
+ * have been collected a dictionary is trained from them on a background thread. Each dictionary a
+ * session trains gets the next version number. The session starts using a dictionary by sending
+ * it to its peer along with the first message compressed with it, after which messages only name
+ * the version they use. The peer keeps the last dictionary it received on the session, so two
+ * processes never need to agree on dictionaries up front.
+ *
+ * A dictionary holds fragments of the messages it was trained from, so it is only ever trained
+ * from and sent on a single session, whose peer has already received those messages.
+ *
+ * The compressed data begins with a byte of flags. If kUsesDictionary is set, then it is followed
+ * by the 32-bit version of the dictionary. If kCarriesDictionary is also set, then the version is
+ * followed by the 32-bit size of the dictionary and the dictionary itself. The zstd frame follows.
+ */
+class ZstdDictionaryMessageCompressor final : public MessageCompressorBase {
+public:
+    static constexpr uint8_t kUsesDictionary = 1 << 0;
+    static constexpr uint8_t kCarriesDictionary = 1 << 1;
+
+    // The largest dictionary which may be trained or received.
+    static constexpr size_t kMaxDictionaryBytes = 1024 * 1024;
+
+    // Messages larger than this compress well enough on their own, so aren't sampled.
+    static constexpr size_t kMaxSampleBytes = 16 * 1024;
+
+    // One in this many of the messages of a session is sampled.
+    static constexpr int kSampleInterval = 16;
+
+    ZstdDictionaryMessageCompressor();
+    ~ZstdDictionaryMessageCompressor();
+
+    std::size_t getMaxCompressedSize(size_t inputSize) override;
+
+    StatusWith<std::size_t> compressData(ConstDataRange input, DataRange output) override;
+
+    StatusWith<std::size_t> decompressData(ConstDataRange input, DataRange output) override;
+
+    std::unique_ptr<MessageCompressorSessionState> makeSessionState() override;
+
+    std::size_t getMaxSessionCompressedSize(MessageCompressorSessionState* state,
+                                            size_t inputSize) override;
+
+    StatusWith<std::size_t> compressSessionData(MessageCompressorSessionState* state,
+                                                ConstDataRange input,
+                                                DataRange output) override;
+
+    StatusWith<std::size_t> decompressSessionData(MessageCompressorSessionState* state,
+                                                  ConstDataRange input,
+                                                  DataRange output) override;
+
+    void appendStats(BSONObjBuilder* b) const override;
+
+    /**
+     * Returns how many dictionaries have been trained, across all sessions.
+     */
+    long long getDictionariesTrained() const;
+
+    /**
+     * Waits for the dictionaries which are being trained to be done.
+     */
+    void waitForTrainingForTest();
+
+private:
+    struct Dictionary;
+    struct Training;
+    class SessionState;
+
+    /**
+     * Samples 'input' if it's this message's turn on the session, and schedules a new dictionary
+     * to be trained for the session once enough samples have been collected.
+     */
+    void _sample(SessionState* state, ConstDataRange input);
+
+    /**
+     * Trains a dictionary from the samples and makes it the latest one of the session training
+     * it, unless it can't be trained from them.
+     */
+    void _train(Training* training, std::string samples, std::vector<size_t> sampleSizes);
+
+    // Trains dictionaries off of the threads which compress messages.
+    ThreadPool _trainingPool;
+
+    AtomicWord<long long> _dictionariesTrained;
+    AtomicWord<long long> _dictionariesSent;
+    AtomicWord<long long> _dictionariesReceived;
+};
+
+}  // namespace mongo
@@ -0,0 +1,221 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/message_compressor_zstd_stream.h"
+
+#include <zstd.h>
+
+#include "mongo/base/checked_cast.h"
+#include "mongo/base/init.h"
+#include "mongo/transport/message_compressor_registry.h"
+#include "mongo/transport/message_compressor_zstd_stream_gen.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace {
+
+// Room for the frame header which starts the stream, beyond what the data itself may need.
+constexpr size_t kFrameHeaderBytes = 32;
+
+struct CCtxDeleter {
+    void operator()(ZSTD_CCtx* cctx) {
+        ZSTD_freeCCtx(cctx);
+    }
+};
+
+struct DCtxDeleter {
+    void operator()(ZSTD_DCtx* dctx) {
+        ZSTD_freeDCtx(dctx);
+    }
+};
+
+}  // namespace
+
+class ZstdStreamMessageCompressor::SessionState final : public MessageCompressorSessionState {
+public:
+    // Created when the session first compresses or decompresses a message.
+    std::unique_ptr<ZSTD_CCtx, CCtxDeleter> cctx;
+    std::unique_ptr<ZSTD_DCtx, DCtxDeleter> dctx;
+
+    // A stream which fails part of the way through a message can't carry on with the next one.
+    bool compressFailed = false;
+    bool decompressFailed = false;
+};
+
+ZstdStreamMessageCompressor::ZstdStreamMessageCompressor()
+    : MessageCompressorBase(MessageCompressor::kZstdStream) {}
+
+std::size_t ZstdStreamMessageCompressor::getMaxCompressedSize(size_t inputSize) {
+    return ZSTD_compressBound(inputSize) + kFrameHeaderBytes;
+}
+
+StatusWith<std::size_t> ZstdStreamMessageCompressor::compressData(ConstDataRange input,
+                                                                  DataRange output) {
+    size_t ret = ZSTD_compress(const_cast<char*>(output.data()),
+                               output.length(),
+                               input.data(),
+                               input.length(),
+                               zstdStreamCompressionLevel);
+
+    if (ZSTD_isError(ret)) {
+        return Status{ErrorCodes::BadValue,
+                      str::stream() << "Could not compress input: " << ZSTD_getErrorName(ret)};
+    }
+    counterHitCompress(input.length(), ret);
+    return {ret};
+}
+
+StatusWith<std::size_t> ZstdStreamMessageCompressor::decompressData(ConstDataRange input,
+                                                                    DataRange output) {
+    size_t ret = ZSTD_decompress(
+        const_cast<char*>(output.data()), output.length(), input.data(), input.length());
+
+    if (ZSTD_isError(ret)) {
+        return Status{ErrorCodes::BadValue,
+                      str::stream() << "Could not decompress message: " << ZSTD_getErrorName(ret)};
+    }
+
+    counterHitDecompress(input.length(), ret);
+    return {ret};
+}
+
+std::unique_ptr<MessageCompressorSessionState> ZstdStreamMessageCompressor::makeSessionState() {
+    return std::make_unique<SessionState>();
+}
+
+StatusWith<std::size_t> ZstdStreamMessageCompressor::compressSessionData(
+    MessageCompressorSessionState* stateBase, ConstDataRange input, DataRange output) {
+    auto state = checked_cast<SessionState*>(stateBase);
+    if (!state) {
+        return compressData(input, output);
+    }
+    if (state->compressFailed) {
+        return Status{ErrorCodes::BadValue, "The compression stream of this session failed"};
+    }
+
+    if (!state->cctx) {
+        state->cctx.reset(ZSTD_createCCtx());
+        if (!state->cctx) {
+            return Status{ErrorCodes::ExceededMemoryLimit, "Could not create a zstd context"};
+        }
+        for (auto [param, value] : {std::make_pair(ZSTD_c_compressionLevel,
+                                                   int(zstdStreamCompressionLevel)),
+                                    std::make_pair(ZSTD_c_windowLog, int(zstdStreamWindowLog))}) {
+            size_t ret = ZSTD_CCtx_setParameter(state->cctx.get(), param, value);
+            if (ZSTD_isError(ret)) {
+                state->cctx.reset();
+                return Status{ErrorCodes::BadValue,
+                              str::stream() << "Could not configure a zstd context: "
+                                            << ZSTD_getErrorName(ret)};
+            }
+        }
+    }
+
+    // Flushing ends the block, so that the peer can decompress all of the message without the
+    // next one, but leaves the frame open so that the next message can refer back to this one.
+    ZSTD_inBuffer in{input.data(), input.length(), 0};
+    ZSTD_outBuffer out{const_cast<char*>(output.data()), output.length(), 0};
+    size_t remaining;
+    do {
+        remaining = ZSTD_compressStream2(state->cctx.get(), &out, &in, ZSTD_e_flush);
+    } while (!ZSTD_isError(remaining) && remaining && out.pos < out.size);
+
+    if (ZSTD_isError(remaining) || remaining) {
+        state->compressFailed = true;
+        return Status{ErrorCodes::BadValue,
+                      str::stream() << "Could not compress input: "
+                                    << (ZSTD_isError(remaining) ? ZSTD_getErrorName(remaining)
+                                                                : "output buffer is too small")};
+    }
+
+    counterHitCompress(input.length(), out.pos);
+    return {out.pos};
+}
+
+StatusWith<std::size_t> ZstdStreamMessageCompressor::decompressSessionData(
+    MessageCompressorSessionState* stateBase, ConstDataRange input, DataRange output) {
+    auto state = checked_cast<SessionState*>(stateBase);
+    if (!state) {
+        return decompressData(input, output);
+    }
+    if (state->decompressFailed) {
+        return Status{ErrorCodes::BadValue, "The decompression stream of this session failed"};
+    }
+
+    if (!state->dctx) {
+        state->dctx.reset(ZSTD_createDCtx());
+        if (!state->dctx) {
+            return Status{ErrorCodes::ExceededMemoryLimit, "Could not create a zstd context"};
+        }
+        size_t ret = ZSTD_DCtx_setParameter(state->dctx.get(), ZSTD_d_windowLogMax, kMaxWindowLog);
+        if (ZSTD_isError(ret)) {
+            state->dctx.reset();
+            return Status{ErrorCodes::BadValue,
+                          str::stream() << "Could not configure a zstd context: "
+                                        << ZSTD_getErrorName(ret)};
+        }
+    }
+
+    ZSTD_inBuffer in{input.data(), input.length(), 0};
+    ZSTD_outBuffer out{const_cast<char*>(output.data()), output.length(), 0};
+    while (in.pos < in.size) {
+        const auto inPos = in.pos;
+        const auto outPos = out.pos;
+        size_t ret = ZSTD_decompressStream(state->dctx.get(), &out, &in);
+        if (ZSTD_isError(ret)) {
+            state->decompressFailed = true;
+            return Status{ErrorCodes::BadValue,
+                          str::stream()
+                              << "Could not decompress message: " << ZSTD_getErrorName(ret)};
+        }
+        if (in.pos == inPos && out.pos == outPos) {
+            state->decompressFailed = true;
+            return Status{ErrorCodes::BadValue,
+                          "Could not decompress message: it holds more data than expected"};
+        }
+    }
+
+    counterHitDecompress(input.length(), out.pos);
+    return {out.pos};
+}
+
+MONGO_INITIALIZER_GENERAL(ZstdStreamMessageCompressorInit,
+                          ("EndStartupOptionHandling"),
+                          ("AllCompressorsRegistered"))
+(InitializerContext* context) {
+    auto& compressorRegistry = MessageCompressorRegistry::get();
+    compressorRegistry.registerImplementation(std::make_unique<ZstdStreamMessageCompressor>());
+    return Status::OK();
+}
+}  // namespace mongo
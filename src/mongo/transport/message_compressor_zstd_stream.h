@@ -0,0 +1,80 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <memory>
+
+#include "mongo/transport/message_compressor_base.h"
+
+namespace mongo {
+
+/**
+ * A zstd compressor which compresses all the messages sent on a session as one stream, so that
+ * each message can refer back to earlier ones instead of being compressed on its own. This suits
+ * long-lived connections, such as replication and mongos-to-shard connections, which send many
+ * similar messages.
+ *
+ * Each session keeps a compression context for the messages it sends and a decompression context
+ * for those it receives. Every message is flushed to the end of a zstd block, so the peer can
+ * decompress it as soon as it arrives, while the frame and its window carry on into the next
+ * message. The peer must therefore decompress messages in the order they were compressed, which
+ * holds since a session's messages are sent and received in order.
+ *
+ * Outside of a session, each message is compressed as a zstd frame of its own.
+ */
+class ZstdStreamMessageCompressor final : public MessageCompressorBase {
+public:
+    // The largest window a peer may use, which bounds the memory of a decompression context.
+    static constexpr int kMaxWindowLog = 23;
+
+    ZstdStreamMessageCompressor();
+
+    std::size_t getMaxCompressedSize(size_t inputSize) override;
+
+    StatusWith<std::size_t> compressData(ConstDataRange input, DataRange output) override;
+
+    StatusWith<std::size_t> decompressData(ConstDataRange input, DataRange output) override;
+
+    std::unique_ptr<MessageCompressorSessionState> makeSessionState() override;
+
+    StatusWith<std::size_t> compressSessionData(MessageCompressorSessionState* state,
+                                                ConstDataRange input,
+                                                DataRange output) override;
+
+    StatusWith<std::size_t> decompressSessionData(MessageCompressorSessionState* state,
+                                                  ConstDataRange input,
+                                                  DataRange output) override;
+
+private:
+    class SessionState;
+};
+
+}  // namespace mongo
@@ -0,0 +1,161 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/db/service_context.h"
+#include "mongo/platform/condition_variable.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/transport/service_executor_adaptive.h"
+#include "mongo/transport/service_executor_thread_per_core.h"
+#include "mongo/transport/transport_layer_asio.h"
+#include "mongo/util/processinfo.h"
+
+namespace mongo {
+namespace transport {
+namespace {
+
+// The number of requests each mock session makes before it ends.
+const int kRequestsPerSession = 8;
+
+enum ExecutorKind { kAdaptive = 0, kThreadPerCore = 1 };
+
+/**
+ * Stands in for the sessions of a server under load: every session waits for a "network"
+ * completion on its home reactor, then schedules the processing of its request on the executor,
+ * which does a little work and waits for the next completion, until it has made all of its
+ * requests.
+ */
+class MockSessions {
+public:
+    MockSessions(ServiceExecutor* executor, std::vector<ReactorHandle> reactors, int numSessions)
+        : _executor(executor), _reactors(std::move(reactors)), _numSessions(numSessions) {}
+
+    void runToCompletion() {
+        _remaining = _numSessions;
+        for (int i = 0; i < _numSessions; ++i) {
+            _waitForRequest(i, kRequestsPerSession);
+        }
+
+        stdx::unique_lock<Latch> lk(_mutex);
+        _done.wait(lk, [&] { return _remaining == 0; });
+    }
+
+private:
+    void _waitForRequest(int session, int requestsLeft) {
+        auto& reactor = _reactors[session % _reactors.size()];
+        reactor->schedule([this, session, requestsLeft](Status status) {
+            invariant(status);
+            invariant(_executor->schedule(
+                [this, session, requestsLeft] { _processRequest(session, requestsLeft); },
+                ServiceExecutor::kMayRecurse,
+                ServiceExecutorTaskName::kSSMProcessMessage));
+        });
+    }
+
+    void _processRequest(int session, int requestsLeft) {
+        uint64_t hash = session;
+        for (int i = 0; i < 256; ++i) {
+            hash = hash * 6364136223846793005ULL + 1442695040888963407ULL;
+        }
+        benchmark::DoNotOptimize(hash);
+
+        if (--requestsLeft > 0) {
+            _waitForRequest(session, requestsLeft);
+            return;
+        }
+
+        stdx::lock_guard<Latch> lk(_mutex);
+        if (--_remaining == 0) {
+            _done.notify_all();
+        }
+    }
+
+    ServiceExecutor* const _executor;
+    const std::vector<ReactorHandle> _reactors;
+    const int _numSessions;
+
+    Mutex _mutex = MONGO_MAKE_LATCH("MockSessions::_mutex");
+    stdx::condition_variable _done;
+    int _remaining = 0;
+};
+
+/**
+ * Benchmarks how quickly an executor works through the requests of many concurrent sessions. The
+ * arguments are the executor, 0 for adaptive and 1 for thread per core, and the number of
+ * sessions.
+ */
+void BM_ServiceExecutorMockSessions(benchmark::State& state) {
+    if (!hasGlobalServiceContext()) {
+        setGlobalServiceContext(ServiceContext::make());
+    }
+
+    TransportLayerASIO tl(TransportLayerASIO::Options{}, nullptr);
+    const auto numCores = ProcessInfo::getNumAvailableCores();
+
+    std::vector<ReactorHandle> reactors;
+    std::unique_ptr<ServiceExecutor> executor;
+    if (state.range(0) == kAdaptive) {
+        reactors.push_back(tl.getReactor(TransportLayer::kNewReactor));
+        executor = std::make_unique<ServiceExecutorAdaptive>(getGlobalServiceContext(),
+                                                             reactors.front());
+    } else {
+        for (size_t i = 0; i < numCores; ++i) {
+            reactors.push_back(tl.getReactor(TransportLayer::kNewReactor));
+        }
+        executor =
+            std::make_unique<ServiceExecutorThreadPerCore>(getGlobalServiceContext(), reactors);
+    }
+    invariant(executor->start());
+
+    const auto numSessions = state.range(1);
+    MockSessions sessions(executor.get(), reactors, numSessions);
+    for (auto keepRunning : state) {
+        sessions.runToCompletion();
+    }
+    state.SetItemsProcessed(state.iterations() * numSessions * kRequestsPerSession);
+
+    invariant(executor->shutdown(Seconds(10)));
+}
+
+BENCHMARK(BM_ServiceExecutorMockSessions)
+    ->ArgNames({"threadPerCore", "sessions"})
+    ->Args({kAdaptive, 1000})
+    ->Args({kThreadPerCore, 1000})
+    ->Args({kAdaptive, 10000})
+    ->Args({kThreadPerCore, 10000})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace transport
+}  // namespace mongo
@@ -37,6 +37,7 @@
 #include "mongo/transport/service_executor_adaptive.h"
 #include "mongo/transport/service_executor_synchronous.h"
 #include "mongo/transport/service_executor_task_names.h"
+#include "mongo/transport/service_executor_thread_per_core.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
@@ -164,6 +165,88 @@ protected:
     std::shared_ptr<asio::io_context> asioIOCtx;
 };
 
+struct ThreadPerCoreTestOptions : public ServiceExecutorThreadPerCore::Options {
+    explicit ThreadPerCoreTestOptions(Milliseconds stuckThreadTimeout)
+        : _stuckThreadTimeout(stuckThreadTimeout) {}
+
+    int recursionLimit() const final {
+        return 0;
+    }
+
+    Milliseconds stuckThreadTimeout() const final {
+        return _stuckThreadTimeout;
+    }
+
+    Milliseconds idlePollInterval() const final {
+        return Milliseconds{5};
+    }
+
+    const Milliseconds _stuckThreadTimeout;
+};
+
+class ServiceExecutorThreadPerCoreFixture : public unittest::Test {
+protected:
+    void setUp() override {
+        auto scOwned = ServiceContext::make();
+        setGlobalServiceContext(std::move(scOwned));
+    }
+
+    void makeExecutor(size_t cores, Milliseconds stuckThreadTimeout = Hours{1}) {
+        std::vector<ReactorHandle> reactors;
+        for (size_t i = 0; i < cores; ++i) {
+            reactors.push_back(std::make_shared<ASIOReactor>());
+        }
+        executor = std::make_unique<ServiceExecutorThreadPerCore>(
+            getGlobalServiceContext(),
+            std::move(reactors),
+            std::make_unique<ThreadPerCoreTestOptions>(stuckThreadTimeout));
+    }
+
+    BSONObj getStats() const {
+        BSONObjBuilder bob;
+        executor->appendStats(&bob);
+        return bob.obj();
+    }
+
+    /**
+     * Schedules a task which schedules 'numTasks' more tasks on its own core and then blocks its
+     * thread until they have all run, which other threads must do. Returns whether they did.
+     */
+    bool runTasksWhileCoreIsBlocked(int numTasks) {
+        auto mutex = MONGO_MAKE_LATCH();
+        stdx::condition_variable cond;
+        int tasksRun = 0;
+        boost::optional<bool> allTasksRun;
+
+        auto blockingTask = [&] {
+            for (int i = 0; i < numTasks; ++i) {
+                ASSERT_OK(executor->schedule(
+                    [&] {
+                        stdx::lock_guard<Latch> lk(mutex);
+                        ++tasksRun;
+                        cond.notify_all();
+                    },
+                    ServiceExecutor::kEmptyFlags,
+                    ServiceExecutorTaskName::kSSMProcessMessage));
+            }
+
+            stdx::unique_lock<Latch> lk(mutex);
+            allTasksRun = cond.wait_for(
+                lk, stdx::chrono::seconds(10), [&] { return tasksRun == numTasks; });
+            cond.notify_all();
+        };
+
+        stdx::unique_lock<Latch> lk(mutex);
+        ASSERT_OK(executor->schedule(std::move(blockingTask),
+                                     ServiceExecutor::kEmptyFlags,
+                                     ServiceExecutorTaskName::kSSMStartSession));
+        cond.wait(lk, [&] { return allTasksRun.is_initialized(); });
+        return *allTasksRun;
+    }
+
+    std::unique_ptr<ServiceExecutorThreadPerCore> executor;
+};
+
 class ServiceExecutorSynchronousFixture : public unittest::Test {
 protected:
     void setUp() override {
@@ -206,6 +289,61 @@ TEST_F(ServiceExecutorAdaptiveFixture, ScheduleFailsBeforeStartup) {
     scheduleBasicTask(executor.get(), false);
 }
 
+TEST_F(ServiceExecutorThreadPerCoreFixture, BasicTaskRuns) {
+    makeExecutor(4);
+    ASSERT_OK(executor->start());
+    auto guard = makeGuard([this] { ASSERT_OK(executor->shutdown(kShutdownTime)); });
+
+    for (int i = 0; i < 8; ++i) {
+        scheduleBasicTask(executor.get(), true);
+    }
+
+    auto stats = getStats();
+    ASSERT_EQ(stats["executor"].str(), "threadPerCore");
+    ASSERT_EQ(stats["totalQueued"].numberLong(), 8);
+    ASSERT_EQ(stats["threadsRunning"].numberInt(), 4);
+
+    // Tasks scheduled from outside the executor are spread over all of its cores.
+    auto cores = stats["cores"].Array();
+    ASSERT_EQ(cores.size(), 4U);
+    for (auto&& core : cores) {
+        ASSERT_EQ(core["totalQueued"].numberLong(), 2);
+        ASSERT_TRUE(core.Obj().hasField("queueDepth"));
+    }
+}
+
+TEST_F(ServiceExecutorThreadPerCoreFixture, ScheduleFailsBeforeStartup) {
+    makeExecutor(2);
+    scheduleBasicTask(executor.get(), false);
+}
+
+TEST_F(ServiceExecutorThreadPerCoreFixture, IdleCoreStealsTasksQueuedOnBlockedCore) {
+    makeExecutor(2);
+    ASSERT_OK(executor->start());
+    auto guard = makeGuard([this] { ASSERT_OK(executor->shutdown(kShutdownTime)); });
+
+    // The tasks are queued on the blocked task's core, so only the other core can run them.
+    ASSERT_TRUE(runTasksWhileCoreIsBlocked(50));
+
+    auto cores = getStats()["cores"].Array();
+    ASSERT_EQ(cores[0]["totalQueued"].numberLong(), 51);
+    ASSERT_EQ(cores[1]["totalStolen"].numberLong(), 50);
+    ASSERT_EQ(cores[0]["helperThreadsStarted"].numberLong(), 0);
+}
+
+TEST_F(ServiceExecutorThreadPerCoreFixture, BlockedCoreGetsHelperThread) {
+    makeExecutor(1, Milliseconds{20});
+    ASSERT_OK(executor->start());
+    auto guard = makeGuard([this] { ASSERT_OK(executor->shutdown(kShutdownTime)); });
+
+    // With a single core, nothing can be stolen, so a helper thread must run the tasks.
+    ASSERT_TRUE(runTasksWhileCoreIsBlocked(5));
+
+    auto stats = getStats();
+    ASSERT_EQ(stats["totalStolen"].numberLong(), 0);
+    ASSERT_GTE(stats["helperThreadsStarted"].numberLong(), 1);
+}
+
 TEST_F(ServiceExecutorSynchronousFixture, BasicTaskRuns) {
     ASSERT_OK(executor->start());
     auto guard = makeGuard([this] { ASSERT_OK(executor->shutdown(kShutdownTime)); });
@@ -0,0 +1,456 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kExecutor
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/service_executor_thread_per_core.h"
+
+#include "mongo/transport/service_entry_point_utils.h"
+#include "mongo/transport/service_executor_gen.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/log.h"
+#include "mongo/util/processinfo.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace transport {
+namespace {
+constexpr auto kExecutorLabel = "executor"_sd;
+constexpr auto kExecutorName = "threadPerCore"_sd;
+constexpr auto kTotalQueued = "totalQueued"_sd;
+constexpr auto kTotalExecuted = "totalExecuted"_sd;
+constexpr auto kTotalStolen = "totalStolen"_sd;
+constexpr auto kTotalTimeQueuedUs = "totalTimeQueuedMicros"_sd;
+constexpr auto kThreadsRunning = "threadsRunning"_sd;
+constexpr auto kHelperThreadsStarted = "helperThreadsStarted"_sd;
+constexpr auto kQueueDepth = "queueDepth"_sd;
+constexpr auto kCores = "cores"_sd;
+
+int64_t ticksToMicros(TickSource::Tick ticks, TickSource* tickSource) {
+    invariant(tickSource->getTicksPerSecond() >= 1000000);
+    return tickSource->ticksTo<Microseconds>(ticks).count();
+}
+
+struct ServerParameterOptions : public ServiceExecutorThreadPerCore::Options {
+    int recursionLimit() const final {
+        return threadPerCoreServiceExecutorRecursionLimit.load();
+    }
+
+    Milliseconds stuckThreadTimeout() const final {
+        return Milliseconds{threadPerCoreServiceExecutorStuckThreadTimeoutMillis.load()};
+    }
+
+    Milliseconds idlePollInterval() const final {
+        return Milliseconds{threadPerCoreServiceExecutorIdlePollIntervalMillis.load()};
+    }
+};
+
+}  // namespace
+
+thread_local ServiceExecutorThreadPerCore::RunnerState
+    ServiceExecutorThreadPerCore::_localRunnerState;
+
+size_t ServiceExecutorThreadPerCore::configuredCoreCount() {
+    int value = threadPerCoreServiceExecutorCores;
+    if (value <= 0) {
+        value = ProcessInfo::getNumAvailableCores();
+    }
+    return static_cast<size_t>(std::max(value, 1));
+}
+
+ServiceExecutorThreadPerCore::ServiceExecutorThreadPerCore(ServiceContext* ctx,
+                                                           std::vector<ReactorHandle> reactors)
+    : ServiceExecutorThreadPerCore(
+          ctx, std::move(reactors), std::make_unique<ServerParameterOptions>()) {}
+
+ServiceExecutorThreadPerCore::ServiceExecutorThreadPerCore(ServiceContext* ctx,
+                                                           std::vector<ReactorHandle> reactors,
+                                                           std::unique_ptr<Options> config)
+    : _config(std::move(config)), _tickSource(ctx->getTickSource()) {
+    invariant(!reactors.empty());
+    for (auto&& reactor : reactors) {
+        _cores.push_back(std::make_unique<Core>(_cores.size(), std::move(reactor)));
+    }
+}
+
+ServiceExecutorThreadPerCore::~ServiceExecutorThreadPerCore() {
+    invariant(!_isRunning.load());
+}
+
+Status ServiceExecutorThreadPerCore::start() {
+    invariant(!_isRunning.load());
+    _isRunning.store(true);
+
+    for (auto&& core : _cores) {
+        auto status = _startRunner(core.get(), false);
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+    _controllerThread = stdx::thread(&ServiceExecutorThreadPerCore::_controllerRoutine, this);
+
+    log() << "Started thread per core service executor with " << _cores.size() << " cores";
+    return Status::OK();
+}
+
+Status ServiceExecutorThreadPerCore::shutdown(Milliseconds timeout) {
+    if (!_isRunning.load())
+        return Status::OK();
+
+    _isRunning.store(false);
+
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _controllerCondition.notify_all();
+    }
+    if (_controllerThread.joinable()) {
+        _controllerThread.join();
+    }
+
+    stdx::unique_lock<Latch> lk(_mutex);
+    for (auto&& core : _cores) {
+        core->reactor->stop();
+    }
+    bool result = _deathCondition.wait_for(
+        lk, timeout.toSystemDuration(), [&] { return _runnersRunning.load() == 0; });
+
+    return result ? Status::OK()
+                  : Status(ErrorCodes::Error::ExceededTimeLimit,
+                           "thread per core executor couldn't shutdown all worker threads within "
+                           "time limit.");
+}
+
+Status ServiceExecutorThreadPerCore::schedule(Task task,
+                                              ScheduleFlags flags,
+                                              ServiceExecutorTaskName taskName) {
+    if (!_isRunning.load()) {
+        return {ErrorCodes::ShutdownInProgress, "Executor is not running"};
+    }
+
+    QueuedTask queuedTask{std::move(task), _tickSource->getTicks()};
+
+    // Tasks scheduled by a runner stay on its core, which is the home core of the session whose
+    // network callback or previous task is running. If the task is allowed to recurse and we are
+    // not over the depth limit, run it right away.
+    auto core = _localCore();
+    if (core && (flags & kMayRecurse) &&
+        (_localRunnerState.recursionDepth + 1 < _config->recursionLimit())) {
+        _runTask(core, std::move(queuedTask));
+        return Status::OK();
+    }
+
+    if (!core) {
+        core = _cores[_nextCore.fetchAndAdd(1) % _cores.size()].get();
+    }
+    _enqueue(core, std::move(queuedTask));
+    return Status::OK();
+}
+
+void ServiceExecutorThreadPerCore::appendStats(BSONObjBuilder* bob) const {
+    int64_t totalQueued = 0;
+    int64_t totalExecuted = 0;
+    int64_t totalStolen = 0;
+    int64_t helpersStarted = 0;
+    TickSource::Tick totalSpentQueued = 0;
+
+    BSONArrayBuilder coresBuilder;
+    for (auto&& core : _cores) {
+        BSONObjBuilder coreBuilder(coresBuilder.subobjStart());
+        coreBuilder << kQueueDepth << core->queueDepth.load()                   //
+                    << kTotalQueued << core->totalQueued.load()                 //
+                    << kTotalExecuted << core->totalExecuted.load()             //
+                    << kTotalStolen << core->totalStolen.load()                 //
+                    << kThreadsRunning << core->runners.load()                  //
+                    << kHelperThreadsStarted << core->helpersStarted.load();
+        coreBuilder.doneFast();
+
+        totalQueued += core->totalQueued.load();
+        totalExecuted += core->totalExecuted.load();
+        totalStolen += core->totalStolen.load();
+        helpersStarted += core->helpersStarted.load();
+        totalSpentQueued += core->totalSpentQueued.load();
+    }
+
+    *bob << kExecutorLabel << kExecutorName                                        //
+         << kTotalQueued << totalQueued                                            //
+         << kTotalExecuted << totalExecuted                                        //
+         << kTotalStolen << totalStolen                                            //
+         << kTotalTimeQueuedUs << ticksToMicros(totalSpentQueued, _tickSource)     //
+         << kThreadsRunning << _runnersRunning.load()                              //
+         << kHelperThreadsStarted << helpersStarted;
+    bob->append(kCores, coresBuilder.arr());
+}
+
+ServiceExecutorThreadPerCore::Core* ServiceExecutorThreadPerCore::_localCore() const {
+    return _localRunnerState.executor == this ? _localRunnerState.core : nullptr;
+}
+
+void ServiceExecutorThreadPerCore::_enqueue(Core* core, QueuedTask task) {
+    core->totalQueued.addAndFetch(1);
+
+    size_t depth;
+    {
+        stdx::lock_guard<Latch> lk(core->mutex);
+        core->queue.push_back(std::move(task));
+        depth = core->queue.size();
+        core->queueDepth.store(depth);
+    }
+
+    // A runner of this core which is executing a task goes back to the queue once it is done, so
+    // it doesn't need to be woken up.
+    if (_localCore() != core || _localRunnerState.recursionDepth == 0) {
+        _postDrain(core);
+    }
+
+    if (depth > 1) {
+        _requestSteal(core);
+    }
+}
+
+boost::optional<ServiceExecutorThreadPerCore::QueuedTask> ServiceExecutorThreadPerCore::_pop(
+    Core* core) {
+    stdx::lock_guard<Latch> lk(core->mutex);
+    if (core->queue.empty()) {
+        return boost::none;
+    }
+    auto task = std::move(core->queue.front());
+    core->queue.pop_front();
+    core->queueDepth.store(core->queue.size());
+    return std::move(task);
+}
+
+boost::optional<ServiceExecutorThreadPerCore::QueuedTask> ServiceExecutorThreadPerCore::_steal(
+    Core* thief) {
+    // Only take a core's last queued task if none of its runners is free to run it.
+    Core* victim = nullptr;
+    int64_t victimDepth = 0;
+    for (auto&& core : _cores) {
+        if (core.get() == thief) {
+            continue;
+        }
+        auto depth = core->queueDepth.load();
+        if (depth > victimDepth && (depth > 1 || core->idleRunners.load() == 0)) {
+            victim = core.get();
+            victimDepth = depth;
+        }
+    }
+    if (!victim) {
+        return boost::none;
+    }
+
+    // The oldest task has waited the longest, so it is the one to take.
+    auto task = _pop(victim);
+    if (task) {
+        thief->totalStolen.addAndFetch(1);
+    }
+    return task;
+}
+
+void ServiceExecutorThreadPerCore::_runTask(Core* core, QueuedTask task) {
+    invariant(_localCore() == core);
+    auto& state = _localRunnerState;
+
+    const auto start = _tickSource->getTicks();
+    core->totalSpentQueued.addAndFetch(start - task.scheduledAt);
+
+    if (state.recursionDepth++ == 0) {
+        core->idleRunners.subtractAndFetch(1);
+        core->lastTaskStartedAt.store(start);
+    }
+    const auto guard = makeGuard([&] {
+        if (--state.recursionDepth == 0) {
+            core->idleRunners.addAndFetch(1);
+        }
+        core->totalExecuted.addAndFetch(1);
+    });
+
+    task.task();
+}
+
+void ServiceExecutorThreadPerCore::_postDrain(Core* core) {
+    if (core->drainPosted.swap(true)) {
+        return;
+    }
+
+    core->reactor->schedule([this, core](Status) {
+        core->drainPosted.store(false);
+        if (!_isRunning.load()) {
+            return;
+        }
+        while (auto task = _pop(core)) {
+            _runTask(core, std::move(*task));
+        }
+    });
+}
+
+void ServiceExecutorThreadPerCore::_requestSteal(Core* busy) {
+    for (size_t i = 1; i < _cores.size(); ++i) {
+        auto core = _cores[(busy->id + i) % _cores.size()].get();
+        if (core->idleRunners.load() == 0 || core->queueDepth.load() > 0) {
+            continue;
+        }
+        if (core->stealPosted.swap(true)) {
+            return;
+        }
+
+        core->reactor->schedule([this, core](Status) {
+            core->stealPosted.store(false);
+            if (!_isRunning.load()) {
+                return;
+            }
+            while (core->queueDepth.load() == 0) {
+                auto task = _steal(core);
+                if (!task) {
+                    break;
+                }
+                _runTask(core, std::move(*task));
+            }
+
+            // The stolen tasks may have queued work on this core, which the runner only looks at
+            // once it leaves the reactor.
+            if (core->queueDepth.load() > 0) {
+                _postDrain(core);
+            }
+        });
+        return;
+    }
+}
+
+Status ServiceExecutorThreadPerCore::_startRunner(Core* core, bool helper) {
+    _runnersRunning.addAndFetch(1);
+    core->runners.addAndFetch(1);
+    if (helper) {
+        core->helpersStarted.addAndFetch(1);
+    }
+
+    auto status = launchServiceWorkerThread([this, core, helper] { _runnerRoutine(core, helper); });
+    if (!status.isOK()) {
+        warning() << "Failed to launch new worker thread for core " << core->id << ": " << status;
+        core->runners.subtractAndFetch(1);
+        if (helper) {
+            core->helpersStarted.subtractAndFetch(1);
+        }
+        stdx::lock_guard<Latch> lk(_mutex);
+        if (_runnersRunning.subtractAndFetch(1) == 0) {
+            _deathCondition.notify_all();
+        }
+    }
+    return status;
+}
+
+void ServiceExecutorThreadPerCore::_runnerRoutine(Core* core, bool helper) {
+    {
+        std::string threadName = str::stream()
+            << "worker-core" << core->id << (helper ? "-helper" : "");
+        setThreadName(threadName);
+    }
+
+    _localRunnerState = RunnerState{this, core, 0};
+    core->idleRunners.addAndFetch(1);
+
+    const auto guard = makeGuard([this, core] {
+        _localRunnerState = RunnerState{};
+        core->idleRunners.subtractAndFetch(1);
+        core->runners.subtractAndFetch(1);
+
+        stdx::lock_guard<Latch> lk(_mutex);
+        if (_runnersRunning.subtractAndFetch(1) == 0) {
+            _deathCondition.notify_all();
+        }
+    });
+
+    while (_isRunning.load()) {
+        // A helper is no longer needed once another runner of its core is free.
+        if (helper && core->idleRunners.load() > 1) {
+            if (core->queueDepth.load() > 0) {
+                _postDrain(core);
+            }
+            LOG(1) << "Helper thread for core " << core->id << " is exiting";
+            return;
+        }
+
+        if (auto task = _pop(core)) {
+            _runTask(core, std::move(*task));
+            continue;
+        }
+        if (auto task = _steal(core)) {
+            _runTask(core, std::move(*task));
+            continue;
+        }
+
+        // Wait for network events on this core's sessions, which also runs the queue and steals
+        // when another thread asks us to.
+        core->reactor->runFor(_config->idlePollInterval());
+    }
+}
+
+void ServiceExecutorThreadPerCore::_controllerRoutine() {
+    setThreadName("worker-controller"_sd);
+
+    stdx::unique_lock<Latch> lk(_mutex);
+    while (_isRunning.load()) {
+        const auto stuckThreadTimeout = _config->stuckThreadTimeout();
+        _controllerCondition.wait_for(lk, (stuckThreadTimeout / 2).toSystemDuration(), [&] {
+            return !_isRunning.load();
+        });
+        if (!_isRunning.load()) {
+            break;
+        }
+
+        const auto now = _tickSource->getTicks();
+        for (auto&& core : _cores) {
+            if (core->idleRunners.load() > 0) {
+                continue;
+            }
+            const auto busyFor =
+                _tickSource->ticksTo<Milliseconds>(now - core->lastTaskStartedAt.load());
+            if (busyFor < stuckThreadTimeout) {
+                continue;
+            }
+
+            log() << "Detected blocked worker threads on core " << core->id
+                  << ", starting a helper thread to keep its sessions moving. No task has started "
+                  << "on it for " << busyFor;
+
+            // Count the helper's start as progress, so that another is only started if it gets
+            // stuck as well.
+            core->lastTaskStartedAt.store(now);
+            lk.unlock();
+            _startRunner(core.get(), true).ignore();
+            lk.lock();
+        }
+    }
+}
+
+}  // namespace transport
+}  // namespace mongo
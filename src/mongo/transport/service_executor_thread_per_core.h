@@ -0,0 +1,185 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include "mongo/db/service_context.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/platform/condition_variable.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/transport/service_executor.h"
+#include "mongo/transport/service_executor_task_names.h"
+#include "mongo/transport/transport_layer.h"
+#include "mongo/util/tick_source.h"
+
+namespace mongo {
+namespace transport {
+
+/**
+ * An asynchronous ServiceExecutor which runs one reactor and one run queue per core.
+ *
+ * Each core has a runner thread which drives the core's reactor and runs the tasks in its queue.
+ * Sessions are accepted onto the reactors in turn, so a session's network callbacks always run on
+ * its home core, and the tasks they schedule are queued on that core. Tasks scheduled from any
+ * other thread are spread over the cores in turn.
+ *
+ * A runner whose own queue is empty steals the oldest task from the core with the longest queue,
+ * and a core whose queue backs up wakes an idle core to do so. Tasks may block, so if every runner
+ * of a core has been busy with a task for longer than the stuck thread timeout, a helper runner is
+ * started for that core. Helpers exit once another runner of the core is idle again.
+ */
+class ServiceExecutorThreadPerCore final : public ServiceExecutor {
+public:
+    struct Options {
+        virtual ~Options() = default;
+
+        // The maximum allowable depth of recursion for tasks scheduled with the MayRecurse flag
+        // before stack unwinding is forced.
+        virtual int recursionLimit() const = 0;
+
+        // How long every runner of a core may be busy with a task before a helper runner is
+        // started for it.
+        virtual Milliseconds stuckThreadTimeout() const = 0;
+
+        // How long an idle runner waits on its reactor before looking for tasks to steal.
+        virtual Milliseconds idlePollInterval() const = 0;
+    };
+
+    /**
+     * Returns the number of cores the executor is configured to run, which is the number of
+     * ingress reactors the transport layer must create for it.
+     */
+    static size_t configuredCoreCount();
+
+    ServiceExecutorThreadPerCore(ServiceContext* ctx, std::vector<ReactorHandle> reactors);
+    ServiceExecutorThreadPerCore(ServiceContext* ctx,
+                                 std::vector<ReactorHandle> reactors,
+                                 std::unique_ptr<Options> config);
+
+    ~ServiceExecutorThreadPerCore();
+
+    Status start() final;
+    Status shutdown(Milliseconds timeout) final;
+    Status schedule(Task task, ScheduleFlags flags, ServiceExecutorTaskName taskName) final;
+
+    Mode transportMode() const final {
+        return Mode::kAsynchronous;
+    }
+
+    void appendStats(BSONObjBuilder* bob) const final;
+
+    size_t coreCount() const {
+        return _cores.size();
+    }
+
+private:
+    struct QueuedTask {
+        Task task;
+        TickSource::Tick scheduledAt;
+    };
+
+    struct Core {
+        Core(size_t id, ReactorHandle reactor) : id(id), reactor(std::move(reactor)) {}
+
+        const size_t id;
+        const ReactorHandle reactor;
+
+        mutable Mutex mutex = MONGO_MAKE_LATCH("ServiceExecutorThreadPerCore::Core::mutex");
+        std::deque<QueuedTask> queue;
+
+        // Set while a handler to run the queue, or to steal for this core, is posted to the
+        // reactor and has not started yet.
+        AtomicWord<bool> drainPosted{false};
+        AtomicWord<bool> stealPosted{false};
+
+        AtomicWord<int> runners{0};
+        AtomicWord<int> idleRunners{0};
+        AtomicWord<TickSource::Tick> lastTaskStartedAt{0};
+
+        // These counters are only used for reporting in serverStatus.
+        AtomicWord<int64_t> queueDepth{0};
+        AtomicWord<int64_t> totalQueued{0};
+        AtomicWord<int64_t> totalExecuted{0};
+        AtomicWord<int64_t> totalStolen{0};
+        AtomicWord<int64_t> helpersStarted{0};
+        AtomicWord<TickSource::Tick> totalSpentQueued{0};
+    };
+
+    struct RunnerState {
+        const ServiceExecutorThreadPerCore* executor = nullptr;
+        Core* core = nullptr;
+        int recursionDepth = 0;
+    };
+
+    Core* _localCore() const;
+
+    void _enqueue(Core* core, QueuedTask task);
+    boost::optional<QueuedTask> _pop(Core* core);
+    boost::optional<QueuedTask> _steal(Core* thief);
+    void _runTask(Core* core, QueuedTask task);
+
+    // Posts a handler to the core's reactor which runs its queue, if one is not posted already.
+    void _postDrain(Core* core);
+
+    // Posts a handler which steals tasks from 'busy' to the reactor of an idle core, if any.
+    void _requestSteal(Core* busy);
+
+    Status _startRunner(Core* core, bool helper);
+    void _runnerRoutine(Core* core, bool helper);
+    void _controllerRoutine();
+
+    std::unique_ptr<Options> _config;
+    TickSource* const _tickSource;
+
+    std::vector<std::unique_ptr<Core>> _cores;
+    AtomicWord<size_t> _nextCore{0};
+
+    AtomicWord<bool> _isRunning{false};
+    AtomicWord<int> _runnersRunning{0};
+
+    mutable Mutex _mutex = MONGO_MAKE_LATCH("ServiceExecutorThreadPerCore::_mutex");
+
+    // Runners signal this condition variable when they exit so we can gracefully shutdown the
+    // executor.
+    stdx::condition_variable _deathCondition;
+
+    // Signaled on shutdown to stop the controller thread, which starts helper runners.
+    stdx::condition_variable _controllerCondition;
+    stdx::thread _controllerThread;
+
+    static thread_local RunnerState _localRunnerState;
+};
+
+}  // namespace transport
+}  // namespace mongo
@@ -476,6 +476,9 @@ void ServiceStateMachine::_processMessage(ThreadGuard guard) {
         networkCounter.hitLogicalOut(toSink.size());
 
         if (_compressorId) {
+            // Compressors need the whole message in one buffer, so any documents it references
+            // are copied into it here rather than sent directly.
+            toSink.flatten();
             auto swm = compressorMgr.compressMessage(toSink, &_compressorId.value());
             uassertStatusOK(swm.getStatus());
             toSink = swm.getValue();
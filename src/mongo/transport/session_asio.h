@@ -150,7 +150,7 @@ public:
     Status sinkMessage(Message message) override {
         ensureSync();
 
-        return write(asio::buffer(message.buf(), message.size()))
+        return writeMessage(message)
             .then([this, &message] {
                 if (_isIngressSession) {
                     networkCounter.hitPhysicalOut(message.size());
@@ -161,7 +161,7 @@ public:
 
     Future<void> asyncSinkMessage(Message message, const BatonHandle& baton = nullptr) override {
         ensureAsync();
-        return write(asio::buffer(message.buf(), message.size()), baton)
+        return writeMessage(message, baton)
             .then([this, message /*keep the buffer alive*/]() {
                 if (_isIngressSession) {
                     networkCounter.hitPhysicalOut(message.size());
@@ -439,6 +439,66 @@ private:
         return opportunisticWrite(_socket, buffers, baton);
     }
 
+    /**
+     * Writes 'message', sending any documents it references straight from the buffers which own
+     * them. The caller must keep 'message' alive until the returned future is ready.
+     */
+    Future<void> writeMessage(Message& message, const BatonHandle& baton = nullptr) {
+#ifdef MONGO_CONFIG_SSL
+        // TLS encrypts the message into buffers of its own, so gathering it would save nothing.
+        if (_sslSocket) {
+            message.flatten();
+        }
+#endif
+        if (message.isContiguous()) {
+            return write(asio::buffer(message.buf(), message.size()), baton);
+        }
+
+        std::vector<asio::const_buffer> buffers;
+        for (auto&& range : message.buffers()) {
+            buffers.emplace_back(range.data(), range.length());
+        }
+        return opportunisticGatherWrite(std::move(buffers), baton);
+    }
+
+    /**
+     * Like opportunisticWrite(), but sends several buffers with as few system calls as possible.
+     * Only used for plain sockets, which is all writeMessage() needs.
+     */
+    Future<void> opportunisticGatherWrite(std::vector<asio::const_buffer> buffers,
+                                          const BatonHandle& baton) {
+#ifdef MONGO_CONFIG_SSL
+        _ranHandshake = true;
+#endif
+        std::error_code ec;
+        auto size = asio::write(_socket, buffers, ec);
+
+        if (((ec == asio::error::would_block) || (ec == asio::error::try_again)) &&
+            (_blockingMode == Async)) {
+            // Drop whatever asio::write managed to send before it would have blocked.
+            auto it = buffers.begin();
+            for (; it != buffers.end() && size >= it->size(); ++it) {
+                size -= it->size();
+            }
+            buffers.erase(buffers.begin(), it);
+            if (!buffers.empty()) {
+                buffers.front() += size;
+            }
+
+            if (baton && baton->networking()) {
+                return baton->networking()
+                    ->addSession(*this, NetworkingBaton::Type::Out)
+                    .then([buffers = std::move(buffers), baton, this]() mutable {
+                        return opportunisticGatherWrite(std::move(buffers), baton);
+                    });
+            }
+
+            return asio::async_write(_socket, buffers, UseFuture{}).ignoreValue();
+        } else {
+            return futurize(ec);
+        }
+    }
+
     template <typename Stream, typename MutableBufferSequence>
     Future<void> opportunisticRead(Stream& stream,
                                    const MutableBufferSequence& buffers,
@@ -239,6 +239,9 @@ TransportLayerASIO::TransportLayerASIO(const TransportLayerASIO::Options& opts,
 #endif
       _sep(sep),
       _listenerOptions(opts) {
+    for (size_t i = 1; i < _listenerOptions.ingressReactorCount; ++i) {
+        _additionalIngressReactors.push_back(std::make_shared<ASIOReactor>());
+    }
 }
 
 TransportLayerASIO::~TransportLayerASIO() = default;
@@ -855,6 +858,13 @@ ReactorHandle TransportLayerASIO::getReactor(WhichReactor which) {
     MONGO_UNREACHABLE;
 }
 
+std::vector<ReactorHandle> TransportLayerASIO::getIngressReactors() {
+    std::vector<ReactorHandle> reactors{_ingressReactor};
+    reactors.insert(
+        reactors.end(), _additionalIngressReactors.begin(), _additionalIngressReactors.end());
+    return reactors;
+}
+
 void TransportLayerASIO::_acceptConnection(GenericAcceptor& acceptor) {
     auto acceptCb = [this, &acceptor](const std::error_code& ec, GenericSocket peerSocket) mutable {
         if (!_running.load())
@@ -878,7 +888,12 @@ void TransportLayerASIO::_acceptConnection(GenericAcceptor& acceptor) {
         _acceptConnection(acceptor);
     };
 
-    acceptor.async_accept(*_ingressReactor, std::move(acceptCb));
+    // The accepted socket belongs to the reactor passed here, so all of its networking runs there.
+    auto& reactor = [&]() -> ASIOReactor& {
+        auto which = _nextIngressReactor++ % (_additionalIngressReactors.size() + 1);
+        return which == 0 ? *_ingressReactor : *_additionalIngressReactors[which - 1];
+    }();
+    acceptor.async_accept(reactor, std::move(acceptCb));
 }
 
 #ifdef MONGO_CONFIG_SSL
@@ -109,6 +109,8 @@ public:
         Mode transportMode = Mode::kSynchronous;  // whether accepted sockets should be put into
                                                   // non-blocking mode after they're accepted
         size_t maxConns = DEFAULT_MAX_CONN;       // maximum number of active connections
+        size_t ingressReactorCount = 1;           // number of reactors accepted sockets are
+                                                  // spread over, one per executor core
     };
 
     TransportLayerASIO(const Options& opts, ServiceEntryPoint* sep);
@@ -128,6 +130,12 @@ public:
 
     ReactorHandle getReactor(WhichReactor which) final;
 
+    /**
+     * Returns the reactors that accepted sockets are spread over, the first of which is the
+     * kIngress reactor.
+     */
+    std::vector<ReactorHandle> getIngressReactors();
+
     Status start() final;
 
     void shutdown() final;
@@ -166,6 +174,9 @@ private:
     // all the accepted sockets and all ingress networking activity. The _acceptorReactor contains
     // all the sockets in _acceptors.  The _egressReactor contains egress connections.
     //
+    // If Options::ingressReactorCount is greater than one, accepted sockets are instead spread
+    // over the _ingressReactor and the _additionalIngressReactors in turn.
+    //
     // TransportLayerASIO should never call run() on the _ingressReactor.
     // In synchronous mode, this will cause a massive performance degradation due to
     // unnecessary wakeups on the asio thread for sockets we don't intend to interact
@@ -187,6 +198,10 @@ private:
     std::shared_ptr<ASIOReactor> _ingressReactor;
     std::shared_ptr<ASIOReactor> _egressReactor;
     std::shared_ptr<ASIOReactor> _acceptorReactor;
+    std::vector<std::shared_ptr<ASIOReactor>> _additionalIngressReactors;
+
+    // Only used by the listener thread, which runs the accept callbacks.
+    size_t _nextIngressReactor = 0;
 
 #ifdef MONGO_CONFIG_SSL
     std::unique_ptr<asio::ssl::context> _ingressSSLContext;
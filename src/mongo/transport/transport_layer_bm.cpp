@@ -0,0 +1,195 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/db/server_options.h"
+#include "mongo/db/service_context.h"
+#include "mongo/transport/service_entry_point.h"
+#include "mongo/transport/transport_layer_asio.h"
+#include "mongo/transport/transport_layer_io_uring.h"
+#include "mongo/util/net/sock.h"
+
+namespace mongo {
+namespace transport {
+namespace {
+
+enum TransportLayerKind { kASIO = 0, kIoUring = 1 };
+
+/**
+ * Runs a thread for every session, which sends every message it receives straight back.
+ */
+class EchoServiceEntryPoint : public ServiceEntryPoint {
+public:
+    ~EchoServiceEntryPoint() override {
+        shutdown(Milliseconds::max());
+    }
+
+    void startSession(SessionHandle session) override {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _sessions.push_back(session);
+        _threads.emplace_back([session] {
+            while (true) {
+                auto swMsg = session->sourceMessage();
+                if (!swMsg.isOK() || !session->sinkMessage(std::move(swMsg.getValue())).isOK()) {
+                    return;
+                }
+            }
+        });
+    }
+
+    void endAllSessions(Session::TagMask tags) override {
+        stdx::lock_guard<Latch> lk(_mutex);
+        for (auto& session : _sessions) {
+            session->end();
+        }
+    }
+
+    Status start() override {
+        return Status::OK();
+    }
+
+    bool shutdown(Milliseconds timeout) override {
+        endAllSessions({});
+        for (auto& thread : _threads) {
+            thread.join();
+        }
+        _threads.clear();
+        _sessions.clear();
+        return true;
+    }
+
+    void appendStats(BSONObjBuilder*) const override {}
+
+    size_t numOpenSessions() const override {
+        stdx::lock_guard<Latch> lk(_mutex);
+        return _sessions.size();
+    }
+
+    DbResponse handleRequest(OperationContext* opCtx, const Message& request) override {
+        MONGO_UNREACHABLE;
+    }
+
+private:
+    mutable Mutex _mutex = MONGO_MAKE_LATCH("EchoServiceEntryPoint::_mutex");
+    std::vector<SessionHandle> _sessions;
+    std::vector<stdx::thread> _threads;
+};
+
+struct EchoServer {
+    explicit EchoServer(TransportLayerKind kind) {
+        ServerGlobalParams params;
+        params.noUnixSocket = true;
+        if (kind == kASIO) {
+            TransportLayerASIO::Options opts(&params);
+            opts.port = 0;
+            auto asio = std::make_unique<TransportLayerASIO>(opts, &sep);
+            invariant(asio->setup());
+            invariant(asio->start());
+            port = asio->listenerPort();
+            tl = std::move(asio);
+        } else {
+            TransportLayerIoUring::Options opts(&params);
+            opts.port = 0;
+            auto ioUring = std::make_unique<TransportLayerIoUring>(opts, &sep);
+            invariant(ioUring->setup());
+            invariant(ioUring->start());
+            port = ioUring->listenerPort();
+            tl = std::move(ioUring);
+        }
+    }
+
+    ~EchoServer() {
+        tl->shutdown();
+        sep.shutdown(Milliseconds::max());
+    }
+
+    EchoServiceEntryPoint sep;
+    std::unique_ptr<TransportLayer> tl;
+    int port = 0;
+};
+
+/**
+ * Benchmarks request and reply round trips over loopback, where every benchmark thread is a
+ * client with its own connection. The arguments are the transport layer, 0 for ASIO and 1 for
+ * io_uring, and the size of each message.
+ */
+void BM_TransportLayerEchoRoundTrip(benchmark::State& state) {
+    if (state.range(0) == kIoUring && !IoUring::isSupported()) {
+        state.SkipWithError("io_uring is not supported");
+        return;
+    }
+
+    static std::unique_ptr<EchoServer> server;
+    if (state.thread_index == 0) {
+        server = std::make_unique<EchoServer>(TransportLayerKind(state.range(0)));
+    }
+
+    const size_t msgLen = state.range(1);
+    std::string request(msgLen, 'x');
+    MSGHEADER::View(&request[0]).setMessageLength(msgLen);
+    std::string reply(msgLen, '\0');
+
+    std::unique_ptr<Socket> socket;
+    for (auto keepRunning : state) {
+        if (!socket) {
+            // The server only exists once every thread has started running.
+            state.PauseTiming();
+            socket = std::make_unique<Socket>();
+            SockAddr sa{"localhost", server->port, AF_INET};
+            invariant(socket->connect(sa));
+            state.ResumeTiming();
+        }
+
+        socket->send(request.data(), request.size(), "benchmark");
+        socket->recv(&reply[0], reply.size());
+    }
+    state.SetBytesProcessed(state.iterations() * msgLen * 2);
+    socket.reset();
+
+    if (state.thread_index == 0) {
+        server.reset();
+    }
+}
+
+BENCHMARK(BM_TransportLayerEchoRoundTrip)
+    ->ArgNames({"ioUring", "bytes"})
+    ->Args({kASIO, 1024})
+    ->Args({kIoUring, 1024})
+    ->Args({kASIO, 64 * 1024})
+    ->Args({kIoUring, 64 * 1024})
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace transport
+}  // namespace mongo
@@ -0,0 +1,974 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/transport_layer_io_uring.h"
+
+#include <algorithm>
+#include <climits>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <set>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#include "mongo/config.h"
+#include "mongo/db/stats/counters.h"
+#include "mongo/rpc/message.h"
+#include "mongo/transport/service_entry_point.h"
+#include "mongo/transport/transport_layer_io_uring_gen.h"
+#include "mongo/util/errno_util.h"
+#include "mongo/util/log.h"
+#include "mongo/util/net/socket_utils.h"
+#include "mongo/util/net/ssl_options.h"
+
+namespace mongo {
+namespace transport {
+namespace {
+
+// Completions with this user data belong to the timeouts linked to other operations, and are
+// ignored.
+constexpr uint64_t kIgnoredUserData = 0;
+
+constexpr auto kHeaderSize = sizeof(MSGHEADER::Value);
+
+// Set on the ring thread of each TransportLayerIoUring, so that operations it queues itself
+// don't wake it.
+thread_local const TransportLayerIoUring* ringThreadOwner = nullptr;
+
+/**
+ * Converts the result of a failed read or write into the Status TransportLayerASIO would return
+ * for the same error.
+ */
+Status ioResultToStatus(int res, bool hadTimeout) {
+    invariant(res <= 0);
+    switch (-res) {
+        case 0:
+            return {ErrorCodes::HostUnreachable, "Connection closed by peer"};
+        case ECANCELED:
+            // The timeout linked to an operation cancels it when it fires.
+            if (hadTimeout) {
+                return {ErrorCodes::NetworkTimeout, "Socket operation timed out"};
+            }
+            return {ErrorCodes::CallbackCanceled, "Callback was canceled"};
+        case EAGAIN:
+            return {ErrorCodes::NetworkTimeout, "Socket operation timed out"};
+        case ECONNRESET:
+            return {ErrorCodes::HostUnreachable, "Connection reset by peer"};
+        case ENETRESET:
+            return {ErrorCodes::HostUnreachable, "Connection reset by network"};
+        default:
+            return {ErrorCodes::SocketException, errnoWithDescription(-res)};
+    }
+}
+
+SockAddr getSocketAddress(int fd, bool peer) {
+    sockaddr_storage storage;
+    socklen_t size = sizeof(storage);
+    auto addr = reinterpret_cast<sockaddr*>(&storage);
+    if ((peer ? ::getpeername(fd, addr, &size) : ::getsockname(fd, addr, &size)) != 0) {
+        auto e = errno;
+        uasserted(ErrorCodes::SocketException,
+                  str::stream() << "Failed to get the " << (peer ? "remote" : "local")
+                                << " address of a socket: " << errnoWithDescription(e));
+    }
+    return SockAddr(storage, size);
+}
+
+}  // namespace
+
+class TransportLayerIoUring::IoUringSession final : public Session {
+    IoUringSession(const IoUringSession&) = delete;
+    IoUringSession& operator=(const IoUringSession&) = delete;
+
+public:
+    // Takes ownership of 'fd' once constructed. May throw a DBException if the socket is
+    // disconnected while it is being configured.
+    IoUringSession(TransportLayerIoUring* tl, int fd) : _tl(tl), _fd(fd) {
+        _localAddr = getSocketAddress(_fd, false);
+        _remoteAddr = getSocketAddress(_fd, true);
+        if (_localAddr.isIP()) {
+            const int on = 1;
+            ::setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            ::setsockopt(_fd, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on));
+            setSocketKeepAliveParams(_fd);
+        }
+
+        _local = HostAndPort(_localAddr.toString(true));
+        _remote = HostAndPort(_remoteAddr.toString(true));
+    }
+
+    ~IoUringSession() {
+        ::close(_fd);
+    }
+
+    TransportLayer* getTransportLayer() const override {
+        return _tl;
+    }
+
+    const HostAndPort& remote() const override {
+        return _remote;
+    }
+
+    const HostAndPort& local() const override {
+        return _local;
+    }
+
+    const SockAddr& remoteAddr() const override {
+        return _remoteAddr;
+    }
+
+    const SockAddr& localAddr() const override {
+        return _localAddr;
+    }
+
+    void end() override {
+        // Shutting the socket down completes any reads and writes queued on it.
+        if (::shutdown(_fd, SHUT_RDWR) != 0 && errno != ENOTCONN) {
+            error() << "Error shutting down socket: " << errnoWithDescription();
+        }
+    }
+
+    StatusWith<Message> sourceMessage() override {
+        return _sourceMessageImpl().getNoThrow();
+    }
+
+    Future<Message> asyncSourceMessage(const BatonHandle& baton = nullptr) override {
+        return _sourceMessageImpl();
+    }
+
+    Status sinkMessage(Message message) override {
+        return _sinkMessageImpl(std::move(message)).getNoThrow();
+    }
+
+    Future<void> asyncSinkMessage(Message message, const BatonHandle& baton = nullptr) override {
+        return _sinkMessageImpl(std::move(message));
+    }
+
+    void cancelAsyncOperations(const BatonHandle& baton = nullptr) override {
+        LOG(3) << "Cancelling outstanding I/O operations on connection to " << _remote;
+        auto op = std::make_unique<Operation>();
+        op->prepare = [this](io_uring_sqe* sqe) {
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->fd = _fd;
+            sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+        };
+        // The session keeps its socket open until the cancellation completes, so that it can't
+        // cancel the I/O of another connection which has been given the same file descriptor.
+        op->complete = [self = _self()](int res, uint32_t) {};
+        _tl->_submit(std::move(op));
+    }
+
+    void setTimeout(boost::optional<Milliseconds> timeout) override {
+        invariant(!timeout || timeout->count() > 0);
+        _timeout = timeout;
+    }
+
+    bool isConnected() override {
+        // Bytes already read for the next message mean the client sent it before going away, if it
+        // has.
+        if (!_readAhead.empty()) {
+            return true;
+        }
+
+        pollfd pfd{_fd, POLLIN, 0};
+        const int ready = ::poll(&pfd, 1, 0);
+        if (ready < 0) {
+            warning() << "Failed to poll socket for connectivity check: "
+                      << errnoWithDescription();
+            return false;
+        }
+        if (ready == 0) {
+            return true;
+        }
+
+        if (pfd.revents & POLLIN) {
+            char testByte;
+            const int size = ::recv(_fd, &testByte, sizeof(testByte), MSG_PEEK | MSG_DONTWAIT);
+            if (size == sizeof(testByte)) {
+                return true;
+            } else if (size == -1) {
+                warning() << "Failed to check socket connectivity: " << errnoWithDescription();
+            }
+            // If size == 0 then we got disconnected and we should return false.
+        }
+
+        return false;
+    }
+
+private:
+    struct WriteState {
+        Promise<void> promise;
+        Message message;
+        // The buffers still to be written from index 'next' on, trimmed by any partial sends.
+        std::vector<iovec> iov;
+        size_t next = 0;
+        msghdr msg{};
+    };
+
+    std::shared_ptr<IoUringSession> _self() {
+        return std::static_pointer_cast<IoUringSession>(shared_from_this());
+    }
+
+    Future<Message> _sourceMessageImpl() {
+        auto pf = makePromiseFuture<Message>();
+        _sourcePromise.emplace(std::move(pf.promise));
+        _headerFilled = 0;
+        _inBuffer = {};
+        _inFilled = 0;
+        _inLength = 0;
+
+        // The previous read may have returned the start, or all, of this message.
+        std::string readAhead;
+        readAhead.swap(_readAhead);
+        if (readAhead.empty() || !_consume(readAhead.data(), readAhead.size())) {
+            _readMore();
+        }
+        return std::move(pf.future);
+    }
+
+    /**
+     * Queues the next read of the message being sourced. Called by the thread sourcing the message
+     * for its first read, and on the ring thread for the rest.
+     */
+    void _readMore() {
+        auto op = std::make_unique<Operation>();
+        op->timeout = _timeout;
+        op->prepare = [this](io_uring_sqe* sqe) {
+            const size_t remaining =
+                _inLength ? _inLength - _inFilled : kHeaderSize - _headerFilled;
+            sqe->fd = _fd;
+
+            // Read as much as a registered buffer holds, which usually covers the rest of the
+            // message and sometimes the start of the next one. The rest of larger messages is read
+            // straight into their own buffer instead.
+            _registeredBuffer =
+                remaining < _tl->_registeredBufferSize ? _tl->_takeRegisteredBuffer() : -1;
+            if (_registeredBuffer >= 0) {
+                auto dest = _tl->_getRegisteredBuffer(_registeredBuffer);
+                sqe->opcode = IORING_OP_READ_FIXED;
+                sqe->addr = reinterpret_cast<uint64_t>(dest);
+                sqe->len = _tl->_registeredBufferSize;
+                sqe->buf_index = _registeredBuffer;
+            } else {
+                auto dest = _inLength ? _inBuffer.get() + _inFilled : _header + _headerFilled;
+                sqe->opcode = IORING_OP_RECV;
+                sqe->addr = reinterpret_cast<uint64_t>(dest);
+                sqe->len = remaining;
+            }
+        };
+        op->complete = [this, self = _self(), hadTimeout = bool(_timeout)](int res, uint32_t) {
+            const int registeredBuffer = std::exchange(_registeredBuffer, -1);
+            ON_BLOCK_EXIT([&] {
+                if (registeredBuffer >= 0) {
+                    _tl->_returnRegisteredBuffer(registeredBuffer);
+                }
+            });
+
+            if (res == -EINTR) {
+                return _readMore();
+            }
+            if (res <= 0) {
+                return _failSource(ioResultToStatus(res, hadTimeout));
+            }
+
+            const bool done = registeredBuffer >= 0
+                ? _consume(_tl->_getRegisteredBuffer(registeredBuffer), res)
+                : _received(res);
+            if (!done) {
+                _readMore();
+            }
+        };
+        _tl->_submit(std::move(op));
+    }
+
+    /**
+     * Copies 'len' bytes read into a registered buffer into the message being sourced, and keeps
+     * any which follow the end of the message for the next one. Returns whether the message is
+     * finished, either read in full or failed.
+     */
+    bool _consume(const char* data, size_t len) {
+        if (_inLength == 0) {
+            const auto n = std::min(len, kHeaderSize - _headerFilled);
+            memcpy(_header + _headerFilled, data, n);
+            _headerFilled += n;
+            data += n;
+            len -= n;
+            if (_headerFilled < kHeaderSize) {
+                return false;
+            }
+            if (!_startMessage()) {
+                return true;
+            }
+        }
+
+        const auto n = std::min(len, _inLength - _inFilled);
+        memcpy(_inBuffer.get() + _inFilled, data, n);
+        _inFilled += n;
+        if (n < len) {
+            _readAhead.assign(data + n, len - n);
+        }
+        return _finishIfComplete();
+    }
+
+    /**
+     * Accounts for 'n' bytes read straight into the header or message buffer. Returns whether the
+     * message is finished, either read in full or failed.
+     */
+    bool _received(size_t n) {
+        if (_inLength == 0) {
+            _headerFilled += n;
+            if (_headerFilled < kHeaderSize) {
+                return false;
+            }
+            return !_startMessage() || _finishIfComplete();
+        }
+
+        _inFilled += n;
+        return _finishIfComplete();
+    }
+
+    /**
+     * Validates the header just read and allocates the buffer of the message. Returns false if the
+     * message has been failed instead.
+     */
+    bool _startMessage() {
+        if (StringData(_header, 4) == "GET "_sd) {
+            _sendHTTPResponse();
+            return false;
+        }
+
+        const auto msgLen = size_t(MSGHEADER::ConstView(_header).getMessageLength());
+        if (msgLen < kHeaderSize || msgLen > MaxMessageSizeBytes) {
+            StringBuilder sb;
+            sb << "recv(): message msgLen " << msgLen << " is invalid. "
+               << "Min " << kHeaderSize << " Max: " << MaxMessageSizeBytes;
+            const auto str = sb.str();
+            LOG(0) << str;
+
+            _failSource(Status(ErrorCodes::ProtocolError, str));
+            return false;
+        }
+
+        _inBuffer = SharedBuffer::allocate(msgLen);
+        memcpy(_inBuffer.get(), _header, kHeaderSize);
+        _inFilled = kHeaderSize;
+        _inLength = msgLen;
+        return true;
+    }
+
+    bool _finishIfComplete() {
+        if (_inFilled < _inLength) {
+            return false;
+        }
+
+        networkCounter.hitPhysicalIn(_inLength);
+        auto promise = std::move(*_sourcePromise);
+        _sourcePromise.reset();
+        promise.emplaceValue(Message(std::move(_inBuffer)));
+        return true;
+    }
+
+    void _failSource(Status status) {
+        auto promise = std::move(*_sourcePromise);
+        _sourcePromise.reset();
+        promise.setError(std::move(status));
+    }
+
+    // Sends an HTTP response back to a client that's trying to use HTTP over a native MongoDB
+    // port, then fails the message being sourced.
+    void _sendHTTPResponse() {
+        constexpr auto userMsg =
+            "It looks like you are trying to access MongoDB over HTTP"
+            " on the native driver port.\r\n"_sd;
+
+        static const std::string httpResp = str::stream() << "HTTP/1.0 200 OK\r\n"
+                                                             "Connection: close\r\n"
+                                                             "Content-Type: text/plain\r\n"
+                                                             "Content-Length: "
+                                                          << userMsg.size() << "\r\n\r\n"
+                                                          << userMsg;
+
+        auto promise = std::move(*_sourcePromise);
+        _sourcePromise.reset();
+        _write({}, {iovec{const_cast<char*>(httpResp.data()), httpResp.size()}})
+            .getAsync([promise = std::move(promise)](Status status) mutable {
+                if (!status.isOK()) {
+                    return promise.setError(
+                        {ErrorCodes::ProtocolError,
+                         str::stream()
+                             << "Client sent an HTTP request over a native MongoDB connection, "
+                                "but there was an error sending a response: "
+                             << status.toString()});
+                }
+                promise.setError({ErrorCodes::ProtocolError,
+                                  "Client sent an HTTP request over a native MongoDB connection"});
+            });
+    }
+
+    Future<void> _sinkMessageImpl(Message message) {
+        // Documents the message references are sent straight from the buffers which own them.
+        const auto size = message.size();
+        std::vector<iovec> iov;
+        for (auto&& range : message.buffers()) {
+            iov.push_back({const_cast<char*>(range.data()), range.length()});
+        }
+        return _write(std::move(message), std::move(iov)).then([size] {
+            networkCounter.hitPhysicalOut(size);
+        });
+    }
+
+    /**
+     * Writes the buffers in 'iov', which 'message' keeps alive if it isn't empty.
+     */
+    Future<void> _write(Message message, std::vector<iovec> iov) {
+        auto pf = makePromiseFuture<void>();
+        auto state = std::make_shared<WriteState>(
+            WriteState{std::move(pf.promise), std::move(message), std::move(iov)});
+        _writeMore(std::move(state));
+        return std::move(pf.future);
+    }
+
+    void _writeMore(std::shared_ptr<WriteState> state) {
+        auto op = std::make_unique<Operation>();
+        op->timeout = _timeout;
+        op->prepare = [this, state](io_uring_sqe* sqe) {
+            const auto remaining = state->iov.size() - state->next;
+            sqe->fd = _fd;
+            sqe->msg_flags = MSG_NOSIGNAL;
+            if (remaining == 1) {
+                sqe->opcode = IORING_OP_SEND;
+                sqe->addr = reinterpret_cast<uint64_t>(state->iov[state->next].iov_base);
+                sqe->len = state->iov[state->next].iov_len;
+                return;
+            }
+
+            state->msg = {};
+            state->msg.msg_iov = &state->iov[state->next];
+            state->msg.msg_iovlen = std::min<size_t>(remaining, IOV_MAX);
+            sqe->opcode = IORING_OP_SENDMSG;
+            sqe->addr = reinterpret_cast<uint64_t>(&state->msg);
+            sqe->len = 1;
+        };
+        op->complete = [this, self = _self(), state, hadTimeout = bool(_timeout)](int res,
+                                                                                 uint32_t) {
+            if (res == -EINTR) {
+                return _writeMore(std::move(state));
+            }
+            if (res < 0) {
+                return state->promise.setError(ioResultToStatus(res, hadTimeout));
+            }
+
+            for (size_t sent = res; sent && state->next < state->iov.size();) {
+                auto& buffer = state->iov[state->next];
+                if (sent < buffer.iov_len) {
+                    buffer.iov_base = static_cast<char*>(buffer.iov_base) + sent;
+                    buffer.iov_len -= sent;
+                    break;
+                }
+                sent -= buffer.iov_len;
+                state->next++;
+            }
+            if (state->next < state->iov.size()) {
+                return _writeMore(std::move(state));
+            }
+            state->promise.emplaceValue();
+        };
+        _tl->_submit(std::move(op));
+    }
+
+    TransportLayerIoUring* const _tl;
+    const int _fd;
+
+    HostAndPort _remote;
+    HostAndPort _local;
+
+    SockAddr _remoteAddr;
+    SockAddr _localAddr;
+
+    boost::optional<Milliseconds> _timeout;
+
+    // The message being sourced. Only the thread sourcing a message uses these until it queues the
+    // first read, after which only the ring thread does until the message is finished.
+    boost::optional<Promise<Message>> _sourcePromise;
+    char _header[kHeaderSize];
+    size_t _headerFilled = 0;
+    SharedBuffer _inBuffer;
+    size_t _inFilled = 0;
+    size_t _inLength = 0;
+    int _registeredBuffer = -1;
+
+    // Bytes read past the end of the last message, which start the next one.
+    std::string _readAhead;
+};
+
+TransportLayerIoUring::Options::Options(const ServerGlobalParams* params)
+    : port(params->port),
+      ipList(params->bind_ips),
+      useUnixSockets(!params->noUnixSocket),
+      enableIPv6(params->enableIPv6) {}
+
+TransportLayerIoUring::TransportLayerIoUring(const Options& opts, ServiceEntryPoint* sep)
+    : _sep(sep), _listenerOptions(opts) {}
+
+TransportLayerIoUring::~TransportLayerIoUring() {
+    shutdown();
+    if (_ringThread.joinable()) {
+        _ringThread.join();
+    }
+
+    for (auto& listener : _listeners) {
+        ::close(listener->fd);
+    }
+    if (_wakeupFd >= 0) {
+        ::close(_wakeupFd);
+    }
+}
+
+StatusWith<SessionHandle> TransportLayerIoUring::connect(HostAndPort peer,
+                                                         ConnectSSLMode sslMode,
+                                                         Milliseconds timeout) {
+    return Status(ErrorCodes::NotImplemented,
+                  "The io_uring transport layer does not make outgoing connections");
+}
+
+Future<SessionHandle> TransportLayerIoUring::asyncConnect(HostAndPort peer,
+                                                          ConnectSSLMode sslMode,
+                                                          const ReactorHandle& reactor,
+                                                          Milliseconds timeout) {
+    return Future<SessionHandle>::makeReady(
+        Status(ErrorCodes::NotImplemented,
+               "The io_uring transport layer does not make outgoing connections"));
+}
+
+Status TransportLayerIoUring::setup() {
+#ifdef MONGO_CONFIG_SSL
+    if (getSSLGlobalParams().sslMode.load() != SSLParams::SSLMode_disabled) {
+        return {ErrorCodes::InvalidOptions, "The io_uring transport layer does not support TLS"};
+    }
+#endif
+
+    if (!IoUring::isSupported()) {
+        return {ErrorCodes::InvalidOptions,
+                "The io_uring transport layer requires a kernel which supports io_uring"};
+    }
+
+    std::vector<std::string> listenAddrs = _listenerOptions.ipList;
+    if (listenAddrs.empty()) {
+        listenAddrs = {"127.0.0.1"};
+        if (_listenerOptions.enableIPv6) {
+            listenAddrs.emplace_back("::1");
+        }
+    }
+    if (_listenerOptions.useUnixSockets) {
+        listenAddrs.emplace_back(makeUnixSockPath(_listenerOptions.port));
+    }
+
+    _listenerPort = _listenerOptions.port;
+
+    // Self-deduplicating list of unique endpoint addresses.
+    std::set<SockAddr> endpoints;
+    for (auto& ip : listenAddrs) {
+        if (ip.empty()) {
+            warning() << "Skipping empty bind address";
+            continue;
+        }
+
+        auto addrs = SockAddr::createAll(
+            ip, _listenerPort, _listenerOptions.enableIPv6 ? AF_UNSPEC : AF_INET);
+        if (addrs.empty()) {
+            warning() << "Found no addresses for " << ip;
+            continue;
+        }
+        endpoints.insert(addrs.begin(), addrs.end());
+    }
+
+    for (auto& addr : endpoints) {
+        if (addr.getType() == AF_UNIX) {
+            if (::unlink(addr.getAddr().c_str()) == -1 && errno != ENOENT) {
+                return {ErrorCodes::SocketException,
+                        str::stream() << "Failed to unlink socket file " << addr.getAddr() << " "
+                                      << errnoWithDescription()};
+            }
+        }
+        if (addr.getType() == AF_INET6 && !_listenerOptions.enableIPv6) {
+            return {ErrorCodes::BadValue, "Specified ipv6 bind address, but ipv6 is disabled"};
+        }
+
+        auto listener = std::make_unique<Listener>(Listener{addr, -1});
+        listener->fd = ::socket(addr.getType(), SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listener->fd < 0) {
+            return {ErrorCodes::SocketException,
+                    str::stream() << "Failed to create a socket for " << addr.toString() << ": "
+                                  << errnoWithDescription()};
+        }
+        _listeners.push_back(std::move(listener));
+        const int fd = _listeners.back()->fd;
+
+        const int on = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        if (addr.getType() == AF_INET6) {
+            ::setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &on, sizeof(on));
+        }
+
+        if (::bind(fd, addr.raw(), addr.addressSize) != 0) {
+            return {ErrorCodes::SocketException,
+                    str::stream() << "Failed to bind to " << addr.toString() << ": "
+                                  << errnoWithDescription()};
+        }
+
+        if (addr.getType() == AF_UNIX) {
+            if (::chmod(addr.getAddr().c_str(), serverGlobalParams.unixSocketPermissions) == -1) {
+                return {ErrorCodes::SocketException,
+                        str::stream() << "Failed to chmod socket file " << addr.getAddr() << " "
+                                      << errnoWithDescription()};
+            }
+        }
+
+        if (_listenerOptions.port == 0 && addr.isIP()) {
+            if (_listenerPort != _listenerOptions.port) {
+                return Status(ErrorCodes::BadValue,
+                              "Port 0 (ephemeral port) is not allowed when"
+                              " listening on multiple IP interfaces");
+            }
+            try {
+                _listenerPort = getSocketAddress(fd, false).getPort();
+            } catch (const DBException& ex) {
+                return ex.toStatus();
+            }
+        }
+    }
+
+    if (_listeners.empty()) {
+        return Status(ErrorCodes::SocketException, "No available addresses/ports to bind to");
+    }
+
+    _wakeupFd = ::eventfd(0, EFD_CLOEXEC);
+    if (_wakeupFd < 0) {
+        return {ErrorCodes::UnknownError,
+                str::stream() << "error in creating eventfd: " << errnoWithDescription()};
+    }
+
+    try {
+        _ring = std::make_unique<IoUring>(ioUringQueueDepth);
+    } catch (const DBException& ex) {
+        return ex.toStatus();
+    }
+
+    const size_t bufferCount = ioUringRegisteredBufferCount;
+    if (bufferCount > 0) {
+        _registeredBufferSize = ioUringRegisteredBufferSizeBytes;
+        _registeredBuffers = std::make_unique<char[]>(bufferCount * _registeredBufferSize);
+
+        std::vector<iovec> iovecs;
+        for (size_t i = 0; i < bufferCount; ++i) {
+            iovecs.push_back({_getRegisteredBuffer(i), _registeredBufferSize});
+        }
+
+        // Registering the buffers pins them, which the locked memory limit may not allow.
+        auto status = _ring->registerBuffers(iovecs);
+        if (status.isOK()) {
+            for (int i = bufferCount - 1; i >= 0; --i) {
+                _freeRegisteredBuffers.push_back(i);
+            }
+        } else {
+            warning() << "Reading messages without registered buffers: " << status;
+            _registeredBuffers.reset();
+            _registeredBufferSize = 0;
+        }
+    }
+
+    return Status::OK();
+}
+
+Status TransportLayerIoUring::start() {
+    _running.store(true);
+
+    for (auto& listener : _listeners) {
+        if (::listen(listener->fd, serverGlobalParams.listenBacklog) != 0) {
+            return {ErrorCodes::SocketException,
+                    str::stream() << "Failed to listen on " << listener->addr.toString() << ": "
+                                  << errnoWithDescription()};
+        }
+        _acceptConnections(listener.get());
+        log() << "Listening on " << listener->addr.getAddr();
+    }
+    _armWakeup();
+
+    _ringThread = stdx::thread([this] { _runRing(); });
+
+    log() << "Using the io_uring transport layer";
+    log() << "waiting for connections on port " << _listenerPort;
+    return Status::OK();
+}
+
+void TransportLayerIoUring::shutdown() {
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        if (_stopped) {
+            return;
+        }
+        _stopped = true;
+    }
+    _running.store(false);
+
+    // Shutting the listening sockets down completes the accepts queued on them.
+    for (auto& listener : _listeners) {
+        ::shutdown(listener->fd, SHUT_RDWR);
+        auto& addr = listener->addr;
+        if (addr.getType() == AF_UNIX && !addr.isAnonymousUNIXSocket()) {
+            auto path = addr.getAddr();
+            log() << "removing socket file: " << path;
+            if (::unlink(path.c_str()) != 0) {
+                const auto ewd = errnoWithDescription();
+                warning() << "Unable to remove UNIX socket " << path << ": " << ewd;
+            }
+        }
+    }
+
+    // The ring thread cancels everything in flight, and exits once it has all completed.
+    _wakeRing();
+}
+
+ReactorHandle TransportLayerIoUring::getReactor(WhichReactor which) {
+    // The ring is only driven by the ring thread, so there is no reactor to run elsewhere.
+    MONGO_UNREACHABLE;
+}
+
+void TransportLayerIoUring::_submit(std::unique_ptr<Operation> op) {
+    stdx::unique_lock<Latch> lk(_mutex);
+    if (_stopped) {
+        lk.unlock();
+        op->complete(-ECANCELED, 0);
+        return;
+    }
+
+    const bool wasEmpty = _pending.empty();
+    _pending.push_back(std::move(op));
+    lk.unlock();
+
+    // The ring thread picks up everything queued before it next submits, so it only needs waking
+    // for the first operation queued while it may be waiting for completions.
+    if (wasEmpty && ringThreadOwner != this) {
+        _wakeRing();
+    }
+}
+
+void TransportLayerIoUring::_wakeRing() {
+    if (_wakeupFd < 0) {
+        return;
+    }
+    while (::eventfd_write(_wakeupFd, 1) != 0) {
+        invariant(errno == EINTR);
+    }
+}
+
+void TransportLayerIoUring::_acceptConnections(Listener* listener) {
+    auto op = std::make_unique<Operation>();
+    op->prepare = [listener](io_uring_sqe* sqe) {
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->fd = listener->fd;
+        sqe->accept_flags = SOCK_CLOEXEC;
+        if (listener->multishot) {
+            sqe->ioprio |= IORING_ACCEPT_MULTISHOT;
+        }
+    };
+    op->complete = [this, listener](int res, uint32_t flags) {
+        if (!_running.load()) {
+            if (res >= 0) {
+                ::close(res);
+            }
+            return;
+        }
+
+        if (res == -EINVAL && listener->multishot) {
+            LOG(1) << "Multishot accept is not supported, accepting one connection at a time";
+            listener->multishot = false;
+        } else if (res < 0) {
+            log() << "Error accepting new connection on " << listener->addr.toString() << ": "
+                  << errnoWithDescription(-res);
+        } else {
+            std::shared_ptr<IoUringSession> session;
+            try {
+                session = std::make_shared<IoUringSession>(this, res);
+            } catch (const DBException& e) {
+                ::close(res);
+                warning() << "Error accepting new connection " << e;
+            }
+            if (session) {
+                try {
+                    _sep->startSession(std::move(session));
+                } catch (const DBException& e) {
+                    warning() << "Error accepting new connection " << e;
+                }
+            }
+        }
+
+        // Multishot accepts keep producing connections until the kernel ends them.
+        if (!(flags & IORING_CQE_F_MORE)) {
+            _acceptConnections(listener);
+        }
+    };
+    _submit(std::move(op));
+}
+
+void TransportLayerIoUring::_armWakeup() {
+    auto op = std::make_unique<Operation>();
+    op->prepare = [this](io_uring_sqe* sqe) {
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = _wakeupFd;
+        sqe->addr = reinterpret_cast<uint64_t>(&_wakeupValue);
+        sqe->len = sizeof(_wakeupValue);
+    };
+    op->complete = [this](int res, uint32_t) {
+        if (res >= 0) {
+            _armWakeup();
+        }
+    };
+    _submit(std::move(op));
+}
+
+void TransportLayerIoUring::_prepare(std::unique_ptr<Operation> op) {
+    const unsigned entriesNeeded = op->timeout ? 2 : 1;
+    while (_ring->spaceLeft() < entriesNeeded) {
+        // Submitting frees up the submission queue, unless the completion queue is full, in which
+        // case completions have to be handled first.
+        fassert(51264, _ring->submitAndWait(0));
+        if (_ring->spaceLeft() < entriesNeeded) {
+            _reapCompletions();
+        }
+    }
+
+    auto sqe = _ring->getSqe();
+    op->prepare(sqe);
+    if (op->timeout) {
+        sqe->flags |= IOSQE_IO_LINK;
+        op->timeoutSpec.tv_sec = durationCount<Seconds>(*op->timeout);
+        op->timeoutSpec.tv_nsec =
+            durationCount<Nanoseconds>(*op->timeout - Seconds(op->timeoutSpec.tv_sec));
+
+        auto timeoutSqe = _ring->getSqe();
+        timeoutSqe->opcode = IORING_OP_LINK_TIMEOUT;
+        timeoutSqe->addr = reinterpret_cast<uint64_t>(&op->timeoutSpec);
+        timeoutSqe->len = 1;
+        timeoutSqe->user_data = kIgnoredUserData;
+    }
+    sqe->user_data = reinterpret_cast<uint64_t>(op.release());
+    ++_inFlight;
+}
+
+void TransportLayerIoUring::_reapCompletions() {
+    _ring->reapCompletions([&](const io_uring_cqe& cqe) {
+        if (cqe.user_data == kIgnoredUserData) {
+            return;
+        }
+
+        auto op = reinterpret_cast<Operation*>(cqe.user_data);
+        op->complete(cqe.res, cqe.flags);
+        if (!(cqe.flags & IORING_CQE_F_MORE)) {
+            delete op;
+            --_inFlight;
+        }
+    });
+}
+
+void TransportLayerIoUring::_runRing() {
+    setThreadName("ioUringRing");
+    ringThreadOwner = this;
+
+    bool canceledAll = false;
+    while (true) {
+        std::vector<std::unique_ptr<Operation>> pending;
+        bool stopped;
+        {
+            stdx::lock_guard<Latch> lk(_mutex);
+            pending.swap(_pending);
+            stopped = _stopped;
+        }
+
+        if (stopped) {
+            // Nothing more is submitted after the operations in flight are canceled.
+            for (auto& op : pending) {
+                op->complete(-ECANCELED, 0);
+            }
+            pending.clear();
+
+            if (!canceledAll) {
+                canceledAll = true;
+                auto op = std::make_unique<Operation>();
+                op->prepare = [](io_uring_sqe* sqe) {
+                    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+                    sqe->fd = -1;
+                    sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY | IORING_ASYNC_CANCEL_ALL;
+                };
+                op->complete = [](int res, uint32_t) {
+                    if (res < 0 && res != -ENOENT) {
+                        warning() << "Failed to cancel io_uring operations at shutdown: "
+                                  << errnoWithDescription(-res);
+                    }
+                };
+                pending.push_back(std::move(op));
+            }
+        }
+
+        for (auto& op : pending) {
+            _prepare(std::move(op));
+        }
+
+        if (stopped && _inFlight == 0) {
+            break;
+        }
+
+        fassert(51265, _ring->submitAndWait(1));
+        _reapCompletions();
+    }
+}
+
+int TransportLayerIoUring::_takeRegisteredBuffer() {
+    if (_freeRegisteredBuffers.empty()) {
+        return -1;
+    }
+    auto index = _freeRegisteredBuffers.back();
+    _freeRegisteredBuffers.pop_back();
+    return index;
+}
+
+void TransportLayerIoUring::_returnRegisteredBuffer(int index) {
+    _freeRegisteredBuffers.push_back(index);
+}
+
+}  // namespace transport
+}  // namespace mongo
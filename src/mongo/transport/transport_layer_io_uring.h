@@ -0,0 +1,191 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/db/server_options.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/transport/io_uring.h"
+#include "mongo/transport/transport_layer.h"
+#include "mongo/util/functional.h"
+#include "mongo/util/net/sockaddr.h"
+
+namespace mongo {
+
+class ServiceEntryPoint;
+
+namespace transport {
+
+/**
+ * An ingress-only TransportLayer for Linux built on io_uring.
+ *
+ * A single ring thread owns the ring. Reads and writes requested by any session are queued, and
+ * the ring thread submits everything queued since its last pass with one io_uring_enter() call,
+ * which also waits for the next completions. Listening sockets use multishot accepts, and the
+ * first read of every message goes into a buffer registered with the ring, which usually holds
+ * the header and body together. Completions are handled on the ring thread, which fulfills the
+ * futures returned by the sessions.
+ *
+ * Outgoing connections are not supported; they are made by a separate egress TransportLayerASIO.
+ */
+class TransportLayerIoUring final : public TransportLayer {
+    TransportLayerIoUring(const TransportLayerIoUring&) = delete;
+    TransportLayerIoUring& operator=(const TransportLayerIoUring&) = delete;
+
+public:
+    struct Options {
+        explicit Options(const ServerGlobalParams* params);
+        Options() = default;
+
+        int port = ServerGlobalParams::DefaultDBPort;  // port to bind to
+        std::vector<std::string> ipList;               // addresses to bind to
+        bool useUnixSockets = true;                    // whether to allow UNIX sockets in ipList
+        bool enableIPv6 = false;                       // whether to allow IPv6 sockets in ipList
+    };
+
+    TransportLayerIoUring(const Options& opts, ServiceEntryPoint* sep);
+
+    ~TransportLayerIoUring();
+
+    StatusWith<SessionHandle> connect(HostAndPort peer,
+                                      ConnectSSLMode sslMode,
+                                      Milliseconds timeout) final;
+
+    Future<SessionHandle> asyncConnect(HostAndPort peer,
+                                       ConnectSSLMode sslMode,
+                                       const ReactorHandle& reactor,
+                                       Milliseconds timeout) final;
+
+    Status setup() final;
+
+    Status start() final;
+
+    void shutdown() final;
+
+    ReactorHandle getReactor(WhichReactor which) final;
+
+    int listenerPort() const {
+        return _listenerPort;
+    }
+
+private:
+    class IoUringSession;
+
+    /**
+     * One request submitted to the ring. It is owned by the ring thread from when it is submitted
+     * until its last completion has been handled.
+     */
+    struct Operation {
+        // Fills in the submission queue entry, apart from its user data.
+        unique_function<void(io_uring_sqe*)> prepare;
+
+        // Called on the ring thread with the result and flags of every completion.
+        unique_function<void(int, uint32_t)> complete;
+
+        // If set, the operation is canceled if it does not complete within this time.
+        boost::optional<Milliseconds> timeout;
+        __kernel_timespec timeoutSpec;
+    };
+
+    struct Listener {
+        SockAddr addr;
+        int fd;
+        bool multishot = true;
+    };
+
+    /**
+     * Queues 'op' for the ring thread to submit. If the ring thread is no longer running, instead
+     * completes it with -ECANCELED.
+     */
+    void _submit(std::unique_ptr<Operation> op);
+
+    void _wakeRing();
+
+    void _acceptConnections(Listener* listener);
+    void _armWakeup();
+
+    /**
+     * Moves 'op' into the submission queue of the ring, making room for it first if needed. Only
+     * called on the ring thread.
+     */
+    void _prepare(std::unique_ptr<Operation> op);
+    void _reapCompletions();
+    void _runRing();
+
+    /**
+     * Returns the index of a free registered buffer, or -1 if there are none. Only called on the
+     * ring thread.
+     */
+    int _takeRegisteredBuffer();
+    void _returnRegisteredBuffer(int index);
+
+    char* _getRegisteredBuffer(int index) {
+        return _registeredBuffers.get() + index * _registeredBufferSize;
+    }
+
+    Mutex _mutex = MONGO_MAKE_LATCH("TransportLayerIoUring::_mutex");
+
+    // Operations waiting for the ring thread to submit them, and whether it has stopped taking
+    // them.
+    std::vector<std::unique_ptr<Operation>> _pending;
+    bool _stopped = false;
+
+    std::unique_ptr<IoUring> _ring;
+    stdx::thread _ringThread;
+
+    // Written to wake the ring thread when operations are queued while it waits for completions.
+    int _wakeupFd = -1;
+    uint64_t _wakeupValue = 0;
+
+    // The registered buffers and the indexes of those not being read into.
+    std::unique_ptr<char[]> _registeredBuffers;
+    size_t _registeredBufferSize = 0;
+    std::vector<int> _freeRegisteredBuffers;
+
+    // The number of operations submitted to the ring whose last completion has not been handled.
+    size_t _inFlight = 0;
+
+    std::vector<std::unique_ptr<Listener>> _listeners;
+
+    ServiceEntryPoint* const _sep = nullptr;
+    AtomicWord<bool> _running{false};
+    Options _listenerOptions;
+    // The real incoming port in case of _listenerOptions.port==0 (ephemeral).
+    int _listenerPort = 0;
+};
+
+}  // namespace transport
+}  // namespace mongo
@@ -0,0 +1,249 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/transport_layer_io_uring.h"
+
+#include "mongo/db/server_options.h"
+#include "mongo/rpc/op_msg.h"
+#include "mongo/transport/service_entry_point.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/log.h"
+#include "mongo/util/net/sock.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Runs a thread for every session, which sends every message it receives straight back.
+ */
+class EchoServiceEntryPoint : public ServiceEntryPoint {
+public:
+    ~EchoServiceEntryPoint() override {
+        shutdown(Milliseconds::max());
+    }
+
+    void startSession(transport::SessionHandle session) override {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _sessions.push_back(session);
+        _threads.emplace_back([session] {
+            while (true) {
+                auto swMsg = session->sourceMessage();
+                if (!swMsg.isOK()) {
+                    log() << "Ending echo session: " << swMsg.getStatus();
+                    return;
+                }
+                if (!session->sinkMessage(std::move(swMsg.getValue())).isOK()) {
+                    return;
+                }
+            }
+        });
+        _cv.notify_all();
+    }
+
+    void endAllSessions(transport::Session::TagMask tags) override {
+        stdx::lock_guard<Latch> lk(_mutex);
+        for (auto& session : _sessions) {
+            session->end();
+        }
+    }
+
+    Status start() override {
+        return Status::OK();
+    }
+
+    bool shutdown(Milliseconds timeout) override {
+        endAllSessions({});
+        for (auto& thread : _threads) {
+            thread.join();
+        }
+        _threads.clear();
+        return true;
+    }
+
+    void appendStats(BSONObjBuilder*) const override {}
+
+    size_t numOpenSessions() const override {
+        stdx::lock_guard<Latch> lk(_mutex);
+        return _sessions.size();
+    }
+
+    DbResponse handleRequest(OperationContext* opCtx, const Message& request) override {
+        MONGO_UNREACHABLE;
+    }
+
+    void waitForSessions(size_t count) {
+        stdx::unique_lock<Latch> lk(_mutex);
+        _cv.wait(lk, [&] { return _sessions.size() >= count; });
+    }
+
+private:
+    mutable Mutex _mutex = MONGO_MAKE_LATCH("EchoServiceEntryPoint::_mutex");
+    stdx::condition_variable _cv;
+    std::vector<transport::SessionHandle> _sessions;
+    std::vector<stdx::thread> _threads;
+};
+
+class TransportLayerIoUringTest : public unittest::Test {
+protected:
+    void setUp() override {
+        if (!transport::IoUring::isSupported()) {
+            return;
+        }
+
+        ServerGlobalParams params;
+        params.noUnixSocket = true;
+        transport::TransportLayerIoUring::Options opts(&params);
+        opts.port = 0;
+
+        tl = std::make_unique<transport::TransportLayerIoUring>(opts, &sep);
+        ASSERT_OK(tl->setup());
+        ASSERT_OK(tl->start());
+        ASSERT_GT(tl->listenerPort(), 0);
+    }
+
+    void tearDown() override {
+        sep.shutdown(Milliseconds::max());
+        tl.reset();
+    }
+
+    std::unique_ptr<Socket> connect() {
+        auto socket = std::make_unique<Socket>();
+        SockAddr sa{"localhost", tl->listenerPort(), AF_INET};
+        ASSERT_TRUE(socket->connect(sa));
+        return socket;
+    }
+
+    static Message makeMessage(int i, size_t padding) {
+        OpMsg msg;
+        msg.body = BSON("ping" << i << "padding" << std::string(padding, 'x'));
+        return msg.serialize();
+    }
+
+    static BSONObj receiveReply(Socket* socket) {
+        MSGHEADER::Value header;
+        socket->recv(reinterpret_cast<char*>(&header), sizeof(header));
+        const auto msgLen = MSGHEADER::ConstView(reinterpret_cast<char*>(&header))
+                                .getMessageLength();
+
+        auto buffer = SharedBuffer::allocate(msgLen);
+        memcpy(buffer.get(), &header, sizeof(header));
+        socket->recv(buffer.get() + sizeof(header), msgLen - sizeof(header));
+        return OpMsg::parseOwned(Message(std::move(buffer))).body;
+    }
+
+    EchoServiceEntryPoint sep;
+    std::unique_ptr<transport::TransportLayerIoUring> tl;
+};
+
+TEST_F(TransportLayerIoUringTest, EchoesMessagesOfAllSizes) {
+    if (!tl) {
+        log() << "Skipping test since io_uring is not supported";
+        return;
+    }
+
+    auto socket = connect();
+    sep.waitForSessions(1);
+
+    // Messages which fit in a registered buffer, and ones which need reading in several parts.
+    for (size_t padding : {size_t(0), size_t(1000), size_t(100 * 1000), size_t(4 * 1000 * 1000)}) {
+        auto msg = makeMessage(padding, padding);
+        socket->send(msg.buf(), msg.size(), "io_uring test");
+        auto reply = receiveReply(socket.get());
+        ASSERT_EQ(reply["ping"].numberInt(), static_cast<int>(padding));
+        ASSERT_EQ(reply["padding"].str().size(), padding);
+    }
+}
+
+TEST_F(TransportLayerIoUringTest, ReadsMessagesSentTogether) {
+    if (!tl) {
+        log() << "Skipping test since io_uring is not supported";
+        return;
+    }
+
+    auto socket = connect();
+    sep.waitForSessions(1);
+
+    // A single send of several messages is likely read all at once, so the messages after the
+    // first must be kept for the reads which follow.
+    std::string together;
+    for (int i = 0; i < 10; ++i) {
+        auto msg = makeMessage(i, 10 * i);
+        together.append(msg.buf(), msg.size());
+    }
+    socket->send(together.data(), together.size(), "io_uring test");
+
+    for (int i = 0; i < 10; ++i) {
+        auto reply = receiveReply(socket.get());
+        ASSERT_EQ(reply["ping"].numberInt(), i);
+    }
+}
+
+TEST_F(TransportLayerIoUringTest, ServesManySessionsAtOnce) {
+    if (!tl) {
+        log() << "Skipping test since io_uring is not supported";
+        return;
+    }
+
+    std::vector<std::unique_ptr<Socket>> sockets;
+    for (int i = 0; i < 20; ++i) {
+        sockets.push_back(connect());
+    }
+    sep.waitForSessions(sockets.size());
+
+    for (int round = 0; round < 5; ++round) {
+        for (size_t i = 0; i < sockets.size(); ++i) {
+            auto msg = makeMessage(i, 100);
+            sockets[i]->send(msg.buf(), msg.size(), "io_uring test");
+        }
+        for (size_t i = 0; i < sockets.size(); ++i) {
+            ASSERT_EQ(receiveReply(sockets[i].get())["ping"].numberInt(), static_cast<int>(i));
+        }
+    }
+}
+
+TEST_F(TransportLayerIoUringTest, SessionEndsWhenClientDisconnects) {
+    if (!tl) {
+        log() << "Skipping test since io_uring is not supported";
+        return;
+    }
+
+    auto socket = connect();
+    sep.waitForSessions(1);
+    socket.reset();
+
+    // The echo thread sees the session end, which lets tearDown() join it.
+}
+
+}  // namespace
+}  // namespace mongo
@@ -36,12 +36,17 @@
 #include <memory>
 
 #include "mongo/base/status.h"
+#include "mongo/config.h"
 #include "mongo/db/server_options.h"
 #include "mongo/db/service_context.h"
 #include "mongo/transport/service_executor_adaptive.h"
 #include "mongo/transport/service_executor_synchronous.h"
+#include "mongo/transport/service_executor_thread_per_core.h"
 #include "mongo/transport/session.h"
 #include "mongo/transport/transport_layer_asio.h"
+#ifdef MONGO_CONFIG_IO_URING
+#include "mongo/transport/transport_layer_io_uring.h"
+#endif
 #include "mongo/util/net/ssl_types.h"
 #include "mongo/util/time_support.h"
 
@@ -136,17 +141,41 @@ std::unique_ptr<TransportLayer> TransportLayerManager::createWithConfig(
     transport::TransportLayerASIO::Options opts(config);
     if (config->serviceExecutor == "adaptive") {
         opts.transportMode = transport::Mode::kAsynchronous;
+    } else if (config->serviceExecutor == "threadPerCore") {
+        opts.transportMode = transport::Mode::kAsynchronous;
+        opts.ingressReactorCount = ServiceExecutorThreadPerCore::configuredCoreCount();
     } else if (config->serviceExecutor == "synchronous") {
         opts.transportMode = transport::Mode::kSynchronous;
     } else {
         MONGO_UNREACHABLE;
     }
 
+#ifdef MONGO_CONFIG_IO_URING
+    if (config->transportLayer == "iouring") {
+        // Sessions are accepted by the io_uring transport layer, which only supports the
+        // synchronous executor, while the ASIO one makes outgoing connections. The ASIO one comes
+        // first, since connect() goes to the first transport layer.
+        invariant(config->serviceExecutor == "synchronous");
+        opts.mode = transport::TransportLayerASIO::Options::kEgress;
+        opts.ipList.clear();
+
+        std::vector<std::unique_ptr<TransportLayer>> retVector;
+        retVector.emplace_back(std::make_unique<transport::TransportLayerASIO>(opts, nullptr));
+        retVector.emplace_back(std::make_unique<transport::TransportLayerIoUring>(
+            transport::TransportLayerIoUring::Options(config), sep));
+        ctx->setServiceExecutor(std::make_unique<ServiceExecutorSynchronous>(ctx));
+        return std::make_unique<TransportLayerManager>(std::move(retVector));
+    }
+#endif
+
     auto transportLayerASIO = std::make_unique<transport::TransportLayerASIO>(opts, sep);
 
     if (config->serviceExecutor == "adaptive") {
         auto reactor = transportLayerASIO->getReactor(TransportLayer::kIngress);
         ctx->setServiceExecutor(std::make_unique<ServiceExecutorAdaptive>(ctx, std::move(reactor)));
+    } else if (config->serviceExecutor == "threadPerCore") {
+        ctx->setServiceExecutor(std::make_unique<ServiceExecutorThreadPerCore>(
+            ctx, transportLayerASIO->getIngressReactors()));
     } else if (config->serviceExecutor == "synchronous") {
         ctx->setServiceExecutor(std::make_unique<ServiceExecutorSynchronous>(ctx));
     }